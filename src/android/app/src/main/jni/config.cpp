@@ -138,6 +138,10 @@ void Config::ReadValues() {
     ReadSetting("Core", Settings::values.custom_cpu_ticks);
     ReadSetting("Core", Settings::values.core_downcount_hack);
     ReadSetting("Core", Settings::values.priority_boost);
+    ReadSetting("Core", Settings::values.incremental_save_states);
+    ReadSetting("Core", Settings::values.enable_rewind);
+    ReadSetting("Core", Settings::values.rewind_interval);
+    ReadSetting("Core", Settings::values.rewind_buffer_size);
 
     // Renderer
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", true);
@@ -157,6 +161,7 @@ void Config::ReadValues() {
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.shaders_accurate_mul);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
+    ReadSetting("Renderer", Settings::values.use_shader_jit_simd);
     ReadSetting("Renderer", Settings::values.resolution_factor);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.use_vsync_new);
@@ -252,6 +257,7 @@ void Config::ReadValues() {
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
     ReadSetting("Data Storage", Settings::values.hide_images);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
 
     // System
     ReadSetting("System", Settings::values.is_new_3ds);
@@ -310,6 +316,8 @@ void Config::ReadValues() {
     ReadSetting("Debugging", Settings::values.use_gdbstub);
     ReadSetting("Debugging", Settings::values.gdbstub_port);
     ReadSetting("Debugging", Settings::values.instant_debug_log);
+    ReadSetting("Debugging", Settings::values.binary_log);
+    Common::Log::SetBinaryLogEnabled(Settings::values.binary_log.GetValue());
 
     for (const auto& service_module : Service::service_module_map) {
         bool use_lle = sdl2_config->GetBoolean("Debugging", "LLE\\" + service_module.name, false);
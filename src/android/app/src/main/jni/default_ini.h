@@ -99,6 +99,21 @@ sustained_performance =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to write save states in the background as differences against a shared base state
+# 0 (default): Off, 1: On
+incremental_save_states =
+
+# Whether to keep recent states in memory so emulation can be rewound
+# 0 (default): Off, 1: On
+enable_rewind =
+
+# The number of frames between states kept for rewinding. Default is 30
+rewind_interval =
+
+# The amount of memory in MiB the states kept for rewinding may use, at least the size of the
+# emulated memory. Default is 256
+rewind_buffer_size =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance at the risk of freezing.
 # Overclocking may fix lagging, but at the risk of freezing.
@@ -180,6 +195,10 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether the shader JIT shades four vertices at once with SIMD instructions (x86_64 only)
+# 0 (default): Off, 1: On
+use_shader_jit_simd =
+
 # Perform presentation on seperate threads. Improves performance on Vulkan in most games.
 # 0: Off, 1 (default): On
 async_presentation =
@@ -428,6 +447,10 @@ input_device =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# The amount of memory in MiB used to cache decrypted RomFS data, shared by all open game files
+# Default is 8
+romfs_cache_size =
+
 # Whether to use custom storage locations
 # 1: Yes, 0 (default): No
 use_custom_storage =
@@ -553,6 +576,12 @@ gdbstub_port=24689
 # 0: Off, 1 (default): On
 instant_debug_log =
 
+# Write debug and info messages to borked3ds_log.bin without formatting them, which is much faster
+# when logging a lot. Decode the file with borked3ds-log-decoder. Warnings and errors are still
+# written to the text log.
+# 0 (default): Off, 1: On
+binary_log =
+
 # To LLE a service module add "LLE\<module name>=true"
 
 [WebService]
@@ -10,6 +10,7 @@
 #include "audio_core/hle/filter.h"
 #include "audio_core/hle/shared_memory.h"
 #include "common/common_types.h"
+#include "common/vector_math.h"
 
 namespace AudioCore::HLE {
 
@@ -44,7 +45,7 @@ void SourceFilters::ProcessFrame(StereoFrame16& frame) {
     }
 
     if (biquad_filter_enabled) {
-        FilterFrame(frame, biquad_filter);
+        biquad_filter.ProcessFrame(frame);
     }
 }
 
@@ -98,19 +99,67 @@ void SourceFilters::BiquadFilter::Configure(
     b2 = config.b2;
 }
 
-std::array<s16, 2> SourceFilters::BiquadFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    // b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] of each sample, with the history in front of the frame.
+    std::array<std::array<s16, 2>, samples_per_frame + 2> input;
+    std::array<std::array<s32, 2>, samples_per_frame> feedforward;
+    input[0] = x2;
+    input[1] = x1;
+    std::copy(frame.begin(), frame.end(), input.begin() + 2);
+
+    static_assert(samples_per_frame % 4 == 0);
+#if defined(HAVE_SSE2)
+    // Each channel of x[n], x[n-1] is multiplied with b0, b1 in a pair, x[n-2] with b2 and zero.
+    const __m128i b01 = _mm_set1_epi32(static_cast<u16>(b0) | (static_cast<u32>(b1) << 16));
+    const __m128i b2z = _mm_set1_epi32(static_cast<u16>(b2));
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const __m128i xn = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i + 2]));
+        const __m128i xn1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i + 1]));
+        const __m128i xn2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i low = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(xn, xn1), b01),
+                                          _mm_madd_epi16(_mm_unpacklo_epi16(xn2, zero), b2z));
+        const __m128i high = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(xn, xn1), b01),
+                                           _mm_madd_epi16(_mm_unpackhi_epi16(xn2, zero), b2z));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&feedforward[i]), low);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&feedforward[i + 2]), high);
+    }
+#elif defined(HAVE_NEON)
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int16x8_t xn = vld1q_s16(input[i + 2].data());
+        const int16x8_t xn1 = vld1q_s16(input[i + 1].data());
+        const int16x8_t xn2 = vld1q_s16(input[i].data());
+        int32x4_t low = vmull_n_s16(vget_low_s16(xn), static_cast<s16>(b0));
+        int32x4_t high = vmull_n_s16(vget_high_s16(xn), static_cast<s16>(b0));
+        low = vmlal_n_s16(low, vget_low_s16(xn1), static_cast<s16>(b1));
+        high = vmlal_n_s16(high, vget_high_s16(xn1), static_cast<s16>(b1));
+        low = vmlal_n_s16(low, vget_low_s16(xn2), static_cast<s16>(b2));
+        high = vmlal_n_s16(high, vget_high_s16(xn2), static_cast<s16>(b2));
+        vst1q_s32(feedforward[i].data(), low);
+        vst1q_s32(feedforward[i + 2].data(), high);
+    }
+#else
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            feedforward[i][channel] = b0 * input[i + 2][channel] + b1 * input[i + 1][channel] +
+                                      b2 * input[i][channel];
+        }
+    }
+#endif
+
+    for (std::size_t i = 0; i < samples_per_frame; i++) {
+        std::array<s16, 2> y0;
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s32 tmp = (feedforward[i][channel] + a1 * y1[channel] + a2 * y2[channel]) >> 14;
+            y0[channel] = std::clamp(tmp, -32768, 32767);
+        }
+        y2 = y1;
+        y1 = y0;
+        frame[i] = y0;
     }
 
-    x2 = x1;
-    x1 = x0;
-    y2 = y1;
-    y1 = y0;
-
-    return y0;
+    x2 = input[samples_per_frame];
+    x1 = input[samples_per_frame + 1];
 }
 
 } // namespace AudioCore::HLE
@@ -96,11 +96,11 @@ private:
         void Configure(SourceConfiguration::Configuration::BiquadFilter config);
 
         /**
-         * Processes a single stereo PCM16 sample.
-         * @param x0 Input sample
-         * @return Output sample
+         * Processes a frame in-place. The feedforward part of the filter is computed for the
+         * whole frame before the samples are run through the feedback part one by one.
+         * @param frame Audio samples to process. Modified in-place.
          */
-        std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0);
+        void ProcessFrame(StereoFrame16& frame);
 
     private:
         // Configuration
@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <thread>
 
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -25,6 +26,7 @@
 #include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -48,6 +50,10 @@ SERIALIZE_IMPL(DspHle)
 // This value has been verified against a rough hardware test with hardware and LLE
 static constexpr u64 audio_frame_ticks = samples_per_frame * 4096 * 2ull; ///< Units: ARM11 cycles
 
+/// Sources are ticked on the worker threads when at least this many were enabled last frame, below
+/// that waking the workers costs more than it saves.
+static constexpr std::size_t parallel_sources_threshold = 4;
+
 struct DspHle::Impl final {
 public:
     explicit Impl(DspHle& parent, Memory::MemorySystem& memory, Core::Timing& timing);
@@ -92,6 +98,11 @@ private:
     }};
     HLE::Mixers mixers{};
 
+    Common::ThreadWorker source_workers{
+        std::clamp(std::thread::hardware_concurrency() / 4, 1U, 3U), "DspHle"};
+    /// Number of sources that were enabled during the last frame.
+    std::size_t enabled_sources = 0;
+
     DspHle& parent;
     Core::Timing& core_timing;
     Core::TimingEventType* tick_event{};
@@ -104,7 +115,10 @@ private:
     void serialize(Archive& ar, const unsigned int) {
         ar & dsp_state;
         ar & pipe_data;
-        ar & dsp_memory.raw_memory;
+        // The rewind buffer stores the contents itself
+        if (Core::System::GetInstance().SerializesStateRegions()) {
+            ar & dsp_memory.raw_memory;
+        }
         ar & sources;
         ar & mixers;
         // interrupt_handler is reregistered when loading state from DSP_DSP
@@ -374,10 +388,29 @@ StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
 
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
-    // Generate intermediate mixes
+    // Generate the frames of the sources. They are independent of each other, so with enough of
+    // them playing they are interleaved between this thread and the workers.
+    const std::size_t num_tasks = enabled_sources >= parallel_sources_threshold
+                                      ? source_workers.NumWorkers() + 1
+                                      : 1;
+    const auto tick_sources = [&](std::size_t first) {
+        for (std::size_t i = first; i < HLE::num_sources; i += num_tasks) {
+            write.source_statuses.status[i] = sources[i].Tick(read.source_configurations.config[i],
+                                                              read.adpcm_coefficients.coeff[i]);
+        }
+    };
+    for (std::size_t task = 1; task < num_tasks; task++) {
+        source_workers.QueueWork([&tick_sources, task] { tick_sources(task); });
+    }
+    tick_sources(0);
+    if (num_tasks > 1) {
+        source_workers.WaitForRequests();
+    }
+
+    // Generate intermediate mixes, always in source order.
+    enabled_sources = 0;
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        enabled_sources += write.source_statuses.status[i].is_enabled;
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
@@ -8,6 +8,7 @@
 #include "audio_core/hle/mixers.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/vector_math.h"
 
 namespace AudioCore::HLE {
 
@@ -85,6 +86,7 @@ void Mixers::ParseConfig(DspConfiguration& config) {
     config.dirty_raw = 0;
 }
 
+#if !defined(HAVE_SSE2) && !defined(HAVE_NEON)
 static s16 ClampToS16(s32 value) {
     return static_cast<s16>(std::clamp(value, -32768, 32767));
 }
@@ -94,12 +96,81 @@ static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
     return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
             ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
 }
+#endif
+
+#if defined(HAVE_SSE2)
+
+/// Converts a sample to float and applies the gain.
+static __m128 LoadQuadSample(const std::array<s32, 4>& sample, __m128 gain) {
+    const __m128i channels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sample.data()));
+    return _mm_mul_ps(_mm_cvtepi32_ps(channels), gain);
+}
+
+/// Saturates the downmixed samples to s16 and adds them to four stereo samples of the frame.
+static void MixIntoFrame(std::array<s16, 2>* frame, __m128i low, __m128i high) {
+    __m128i* dest = reinterpret_cast<__m128i*>(frame);
+    _mm_storeu_si128(dest, _mm_adds_epi16(_mm_loadu_si128(dest), _mm_packs_epi32(low, high)));
+}
+
+#elif defined(HAVE_NEON)
+
+static float32x4_t LoadQuadSample(const std::array<s32, 4>& sample, float gain) {
+    return vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(sample.data())), gain);
+}
+
+static void MixIntoFrame(std::array<s16, 2>* frame, int32x4_t low, int32x4_t high) {
+    s16* dest = frame->data();
+    vst1q_s16(dest, vqaddq_s16(vld1q_s16(dest), vcombine_s16(vqmovn_s32(low), vqmovn_s32(high))));
+}
+
+#endif
 
 void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& samples) {
     // TODO(merry): Limiter. (Currently we're performing final mixing assuming a disabled limiter.)
 
+    // The vector paths apply the gain and sum up the channels in the same order as the scalar
+    // code, and saturate like ClampToS16 and AddAndClampToS16 do.
+    static_assert(samples_per_frame % 4 == 0);
+
     switch (state.output_format) {
     case OutputFormat::Mono:
+#if defined(HAVE_SSE2)
+        for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+            const __m128 gains = _mm_set1_ps(gain);
+            __m128 c0 = LoadQuadSample(samples[i], gains);
+            __m128 c1 = LoadQuadSample(samples[i + 1], gains);
+            __m128 c2 = LoadQuadSample(samples[i + 2], gains);
+            __m128 c3 = LoadQuadSample(samples[i + 3], gains);
+            // Downmix to mono
+            _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+            const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(c0, c1), c2), c3);
+            const __m128i mono = _mm_cvttps_epi32(_mm_mul_ps(sum, _mm_set1_ps(0.5f)));
+            // Mix into current frame
+            const __m128i pairs = _mm_unpacklo_epi32(mono, mono);
+            MixIntoFrame(&current_frame[i], pairs, _mm_unpackhi_epi32(mono, mono));
+        }
+#elif defined(HAVE_NEON)
+        for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+            // Downmix to mono
+            const float32x4x2_t low =
+                vtrnq_f32(LoadQuadSample(samples[i], gain), LoadQuadSample(samples[i + 1], gain));
+            const float32x4x2_t high = vtrnq_f32(LoadQuadSample(samples[i + 2], gain),
+                                                 LoadQuadSample(samples[i + 3], gain));
+            const float32x4_t c0 =
+                vcombine_f32(vget_low_f32(low.val[0]), vget_low_f32(high.val[0]));
+            const float32x4_t c1 =
+                vcombine_f32(vget_low_f32(low.val[1]), vget_low_f32(high.val[1]));
+            const float32x4_t c2 =
+                vcombine_f32(vget_high_f32(low.val[0]), vget_high_f32(high.val[0]));
+            const float32x4_t c3 =
+                vcombine_f32(vget_high_f32(low.val[1]), vget_high_f32(high.val[1]));
+            const float32x4_t sum = vaddq_f32(vaddq_f32(vaddq_f32(c0, c1), c2), c3);
+            const int32x4_t mono = vcvtq_s32_f32(vmulq_n_f32(sum, 0.5f));
+            // Mix into current frame
+            const int32x4x2_t pairs = vzipq_s32(mono, mono);
+            MixIntoFrame(&current_frame[i], pairs.val[0], pairs.val[1]);
+        }
+#else
         std::transform(
             current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
             [gain](const std::array<s16, 2>& accumulator,
@@ -111,6 +182,7 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
                 // Mix into current frame
                 return AddAndClampToS16(accumulator, {mono, mono});
             });
+#endif
         return;
 
     case OutputFormat::Surround:
@@ -118,6 +190,34 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
         // fallthrough
 
     case OutputFormat::Stereo:
+#if defined(HAVE_SSE2)
+        for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+            const __m128 gains = _mm_set1_ps(gain);
+            const __m128 q0 = LoadQuadSample(samples[i], gains);
+            const __m128 q1 = LoadQuadSample(samples[i + 1], gains);
+            const __m128 q2 = LoadQuadSample(samples[i + 2], gains);
+            const __m128 q3 = LoadQuadSample(samples[i + 3], gains);
+            // Downmix to stereo, the left channel is 0 + 2 and the right one 1 + 3.
+            const __m128 low = _mm_add_ps(_mm_movelh_ps(q0, q1), _mm_movehl_ps(q1, q0));
+            const __m128 high = _mm_add_ps(_mm_movelh_ps(q2, q3), _mm_movehl_ps(q3, q2));
+            // Mix into current frame
+            MixIntoFrame(&current_frame[i], _mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+        }
+#elif defined(HAVE_NEON)
+        for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+            const float32x4_t q0 = LoadQuadSample(samples[i], gain);
+            const float32x4_t q1 = LoadQuadSample(samples[i + 1], gain);
+            const float32x4_t q2 = LoadQuadSample(samples[i + 2], gain);
+            const float32x4_t q3 = LoadQuadSample(samples[i + 3], gain);
+            // Downmix to stereo, the left channel is 0 + 2 and the right one 1 + 3.
+            const float32x4_t low = vaddq_f32(vcombine_f32(vget_low_f32(q0), vget_low_f32(q1)),
+                                              vcombine_f32(vget_high_f32(q0), vget_high_f32(q1)));
+            const float32x4_t high = vaddq_f32(vcombine_f32(vget_low_f32(q2), vget_low_f32(q3)),
+                                               vcombine_f32(vget_high_f32(q2), vget_high_f32(q3)));
+            // Mix into current frame
+            MixIntoFrame(&current_frame[i], vcvtq_s32_f32(low), vcvtq_s32_f32(high));
+        }
+#else
         std::transform(
             current_frame.begin(), current_frame.end(), samples.begin(), current_frame.begin(),
             [gain](const std::array<s16, 2>& accumulator,
@@ -128,31 +228,65 @@ void Mixers::DownmixAndMixIntoCurrentFrame(float gain, const QuadFrame32& sample
                 // Mix into current frame
                 return AddAndClampToS16(accumulator, {left, right});
             });
+#endif
         return;
     }
 
     UNREACHABLE_MSG("Invalid output_format {}", static_cast<std::size_t>(state.output_format));
 }
 
+/// Transposes a block of 4x4 samples. Rows of the source and destination are stride samples apart.
+static void Transpose4x4(const s32* src, std::size_t src_stride, s32* dst, std::size_t dst_stride) {
+#if defined(HAVE_SSE2)
+    const auto load_row = [src, src_stride](std::size_t row) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + row * src_stride));
+    };
+    const __m128i r0 = load_row(0);
+    const __m128i r1 = load_row(1);
+    const __m128i r2 = load_row(2);
+    const __m128i r3 = load_row(3);
+    const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + dst_stride), _mm_unpackhi_epi64(t0, t1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * dst_stride), _mm_unpacklo_epi64(t2, t3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * dst_stride), _mm_unpackhi_epi64(t2, t3));
+#elif defined(HAVE_NEON)
+    const int32x4x2_t t01 = vtrnq_s32(vld1q_s32(src), vld1q_s32(src + src_stride));
+    const int32x4x2_t t23 =
+        vtrnq_s32(vld1q_s32(src + 2 * src_stride), vld1q_s32(src + 3 * src_stride));
+    vst1q_s32(dst, vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0])));
+    vst1q_s32(dst + dst_stride, vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1])));
+    vst1q_s32(dst + 2 * dst_stride,
+              vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0])));
+    vst1q_s32(dst + 3 * dst_stride,
+              vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1])));
+#else
+    for (std::size_t row = 0; row < 4; row++) {
+        for (std::size_t column = 0; column < 4; column++) {
+            dst[column * dst_stride + row] = src[row * src_stride + column];
+        }
+    }
+#endif
+}
+
 void Mixers::AuxReturn(const IntermediateMixSamples& read_samples) {
     // NOTE: read_samples.mix{1,2}.pcm32 annoyingly have their dimensions in reverse order to
     // QuadFrame32.
 
     if (state.aux_bus_enable[0]) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                state.intermediate_mix_buffer[1][sample][channel] =
-                    read_samples.mix1.pcm32[channel][sample];
-            }
+        for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+            Transpose4x4(&read_samples.mix1.pcm32[0][sample], samples_per_frame,
+                         state.intermediate_mix_buffer[1][sample].data(), 4);
         }
     }
 
     if (state.aux_bus_enable[1]) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                state.intermediate_mix_buffer[2][sample][channel] =
-                    read_samples.mix2.pcm32[channel][sample];
-            }
+        for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+            Transpose4x4(&read_samples.mix2.pcm32[0][sample], samples_per_frame,
+                         state.intermediate_mix_buffer[2][sample].data(), 4);
         }
     }
 }
@@ -165,20 +299,18 @@ void Mixers::AuxSend(IntermediateMixSamples& write_samples,
     state.intermediate_mix_buffer[0] = input[0];
 
     if (state.aux_bus_enable[0]) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                write_samples.mix1.pcm32[channel][sample] = input[1][sample][channel];
-            }
+        for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+            Transpose4x4(input[1][sample].data(), 4, &write_samples.mix1.pcm32[0][sample],
+                         samples_per_frame);
         }
     } else {
         state.intermediate_mix_buffer[1] = input[1];
     }
 
     if (state.aux_bus_enable[1]) {
-        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
-            for (std::size_t channel = 0; channel < 4; channel++) {
-                write_samples.mix2.pcm32[channel][sample] = input[2][sample][channel];
-            }
+        for (std::size_t sample = 0; sample < samples_per_frame; sample += 4) {
+            Transpose4x4(input[2][sample].data(), 4, &write_samples.mix2.pcm32[0][sample],
+                         samples_per_frame);
         }
     } else {
         state.intermediate_mix_buffer[2] = input[2];
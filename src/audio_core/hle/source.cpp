@@ -5,12 +5,14 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/vector_math.h"
 #include "core/memory.h"
 
 namespace AudioCore::HLE {
@@ -31,6 +33,29 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
         return;
 
     const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
+#if defined(HAVE_SSE2)
+    const __m128 gain = _mm_loadu_ps(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+        s32 stereo;
+        std::memcpy(&stereo, &current_frame[samplei], sizeof(stereo));
+        const __m128i samples = _mm_shufflelo_epi16(_mm_cvtsi32_si128(stereo), 0x44);
+        const __m128i quad = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i* mix = reinterpret_cast<__m128i*>(&dest[samplei]);
+        const __m128i product = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(quad), gain));
+        _mm_storeu_si128(mix, _mm_add_epi32(_mm_loadu_si128(mix), product));
+    }
+#elif defined(HAVE_NEON)
+    const float32x4_t gain = vld1q_f32(gains.data());
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+        u32 stereo;
+        std::memcpy(&stereo, &current_frame[samplei], sizeof(stereo));
+        const int32x4_t quad = vmovl_s16(vreinterpret_s16_u32(vdup_n_u32(stereo)));
+        const int32x4_t product = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(quad), gain));
+        vst1q_s32(dest[samplei].data(), vaddq_s32(vld1q_s32(dest[samplei].data()), product));
+    }
+#else
     for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
         dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
@@ -38,6 +63,7 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
         dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
         dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
     }
+#endif
 }
 
 void Source::Reset() {
@@ -181,8 +207,8 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
         // A quick and dirty way of extending the current buffer is to just read the whole thing
         // again with the new length. Note that this uses the latched physical address instead of
         // whatever is in config, because that may be invalid.
-        const u8* const memory =
-            memory_system->GetPhysicalPointer(state.current_buffer_physical_address & 0xFFFFFFFC);
+        const u8* const memory = memory_system->GetPhysicalPointerUncached(
+            state.current_buffer_physical_address & 0xFFFFFFFC);
 
         // TODO(xperia64): This could potentially be optimized by only decoding the new data and
         // appending that to the buffer.
@@ -350,9 +376,8 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                   state.rate_multiplier, current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -383,7 +408,8 @@ bool Source::DequeueBuffer() {
 
     // This physical address masking occurs due to how the DSP DMA hardware is configured by the
     // firmware.
-    const u8* const memory = memory_system->GetPhysicalPointer(buf.physical_address & 0xFFFFFFFC);
+    const u8* const memory =
+        memory_system->GetPhysicalPointerUncached(buf.physical_address & 0xFFFFFFFC);
     if (memory) {
         const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
         switch (buf.format) {
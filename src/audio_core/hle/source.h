@@ -53,6 +53,7 @@ public:
      * invalid values otherwise).
      * @return The current status of this Source. This is given back to the emulated application via
      * SharedMemory.
+     * @note Sources don't share any state, different sources can be ticked from different threads.
      */
     SourceStatus::Status Tick(SourceConfiguration::Configuration& config,
                               const s16_le (&adpcm_coeffs)[16]);
@@ -4,8 +4,13 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <vector>
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/vector_math.h"
 
 namespace AudioCore::AudioInterp {
 
@@ -14,64 +19,334 @@ namespace AudioCore::AudioInterp {
 constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
+using Sample = std::array<s16, 2>;
+
+/// Position of the samples an output sample is interpolated from.
+struct Step {
+    u64 fposition; ///< Fixed point position of the first output sample.
+    u64 step_size; ///< Fixed point distance between output samples.
+};
+
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
+/// The kernel is called once with a contiguous copy of the input that is read. Output sample k
+/// is at position fposition + k * step_size, which is between the samples at index
+/// position / scale_factor + 1 and the one after it. The sample before and the one after them are
+/// available to the kernel as well.
+template <typename Kernel>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            std::size_t& outputi, Function fn) {
+                            std::size_t& outputi, Kernel kernel) {
     ASSERT(rate > 0);
 
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    input.insert(input.begin(), {state.xn3, state.xn2, state.xn1});
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
     u64 fposition = state.fposition;
+
+    const std::size_t max_outputs = output.size() - outputi;
+    std::size_t num_outputs = 0;
+    while (num_outputs < max_outputs &&
+           (fposition + num_outputs * step_size) / scale_factor + 3 < input.size()) {
+        num_outputs++;
+    }
+
     std::size_t inputi = 0;
+    if (num_outputs < max_outputs) {
+        // Ran out of input, keep the last samples for the next buffer.
+        inputi = input.size() - 3;
+    } else if (num_outputs > 0) {
+        inputi = static_cast<std::size_t>((fposition + (num_outputs - 1) * step_size) /
+                                          scale_factor);
+    }
+
+    if (num_outputs > 0) {
+        thread_local std::vector<Sample> samples;
+        const std::size_t last_inputi =
+            static_cast<std::size_t>((fposition + (num_outputs - 1) * step_size) / scale_factor);
+        samples.assign(input.begin(), std::next(input.begin(), last_inputi + 4));
+        kernel(Step{fposition, step_size}, samples.data(), output.data() + outputi, num_outputs);
+
+        outputi += num_outputs;
+        fposition += num_outputs * step_size;
+    }
+
+    state.xn3 = input[inputi];
+    state.xn2 = input[inputi + 1];
+    state.xn1 = input[inputi + 2];
+    state.fposition = fposition - inputi * scale_factor;
+
+    input.erase(input.begin(), std::next(input.begin(), inputi + 3));
+}
+
+static void NoneKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    u64 fposition = step.fposition;
+    for (std::size_t i = 0; i < count; i++, fposition += step.step_size) {
+        output[i] = input[fposition / scale_factor + 1];
+    }
+}
+
+static Sample LinearSample(u64 fraction, const Sample& x0, const Sample& x1) {
+    // This is a saturated subtraction. (Verified by black-box fuzzing.)
+    s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+    s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+    return Sample{
+        static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+        static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+    };
+}
+
+/*
+ * The scalar code computes fraction * delta / scale_factor with unsigned 64-bit arithmetic, which
+ * makes the division round towards negative infinity once the result is truncated to s16. The
+ * linear interpolation kernels compute the same with 32-bit lanes. The fraction is split in its
+ * high 16 and low 8 bits, and the magnitude of delta is at most 32768, which keeps all
+ * intermediate values within the range of s32:
+ *     floor(fraction * delta / 2^24) = (fh * delta + ((fl * delta) >> 8)) >> 16
+ */
+
+#if defined(HAVE_SSE4_1)
+
+static void LinearKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    const __m128i min_delta = _mm_set1_epi32(-32768);
+    const __m128i max_delta = _mm_set1_epi32(32767);
+    const __m128i low_mask = _mm_set1_epi32(0xFF);
+
+    u64 fposition = step.fposition;
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const u64 fposition_b = fposition + step.step_size;
+        const Sample* a = input + fposition / scale_factor + 1;
+        const Sample* b = input + fposition_b / scale_factor + 1;
+        const u32 fraction_a = static_cast<u32>(fposition & scale_mask);
+        const u32 fraction_b = static_cast<u32>(fposition_b & scale_mask);
+        fposition = fposition_b + step.step_size;
+
+        // Lanes are the left and right channel of two output samples.
+        std::array<s32, 4> pairs;
+        std::memcpy(&pairs[0], a, sizeof(s32));
+        std::memcpy(&pairs[1], b, sizeof(s32));
+        std::memcpy(&pairs[2], a + 1, sizeof(s32));
+        std::memcpy(&pairs[3], b + 1, sizeof(s32));
+        const __m128i x0 = _mm_cvtepi16_epi32(_mm_setr_epi32(pairs[0], pairs[1], 0, 0));
+        const __m128i x1 = _mm_cvtepi16_epi32(_mm_setr_epi32(pairs[2], pairs[3], 0, 0));
+
+        const __m128i delta = _mm_min_epi32(_mm_max_epi32(_mm_sub_epi32(x1, x0), min_delta),
+                                            max_delta);
+        const __m128i fraction = _mm_setr_epi32(fraction_a, fraction_a, fraction_b, fraction_b);
+        const __m128i high = _mm_mullo_epi32(_mm_srli_epi32(fraction, 8), delta);
+        const __m128i low = _mm_mullo_epi32(_mm_and_si128(fraction, low_mask), delta);
+        const __m128i offset = _mm_srai_epi32(_mm_add_epi32(high, _mm_srai_epi32(low, 8)), 16);
+
+        // The result wraps around like the cast to s16 does.
+        __m128i result = _mm_add_epi32(x0, offset);
+        result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(result, result));
+    }
+    for (; i < count; i++, fposition += step.step_size) {
+        const Sample* x = input + fposition / scale_factor + 1;
+        output[i] = LinearSample(fposition & scale_mask, x[0], x[1]);
+    }
+}
+
+#elif defined(HAVE_NEON)
+
+static void LinearKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    u64 fposition = step.fposition;
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const u64 fposition_b = fposition + step.step_size;
+        const Sample* a = input + fposition / scale_factor + 1;
+        const Sample* b = input + fposition_b / scale_factor + 1;
+        const u32 fraction_a = static_cast<u32>(fposition & scale_mask);
+        const u32 fraction_b = static_cast<u32>(fposition_b & scale_mask);
+        fposition = fposition_b + step.step_size;
+
+        // Lanes are the left and right channel of two output samples.
+        std::array<u32, 4> pairs;
+        std::memcpy(&pairs[0], a, sizeof(u32));
+        std::memcpy(&pairs[1], b, sizeof(u32));
+        std::memcpy(&pairs[2], a + 1, sizeof(u32));
+        std::memcpy(&pairs[3], b + 1, sizeof(u32));
+        const int32x4_t x0 =
+            vmovl_s16(vreinterpret_s16_u32(vset_lane_u32(pairs[1], vdup_n_u32(pairs[0]), 1)));
+        const int32x4_t x1 =
+            vmovl_s16(vreinterpret_s16_u32(vset_lane_u32(pairs[3], vdup_n_u32(pairs[2]), 1)));
+        const int32x4_t delta =
+            vminq_s32(vmaxq_s32(vsubq_s32(x1, x0), vdupq_n_s32(-32768)), vdupq_n_s32(32767));
+        const int32x4_t fraction = vreinterpretq_s32_u32(
+            vcombine_u32(vdup_n_u32(fraction_a), vdup_n_u32(fraction_b)));
+        const int32x4_t high = vmulq_s32(vshrq_n_s32(fraction, 8), delta);
+        const int32x4_t low = vmulq_s32(vandq_s32(fraction, vdupq_n_s32(0xFF)), delta);
+        const int32x4_t offset = vshrq_n_s32(vaddq_s32(high, vshrq_n_s32(low, 8)), 16);
+
+        // The result wraps around like the cast to s16 does.
+        vst1_s16(output[i].data(), vmovn_s32(vaddq_s32(x0, offset)));
+    }
+    for (; i < count; i++, fposition += step.step_size) {
+        const Sample* x = input + fposition / scale_factor + 1;
+        output[i] = LinearSample(fposition & scale_mask, x[0], x[1]);
+    }
+}
+
+#else
+
+static void LinearKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    u64 fposition = step.fposition;
+    for (std::size_t i = 0; i < count; i++, fposition += step.step_size) {
+        const Sample* x = input + fposition / scale_factor + 1;
+        output[i] = LinearSample(fposition & scale_mask, x[0], x[1]);
+    }
+}
+
+#endif
+
+constexpr std::size_t polyphase_phase_bits = 7;
+constexpr std::size_t polyphase_num_phases = 1 << polyphase_phase_bits;
+/// Coefficients have 14 fractional bits.
+constexpr s32 polyphase_one = 1 << 14;
+
+using PolyphaseTable = std::array<std::array<s16, 4>, polyphase_num_phases>;
+
+/// Computes the coefficients of a Lanczos kernel with a = 2 for each phase. The coefficients of a
+/// phase sum up to one, so a constant signal passes unchanged.
+static PolyphaseTable MakePolyphaseTable() {
+    const auto sinc = [](double x) {
+        return x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+    };
+    const auto lanczos = [&sinc](double x) {
+        return std::abs(x) < 2.0 ? sinc(x) * sinc(x / 2.0) : 0.0;
+    };
 
-    while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
+    PolyphaseTable table{};
+    for (std::size_t phase = 0; phase < polyphase_num_phases; phase++) {
+        const double t = static_cast<double>(phase) / polyphase_num_phases;
+        std::array<double, 4> weights;
+        double total = 0.0;
+        for (std::size_t tap = 0; tap < 4; tap++) {
+            weights[tap] = lanczos(static_cast<double>(tap) - 1.0 - t);
+            total += weights[tap];
+        }
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
-            break;
+        s32 sum = 0;
+        for (std::size_t tap = 0; tap < 4; tap++) {
+            table[phase][tap] = static_cast<s16>(std::lround(weights[tap] / total * polyphase_one));
+            sum += table[phase][tap];
         }
+        // Put the rounding error into the tap closest to the position.
+        table[phase][t < 0.5 ? 1 : 2] += static_cast<s16>(polyphase_one - sum);
+    }
+    return table;
+}
 
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+static const PolyphaseTable& GetPolyphaseTable() {
+    static const PolyphaseTable table = MakePolyphaseTable();
+    return table;
+}
 
-        fposition += step_size;
+static std::size_t PolyphasePhase(u64 fposition) {
+    return static_cast<std::size_t>((fposition & scale_mask) >> (24 - polyphase_phase_bits));
+}
+
+static Sample PolyphaseSample(const std::array<s16, 4>& coeffs, const Sample* x) {
+    Sample result;
+    for (std::size_t channel = 0; channel < 2; channel++) {
+        const s32 sum = coeffs[0] * x[0][channel] + coeffs[1] * x[1][channel] +
+                        coeffs[2] * x[2][channel] + coeffs[3] * x[3][channel];
+        result[channel] =
+            static_cast<s16>(std::clamp((sum + polyphase_one / 2) >> 14, -32768, 32767));
     }
+    return result;
+}
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
+#if defined(HAVE_SSE4_1)
+
+static void PolyphaseKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    const PolyphaseTable& table = GetPolyphaseTable();
+    const __m128i rounding = _mm_set1_epi32(polyphase_one / 2);
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    // Multiplies four stereo samples with the coefficients of a phase, leaving the sums of the
+    // first two and the last two taps of each channel.
+    const auto multiply = [&](u64 position) {
+        __m128i samples = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(input + position / scale_factor));
+        // L-1 R-1 L0 R0 L1 R1 L2 R2 -> L-1 L0 R-1 R0 L1 L2 R1 R2
+        samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        // c0 c1 c2 c3 -> c0 c1 c0 c1 c2 c3 c2 c3
+        __m128i coeffs = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(table[PolyphasePhase(position)].data()));
+        coeffs = _mm_unpacklo_epi32(coeffs, coeffs);
+        return _mm_madd_epi16(samples, coeffs);
+    };
+
+    u64 fposition = step.fposition;
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128i a = multiply(fposition);
+        const __m128i b = multiply(fposition + step.step_size);
+        fposition += 2 * step.step_size;
+
+        __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, rounding), 14);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i), _mm_packs_epi32(sum, sum));
+    }
+    for (; i < count; i++, fposition += step.step_size) {
+        output[i] = PolyphaseSample(table[PolyphasePhase(fposition)],
+                                    input + fposition / scale_factor);
+    }
+}
+
+#elif defined(HAVE_NEON)
+
+static void PolyphaseKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    const PolyphaseTable& table = GetPolyphaseTable();
+
+    u64 fposition = step.fposition;
+    for (std::size_t i = 0; i < count; i++, fposition += step.step_size) {
+        // L-1 R-1 L0 R0 and L1 R1 L2 R2 are multiplied with c0 c0 c1 c1 and c2 c2 c3 c3.
+        const int16x8_t samples = vld1q_s16(input[fposition / scale_factor].data());
+        const int16x4_t coeffs = vld1_s16(table[PolyphasePhase(fposition)].data());
+        const int16x4x2_t spread = vzip_s16(coeffs, coeffs);
+        int32x4_t sum = vmull_s16(vget_low_s16(samples), spread.val[0]);
+        sum = vmlal_s16(sum, vget_high_s16(samples), spread.val[1]);
+        const int32x2_t channels = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+        const int32x2_t rounded = vrshr_n_s32(channels, 14);
+        const int16x4_t result = vqmovn_s32(vcombine_s32(rounded, rounded));
+        vst1_lane_u32(reinterpret_cast<u32*>(output + i), vreinterpret_u32_s16(result), 0);
+    }
 }
 
+#else
+
+static void PolyphaseKernel(Step step, const Sample* input, Sample* output, std::size_t count) {
+    const PolyphaseTable& table = GetPolyphaseTable();
+
+    u64 fposition = step.fposition;
+    for (std::size_t i = 0; i < count; i++, fposition += step.step_size) {
+        output[i] = PolyphaseSample(table[PolyphasePhase(fposition)],
+                                    input + fposition / scale_factor);
+    }
+}
+
+#endif
+
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    StepOverSamples(state, input, rate, output, outputi, NoneKernel);
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    StepOverSamples(state, input, rate, output, outputi, LinearKernel);
+}
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    StepOverSamples(state, input, rate, output, outputi, PolyphaseKernel);
 }
 
 } // namespace AudioCore::AudioInterp
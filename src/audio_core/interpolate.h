@@ -16,9 +16,10 @@ namespace AudioCore::AudioInterp {
 using StereoBuffer16 = std::deque<std::array<s16, 2>>;
 
 struct State {
-    /// Two historical samples.
+    /// Three historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    std::array<s16, 2> xn3 = {}; ///< x[n-3]
     /// Current fractional position.
     u64 fposition = 0;
 };
@@ -47,4 +48,17 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Polyphase interpolation. This is a four tap windowed sinc filter with a table of coefficients for
+ * each of 128 phases between two samples. There is a two-sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
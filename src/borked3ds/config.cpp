@@ -147,6 +147,10 @@ void Config::ReadValues() {
     ReadSetting("Core", Settings::values.custom_cpu_ticks);
     ReadSetting("Core", Settings::values.core_downcount_hack);
     ReadSetting("Core", Settings::values.priority_boost);
+    ReadSetting("Core", Settings::values.incremental_save_states);
+    ReadSetting("Core", Settings::values.enable_rewind);
+    ReadSetting("Core", Settings::values.rewind_interval);
+    ReadSetting("Core", Settings::values.rewind_buffer_size);
 
     // Renderer
     ReadSetting("Renderer", Settings::values.graphics_api);
@@ -167,6 +171,7 @@ void Config::ReadValues() {
     ReadSetting("Renderer", Settings::values.use_hw_shader);
     ReadSetting("Renderer", Settings::values.shaders_accurate_mul);
     ReadSetting("Renderer", Settings::values.use_shader_jit);
+    ReadSetting("Renderer", Settings::values.use_shader_jit_simd);
     ReadSetting("Renderer", Settings::values.resolution_factor);
     ReadSetting("Renderer", Settings::values.use_disk_shader_cache);
     ReadSetting("Renderer", Settings::values.frame_limit);
@@ -240,6 +245,7 @@ void Config::ReadValues() {
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
     ReadSetting("Data Storage", Settings::values.use_custom_storage);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
 
     if (Settings::values.use_custom_storage) {
         FileUtil::UpdateUserPath(FileUtil::UserPath::NANDDir,
@@ -370,6 +376,8 @@ void Config::ReadValues() {
     ReadSetting("Debugging", Settings::values.use_gdbstub);
     ReadSetting("Debugging", Settings::values.gdbstub_port);
     ReadSetting("Debugging", Settings::values.instant_debug_log);
+    ReadSetting("Debugging", Settings::values.binary_log);
+    Common::Log::SetBinaryLogEnabled(Settings::values.binary_log.GetValue());
 
     for (const auto& service_module : Service::service_module_map) {
         bool use_lle = sdl2_config->GetBoolean("Debugging", "LLE\\" + service_module.name, false);
@@ -63,7 +63,7 @@ const std::array<std::array<int, 9>, Settings::NativeAnalog::NumAnalogs> Config:
 // This must be in alphabetical order according to action name as it must have the same order as
 // UISetting::values.shortcuts, which is alphabetically ordered.
 // clang-format off
-const std::array<UISettings::Shortcut, 38> Config::default_hotkeys {{
+const std::array<UISettings::Shortcut, 39> Config::default_hotkeys {{
      {QStringLiteral("Advance Frame"),            QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::ApplicationShortcut}},
      {QStringLiteral("Audio Mute/Unmute"),        QStringLiteral("Main Window"), {QStringLiteral("Ctrl+M"), Qt::WindowShortcut}},
      {QStringLiteral("Audio Volume Down"),        QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::WindowShortcut}},
@@ -89,6 +89,7 @@ const std::array<UISettings::Shortcut, 38> Config::default_hotkeys {{
      {QStringLiteral("Quick Load"),               QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::WindowShortcut}},
      {QStringLiteral("Remove Amiibo"),            QStringLiteral("Main Window"), {QStringLiteral("F3"),     Qt::ApplicationShortcut}},
      {QStringLiteral("Restart Emulation"),        QStringLiteral("Main Window"), {QStringLiteral("F6"),     Qt::WindowShortcut}},
+     {QStringLiteral("Rewind"),                   QStringLiteral("Main Window"), {QStringLiteral(""),       Qt::ApplicationShortcut}},
      {QStringLiteral("Rotate Screens Upright"),   QStringLiteral("Main Window"), {QStringLiteral("F8"),     Qt::WindowShortcut}},
      {QStringLiteral("Save to Oldest Non-Quick Slot"),      QStringLiteral("Main Window"), {QStringLiteral("Ctrl+C"), Qt::WindowShortcut}},
      {QStringLiteral("Stop Emulation"),           QStringLiteral("Main Window"), {QStringLiteral("F5"),     Qt::WindowShortcut}},
@@ -478,6 +479,10 @@ void Config::ReadCoreValues() {
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
+        ReadBasicSetting(Settings::values.incremental_save_states);
+        ReadBasicSetting(Settings::values.enable_rewind);
+        ReadBasicSetting(Settings::values.rewind_interval);
+        ReadBasicSetting(Settings::values.rewind_buffer_size);
     }
 
     qt_config->endGroup();
@@ -488,6 +493,7 @@ void Config::ReadDataStorageValues() {
 
     ReadBasicSetting(Settings::values.use_virtual_sd);
     ReadBasicSetting(Settings::values.use_custom_storage);
+    ReadBasicSetting(Settings::values.romfs_cache_size);
 
     const std::string nand_dir =
         ReadSetting(QStringLiteral("nand_directory"), QStringLiteral("")).toString().toStdString();
@@ -511,6 +517,7 @@ void Config::ReadDebuggingValues() {
     ReadBasicSetting(Settings::values.renderer_debug);
     ReadBasicSetting(Settings::values.dump_command_buffers);
     ReadBasicSetting(Settings::values.instant_debug_log);
+    ReadBasicSetting(Settings::values.binary_log);
 
     qt_config->beginGroup(QStringLiteral("LLE"));
     for (const auto& service_module : Service::service_module_map) {
@@ -719,6 +726,7 @@ void Config::ReadRendererValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
+        ReadBasicSetting(Settings::values.use_shader_jit_simd);
     }
 
     qt_config->endGroup();
@@ -1062,6 +1070,10 @@ void Config::SaveCoreValues() {
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
+        WriteBasicSetting(Settings::values.incremental_save_states);
+        WriteBasicSetting(Settings::values.enable_rewind);
+        WriteBasicSetting(Settings::values.rewind_interval);
+        WriteBasicSetting(Settings::values.rewind_buffer_size);
     }
 
     qt_config->endGroup();
@@ -1072,6 +1084,7 @@ void Config::SaveDataStorageValues() {
 
     WriteBasicSetting(Settings::values.use_virtual_sd);
     WriteBasicSetting(Settings::values.use_custom_storage);
+    WriteBasicSetting(Settings::values.romfs_cache_size);
     WriteSetting(QStringLiteral("nand_directory"),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)),
                  QStringLiteral(""));
@@ -1090,6 +1103,7 @@ void Config::SaveDebuggingValues() {
     WriteBasicSetting(Settings::values.gdbstub_port);
     WriteBasicSetting(Settings::values.renderer_debug);
     WriteBasicSetting(Settings::values.instant_debug_log);
+    WriteBasicSetting(Settings::values.binary_log);
 
     qt_config->beginGroup(QStringLiteral("LLE"));
     for (const auto& service_module : Settings::values.lle_modules) {
@@ -1265,6 +1279,8 @@ void Config::SaveRendererValues() {
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
                      true);
+        WriteSetting(QStringLiteral("use_shader_jit_simd"),
+                     Settings::values.use_shader_jit_simd.GetValue(), false);
     }
 
     qt_config->endGroup();
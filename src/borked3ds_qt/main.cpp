@@ -173,6 +173,7 @@ GMainWindow::GMainWindow(Core::System& system_)
     CheckForMigration();
 
     this->config = std::make_unique<Config>();
+    Common::Log::SetBinaryLogEnabled(Settings::values.binary_log.GetValue());
 
 #ifdef __unix__
     SetGamemodeEnabled(Settings::values.enable_gamemode.GetValue());
@@ -754,6 +755,13 @@ void GMainWindow::InitializeHotkeys() {
 
     connect_shortcut(QStringLiteral("Toggle Turbo Mode"), &GMainWindow::ToggleEmulationSpeed);
 
+    connect_shortcut(QStringLiteral("Rewind"), [&] {
+        if (emulation_running) {
+            system.SendSignal(Core::System::Signal::Rewind);
+            system.frame_limiter.AdvanceFrame();
+        }
+    });
+
     connect_shortcut(QStringLiteral("Increase Speed Limit"), [&] { AdjustSpeedLimit(true); });
 
     connect_shortcut(QStringLiteral("Decrease Speed Limit"), [&] { AdjustSpeedLimit(false); });
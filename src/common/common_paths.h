@@ -62,6 +62,7 @@
 // Filenames
 // Files in the directory returned by GetUserPath(UserPath::LogDir)
 #define LOG_FILE "borked3ds_log.txt"
+#define LOG_BINARY_FILE "borked3ds_log.bin"
 
 // Files in the directory returned by GetUserPath(UserPath::ConfigDir)
 #define EMU_CONFIG "emu.ini"
@@ -0,0 +1,237 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "common/delta_encoding.h"
+
+namespace Common::Delta {
+
+namespace {
+
+enum class Op : u8 {
+    Copy,    ///< Followed by the u32 index of the first base block and the u32 number of blocks
+    Literal, ///< Followed by the u32 number of bytes and the bytes
+};
+
+/// Adler-32 style checksum of a block that can be rolled forward one byte at a time.
+class RollingHash {
+public:
+    explicit RollingHash(const u8* data) {
+        for (std::size_t i = 0; i < BLOCK_SIZE; ++i) {
+            a += data[i];
+            b += a;
+        }
+    }
+
+    void Roll(u8 out, u8 in) {
+        a += in - out;
+        b += a - static_cast<u32>(BLOCK_SIZE) * out;
+    }
+
+    u64 Value() const {
+        return (static_cast<u64>(b) << 32) | a;
+    }
+
+private:
+    u32 a = 0;
+    u32 b = 0;
+};
+
+/// Set of hashes queried before the block map, most offsets searched don't match anything.
+class HashFilter {
+public:
+    void Insert(u64 hash) {
+        const u32 bit = Index(hash);
+        bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+
+    bool MayContain(u64 hash) const {
+        const u32 bit = Index(hash);
+        return (bits[bit / 64] >> (bit % 64)) & 1;
+    }
+
+private:
+    static constexpr u32 NUM_BITS = 1U << 20;
+
+    static u32 Index(u64 hash) {
+        return static_cast<u32>((hash ^ (hash >> 29)) * 0x9E3779B1U) % NUM_BITS;
+    }
+
+    std::vector<u64> bits = std::vector<u64>(NUM_BITS / 64);
+};
+
+template <typename T>
+void Write(std::vector<u8>& out, const T& value) {
+    const u8* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool Read(std::span<const u8> in, std::size_t& offset, T& value) {
+    if (in.size() - offset < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+} // Anonymous namespace
+
+std::vector<u8> Encode(std::span<const u8> base, std::span<const u8> target) {
+    std::vector<u8> delta;
+    Write<u64>(delta, target.size());
+
+    const u32 num_blocks = static_cast<u32>(base.size() / BLOCK_SIZE);
+    std::unordered_map<u64, u32> blocks;
+    HashFilter filter;
+    blocks.reserve(num_blocks);
+    for (u32 block = 0; block < num_blocks; ++block) {
+        const u64 hash = RollingHash{base.data() + block * BLOCK_SIZE}.Value();
+        if (blocks.try_emplace(hash, block).second) {
+            filter.Insert(hash);
+        }
+    }
+
+    const auto block_matches = [&](std::size_t pos, u32 block) {
+        return std::memcmp(target.data() + pos, base.data() + block * BLOCK_SIZE, BLOCK_SIZE) == 0;
+    };
+
+    // Consecutive base blocks are merged into a single copy operation.
+    u32 copy_start = 0;
+    u32 copy_count = 0;
+    std::size_t literal_start = 0;
+    const auto flush_copy = [&] {
+        if (copy_count != 0) {
+            Write(delta, Op::Copy);
+            Write(delta, copy_start);
+            Write(delta, copy_count);
+            copy_count = 0;
+        }
+    };
+    const auto flush_literal = [&](std::size_t end) {
+        if (end != literal_start) {
+            flush_copy();
+            Write(delta, Op::Literal);
+            Write(delta, static_cast<u32>(end - literal_start));
+            delta.insert(delta.end(), target.begin() + literal_start, target.begin() + end);
+        }
+    };
+    const auto emit_copy = [&](std::size_t pos, u32 block) {
+        flush_literal(pos);
+        if (copy_count == 0 || copy_start + copy_count != block) {
+            flush_copy();
+            copy_start = block;
+        }
+        ++copy_count;
+        literal_start = pos + BLOCK_SIZE;
+    };
+
+    std::size_t pos = 0;
+    u32 next_block = num_blocks;
+    while (pos + BLOCK_SIZE <= target.size()) {
+        // Unchanged data usually continues with the following block of the base.
+        if (next_block < num_blocks && block_matches(pos, next_block)) {
+            emit_copy(pos, next_block++);
+            pos += BLOCK_SIZE;
+            continue;
+        }
+
+        // Otherwise look for any block of the base at every offset up to a block ahead, this
+        // realigns the target when data before it changed size.
+        const std::size_t search_end = std::min(pos + BLOCK_SIZE, target.size() - BLOCK_SIZE + 1);
+        RollingHash hash{target.data() + pos};
+        std::size_t match_pos = search_end;
+        u32 match_block = 0;
+        for (std::size_t offset = pos; offset < search_end; ++offset) {
+            if (offset != pos) {
+                hash.Roll(target[offset - 1], target[offset + BLOCK_SIZE - 1]);
+            }
+            if (!filter.MayContain(hash.Value())) {
+                continue;
+            }
+            const auto it = blocks.find(hash.Value());
+            if (it != blocks.end() && block_matches(offset, it->second)) {
+                match_pos = offset;
+                match_block = it->second;
+                break;
+            }
+        }
+
+        if (match_pos == search_end) {
+            // Data modified in place, keep expecting the base block at the same position.
+            pos = search_end;
+            next_block = std::min(next_block + 1, num_blocks);
+            continue;
+        }
+
+        emit_copy(match_pos, match_block);
+        pos = match_pos + BLOCK_SIZE;
+        next_block = match_block + 1;
+    }
+
+    flush_literal(target.size());
+    flush_copy();
+    return delta;
+}
+
+std::optional<std::vector<u8>> Decode(std::span<const u8> base, std::span<const u8> delta) {
+    std::size_t offset = 0;
+    u64 target_size{};
+    if (!Read(delta, offset, target_size)) {
+        return std::nullopt;
+    }
+
+    std::vector<u8> target;
+    if (target_size <= base.size() + delta.size()) {
+        target.reserve(target_size);
+    }
+
+    while (offset < delta.size()) {
+        Op op{};
+        if (!Read(delta, offset, op)) {
+            return std::nullopt;
+        }
+
+        switch (op) {
+        case Op::Copy: {
+            u32 block{};
+            u32 count{};
+            if (!Read(delta, offset, block) || !Read(delta, offset, count) ||
+                (static_cast<u64>(block) + count) * BLOCK_SIZE > base.size()) {
+                return std::nullopt;
+            }
+            const auto begin = base.begin() + static_cast<std::size_t>(block) * BLOCK_SIZE;
+            const auto end = begin + static_cast<std::size_t>(count) * BLOCK_SIZE;
+            target.insert(target.end(), begin, end);
+            break;
+        }
+        case Op::Literal: {
+            u32 length{};
+            if (!Read(delta, offset, length) || delta.size() - offset < length) {
+                return std::nullopt;
+            }
+            target.insert(target.end(), delta.begin() + offset, delta.begin() + offset + length);
+            offset += length;
+            break;
+        }
+        default:
+            return std::nullopt;
+        }
+
+        if (target.size() > target_size) {
+            return std::nullopt;
+        }
+    }
+
+    if (target.size() != target_size) {
+        return std::nullopt;
+    }
+    return target;
+}
+
+} // namespace Common::Delta
@@ -0,0 +1,41 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common::Delta {
+
+/// Granularity at which data is matched against the base.
+constexpr std::size_t BLOCK_SIZE = 4096;
+
+/**
+ * Encodes the target as a delta against a base. Blocks of the target that appear anywhere in the
+ * base, at any byte offset of the target, are stored as references to the base. The remaining
+ * bytes are stored as is, so the delta is only small when most of the target is unchanged.
+ *
+ * @param base the data the delta is encoded against.
+ * @param target the data to encode.
+ *
+ * @return the encoded delta.
+ */
+[[nodiscard]] std::vector<u8> Encode(std::span<const u8> base, std::span<const u8> target);
+
+/**
+ * Rebuilds the target of a delta from the base it was encoded against.
+ *
+ * @param base the data the delta was encoded against.
+ * @param delta the encoded delta.
+ *
+ * @return the decoded target, or std::nullopt if the delta is corrupt or doesn't match the base.
+ */
+[[nodiscard]] std::optional<std::vector<u8>> Decode(std::span<const u8> base,
+                                                    std::span<const u8> delta);
+
+} // namespace Common::Delta
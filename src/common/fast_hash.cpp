@@ -0,0 +1,200 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/cityhash.h"
+#include "common/fast_hash.h"
+#include "common/vector_math.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t STRIPE_SIZE = 64;
+constexpr std::size_t NUM_LANES = STRIPE_SIZE / sizeof(u64);
+constexpr std::size_t STRIPES_PER_BLOCK = 16;
+constexpr std::size_t BLOCK_SIZE = STRIPE_SIZE * STRIPES_PER_BLOCK;
+
+constexpr u64 PRIME32_1 = 0x9E3779B1U;
+constexpr u64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 PRIME64_3 = 0x165667B19E3779F9ULL;
+
+/// Keys mixed into the data, one set of lanes per stripe of a block plus one for scrambling.
+constexpr std::array<u64, NUM_LANES * (STRIPES_PER_BLOCK + 1)> SECRET = [] {
+    std::array<u64, NUM_LANES * (STRIPES_PER_BLOCK + 1)> secret{};
+    u64 state = PRIME64_3;
+    for (u64& key : secret) {
+        // SplitMix64
+        state += 0x9E3779B97F4A7C15ULL;
+        u64 z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        key = z ^ (z >> 31);
+    }
+    return secret;
+}();
+
+u64 Multiply128Fold64(u64 a, u64 b) {
+#ifdef __SIZEOF_INT128__
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#else
+    const u64 lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    const u64 hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    const u64 lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    const u64 hi_hi = (a >> 32) * (b >> 32);
+    const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const u64 upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    const u64 lower = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lower ^ upper;
+#endif
+}
+
+u64 Avalanche(u64 hash) {
+    hash ^= hash >> 37;
+    hash *= 0x165667919E3779F9ULL;
+    return hash ^ (hash >> 32);
+}
+
+#if defined(HAVE_SSE2)
+/// Eight lanes of the hash state held in SSE registers, two per register. The registers are
+/// spelled out so the compiler keeps them out of memory.
+class Accumulator {
+public:
+    explicit Accumulator(const std::array<u64, NUM_LANES>& init)
+        : lanes0{Load(init.data(), 0)}, lanes1{Load(init.data(), 1)},
+          lanes2{Load(init.data(), 2)}, lanes3{Load(init.data(), 3)} {}
+
+    /// Mixes one stripe into the lanes, each lane multiplies the halves of its keyed input.
+    void Accumulate(const u8* stripe, const u64* keys) {
+        AccumulateLanes(lanes0, Load(stripe, 0), Load(keys, 0));
+        AccumulateLanes(lanes1, Load(stripe, 1), Load(keys, 1));
+        AccumulateLanes(lanes2, Load(stripe, 2), Load(keys, 2));
+        AccumulateLanes(lanes3, Load(stripe, 3), Load(keys, 3));
+    }
+
+    /// Folds the high bits of every lane back in so the products keep their entropy.
+    void Scramble(const u64* keys) {
+        ScrambleLanes(lanes0, Load(keys, 0));
+        ScrambleLanes(lanes1, Load(keys, 1));
+        ScrambleLanes(lanes2, Load(keys, 2));
+        ScrambleLanes(lanes3, Load(keys, 3));
+    }
+
+    std::array<u64, NUM_LANES> Lanes() const {
+        std::array<u64, NUM_LANES> values;
+        __m128i* const dest = reinterpret_cast<__m128i*>(values.data());
+        _mm_storeu_si128(dest + 0, lanes0);
+        _mm_storeu_si128(dest + 1, lanes1);
+        _mm_storeu_si128(dest + 2, lanes2);
+        _mm_storeu_si128(dest + 3, lanes3);
+        return values;
+    }
+
+private:
+    static __m128i Load(const void* data, std::size_t index) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(data) + index);
+    }
+
+    static void AccumulateLanes(__m128i& lanes, __m128i data, __m128i key) {
+        const __m128i keyed = _mm_xor_si128(data, key);
+        const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, 0x31));
+        lanes = _mm_add_epi64(lanes, _mm_shuffle_epi32(data, 0x4E));
+        lanes = _mm_add_epi64(lanes, product);
+    }
+
+    static void ScrambleLanes(__m128i& lanes, __m128i key) {
+        const __m128i prime = _mm_set1_epi32(static_cast<s32>(PRIME32_1));
+        const __m128i mixed = _mm_xor_si128(_mm_xor_si128(lanes, _mm_srli_epi64(lanes, 47)), key);
+        // 64x32 bit multiply out of two 32x32 bit multiplies.
+        const __m128i low = _mm_mul_epu32(mixed, prime);
+        const __m128i high = _mm_mul_epu32(_mm_srli_epi64(mixed, 32), prime);
+        lanes = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+    }
+
+    __m128i lanes0;
+    __m128i lanes1;
+    __m128i lanes2;
+    __m128i lanes3;
+};
+#else
+u64 Read64(const u8* data) {
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/// Eight lanes of the hash state, the loops are simple enough for the compiler to vectorize.
+class Accumulator {
+public:
+    explicit Accumulator(const std::array<u64, NUM_LANES>& init) : lanes{init} {}
+
+    /// Mixes one stripe into the lanes, each lane multiplies the halves of its keyed input.
+    void Accumulate(const u8* stripe, const u64* keys) {
+        for (std::size_t lane = 0; lane < NUM_LANES; lane++) {
+            const u64 data = Read64(stripe + lane * sizeof(u64));
+            const u64 keyed = data ^ keys[lane];
+            lanes[lane ^ 1] += data;
+            lanes[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+        }
+    }
+
+    /// Folds the high bits of every lane back in so the products keep their entropy.
+    void Scramble(const u64* keys) {
+        for (std::size_t lane = 0; lane < NUM_LANES; lane++) {
+            lanes[lane] = ((lanes[lane] ^ (lanes[lane] >> 47)) ^ keys[lane]) * PRIME32_1;
+        }
+    }
+
+    std::array<u64, NUM_LANES> Lanes() const {
+        return lanes;
+    }
+
+private:
+    std::array<u64, NUM_LANES> lanes;
+};
+#endif
+
+} // Anonymous namespace
+
+u64 FastHash64(const void* data, std::size_t len) noexcept {
+    // Short inputs don't fill the lanes, CityHash is faster there.
+    if (len < 2 * STRIPE_SIZE) {
+        return CityHash64(static_cast<const char*>(data), len);
+    }
+
+    const u8* bytes = static_cast<const u8*>(data);
+    const u64* scramble_keys = SECRET.data() + NUM_LANES * STRIPES_PER_BLOCK;
+    Accumulator acc{{PRIME32_1, PRIME64_1, PRIME64_2, PRIME64_3, PRIME64_1 ^ PRIME64_2,
+                     PRIME64_2 ^ PRIME64_3, PRIME64_3 ^ PRIME32_1, PRIME64_1 + PRIME32_1}};
+
+    const std::size_t num_blocks = (len - 1) / BLOCK_SIZE;
+    for (std::size_t block = 0; block < num_blocks; block++) {
+        for (std::size_t stripe = 0; stripe < STRIPES_PER_BLOCK; stripe++) {
+            acc.Accumulate(bytes + block * BLOCK_SIZE + stripe * STRIPE_SIZE,
+                           SECRET.data() + stripe * NUM_LANES);
+        }
+        acc.Scramble(scramble_keys);
+    }
+
+    // The remaining full stripes, then the last stripe of the input which may overlap them.
+    const u8* tail = bytes + num_blocks * BLOCK_SIZE;
+    const std::size_t num_stripes = (len - 1 - num_blocks * BLOCK_SIZE) / STRIPE_SIZE;
+    for (std::size_t stripe = 0; stripe < num_stripes; stripe++) {
+        acc.Accumulate(tail + stripe * STRIPE_SIZE, SECRET.data() + stripe * NUM_LANES);
+    }
+    acc.Accumulate(bytes + len - STRIPE_SIZE, scramble_keys);
+
+    const auto lanes = acc.Lanes();
+    u64 hash = len * PRIME64_1;
+    for (std::size_t lane = 0; lane < NUM_LANES; lane += 2) {
+        hash += Multiply128Fold64(lanes[lane] ^ SECRET[lane + 3],
+                                  lanes[lane + 1] ^ SECRET[lane + 11]);
+    }
+    return Avalanche(hash);
+}
+
+} // namespace Common
@@ -0,0 +1,24 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Computes a 64-bit hash over the specified block of data. Large blocks are consumed in 64 byte
+ * stripes by eight independent multiply-accumulate lanes in the style of XXH3, which keeps the
+ * SIMD units busy and is several times faster than CityHash64 on texture sized inputs.
+ * The values are not compatible with XXH3 and may change between versions, so they must never be
+ * stored anywhere.
+ * @param data Block of data to compute hash over
+ * @param len Length of data (in bytes) to compute hash over
+ * @returns 64-bit hash value that was computed over the data block
+ */
+[[nodiscard]] u64 FastHash64(const void* data, std::size_t len) noexcept;
+
+} // namespace Common
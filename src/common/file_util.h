@@ -411,6 +411,10 @@ public:
         return nullptr != m_file;
     }
 
+    [[nodiscard]] const std::string& GetPath() const {
+        return filename;
+    }
+
     // m_good is set to false when a read, write or other function fails
     [[nodiscard]] bool IsGood() const {
         return m_good;
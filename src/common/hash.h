@@ -11,9 +11,15 @@
 #include <type_traits>
 #include "common/cityhash.h"
 #include "common/common_types.h"
+#include "common/fast_hash.h"
 
 namespace Common {
 
+enum class HashAlgorithm {
+    CityHash, ///< Stable across versions, required for anything stored or shared
+    Fast,     ///< FastHash64, faster on large blocks but only for hashes kept in memory
+};
+
 /**
  * Computes a 64-bit hash over the specified block of data
  * @param data Block of data to compute hash over
@@ -33,6 +39,21 @@ static inline u64 ComputeHash64(std::span<const std::byte> data) noexcept {
     return ComputeHash64(data.data(), data.size());
 }
 
+/**
+ * Computes a 64-bit hash over the specified block of data with the selected algorithm
+ * @param data Block of data to compute hash over
+ * @param len Length of data (in bytes) to compute hash over
+ * @param algorithm Hash function to use
+ * @returns 64-bit hash value that was computed over the data block
+ */
+static inline u64 ComputeHash64(const void* data, std::size_t len,
+                                HashAlgorithm algorithm) noexcept {
+    if (algorithm == HashAlgorithm::Fast) {
+        return FastHash64(data, len);
+    }
+    return ComputeHash64(data, len);
+}
+
 /**
  * Computes a 64-bit hash of a struct. In addition to being trivially copyable, it is also critical
  * that either the struct includes no padding, or that any padding is initialized to a known value
@@ -0,0 +1,163 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifndef _WIN32
+#include <atomic>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__ANDROID__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+
+namespace Common {
+
+#ifndef _WIN32
+
+namespace {
+
+/// The guest maps memory with 4 KiB granularity, views can only mirror that with 4 KiB host pages.
+constexpr long REQUIRED_PAGE_SIZE = 0x1000;
+
+#ifdef MAP_NORESERVE
+constexpr int RESERVE_FLAGS = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+#else
+constexpr int RESERVE_FLAGS = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+
+int CreateSharedMemoryFile() {
+#if defined(__ANDROID__)
+    // memfd_create is only declared by bionic from API level 30
+    constexpr unsigned int MFD_CLOEXEC_FLAG = 0x0001U;
+    return static_cast<int>(syscall(__NR_memfd_create, "borked3ds-memory", MFD_CLOEXEC_FLAG));
+#elif defined(__linux__)
+    return memfd_create("borked3ds-memory", MFD_CLOEXEC);
+#elif defined(__FreeBSD__)
+    return shm_open(SHM_ANON, O_RDWR, 0600);
+#else
+    static std::atomic<u32> counter{};
+    const std::string name = "/borked3ds." + std::to_string(getpid()) + "." +
+                             std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        // The file stays alive as long as it's open, it doesn't need a name anymore
+        shm_unlink(name.c_str());
+    }
+    return fd;
+#endif
+}
+
+} // Anonymous namespace
+
+HostMemory::HostMemory(std::size_t backing_size_) : backing_size{backing_size_} {
+    if (sysconf(_SC_PAGESIZE) == REQUIRED_PAGE_SIZE) {
+        fd = CreateSharedMemoryFile();
+    }
+    if (fd >= 0 && ftruncate(fd, static_cast<off_t>(backing_size)) == 0) {
+        void* const base =
+            mmap(nullptr, backing_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            backing_base = static_cast<u8*>(base);
+            return;
+        }
+    }
+
+    LOG_WARNING(Common_Memory, "Unable to create shared memory, fastmem is unavailable: {}",
+                GetLastErrorMsg());
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+    fallback_buffer = std::make_unique<u8[]>(backing_size);
+    backing_base = fallback_buffer.get();
+}
+
+HostMemory::~HostMemory() {
+    if (fd >= 0) {
+        munmap(backing_base, backing_size);
+        close(fd);
+    }
+}
+
+HostMemory::View::View(HostMemory& memory_, std::size_t size_) : memory{memory_}, size{size_} {
+    void* const reserved = mmap(nullptr, size, PROT_NONE, RESERVE_FLAGS, -1, 0);
+    if (reserved != MAP_FAILED) {
+        base = static_cast<u8*>(reserved);
+    }
+}
+
+HostMemory::View::~View() {
+    if (base) {
+        munmap(base, size);
+    }
+}
+
+void HostMemory::View::Map(std::size_t virtual_offset, std::size_t backing_offset,
+                           std::size_t length) {
+    ASSERT(virtual_offset + length <= size && backing_offset + length <= memory.backing_size);
+    void* const result = mmap(base + virtual_offset, length, PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_FIXED, memory.fd,
+                              static_cast<off_t>(backing_offset));
+    ASSERT_MSG(result != MAP_FAILED, "Mapping fastmem view failed: {}", GetLastErrorMsg());
+}
+
+void HostMemory::View::Unmap(std::size_t virtual_offset, std::size_t length) {
+    ASSERT(virtual_offset + length <= size);
+    void* const result =
+        mmap(base + virtual_offset, length, PROT_NONE, RESERVE_FLAGS | MAP_FIXED, -1, 0);
+    ASSERT_MSG(result != MAP_FAILED, "Unmapping fastmem view failed: {}", GetLastErrorMsg());
+}
+
+std::unique_ptr<HostMemory::View> HostMemory::CreateView(std::size_t size) {
+    if (!IsMappable()) {
+        return nullptr;
+    }
+    auto view = std::make_unique<View>(*this, size);
+    if (!view->BasePointer()) {
+        LOG_WARNING(Common_Memory, "Unable to reserve {:#x} bytes for fastmem: {}", size,
+                    GetLastErrorMsg());
+        return nullptr;
+    }
+    return view;
+}
+
+#else
+
+// Windows needs placeholder mappings to replace parts of a reservation, which aren't implemented
+// yet, so the memory is a plain allocation there and guest memory is accessed through the page
+// tables only.
+
+HostMemory::HostMemory(std::size_t backing_size_)
+    : backing_size{backing_size_}, fallback_buffer{std::make_unique<u8[]>(backing_size_)} {
+    backing_base = fallback_buffer.get();
+}
+
+HostMemory::~HostMemory() = default;
+
+HostMemory::View::View(HostMemory& memory_, std::size_t size_) : memory{memory_}, size{size_} {}
+
+HostMemory::View::~View() = default;
+
+void HostMemory::View::Map(std::size_t, std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+void HostMemory::View::Unmap(std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+std::unique_ptr<HostMemory::View> HostMemory::CreateView(std::size_t) {
+    return nullptr;
+}
+
+#endif
+
+} // namespace Common
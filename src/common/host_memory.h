@@ -0,0 +1,94 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * A block of host memory that can be mapped at several places of the host address space at once.
+ * It backs the emulated physical memory, so that the address spaces of guest processes can be
+ * mirrored in host address ranges and accessed with plain host loads and stores (fastmem).
+ * Where the host doesn't support it, the memory is a plain allocation and no views can be made.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t backing_size);
+    ~HostMemory();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    [[nodiscard]] u8* BackingBasePointer() noexcept {
+        return backing_base;
+    }
+    [[nodiscard]] const u8* BackingBasePointer() const noexcept {
+        return backing_base;
+    }
+
+    [[nodiscard]] std::size_t BackingSize() const noexcept {
+        return backing_size;
+    }
+
+    /// Whether the pointer points into the backing memory.
+    [[nodiscard]] bool IsInBacking(const u8* pointer) const noexcept {
+        return pointer >= backing_base && pointer < backing_base + backing_size;
+    }
+
+    /// Whether views of the backing memory can be made.
+    [[nodiscard]] bool IsMappable() const noexcept {
+        return fd >= 0;
+    }
+
+    /**
+     * A reserved host address range in which parts of the backing memory can be mapped.
+     * Everything else in the range is inaccessible, so accesses to it fault.
+     */
+    class View {
+    public:
+        View(HostMemory& memory, std::size_t size);
+        ~View();
+
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        [[nodiscard]] u8* BasePointer() noexcept {
+            return base;
+        }
+
+        /**
+         * Maps part of the backing memory into the view.
+         * @param virtual_offset Offset into the view, must be page aligned.
+         * @param backing_offset Offset into the backing memory, must be page aligned.
+         * @param length Size of the mapping, must be page aligned.
+         */
+        void Map(std::size_t virtual_offset, std::size_t backing_offset, std::size_t length);
+
+        /// Makes part of the view inaccessible again.
+        void Unmap(std::size_t virtual_offset, std::size_t length);
+
+    private:
+        HostMemory& memory;
+        u8* base = nullptr;
+        std::size_t size = 0;
+    };
+
+    /**
+     * Makes a view of the given size, returns nullptr if the host can't map the backing memory or
+     * the address range can't be reserved.
+     */
+    [[nodiscard]] std::unique_ptr<View> CreateView(std::size_t size);
+
+private:
+    std::size_t backing_size;
+    u8* backing_base = nullptr;
+    int fd = -1;
+    std::unique_ptr<u8[]> fallback_buffer;
+};
+
+} // namespace Common
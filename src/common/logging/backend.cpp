@@ -4,6 +4,9 @@
 // Refer to the license.txt file included.
 
 #include <chrono>
+#include <cstring>
+#include <mutex>
+#include <span>
 #include <boost/regex.hpp>
 
 #include <fmt/format.h>
@@ -27,6 +30,7 @@
 #include "common/file_util.h"
 #include "common/literals.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
@@ -181,7 +185,72 @@ public:
 };
 #endif
 
+/**
+ * Bounded lock-free queue of binary log entries. Producers claim a slot by advancing the tail and
+ * publish it through the sequence number of the slot, so logging threads never wait for each other
+ * or for the writer. Entries are dropped when the queue is full.
+ */
+class BinaryEntryQueue {
+public:
+    BinaryEntryQueue() : slots{std::make_unique<Slot[]>(Capacity)} {
+        for (std::size_t i = 0; i < Capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename Func>
+    bool TryPush(Func&& fill) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos & (Capacity - 1)];
+            const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        fill(slot->entry);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Pops an entry, only the writer thread may call this.
+    bool TryPop(BinaryEntry& entry) {
+        Slot& slot = slots[head & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+            return false;
+        }
+        entry = slot.entry;
+        slot.sequence.store(head + Capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+private:
+    static constexpr std::size_t Capacity = 0x4000;
+
+    struct Slot {
+        std::atomic_size_t sequence;
+        BinaryEntry entry;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    alignas(128) std::atomic_size_t tail{0};
+    alignas(128) std::size_t head{0};
+};
+
 bool initialization_in_progress_suppress_logging = true;
+std::atomic_bool binary_log_enabled{false};
+
+/// Format string of messages that were formatted when they were logged.
+constexpr std::string_view PREFORMATTED_FORMAT = "{}";
 
 #ifdef BORKED3DS_LINUX_GCC_BACKTRACE
 [[noreturn]] void SleepForever() {
@@ -253,11 +322,23 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
+    void SetBinaryLogEnabled(bool enabled) {
+        std::scoped_lock lock{binary_log_mutex};
+        if (enabled && !binary_queue) {
+            const auto& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+            binary_writer = std::make_unique<BinaryLogWriter>(log_dir + LOG_BINARY_FILE);
+            binary_queue = std::make_unique<BinaryEntryQueue>();
+            StartBinaryThread();
+        }
+        binary_log_enabled.store(enabled && binary_queue, std::memory_order_release);
+    }
+
+    bool CheckFilter(Class log_class, Level log_level) const {
+        return filter.CheckMessage(log_class, log_level);
+    }
+
     void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, std::string message) {
-        if (!filter.CheckMessage(log_class, log_level)) {
-            return;
-        }
         Entry new_entry =
             CreateEntry(log_class, log_level, filename, line_num, function, std::move(message));
         if (!regex_filter.empty() &&
@@ -274,6 +355,28 @@ public:
         }
     }
 
+    void PushBinaryEntry(Class log_class, Level log_level, const char* filename,
+                         unsigned int line_num, const char* function, std::string_view format,
+                         std::span<const u8> args) {
+        const auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - time_origin);
+        const bool pushed = binary_queue->TryPush([&](BinaryEntry& entry) {
+            entry.timestamp = timestamp;
+            entry.filename = filename;
+            entry.function = function;
+            entry.format = format.data();
+            entry.format_size = static_cast<u32>(format.size());
+            entry.line_num = line_num;
+            entry.log_class = log_class;
+            entry.log_level = log_level;
+            entry.args_size = static_cast<u16>(args.size());
+            std::memcpy(entry.args.data(), args.data(), args.size());
+        });
+        if (!pushed) {
+            dropped_binary_entries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
 private:
     Impl(const std::string& file_backend_filename, const Filter& filter_)
         : filter{filter_}, file_backend{file_backend_filename} {
@@ -361,11 +464,50 @@ private:
         });
     }
 
+    void StartBinaryThread() {
+        binary_thread = std::jthread([this](std::stop_token stop_token) {
+            Common::SetCurrentThreadName("borked3ds:BinaryLog");
+            BinaryEntry entry;
+            const auto write_entries = [this, &entry] {
+                bool written = false;
+                while (binary_queue->TryPop(entry)) {
+                    binary_writer->Write(entry);
+                    written = true;
+                }
+                if (const u64 dropped = dropped_binary_entries.exchange(0)) {
+                    binary_writer->WriteDropped(dropped);
+                    written = true;
+                }
+                return written;
+            };
+            // The producers don't signal new entries, so poll the queue. It is flushed whenever it
+            // runs dry to keep the file current without a flush per entry.
+            bool pending_flush = false;
+            while (!stop_token.stop_requested()) {
+                if (write_entries()) {
+                    pending_flush = true;
+                    continue;
+                }
+                if (pending_flush) {
+                    binary_writer->Flush();
+                    pending_flush = false;
+                }
+                Common::StoppableTimedWait(stop_token, std::chrono::milliseconds{1});
+            }
+            write_entries();
+            binary_writer->Flush();
+        });
+    }
+
     void StopBackendThread() {
         backend_thread.request_stop();
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
+        binary_thread.request_stop();
+        if (binary_thread.joinable()) {
+            binary_thread.join();
+        }
 
         ForEachBackend([](Backend& backend) { backend.Flush(); });
     }
@@ -445,6 +587,12 @@ private:
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 
+    std::mutex binary_log_mutex;
+    std::unique_ptr<BinaryLogWriter> binary_writer;
+    std::unique_ptr<BinaryEntryQueue> binary_queue;
+    std::atomic<u64> dropped_binary_entries{0};
+    std::jthread binary_thread;
+
 #ifdef BORKED3DS_LINUX_GCC_BACKTRACE
     std::atomic_int received_signal{0};
     std::array<u8, 4096> backtrace_storage{};
@@ -482,12 +630,48 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+void SetBinaryLogEnabled(bool enabled) {
+    Impl::Instance().SetBinaryLogEnabled(enabled);
+}
+
+bool IsBinaryLogEnabled() {
+    return binary_log_enabled.load(std::memory_order_acquire);
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args) {
-    if (!initialization_in_progress_suppress_logging) {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+    if (initialization_in_progress_suppress_logging) {
+        return;
+    }
+    auto& impl = Impl::Instance();
+    if (!impl.CheckFilter(log_class, log_level)) {
+        return;
+    }
+    std::string message = fmt::vformat(format, args);
+    if (IsBinaryLogEnabled()) {
+        // Arguments without a binary encoding are stored already formatted
+        BinaryArgsWriter writer;
+        writer.Write(message);
+        impl.PushBinaryEntry(log_class, log_level, filename, line_num, function,
+                             PREFORMATTED_FORMAT, writer.Data());
+        if (log_level < Level::Warning) {
+            return;
+        }
+    }
+    impl.PushEntry(log_class, log_level, filename, line_num, function, std::move(message));
+}
+
+void BinaryLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                          unsigned int line_num, const char* function, fmt::string_view format,
+                          std::span<const u8> args) {
+    if (initialization_in_progress_suppress_logging) {
+        return;
+    }
+    auto& impl = Impl::Instance();
+    if (impl.CheckFilter(log_class, log_level)) {
+        impl.PushBinaryEntry(log_class, log_level, filename, line_num, function,
+                             {format.data(), format.size()}, args);
     }
 }
 } // namespace Common::Log
@@ -34,4 +34,10 @@ void SetGlobalFilter(const Filter& filter);
 bool SetRegexFilter(const std::string& regex);
 
 void SetColorConsoleBackendEnabled(bool enabled);
+
+/**
+ * Writes messages below warning level to a binary log file, formatting them only when the file is
+ * decoded. The regex filter doesn't apply to the binary log.
+ */
+void SetBinaryLogEnabled(bool enabled);
 } // namespace Common::Log
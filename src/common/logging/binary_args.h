@@ -0,0 +1,115 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "common/common_types.h"
+
+namespace Common::Log {
+
+/// Type of an argument of a message in the binary log, followed by its value.
+enum class BinaryArgType : u8 {
+    Signed,   ///< s64
+    Unsigned, ///< u64
+    Float,    ///< float
+    Double,   ///< double
+    Bool,     ///< u8
+    Char,     ///< char
+    String,   ///< u16 size followed by the characters
+    Pointer,  ///< u64
+};
+
+/// Maximum size of the encoded arguments of a message, longer strings are truncated.
+constexpr std::size_t MAX_BINARY_ARGS_SIZE = 192;
+
+namespace detail {
+template <typename T>
+constexpr bool IsStringArg =
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> ||
+    std::is_same_v<T, std::string_view> ||
+    (std::is_array_v<T> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<T>>, char>);
+}
+
+/// Whether an argument can be stored in the binary log as is, instead of being formatted.
+template <typename T>
+constexpr bool IsBinaryLoggable =
+    std::is_arithmetic_v<T> || std::is_enum_v<T> || detail::IsStringArg<T> ||
+    std::is_same_v<T, const void*> || std::is_same_v<T, void*>;
+
+/// Encodes the arguments of a message for the binary log.
+class BinaryArgsWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(IsBinaryLoggable<T>);
+        if constexpr (std::is_enum_v<T>) {
+            Write(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_same_v<T, bool>) {
+            WriteValue(BinaryArgType::Bool, static_cast<u8>(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            WriteValue(BinaryArgType::Char, value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            WriteValue(BinaryArgType::Signed, static_cast<s64>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            WriteValue(BinaryArgType::Unsigned, static_cast<u64>(value));
+        } else if constexpr (std::is_same_v<T, float>) {
+            WriteValue(BinaryArgType::Float, value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            WriteValue(BinaryArgType::Double, static_cast<double>(value));
+        } else if constexpr (std::is_pointer_v<T> && detail::IsStringArg<T>) {
+            WriteString(value ? std::string_view{value} : std::string_view{});
+        } else if constexpr (detail::IsStringArg<T>) {
+            WriteString(value);
+        } else {
+            WriteValue(BinaryArgType::Pointer, reinterpret_cast<u64>(value));
+        }
+    }
+
+    [[nodiscard]] std::span<const u8> Data() const {
+        return {buffer.data(), size};
+    }
+
+private:
+    template <typename T>
+    void WriteValue(BinaryArgType type, T value) {
+        if (size + 1 + sizeof(T) > buffer.size()) {
+            return;
+        }
+        buffer[size++] = static_cast<u8>(type);
+        std::memcpy(buffer.data() + size, &value, sizeof(T));
+        size += sizeof(T);
+    }
+
+    void WriteString(std::string_view str) {
+        if (size + 1 + sizeof(u16) > buffer.size()) {
+            return;
+        }
+        const u16 length =
+            static_cast<u16>(std::min(str.size(), buffer.size() - size - 1 - sizeof(u16)));
+        buffer[size++] = static_cast<u8>(BinaryArgType::String);
+        std::memcpy(buffer.data() + size, &length, sizeof(u16));
+        std::memcpy(buffer.data() + size + sizeof(u16), str.data(), length);
+        size += sizeof(u16) + length;
+    }
+
+    std::array<u8, MAX_BINARY_ARGS_SIZE> buffer;
+    std::size_t size = 0;
+};
+
+/**
+ * Formats a message of the binary log.
+ * @param format The format string of the message.
+ * @param args The arguments encoded by BinaryArgsWriter.
+ */
+std::string FormatBinaryMessage(std::string_view format, std::span<const u8> args);
+
+} // namespace Common::Log
@@ -0,0 +1,235 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include "common/logging/binary_log.h"
+
+namespace Common::Log {
+
+namespace {
+
+constexpr std::array<char, 4> BINARY_LOG_MAGIC{'B', '3', 'D', 'L'};
+constexpr u32 BINARY_LOG_VERSION = 1;
+
+enum class RecordType : u8 {
+    String,  ///< u32 size followed by the characters
+    Message, ///< MessageRecord followed by the encoded arguments
+    Dropped, ///< u64 number of dropped messages
+};
+
+#pragma pack(push, 1)
+struct MessageRecord {
+    u64 timestamp;
+    Class log_class;
+    Level log_level;
+    u32 line_num;
+    u32 filename;
+    u32 function;
+    u32 format;
+    u16 args_size;
+};
+#pragma pack(pop)
+
+} // Anonymous namespace
+
+std::string FormatBinaryMessage(std::string_view format, std::span<const u8> args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    std::size_t offset = 0;
+    const auto read = [&]<typename T>(T& value) {
+        if (offset + sizeof(T) > args.size()) {
+            return false;
+        }
+        std::memcpy(&value, args.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    };
+
+    bool valid = true;
+    while (valid && offset < args.size()) {
+        switch (static_cast<BinaryArgType>(args[offset++])) {
+        case BinaryArgType::Signed: {
+            s64 value;
+            if ((valid = read(value))) {
+                store.push_back(value);
+            }
+            break;
+        }
+        case BinaryArgType::Unsigned: {
+            u64 value;
+            if ((valid = read(value))) {
+                store.push_back(value);
+            }
+            break;
+        }
+        case BinaryArgType::Float: {
+            float value;
+            if ((valid = read(value))) {
+                store.push_back(value);
+            }
+            break;
+        }
+        case BinaryArgType::Double: {
+            double value;
+            if ((valid = read(value))) {
+                store.push_back(value);
+            }
+            break;
+        }
+        case BinaryArgType::Bool: {
+            u8 value;
+            if ((valid = read(value))) {
+                store.push_back(value != 0);
+            }
+            break;
+        }
+        case BinaryArgType::Char: {
+            char value;
+            if ((valid = read(value))) {
+                store.push_back(value);
+            }
+            break;
+        }
+        case BinaryArgType::String: {
+            u16 size;
+            if ((valid = read(size) && offset + size <= args.size())) {
+                store.push_back(
+                    std::string(reinterpret_cast<const char*>(args.data() + offset), size));
+                offset += size;
+            }
+            break;
+        }
+        case BinaryArgType::Pointer: {
+            u64 value;
+            if ((valid = read(value))) {
+                store.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+            }
+            break;
+        }
+        default:
+            valid = false;
+            break;
+        }
+    }
+
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error&) {
+        // Arguments that didn't fit in the entry are missing
+        return fmt::format("{} <missing arguments>", format);
+    }
+}
+
+BinaryLogWriter::BinaryLogWriter(const std::string& filename) : file{filename, "wb"} {
+    file.WriteBytes(BINARY_LOG_MAGIC.data(), BINARY_LOG_MAGIC.size());
+    file.WriteObject(BINARY_LOG_VERSION);
+}
+
+void BinaryLogWriter::Write(const BinaryEntry& entry) {
+    const MessageRecord record{
+        .timestamp = static_cast<u64>(entry.timestamp.count()),
+        .log_class = entry.log_class,
+        .log_level = entry.log_level,
+        .line_num = entry.line_num,
+        .filename = GetStringIndex(entry.filename, std::strlen(entry.filename)),
+        .function = GetStringIndex(entry.function, std::strlen(entry.function)),
+        .format = GetStringIndex(entry.format, entry.format_size),
+        .args_size = entry.args_size,
+    };
+    file.WriteObject(RecordType::Message);
+    file.WriteObject(record);
+    file.WriteBytes(entry.args.data(), entry.args_size);
+}
+
+void BinaryLogWriter::WriteDropped(u64 count) {
+    file.WriteObject(RecordType::Dropped);
+    file.WriteObject(count);
+}
+
+void BinaryLogWriter::Flush() {
+    file.Flush();
+}
+
+u32 BinaryLogWriter::GetStringIndex(const char* str, std::size_t size) {
+    const auto [it, inserted] =
+        string_indices.try_emplace(str, static_cast<u32>(string_indices.size()));
+    if (inserted) {
+        const u32 string_size = static_cast<u32>(size);
+        file.WriteObject(RecordType::String);
+        file.WriteObject(string_size);
+        file.WriteBytes(str, size);
+    }
+    return it->second;
+}
+
+BinaryLogReader::BinaryLogReader(const std::string& filename) : file{filename, "rb"} {
+    std::array<char, 4> magic{};
+    u32 version = 0;
+    valid = file.ReadBytes(magic.data(), magic.size()) == magic.size() &&
+            file.ReadBytes(&version, sizeof(version)) == sizeof(version) &&
+            magic == BINARY_LOG_MAGIC && version == BINARY_LOG_VERSION;
+}
+
+std::optional<Entry> BinaryLogReader::Next() {
+    if (!valid) {
+        return std::nullopt;
+    }
+
+    RecordType type;
+    while (file.ReadBytes(&type, sizeof(type)) == sizeof(type)) {
+        switch (type) {
+        case RecordType::String: {
+            u32 size;
+            if (file.ReadBytes(&size, sizeof(size)) != sizeof(size)) {
+                return std::nullopt;
+            }
+            std::string& str = strings.emplace_back(size, '\0');
+            if (file.ReadBytes(str.data(), size) != size) {
+                return std::nullopt;
+            }
+            break;
+        }
+        case RecordType::Message: {
+            MessageRecord record;
+            std::array<u8, MAX_BINARY_ARGS_SIZE> args;
+            if (file.ReadBytes(&record, sizeof(record)) != sizeof(record) ||
+                record.args_size > args.size() ||
+                file.ReadBytes(args.data(), record.args_size) != record.args_size ||
+                std::max({record.filename, record.function, record.format}) >= strings.size()) {
+                return std::nullopt;
+            }
+            return Entry{
+                .timestamp = std::chrono::microseconds{record.timestamp},
+                .log_class = record.log_class,
+                .log_level = record.log_level,
+                .filename = strings[record.filename].c_str(),
+                .line_num = record.line_num,
+                .function = strings[record.function],
+                .message = FormatBinaryMessage(strings[record.format],
+                                               std::span{args}.first(record.args_size)),
+            };
+        }
+        case RecordType::Dropped: {
+            u64 count;
+            if (file.ReadBytes(&count, sizeof(count)) != sizeof(count)) {
+                return std::nullopt;
+            }
+            return Entry{
+                .log_class = Class::Log,
+                .log_level = Level::Warning,
+                .filename = "?",
+                .function = "?",
+                .message = fmt::format("{} messages were dropped", count),
+            };
+        }
+        default:
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace Common::Log
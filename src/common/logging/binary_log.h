@@ -0,0 +1,80 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "common/file_util.h"
+#include "common/logging/binary_args.h"
+#include "common/logging/log_entry.h"
+#include "common/logging/types.h"
+
+namespace Common::Log {
+
+/**
+ * A message of the binary log. Only the arguments are copied, the strings are literals that live
+ * as long as the program, so formatting can be deferred to the binary log file decoder.
+ */
+struct BinaryEntry {
+    std::chrono::microseconds timestamp;
+    const char* filename;
+    const char* function;
+    const char* format;
+    u32 format_size;
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+    u16 args_size;
+    std::array<u8, MAX_BINARY_ARGS_SIZE> args;
+};
+
+/**
+ * Writes binary log files. The file starts with a magic word and a version, followed by records
+ * starting with their type. Strings are written in a record of their own the first time they are
+ * used, messages refer to them by index.
+ */
+class BinaryLogWriter {
+public:
+    explicit BinaryLogWriter(const std::string& filename);
+
+    void Write(const BinaryEntry& entry);
+
+    /// Records that messages were dropped because the log couldn't keep up with them.
+    void WriteDropped(u64 count);
+
+    void Flush();
+
+private:
+    u32 GetStringIndex(const char* str, std::size_t size);
+
+    FileUtil::IOFile file;
+    std::unordered_map<const char*, u32> string_indices;
+};
+
+/// Reads binary log files back as log entries.
+class BinaryLogReader {
+public:
+    explicit BinaryLogReader(const std::string& filename);
+
+    [[nodiscard]] bool IsValid() const {
+        return valid;
+    }
+
+    /// Returns the next entry, or std::nullopt at the end of the file. The strings of the entry
+    /// are owned by the reader.
+    [[nodiscard]] std::optional<Entry> Next();
+
+private:
+    FileUtil::IOFile file;
+    std::deque<std::string> strings;
+    bool valid = false;
+};
+
+} // namespace Common::Log
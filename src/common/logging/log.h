@@ -9,6 +9,7 @@
 #include <array>
 #include <string_view>
 
+#include "common/logging/binary_args.h"
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
 
@@ -28,9 +29,27 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args);
 
+/// Whether messages are written to the binary log instead of being formatted when they are logged
+bool IsBinaryLogEnabled();
+
+/// Logs a message to the binary log, with its arguments encoded by BinaryArgsWriter
+void BinaryLogMessageImpl(Class log_class, Level log_level, const char* filename,
+                          unsigned int line_num, const char* function, fmt::string_view format,
+                          std::span<const u8> args);
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, fmt::format_string<Args...> format, const Args&... args) {
+    // Warnings and errors are still formatted right away so that they reach the text log in full.
+    if constexpr ((IsBinaryLoggable<Args> && ...)) {
+        if (log_level < Level::Warning && IsBinaryLogEnabled()) {
+            BinaryArgsWriter writer;
+            (writer.Write(args), ...);
+            BinaryLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                                 writer.Data());
+            return;
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
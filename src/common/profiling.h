@@ -21,11 +21,14 @@
 #define BORKED3DS_FRAME_BEGIN(text) FrameMarkStart(text)
 
 #define BORKED3DS_FRAME_END(text) FrameMarkEnd(text)
+
+#define BORKED3DS_PLOT(name, value) TracyPlot(name, static_cast<int64_t>(value))
 #else
 
 #define BORKED3DS_PROFILE(scope, text)
 #define BORKED3DS_SCOPED_FRAME(text)
 #define BORKED3DS_FRAME_BEGIN(text)
 #define BORKED3DS_FRAME_END(text)
+#define BORKED3DS_PLOT(name, value)
 
 #endif
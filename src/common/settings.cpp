@@ -96,6 +96,10 @@ void LogSettings() {
 
     LOG_INFO(Config, "Borked3DS Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
+    log_setting("Core_IncrementalSaveStates", values.incremental_save_states.GetValue());
+    log_setting("Core_EnableRewind", values.enable_rewind.GetValue());
+    log_setting("Core_RewindInterval", values.rewind_interval.GetValue());
+    log_setting("Core_RewindBufferSize", values.rewind_buffer_size.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
     log_setting("Core_EnableCustomCPUTicks", values.enable_custom_cpu_ticks.GetValue());
     log_setting("Core_CustomCPUTicks", values.custom_cpu_ticks.GetValue());
@@ -123,6 +127,7 @@ void LogSettings() {
     log_setting("Renderer_UseHwShader", values.use_hw_shader.GetValue());
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul.GetValue());
     log_setting("Renderer_UseShaderJit", values.use_shader_jit.GetValue());
+    log_setting("Renderer_UseShaderJitSimd", values.use_shader_jit_simd.GetValue());
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor.GetValue());
     log_setting("Renderer_FrameLimit", values.frame_limit.GetValue());
     log_setting("Renderer_FrameSkip", values.frame_skip.GetValue());
@@ -172,6 +177,7 @@ void LogSettings() {
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd.GetValue());
     log_setting("DataStorage_HideImages", values.hide_images.GetValue());
     log_setting("DataStorage_UseCustomStorage", values.use_custom_storage.GetValue());
+    log_setting("DataStorage_RomFSCacheSize", values.romfs_cache_size.GetValue());
     if (values.use_custom_storage) {
         log_setting("DataStorage_SdmcDir", FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir));
         log_setting("DataStorage_NandDir", FileUtil::GetUserPath(FileUtil::UserPath::NANDDir));
@@ -185,6 +191,7 @@ void LogSettings() {
     log_setting("Debugging_UseGdbstub", values.use_gdbstub.GetValue());
     log_setting("Debugging_GdbstubPort", values.gdbstub_port.GetValue());
     log_setting("Debugging_InstantDebugLog", values.instant_debug_log.GetValue());
+    log_setting("Debugging_BinaryLog", values.binary_log.GetValue());
 }
 
 bool IsConfiguringGlobal() {
@@ -471,11 +471,16 @@ struct Values {
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{false, "lle_applets"};
+    Setting<bool> incremental_save_states{false, "incremental_save_states"};
+    Setting<bool> enable_rewind{false, "enable_rewind"};
+    Setting<u32, true> rewind_interval{30, 1, 600, "rewind_interval"};
+    Setting<u32, true> rewind_buffer_size{256, 16, 4096, "rewind_buffer_size"};
 
     // Data Storage
     Setting<bool> use_virtual_sd{true, "use_virtual_sd"};
     Setting<bool> use_custom_storage{false, "use_custom_storage"};
     Setting<bool> hide_images{false, "hide_images"};
+    Setting<u32, true> romfs_cache_size{8, 1, 256, "romfs_cache_size"};
 
     // System
     SwitchableSetting<s32> region_value{REGION_VALUE_AUTO_SELECT, "region_value"};
@@ -516,6 +521,7 @@ struct Values {
     SwitchableSetting<bool> shaders_accurate_mul{false, "shaders_accurate_mul"};
     SwitchableSetting<bool> use_vsync_new{true, "use_vsync_new"};
     Setting<bool> use_shader_jit{true, "use_shader_jit"};
+    Setting<bool> use_shader_jit_simd{false, "use_shader_jit_simd"};
     SwitchableSetting<u32, true> resolution_factor{1, 0, 10, "resolution_factor"};
     SwitchableSetting<double, true> frame_limit{100, 0, 1000, "frame_limit"};
     SwitchableSetting<int, true> turbo_speed{200, 0, 1000, "turbo_speed"};
@@ -612,6 +618,7 @@ struct Values {
     Setting<bool> use_gdbstub{false, "use_gdbstub"};
     Setting<u16> gdbstub_port{24689, "gdbstub_port"};
     Setting<bool> instant_debug_log{true, "instant_debug_log"};
+    Setting<bool> binary_log{false, "binary_log"};
 
     // Hacks
     SwitchableSetting<bool> enable_custom_cpu_ticks{false, "enable_custom_cpu_ticks"};
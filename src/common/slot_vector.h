@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <bit>
 #include <compare>
 #include <numeric>
@@ -81,6 +82,28 @@ public:
         ResetStorageBit(id.index);
     }
 
+    /// Destroys every value, all ids become free.
+    void clear() noexcept {
+        ForEach([](SlotId, T& value) { value.~T(); });
+        std::fill(stored_bitset.begin(), stored_bitset.end(), u64{0});
+        free_list.resize(values_capacity);
+        std::iota(free_list.begin(), free_list.end(), 0U);
+    }
+
+    /// Calls func with the id and the value of every stored value.
+    template <typename Func>
+    void ForEach(Func&& func) noexcept {
+        std::size_t index = 0;
+        for (u64 bits : stored_bitset) {
+            for (std::size_t bit = 0; bits; ++bit, bits >>= 1) {
+                if ((bits & 1) != 0) {
+                    func(SlotId{static_cast<u32>(index + bit)}, values[index + bit].object);
+                }
+            }
+            index += 64;
+        }
+    }
+
     std::size_t size() const noexcept {
         return values_capacity - free_list.size();
     }
@@ -5,9 +5,10 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
+#include <utility>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
 #include "common/common_types.h"
@@ -15,194 +16,215 @@
 namespace Common {
 
 template <class T, unsigned int N>
-struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+class ThreadQueueList;
 
+/// Links of an element in a ThreadQueueList. Elements derive from it, so queueing doesn't allocate.
+template <class T>
+class ThreadQueueListHook {
+private:
+    template <class, unsigned int>
+    friend class ThreadQueueList;
+
+    T* prev = nullptr;
+    T* next = nullptr;
+    /// Priority level the element is queued at, or -1 if it isn't queued.
+    unsigned int queued_priority = static_cast<unsigned int>(-1);
+};
+
+/**
+ * Queues of elements by priority level, lower levels come first. Each level is an intrusive
+ * doubly linked list, and a bitmap of the non-empty levels finds the first element in constant
+ * time. An element can be in one queue at a time.
+ */
+template <class T, unsigned int N>
+class ThreadQueueList {
+public:
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
-
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    static_assert(NUM_QUEUES <= 64, "The non-empty levels have to fit in the bitmap");
 
     // Only for debugging, returns priority level.
-    [[nodiscard]] Priority contains(const T& uid) const {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
-
-        return -1;
+    [[nodiscard]] Priority contains(const T* element) const {
+        return Hook(element).queued_priority;
     }
 
-    [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
-        }
+    [[nodiscard]] T* get_first() const {
+        return nonempty == 0 ? nullptr : queues[std::countr_zero(nonempty)].head;
+    }
 
-        return T();
+    T* pop_first() {
+        return pop_first_better(NUM_QUEUES);
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
-        }
+    /// Pops the first element for which pred returns true, the skipped elements keep their place.
+    template <typename Pred>
+    T* pop_first(Pred&& pred) {
+        return pop_first_better(NUM_QUEUES, std::forward<Pred>(pred));
+    }
 
-        return T();
+    /// Pops the first element of a level lower than the given priority.
+    T* pop_first_better(Priority priority) {
+        return pop_first_better(priority, [](const T*) { return true; });
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
+    /// Pops the first element of a level lower than the given priority for which pred returns true.
+    template <typename Pred>
+    T* pop_first_better(Priority priority, Pred&& pred) {
+        u64 levels = nonempty & LevelsBelow(priority);
+        while (levels != 0) {
+            for (T* cur = queues[std::countr_zero(levels)].head; cur; cur = Hook(cur).next) {
+                if (pred(cur)) {
+                    Unlink(cur);
+                    return cur;
+                }
             }
-            cur = cur->next_nonempty;
+            levels &= levels - 1;
         }
-
-        return T();
+        return nullptr;
     }
 
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
-    }
-
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+    void push_front(Priority priority, T* element) {
+        Queue& cur = queues[priority];
+        auto& hook = Hook(element);
+        hook.prev = nullptr;
+        hook.next = cur.head;
+        hook.queued_priority = priority;
+        if (cur.head) {
+            Hook(cur.head).prev = element;
+        } else {
+            cur.tail = element;
+        }
+        cur.head = element;
+        nonempty |= u64{1} << priority;
+    }
+
+    void push_back(Priority priority, T* element) {
+        Queue& cur = queues[priority];
+        auto& hook = Hook(element);
+        hook.prev = cur.tail;
+        hook.next = nullptr;
+        hook.queued_priority = priority;
+        if (cur.tail) {
+            Hook(cur.tail).next = element;
+        } else {
+            cur.head = element;
+        }
+        cur.tail = element;
+        nonempty |= u64{1} << priority;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
-        prepare(new_priority);
-        push_back(new_priority, thread_id);
+    void move(T* element, Priority old_priority, Priority new_priority) {
+        remove(old_priority, element);
+        push_back(new_priority, element);
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+    void remove(Priority priority, T* element) {
+        if (Hook(element).queued_priority == priority) {
+            Unlink(element);
+        }
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        Queue& cur = queues[priority];
+        if (cur.head != cur.tail) {
+            T* const front = cur.head;
+            Unlink(front);
+            push_back(priority, front);
         }
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        for (Queue& cur : queues) {
+            while (cur.head) {
+                Unlink(cur.head);
+            }
+        }
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return queues[priority].head == nullptr;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* head = nullptr;
+        T* tail = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    static ThreadQueueListHook<T>& Hook(T* element) {
+        return *element;
+    }
+    static const ThreadQueueListHook<T>& Hook(const T* element) {
+        return *element;
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
+    std::deque<T*> GetElements(std::size_t priority) const {
+        std::deque<T*> elements;
+        for (T* cur = queues[priority].head; cur; cur = Hook(cur).next) {
+            elements.push_back(cur);
         }
-
-        cur->next_nonempty = first;
-        first = cur;
+        return elements;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    static constexpr u64 LevelsBelow(Priority priority) {
+        return priority >= 64 ? ~u64{0} : (u64{1} << priority) - 1;
+    }
 
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
+    void Unlink(T* element) {
+        auto& hook = Hook(element);
+        Queue& cur = queues[hook.queued_priority];
+        if (hook.prev) {
+            Hook(hook.prev).next = hook.next;
         } else {
-            return q - queues.data();
+            cur.head = hook.next;
         }
-    }
-
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
+        if (hook.next) {
+            Hook(hook.next).prev = hook.prev;
         } else {
-            return &queues[idx];
+            cur.tail = hook.prev;
+        }
+        if (!cur.head) {
+            nonempty &= ~(u64{1} << hook.queued_priority);
         }
+        hook = ThreadQueueListHook<T>{};
     }
 
+    // Bit i is set when level i isn't empty.
+    u64 nonempty = 0;
+    // The priority level queues.
+    std::array<Queue, NUM_QUEUES> queues{};
+
+    // Savestates store the levels the way this used to, as a linked list of the levels that were
+    // used followed by a deque per level. All levels are stored as used, as they are equivalent.
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
+        const s64 first_index = 0;
+        ar << first_index;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+            const s64 next_index = i + 1 < NUM_QUEUES ? static_cast<s64>(i + 1) : -2;
+            ar << next_index;
+            const std::deque<T*> data = GetElements(i);
+            ar << data;
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
-        s64 idx;
-        ar >> idx;
-        first = ToPointer(idx);
+        // The queued elements are being replaced by newly loaded ones, don't touch them
+        nonempty = 0;
+        queues.fill(Queue{});
+        s64 index;
+        ar >> index;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            ar >> index;
+            std::deque<T*> data;
+            ar >> data;
+            for (T* element : data) {
+                push_back(static_cast<Priority>(i), element);
+            }
         }
     }
 
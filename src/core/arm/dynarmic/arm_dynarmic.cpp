@@ -21,6 +21,19 @@
 
 namespace Core {
 
+namespace {
+
+/// Size of the code cache of each JIT instance, dynarmic starts over when it is full.
+constexpr u32 JIT_CODE_CACHE_SIZE = 64 * 1024 * 1024;
+
+/// Memory budget for the code caches of the JIT instances of a core. One instance is kept for each
+/// live page table, the kernel keeps at most MAX_RETIRED_PAGE_TABLES of exited processes alive.
+/// When a new instance would exceed the budget, the least recently used one is destroyed.
+constexpr std::size_t JIT_CODE_CACHE_BUDGET = 1024 * 1024 * 1024;
+constexpr std::size_t MAX_CACHED_JITS = JIT_CODE_CACHE_BUDGET / JIT_CODE_CACHE_SIZE;
+
+} // Anonymous namespace
+
 class DynarmicUserCallbacks final : public Dynarmic::A32::UserCallbacks {
 public:
     explicit DynarmicUserCallbacks(ARM_Dynarmic& parent)
@@ -269,7 +282,7 @@ void ARM_Dynarmic::PrepareReschedule() {
 
 void ARM_Dynarmic::ClearInstructionCache() {
     for (const auto& j : jits) {
-        j.second->ClearCache();
+        j.second.jit->ClearCache();
     }
 }
 
@@ -292,17 +305,70 @@ void ARM_Dynarmic::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_t
         SaveContext(ctx);
     }
 
-    auto iter = jits.find(current_page_table);
-    if (iter != jits.end()) {
-        jit = iter->second.get();
+    DropUnusedJits();
+
+    // A page table can be allocated where a destroyed one was, the JIT must be bound to this one
+    auto iter = jits.find(current_page_table.get());
+    if (iter != jits.end() && iter->second.page_table.lock() == current_page_table) {
+        ++jit_cache_hits;
+        CachedJit& cached = iter->second;
+        cached.last_use = ++jit_cache_clock;
+        if (current_page_table && cached.reuse_count != current_page_table->reuse_count) {
+            // The page table was reused for a new process running the same code, only what was
+            // translated from that code is still valid
+            const u64 code_start = current_page_table->reused_code_start;
+            const u64 code_end = code_start + current_page_table->reused_code_size;
+            cached.jit->InvalidateCacheRange(0, static_cast<std::size_t>(code_start));
+            cached.jit->InvalidateCacheRange(static_cast<u32>(code_end),
+                                             static_cast<std::size_t>((1ULL << 32) - code_end));
+            cached.reuse_count = current_page_table->reuse_count;
+        }
+        jit = cached.jit.get();
         LoadContext(ctx);
         return;
     }
 
+    ++jit_cache_misses;
+    LOG_DEBUG(Core_ARM11, "JIT cache miss on core {} ({} hits, {} misses)", GetID(),
+              jit_cache_hits, jit_cache_misses);
+    if (jits.size() >= MAX_CACHED_JITS) {
+        EvictLeastRecentlyUsedJit();
+    }
+
     auto new_jit = MakeJit();
     jit = new_jit.get();
     LoadContext(ctx);
-    jits.emplace(current_page_table, std::move(new_jit));
+    jits.insert_or_assign(current_page_table.get(),
+                          CachedJit{
+                              .jit = std::move(new_jit),
+                              .page_table = current_page_table,
+                              .reuse_count =
+                                  current_page_table ? current_page_table->reuse_count : 0,
+                              .last_use = ++jit_cache_clock,
+                          });
+}
+
+void ARM_Dynarmic::DropUnusedJits() {
+    // The JITs of page tables that are still alive are kept, whether their process runs or they
+    // wait in the kernel to be reused. The current JIT may be executing, this can be called from
+    // within a supervisor call.
+    std::erase_if(jits, [this](const auto& entry) {
+        return entry.first && entry.second.page_table.expired() && entry.second.jit.get() != jit;
+    });
+}
+
+void ARM_Dynarmic::EvictLeastRecentlyUsedJit() {
+    // The current JIT may be executing, this can be called from within a supervisor call
+    auto victim = jits.end();
+    for (auto it = jits.begin(); it != jits.end(); ++it) {
+        if (it->second.jit.get() != jit &&
+            (victim == jits.end() || it->second.last_use < victim->second.last_use)) {
+            victim = it;
+        }
+    }
+    if (victim != jits.end()) {
+        jits.erase(victim);
+    }
 }
 
 void ARM_Dynarmic::ServeBreak() {
@@ -315,8 +381,18 @@ void ARM_Dynarmic::ServeBreak() {
 std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     Dynarmic::A32::UserConfig config;
     config.callbacks = cb.get();
+    config.code_cache_size = JIT_CODE_CACHE_SIZE;
     if (current_page_table) {
         config.page_table = &current_page_table->GetPointerArray();
+        if (current_page_table->fastmem_view) {
+            // Accesses to pages that aren't mirrored in the arena (rasterizer-cached, DSP and
+            // unmapped memory) fault, the faulting code is then recompiled to use the page table.
+            config.fastmem_pointer =
+                reinterpret_cast<uintptr_t>(current_page_table->fastmem_view->BasePointer());
+            config.recompile_on_fastmem_failure = true;
+            config.fastmem_exclusive_access = true;
+            config.recompile_on_exclusive_fastmem_failure = true;
+        }
     }
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
@@ -68,6 +68,8 @@ private:
     Memory::MemorySystem& memory;
     std::unique_ptr<DynarmicUserCallbacks> cb;
     std::unique_ptr<Dynarmic::A32::Jit> MakeJit();
+    void DropUnusedJits();
+    void EvictLeastRecentlyUsedJit();
 
     u32 fpexc = 0;
     CP15State cp15_state;
@@ -75,7 +77,20 @@ private:
 
     Dynarmic::A32::Jit* jit = nullptr;
     std::shared_ptr<Memory::PageTable> current_page_table = nullptr;
-    std::map<std::shared_ptr<Memory::PageTable>, std::unique_ptr<Dynarmic::A32::Jit>> jits;
+
+    struct CachedJit {
+        std::unique_ptr<Dynarmic::A32::Jit> jit;
+        /// Page table the JIT is bound to, the JIT is dropped once the page table is destroyed
+        std::weak_ptr<Memory::PageTable> page_table;
+        /// PageTable::reuse_count of the page table the translated code belongs to
+        u32 reuse_count;
+        /// Value of jit_cache_clock when the JIT was last switched to
+        u64 last_use;
+    };
+    std::map<const Memory::PageTable*, CachedJit> jits;
+    u64 jit_cache_clock = 0;
+    u64 jit_cache_hits = 0;
+    u64 jit_cache_misses = 0;
 };
 
 } // namespace Core
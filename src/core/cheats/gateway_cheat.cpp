@@ -5,8 +5,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <optional>
 #include <span>
 #include <string>
 #include <vector>
@@ -63,8 +65,8 @@ static inline void LoadOffsetOp(Memory::MemorySystem& memory, const GatewayCheat
     state.offset = memory.Read32(addr);
 }
 
-static inline void LoopOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.loop_flag = state.loop_count < line.value;
+static inline void LoopOp(u32 value, State& state) {
+    state.loop_flag = state.loop_count < value;
     state.loop_count++;
     state.loop_back_line = state.current_line_nr;
 }
@@ -95,16 +97,16 @@ static inline void FullTerminateOp(State& state) {
     }
 }
 
-static inline void SetOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.offset = line.value;
+static inline void SetOffsetOp(u32 value, State& state) {
+    state.offset = value;
 }
 
-static inline void AddValueOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.reg += line.value;
+static inline void AddValueOp(u32 value, State& state) {
+    state.reg += value;
 }
 
-static inline void SetValueOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.reg = line.value;
+static inline void SetValueOp(u32 value, State& state) {
+    state.reg = value;
 }
 
 template <typename T, typename ReadFunction, typename WriteFunction>
@@ -128,24 +130,24 @@ static inline std::enable_if_t<std::is_integral_v<T>> LoadOp(const GatewayCheat:
     state.reg = read_func(addr);
 }
 
-static inline void AddOffsetOp(const GatewayCheat::CheatLine& line, State& state) {
-    state.offset += line.value;
+static inline void AddOffsetOp(u32 value, State& state) {
+    state.offset += value;
 }
 
-static inline void JokerOp(const GatewayCheat::CheatLine& line, State& state,
-                           const Core::System& system) {
+static inline void JokerOp(u32 value, State& state, const Core::System& system) {
     u32 pad_state = system.ServiceManager()
                         .GetService<Service::HID::Module::Interface>("hid:USER")
                         ->GetModule()
                         ->GetState()
                         .hex;
-    bool pressed = (pad_state & line.value) == line.value;
+    bool pressed = (pad_state & value) == value;
     if (!pressed) {
         state.if_flag++;
     }
 }
 
 static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Core::System& system,
+                           Memory::MemorySystem& memory,
                            std::span<const GatewayCheat::CheatLine> cheat_lines) {
     if (state.if_flag > 0) {
         // Skip over the additional patch lines
@@ -167,7 +169,7 @@ static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Co
             state.current_line_nr++;
         }
         first = !first;
-        system.Memory().Write32(addr, tmp);
+        memory.Write32(addr, tmp);
         addr += 4;
         num_bytes -= 4;
     }
@@ -175,13 +177,58 @@ static inline void PatchOp(const GatewayCheat::CheatLine& line, State& state, Co
         u32 tmp = (first ? cheat_lines[state.current_line_nr].first
                          : cheat_lines[state.current_line_nr].value) >>
                   bit_offset;
-        system.Memory().Write8(addr, tmp);
+        memory.Write8(addr, tmp);
         addr += 1;
         num_bytes -= 1;
         bit_offset += 8;
     }
 }
 
+/// Number of lines following a patch code that hold the data it copies.
+static inline std::size_t PatchDataLines(u32 num_bytes) {
+    return static_cast<std::size_t>((u64{num_bytes} + 7) / 8);
+}
+
+template <typename T>
+static inline T ReadValue(Memory::MemorySystem& memory, const u8* host_pointer, VAddr addr) {
+    if (host_pointer) {
+        T value;
+        std::memcpy(&value, host_pointer, sizeof(T));
+        return value;
+    }
+    if constexpr (sizeof(T) == sizeof(u8)) {
+        return memory.Read8(addr);
+    } else if constexpr (sizeof(T) == sizeof(u16)) {
+        return memory.Read16(addr);
+    } else {
+        return memory.Read32(addr);
+    }
+}
+
+template <typename T>
+static inline void WriteValue(Memory::MemorySystem& memory, u8* host_pointer, VAddr addr,
+                              T value) {
+    if (host_pointer) {
+        std::memcpy(host_pointer, &value, sizeof(T));
+    } else if constexpr (sizeof(T) == sizeof(u8)) {
+        memory.Write8(addr, value);
+    } else if constexpr (sizeof(T) == sizeof(u16)) {
+        memory.Write16(addr, value);
+    } else {
+        memory.Write32(addr, value);
+    }
+}
+
+/// Writes a value if it differs from the one in memory, invalidating the JIT cache of the range.
+template <typename T>
+static inline void WriteIfChanged(Core::System& system, Memory::MemorySystem& memory,
+                                  u8* host_pointer, VAddr addr, T value) {
+    if (ReadValue<T>(memory, host_pointer, addr) != value) {
+        WriteValue<T>(memory, host_pointer, addr, value);
+        system.InvalidateCacheRange(addr, sizeof(T));
+    }
+}
+
 GatewayCheat::CheatLine::CheatLine(const std::string& line) {
     constexpr std::size_t cheat_length = 17;
     if (line.length() != cheat_length) {
@@ -213,6 +260,7 @@ GatewayCheat::CheatLine::CheatLine(const std::string& line) {
 GatewayCheat::GatewayCheat(std::string name_, std::vector<CheatLine> cheat_lines_,
                            std::string comments_)
     : name(std::move(name_)), cheat_lines(std::move(cheat_lines_)), comments(std::move(comments_)) {
+    Compile();
 }
 
 GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comments_)
@@ -226,14 +274,330 @@ GatewayCheat::GatewayCheat(std::string name_, std::string code, std::string comm
             temp_cheat_lines.emplace_back(line);
     }
     cheat_lines = std::move(temp_cheat_lines);
+    Compile();
 }
 
 GatewayCheat::~GatewayCheat() = default;
 
+void GatewayCheat::Compile() {
+    program.clear();
+    patch_data.clear();
+
+    // The offset is known while it was last set to a constant outside of any conditional block.
+    // Loops jump back to their start until the next full terminator, even from inside skipped
+    // blocks, so the offset is never known in between.
+    std::optional<u32> offset = 0;
+    u32 if_depth = 0;
+    bool in_loop = false;
+    const auto set_offset = [&](std::optional<u32> new_offset) {
+        offset = if_depth == 0 && !in_loop ? new_offset : std::nullopt;
+    };
+    const auto add_offset = [&](u32 value) {
+        set_offset(offset ? std::optional<u32>{*offset + value} : std::nullopt);
+    };
+
+    for (std::size_t i = 0; i < cheat_lines.size(); ++i) {
+        const CheatLine& line = cheat_lines[i];
+        Instruction instruction{
+            .type = line.type,
+            .address = line.address,
+            .value = line.value,
+            .patch_data_index = 0,
+            .access_size = 0,
+            .static_address = false,
+        };
+        const auto access = [&](u32 address, u8 size) {
+            instruction.address = address;
+            if (offset) {
+                instruction.address += *offset;
+                instruction.access_size = size;
+                instruction.static_address = true;
+            }
+        };
+
+        switch (line.type) {
+        case CheatType::Null:
+            continue;
+        case CheatType::Write32:
+            access(line.address, 4);
+            break;
+        case CheatType::Write16:
+            access(line.address, 2);
+            break;
+        case CheatType::Write8:
+            access(line.address, 1);
+            break;
+        case CheatType::GreaterThan32:
+        case CheatType::LessThan32:
+        case CheatType::EqualTo32:
+        case CheatType::NotEqualTo32:
+            access(line.address, 4);
+            ++if_depth;
+            break;
+        case CheatType::GreaterThan16WithMask:
+        case CheatType::LessThan16WithMask:
+        case CheatType::EqualTo16WithMask:
+        case CheatType::NotEqualTo16WithMask:
+            access(line.address, 2);
+            ++if_depth;
+            break;
+        case CheatType::Joker:
+            ++if_depth;
+            break;
+        case CheatType::LoadOffset:
+            access(line.address, 4);
+            offset = std::nullopt;
+            break;
+        case CheatType::Loop:
+            offset = std::nullopt;
+            in_loop = true;
+            break;
+        case CheatType::Terminator:
+            if (if_depth > 0) {
+                --if_depth;
+            }
+            break;
+        case CheatType::LoopExecuteVariant:
+            break;
+        case CheatType::FullTerminator:
+            // Execution only continues past this once the offset was reset.
+            offset = 0;
+            if_depth = 0;
+            in_loop = false;
+            break;
+        case CheatType::SetOffset:
+            set_offset(line.value);
+            break;
+        case CheatType::AddValue:
+        case CheatType::SetValue:
+            break;
+        case CheatType::IncrementiveWrite32:
+            access(line.value, 4);
+            add_offset(4);
+            break;
+        case CheatType::IncrementiveWrite16:
+            access(line.value, 2);
+            add_offset(2);
+            break;
+        case CheatType::IncrementiveWrite8:
+            access(line.value, 1);
+            add_offset(1);
+            break;
+        case CheatType::Load32:
+            access(line.value, 4);
+            break;
+        case CheatType::Load16:
+            access(line.value, 2);
+            break;
+        case CheatType::Load8:
+            access(line.value, 1);
+            break;
+        case CheatType::AddOffset:
+            add_offset(line.value);
+            break;
+        case CheatType::Patch: {
+            // The data lines are skipped whether the patch is executed or not.
+            instruction.patch_data_index = static_cast<u32>(patch_data.size());
+            const std::size_t data_lines =
+                std::min(PatchDataLines(line.value), cheat_lines.size() - i - 1);
+            for (std::size_t j = 0; j < data_lines; ++j) {
+                patch_data.push_back(cheat_lines[++i].first);
+                patch_data.push_back(cheat_lines[i].value);
+            }
+            instruction.value =
+                static_cast<u32>(std::min<u64>(line.value, data_lines * 2 * sizeof(u32)));
+            break;
+        }
+        }
+        program.push_back(instruction);
+    }
+}
+
+void GatewayCheat::ResolveHostPointers(Memory::MemorySystem& memory) const {
+    const auto page_table = memory.GetCurrentPageTable();
+    host_pointers.assign(program.size(), nullptr);
+    for (std::size_t i = 0; i < program.size() && page_table; ++i) {
+        const Instruction& instruction = program[i];
+        const u32 page_offset = instruction.address & Memory::BORKED3DS_PAGE_MASK;
+        // Pages without a pointer are rasterizer cached or unmapped, those accesses and the ones
+        // crossing pages keep going through the memory system.
+        if (!instruction.static_address ||
+            page_offset + instruction.access_size > Memory::BORKED3DS_PAGE_SIZE) {
+            continue;
+        }
+        u8* page_pointer =
+            page_table->GetPointerArray()[instruction.address >> Memory::BORKED3DS_PAGE_BITS];
+        if (page_pointer) {
+            host_pointers[i] = page_pointer + page_offset;
+        }
+    }
+    resolved_memory = &memory;
+    resolved_generation = memory.GetPageTableGeneration();
+}
+
 void GatewayCheat::Execute(Core::System& system) const {
+    Execute(system, system.Memory());
+}
+
+void GatewayCheat::Execute(Core::System& system, Memory::MemorySystem& memory) const {
+    if (resolved_memory != &memory || resolved_generation != memory.GetPageTableGeneration()) {
+        ResolveHostPointers(memory);
+    }
+
+    State state;
+    for (state.current_line_nr = 0; state.current_line_nr < program.size();
+         state.current_line_nr++) {
+        const Instruction& instruction = program[state.current_line_nr];
+        u8* const host_pointer = host_pointers[state.current_line_nr];
+        const u32 value = instruction.value;
+        const VAddr addr =
+            instruction.static_address ? instruction.address : instruction.address + state.offset;
+
+        if (state.if_flag > 0) {
+            switch (instruction.type) {
+            case CheatType::GreaterThan32:
+            case CheatType::LessThan32:
+            case CheatType::EqualTo32:
+            case CheatType::NotEqualTo32:
+            case CheatType::GreaterThan16WithMask:
+            case CheatType::LessThan16WithMask:
+            case CheatType::EqualTo16WithMask:
+            case CheatType::NotEqualTo16WithMask:
+            case CheatType::Joker:
+                state.if_flag++;
+                break;
+            case CheatType::Terminator:
+                TerminateOp(state);
+                break;
+            case CheatType::FullTerminator:
+                FullTerminateOp(state);
+                break;
+            default:
+                break;
+            }
+            continue;
+        }
+
+        const auto compare32 = [&](auto comp) {
+            if (!comp(ReadValue<u32>(memory, host_pointer, addr))) {
+                state.if_flag++;
+            }
+        };
+        const auto compare16 = [&](auto comp) {
+            const u16 mask = static_cast<u16>(~value >> 16);
+            if (!comp(static_cast<u16>(ReadValue<u16>(memory, host_pointer, addr) & mask))) {
+                state.if_flag++;
+            }
+        };
+        const u16 value16 = static_cast<u16>(value);
+
+        switch (instruction.type) {
+        case CheatType::Null:
+            break;
+        case CheatType::Write32:
+            WriteIfChanged<u32>(system, memory, host_pointer, addr, value);
+            break;
+        case CheatType::Write16:
+            WriteIfChanged<u16>(system, memory, host_pointer, addr, static_cast<u16>(value));
+            break;
+        case CheatType::Write8:
+            WriteIfChanged<u8>(system, memory, host_pointer, addr, static_cast<u8>(value));
+            break;
+        case CheatType::GreaterThan32:
+            compare32([value](u32 val) { return value > val; });
+            break;
+        case CheatType::LessThan32:
+            compare32([value](u32 val) { return value < val; });
+            break;
+        case CheatType::EqualTo32:
+            compare32([value](u32 val) { return value == val; });
+            break;
+        case CheatType::NotEqualTo32:
+            compare32([value](u32 val) { return value != val; });
+            break;
+        case CheatType::GreaterThan16WithMask:
+            compare16([value16](u16 val) { return value16 > val; });
+            break;
+        case CheatType::LessThan16WithMask:
+            compare16([value16](u16 val) { return value16 < val; });
+            break;
+        case CheatType::EqualTo16WithMask:
+            compare16([value16](u16 val) { return value16 == val; });
+            break;
+        case CheatType::NotEqualTo16WithMask:
+            compare16([value16](u16 val) { return value16 != val; });
+            break;
+        case CheatType::LoadOffset:
+            state.offset = ReadValue<u32>(memory, host_pointer, addr);
+            break;
+        case CheatType::Loop:
+            LoopOp(value, state);
+            break;
+        case CheatType::Terminator:
+            TerminateOp(state);
+            break;
+        case CheatType::LoopExecuteVariant:
+            LoopExecuteVariantOp(state);
+            break;
+        case CheatType::FullTerminator:
+            FullTerminateOp(state);
+            break;
+        case CheatType::SetOffset:
+            SetOffsetOp(value, state);
+            break;
+        case CheatType::AddValue:
+            AddValueOp(value, state);
+            break;
+        case CheatType::SetValue:
+            SetValueOp(value, state);
+            break;
+        case CheatType::IncrementiveWrite32:
+            WriteIfChanged<u32>(system, memory, host_pointer, addr, state.reg);
+            state.offset += sizeof(u32);
+            break;
+        case CheatType::IncrementiveWrite16:
+            WriteIfChanged<u16>(system, memory, host_pointer, addr, static_cast<u16>(state.reg));
+            state.offset += sizeof(u16);
+            break;
+        case CheatType::IncrementiveWrite8:
+            WriteIfChanged<u8>(system, memory, host_pointer, addr, static_cast<u8>(state.reg));
+            state.offset += sizeof(u8);
+            break;
+        case CheatType::Load32:
+            state.reg = ReadValue<u32>(memory, host_pointer, addr);
+            break;
+        case CheatType::Load16:
+            state.reg = ReadValue<u16>(memory, host_pointer, addr);
+            break;
+        case CheatType::Load8:
+            state.reg = ReadValue<u8>(memory, host_pointer, addr);
+            break;
+        case CheatType::AddOffset:
+            AddOffsetOp(value, state);
+            break;
+        case CheatType::Joker:
+            JokerOp(value, state, system);
+            break;
+        case CheatType::Patch: {
+            system.InvalidateCacheRange(addr, value);
+            const u32* data = patch_data.data() + instruction.patch_data_index;
+            u32 num_bytes = value;
+            VAddr patch_addr = addr;
+            for (; num_bytes >= 4; num_bytes -= 4, patch_addr += 4) {
+                memory.Write32(patch_addr, *data++);
+            }
+            for (u32 shift = 0; num_bytes > 0; --num_bytes, ++patch_addr, shift += 8) {
+                memory.Write8(patch_addr, static_cast<u8>(*data >> shift));
+            }
+            break;
+        }
+        }
+    }
+}
+
+void GatewayCheat::Interpret(Core::System& system, Memory::MemorySystem& memory) const {
     State state;
 
-    Memory::MemorySystem& memory = system.Memory();
     auto Read8 = [&memory](VAddr addr) { return memory.Read8(addr); };
     auto Read16 = [&memory](VAddr addr) { return memory.Read16(addr); };
     auto Read32 = [&memory](VAddr addr) { return memory.Read32(addr); };
@@ -262,7 +626,7 @@ void GatewayCheat::Execute(Core::System& system) const {
                 // EXXXXXXX YYYYYYYY
                 // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
                 // We need to call this here to skip the additional patch lines
-                PatchOp(line, state, system, cheat_lines);
+                PatchOp(line, state, system, memory, cheat_lines);
                 break;
             case CheatType::Terminator:
                 // D0000000 00000000 - ENDIF
@@ -337,12 +701,12 @@ void GatewayCheat::Execute(Core::System& system) const {
             break;
         case CheatType::LoadOffset:
             // BXXXXXXX 00000000 - offset = word[XXXXXXX+offset]
-            LoadOffsetOp(system.Memory(), line, state);
+            LoadOffsetOp(memory, line, state);
             break;
         case CheatType::Loop: {
             // C0000000 YYYYYYYY - LOOP next block YYYYYYYY times
             // TODO(B3N30): Support nested loops if necessary
-            LoopOp(line, state);
+            LoopOp(line.value, state);
             break;
         }
         case CheatType::Terminator: {
@@ -362,17 +726,17 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::SetOffset: {
             // D3000000 XXXXXXXX – Sets the offset to XXXXXXXX
-            SetOffsetOp(line, state);
+            SetOffsetOp(line.value, state);
             break;
         }
         case CheatType::AddValue: {
             // D4000000 XXXXXXXX – reg += XXXXXXXX
-            AddValueOp(line, state);
+            AddValueOp(line.value, state);
             break;
         }
         case CheatType::SetValue: {
             // D5000000 XXXXXXXX – reg = XXXXXXXX
-            SetValueOp(line, state);
+            SetValueOp(line.value, state);
             break;
         }
         case CheatType::IncrementiveWrite32: {
@@ -407,18 +771,18 @@ void GatewayCheat::Execute(Core::System& system) const {
         }
         case CheatType::AddOffset: {
             // DC000000 XXXXXXXX – offset + XXXXXXXX
-            AddOffsetOp(line, state);
+            AddOffsetOp(line.value, state);
             break;
         }
         case CheatType::Joker: {
             // DD000000 XXXXXXXX – if KEYPAD has value XXXXXXXX execute next block
-            JokerOp(line, state, system);
+            JokerOp(line.value, state, system);
             break;
         }
         case CheatType::Patch: {
             // EXXXXXXX YYYYYYYY
             // Copies YYYYYYYY bytes from (current code location + 8) to [XXXXXXXX + offset].
-            PatchOp(line, state, system, cheat_lines);
+            PatchOp(line, state, system, memory, cheat_lines);
             break;
         }
         }
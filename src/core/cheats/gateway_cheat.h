@@ -11,6 +11,10 @@
 #include "common/common_types.h"
 #include "core/cheats/cheat_base.h"
 
+namespace Memory {
+class MemorySystem;
+}
+
 namespace Cheats {
 class GatewayCheat final : public CheatBase {
 public:
@@ -62,6 +66,13 @@ public:
 
     void Execute(Core::System& system) const override;
 
+    /// Runs the compiled cheat against the given memory.
+    void Execute(Core::System& system, Memory::MemorySystem& memory) const;
+
+    /// Runs the cheat by interpreting its lines one by one. This is the reference the compiled
+    /// cheat is tested and benchmarked against.
+    void Interpret(Core::System& system, Memory::MemorySystem& memory) const;
+
     bool IsEnabled() const override;
     void SetEnabled(bool enabled) override;
 
@@ -81,9 +92,40 @@ public:
     static std::vector<std::shared_ptr<CheatBase>> LoadFile(const std::string& filepath);
 
 private:
+    /// A cheat line lowered to the operands needed to execute it.
+    struct Instruction {
+        CheatType type;
+        /// Address operand, already including the offset if `static_address` is set.
+        u32 address;
+        u32 value;
+        /// Index of the first word of a patch in `patch_data`.
+        u32 patch_data_index;
+        /// Size of the memory access, if the instruction accesses a statically known address.
+        u8 access_size;
+        bool static_address;
+    };
+
+    /**
+     * Lowers the cheat lines into instructions. The offset is tracked while it's known at compile
+     * time, so that accesses with a constant address can have their host pointer looked up once.
+     */
+    void Compile();
+
+    /// Looks up the host pointers of the accesses to statically known addresses.
+    void ResolveHostPointers(Memory::MemorySystem& memory) const;
+
     std::atomic<bool> enabled = false;
     const std::string name;
     std::vector<CheatLine> cheat_lines;
     const std::string comments;
+
+    std::vector<Instruction> program;
+    /// The words copied by patch codes, in the order they are written.
+    std::vector<u32> patch_data;
+
+    /// Host pointers of the instructions, null if the access goes through the memory system.
+    mutable std::vector<u8*> host_pointers;
+    mutable const Memory::MemorySystem* resolved_memory = nullptr;
+    mutable u64 resolved_generation = 0;
 };
 } // namespace Cheats
@@ -10,6 +10,7 @@
 #include "audio_core/hle/hle.h"
 #include "audio_core/lle/lle.h"
 #include "common/arch.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "core/arm/arm_interface.h"
@@ -55,6 +56,8 @@
 
 namespace Core {
 
+using namespace Common::Literals;
+
 /*static*/ System System::s_instance;
 
 template <>
@@ -104,6 +107,13 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     u32 param{};
     {
         std::scoped_lock lock{signal_mutex};
+        // Save states are written after their signal was handled, a failed write is reported
+        // like a failed save. Pending signals are handled on the next loop.
+        if (savestate_error) {
+            status_details = std::move(*savestate_error);
+            savestate_error.reset();
+            return ResultStatus::ErrorSavestate;
+        }
         if (current_signal != Signal::None) {
             signal = current_signal;
             param = signal_param;
@@ -144,10 +154,36 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
         frame_limiter.WaitOnce();
         return ResultStatus::Success;
     }
+    case Signal::Rewind: {
+        LOG_INFO(Core, "Begin rewind");
+        try {
+            System::Rewind();
+            LOG_INFO(Core, "Rewind completed");
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error rewinding: {}", e.what());
+            status_details = e.what();
+            return ResultStatus::ErrorSavestate;
+        }
+        frame_limiter.WaitOnce();
+        return ResultStatus::Success;
+    }
     default:
         break;
     }
 
+    if (rewind_buffer) {
+        const s32 frame = gpu->Renderer().GetCurrentFrame();
+        if (frame < rewind_frame) {
+            // The renderer restarts counting frames when a state is loaded.
+            rewind_frame = frame;
+        } else if (frame - rewind_frame >=
+                       static_cast<s32>(Settings::values.rewind_interval.GetValue()) &&
+                   !rewind_buffer->IsEncoding()) {
+            rewind_frame = frame;
+            CaptureRewindState();
+        }
+    }
+
     // All cores should have executed the same amount of ticks. If this is not the case an event was
     // scheduled with a cycles_into_future smaller then the current downcount.
     // So we have to get those cores to the same global time first
@@ -505,6 +541,12 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 
     perf_stats = std::make_unique<PerfStats>(title_id);
 
+    if (Settings::values.enable_rewind && app_loader->SupportsSaveStates()) {
+        rewind_buffer = std::make_unique<RewindBuffer>(
+            Settings::values.rewind_buffer_size.GetValue() * 1_MiB);
+        rewind_frame = 0;
+    }
+
     if (Settings::values.dump_textures) {
         custom_tex_manager->PrepareDumping(title_id);
     }
@@ -754,11 +796,22 @@ void System::Shutdown(bool is_deserializing) {
     // Shutdown emulation session
     is_powered_on = false;
 
+    // Finish writing save states before the game they belong to goes away.
+    if (savestate_worker) {
+        savestate_worker->WaitForRequests();
+    }
+    if (!is_deserializing) {
+        savestate_base.reset();
+        std::scoped_lock lock{signal_mutex};
+        savestate_error.reset();
+    }
+
     gpu.reset();
     if (!is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
         app_loader.reset();
+        rewind_buffer.reset();
     }
     custom_tex_manager.reset();
 #ifdef ENABLE_SCRIPTING
@@ -895,9 +948,13 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
             *m_emu_window, m_secondary_window, *memory_mode.first, *n3ds_hw_caps.first, num_cores);
     }
 
-    // Flush on save, don't flush on load
+    // Flush on save, don't flush on load. Rewind states are taken often, keep the cache for them.
     const bool should_flush = !Archive::is_loading::value;
-    gpu->ClearAll(should_flush);
+    if (should_flush && !serialize_state_regions) {
+        gpu->FlushAll();
+    } else {
+        gpu->ClearAll(should_flush);
+    }
     ar&* timing.get();
     for (u32 i = 0; i < num_cores; i++) {
         ar&* cpu_cores[i].get();
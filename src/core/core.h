@@ -8,16 +8,20 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <boost/optional.hpp>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/arm/arm_interface.h"
 #include "core/cheats/cheats.h"
 #include "core/hle/service/apt/applet_manager.h"
 #include "core/hle/service/plgldr/plgldr.h"
 #include "core/movie.h"
 #include "core/perf_stats.h"
+#include "core/rewind_buffer.h"
+#include "core/savestate.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -132,7 +136,7 @@ public:
     /// Shutdown and then load again
     void Reset();
 
-    enum class Signal : u32 { None, Shutdown, Reset, Save, Load };
+    enum class Signal : u32 { None, Shutdown, Reset, Save, Load, Rewind };
 
     bool SendSignal(Signal signal, u32 param = 0);
 
@@ -346,10 +350,18 @@ public:
                (mic_permission_granted = mic_permission_func());
     }
 
-    void SaveState(u32 slot) const;
+    void SaveState(u32 slot);
 
     void LoadState(u32 slot);
 
+    /// Restores the newest state kept for rewinding
+    void Rewind();
+
+    /// Returns whether serialization includes the memory of MemorySystem::GetStateRegions
+    [[nodiscard]] bool SerializesStateRegions() const {
+        return serialize_state_regions;
+    }
+
     /// Self delete ncch
     bool SetSelfDelete(const std::string& file) {
         if (m_filepath == file) {
@@ -384,6 +396,9 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Adds the current state to the rewind buffer
+    void CaptureRewindState();
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -455,6 +470,8 @@ private:
     std::mutex signal_mutex;
     Signal current_signal;
     u32 signal_param;
+    /// Error of a save state written in the background, reported by the next RunLoop
+    std::optional<std::string> savestate_error;
 
     std::function<bool()> mic_permission_func;
     bool mic_permission_granted = false;
@@ -462,6 +479,18 @@ private:
     boost::optional<Service::APT::DeliverArg> restore_deliver_arg;
     boost::optional<Service::PLGLDR::PLG_LDR::PluginLoaderContext> restore_plugin_context;
 
+    /// Base of incremental save states, only accessed by the save state worker or while it's idle
+    std::optional<SaveStateBase> savestate_base;
+    /// Writes incremental save states in the background
+    std::unique_ptr<Common::ThreadWorker> savestate_worker;
+
+    /// Recent states to rewind to, null when rewinding is disabled
+    std::unique_ptr<RewindBuffer> rewind_buffer;
+    /// Frame of the renderer the last rewind state was captured at
+    s32 rewind_frame = 0;
+    /// False while rewind states are serialized, the rewind buffer stores the memory itself
+    bool serialize_state_regions = true;
+
     friend class boost::serialization::access;
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int file_version);
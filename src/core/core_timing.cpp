@@ -4,9 +4,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <bit>
 #include <random>
 #include <tuple>
+#include <utility>
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "core/core_timing.h"
@@ -62,10 +65,13 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
     return event_type;
 }
 
-void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                           std::uintptr_t user_data, std::size_t core_id, bool thread_safe_mode) {
+std::optional<Timing::EventHandle> Timing::ScheduleEvent(s64 cycles_into_future,
+                                                         const TimingEventType* event_type,
+                                                         std::uintptr_t user_data,
+                                                         std::size_t core_id,
+                                                         bool thread_safe_mode) {
     if (event_queue_locked) {
-        return;
+        return std::nullopt;
     }
 
     ASSERT(event_type != nullptr);
@@ -93,14 +99,17 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            return EventHandle{
+                timer,
+                timer->event_queue.Push(
+                    Event{timeout, timer->event_fifo_id++, user_data, event_type}),
+            };
         } else {
             timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
                                        user_data, event_type});
         }
     }
+    return std::nullopt;
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t user_data) {
@@ -108,32 +117,24 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
         return;
     }
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Remove(event_type, user_data);
     }
     // TODO:remove events from ts_queue
 }
 
+void Timing::UnscheduleEvent(const EventHandle& handle) {
+    if (event_queue_locked) {
+        return;
+    }
+    handle.timer->event_queue.Remove(handle.handle);
+}
+
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->event_queue.Remove(event_type);
     }
     // TODO:remove events from ts_queue
 }
@@ -162,7 +163,7 @@ std::shared_ptr<Timing::Timer> Timing::GetTimer(std::size_t cpu_id) {
     return timers[cpu_id];
 }
 
-Timing::Timer::Timer(s64 base_ticks) : executed_ticks(base_ticks) {}
+Timing::Timer::Timer(s64 base_ticks) : event_queue(base_ticks), executed_ticks(base_ticks) {}
 
 Timing::Timer::~Timer() {
     MoveEvents();
@@ -198,16 +199,15 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 void Timing::Timer::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Push(ev);
     }
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        ASSERT(next_event->time - executed_ticks > 0);
-        return next_event->time - executed_ticks;
+    if (!event_queue.Empty()) {
+        const s64 next_time = event_queue.NextTime();
+        ASSERT(next_time - executed_ticks > 0);
+        return next_time - executed_ticks;
     }
     return MAX_SLICE_LENGTH;
 }
@@ -224,16 +224,14 @@ void Timing::Timer::Advance() {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
-        if (evt.type->callback != nullptr) {
-            evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
+    while (const auto evt = event_queue.PopDue(executed_ticks)) {
+        if (evt->type->callback != nullptr) {
+            evt->type->callback(evt->user_data, static_cast<int>(executed_ticks - evt->time));
         } else {
-            LOG_ERROR(Core, "Event '{}' has no callback", *evt.type->name);
+            LOG_ERROR(Core, "Event '{}' has no callback", *evt->type->name);
         }
     }
+    event_queue.AdvanceTo(executed_ticks);
 
     is_timer_sane = false;
 }
@@ -242,9 +240,9 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_queue.Empty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(event_queue.NextTime() - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length >> downcount_hack;
@@ -259,4 +257,233 @@ s64 Timing::Timer::GetDowncount() const {
     return downcount;
 }
 
+std::size_t Timing::EventQueue::MatchKeyHash::operator()(const MatchKey& key) const noexcept {
+    return static_cast<std::size_t>(
+        Common::HashCombine(reinterpret_cast<std::uintptr_t>(key.type), key.user_data));
+}
+
+Timing::EventQueue::EventQueue(s64 time) : wheel_time{time} {}
+
+Timing::EventQueue::Handle Timing::EventQueue::Push(const Event& event) {
+    Node* node = free_nodes;
+    if (node != nullptr) {
+        free_nodes = node->next;
+    } else {
+        node = &node_storage.emplace_back();
+    }
+    node->event = event;
+
+    const auto [it, inserted] = matches.try_emplace(MatchKey{event.type, event.user_data}, node);
+    node->prev_match = nullptr;
+    node->next_match = inserted ? nullptr : it->second;
+    if (!inserted) {
+        it->second->prev_match = node;
+        it->second = node;
+    }
+
+    ++size;
+    Place(node);
+    if (next_time_valid && event.time < next_time) {
+        next_time = event.time;
+    }
+    return Handle{node, event.fifo_order};
+}
+
+s64 Timing::EventQueue::NextTime() const {
+    if (overdue.head != nullptr) {
+        return overdue.head->event.time;
+    }
+    if (next_time_valid) {
+        return next_time;
+    }
+
+    // Every slot of a level is later than all the slots of the levels below it.
+    const auto level_it = std::find_if(occupied.begin(), occupied.end(),
+                                       [](u64 bits) { return bits != 0; });
+    ASSERT_MSG(level_it != occupied.end(), "Event queue is empty");
+    const std::size_t level = level_it - occupied.begin();
+    const std::size_t slot = std::countr_zero(*level_it);
+    if (level == 0) {
+        // All the events in a slot of the first level are at the same time
+        const u64 base = static_cast<u64>(wheel_time) & ~u64{SLOTS_PER_LEVEL - 1};
+        next_time = static_cast<s64>(base | slot);
+    } else {
+        next_time = std::numeric_limits<s64>::max();
+        for (const Node* node = slots[level][slot].head; node != nullptr; node = node->next) {
+            next_time = std::min(next_time, node->event.time);
+        }
+    }
+    next_time_valid = true;
+    return next_time;
+}
+
+std::optional<Timing::Event> Timing::EventQueue::PopDue(s64 time) {
+    if (Empty()) {
+        return std::nullopt;
+    }
+    const s64 due_time = NextTime();
+    if (due_time > time) {
+        return std::nullopt;
+    }
+
+    Node* node = overdue.head;
+    if (node == nullptr) {
+        AdvanceTo(due_time);
+        node = slots[0][static_cast<u64>(due_time) & (SLOTS_PER_LEVEL - 1)].head;
+    }
+    const Event event = node->event;
+    Erase(node);
+    return event;
+}
+
+void Timing::EventQueue::AdvanceTo(s64 time) {
+    if (time <= wheel_time) {
+        return;
+    }
+    const u64 diff = static_cast<u64>(time) ^ static_cast<u64>(wheel_time);
+    wheel_time = time;
+
+    // Only the slot of the highest level that changed can hold events that need to move down, the
+    // slots it contains were emptied on the way there.
+    const std::size_t level = (std::bit_width(diff) - 1) / LEVEL_BITS;
+    if (level == 0) {
+        return;
+    }
+    const std::size_t slot =
+        (static_cast<u64>(time) >> (level * LEVEL_BITS)) & (SLOTS_PER_LEVEL - 1);
+    const NodeList list = std::exchange(slots[level][slot], {});
+    occupied[level] &= ~(u64{1} << slot);
+    for (Node* node = list.head; node != nullptr;) {
+        Node* const next = node->next;
+        Place(node);
+        node = next;
+    }
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* type, std::uintptr_t user_data) {
+    const auto it = matches.find(MatchKey{type, user_data});
+    if (it == matches.end()) {
+        return;
+    }
+    for (Node* node = it->second; node != nullptr;) {
+        Node* const next = node->next_match;
+        Release(node);
+        node = next;
+    }
+    matches.erase(it);
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* type) {
+    std::erase_if(matches, [this, type](const auto& match) {
+        if (match.first.type != type) {
+            return false;
+        }
+        for (Node* node = match.second; node != nullptr;) {
+            Node* const next = node->next_match;
+            Release(node);
+            node = next;
+        }
+        return true;
+    });
+}
+
+void Timing::EventQueue::Remove(const Handle& handle) {
+    // Nodes are reused, the FIFO order tells whether it still holds the same event
+    if (handle.node->level != FREE_LEVEL && handle.node->event.fifo_order == handle.fifo_order) {
+        Erase(handle.node);
+    }
+}
+
+std::vector<Timing::Event> Timing::EventQueue::GetEvents() const {
+    std::vector<Event> events;
+    events.reserve(size);
+    for (const auto& [key, head] : matches) {
+        for (const Node* node = head; node != nullptr; node = node->next_match) {
+            events.push_back(node->event);
+        }
+    }
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+void Timing::EventQueue::Reset(s64 time) {
+    wheel_time = time;
+    size = 0;
+    occupied = {};
+    slots = {};
+    overdue = {};
+    matches.clear();
+    next_time_valid = false;
+    node_storage.clear();
+    free_nodes = nullptr;
+}
+
+void Timing::EventQueue::Place(Node* node) {
+    if (node->event.time < wheel_time) {
+        PushOverdue(node);
+        return;
+    }
+    const u64 time = static_cast<u64>(node->event.time);
+    const u64 diff = time ^ static_cast<u64>(wheel_time);
+    const std::size_t level = diff == 0 ? 0 : (std::bit_width(diff) - 1) / LEVEL_BITS;
+    const std::size_t slot = (time >> (level * LEVEL_BITS)) & (SLOTS_PER_LEVEL - 1);
+    node->level = static_cast<u8>(level);
+    node->slot = static_cast<u8>(slot);
+
+    NodeList& list = slots[level][slot];
+    node->prev = list.tail;
+    node->next = nullptr;
+    if (list.tail != nullptr) {
+        list.tail->next = node;
+    } else {
+        list.head = node;
+    }
+    list.tail = node;
+    occupied[level] |= u64{1} << slot;
+}
+
+void Timing::EventQueue::PushOverdue(Node* node) {
+    // Only events scheduled into the past end up here, so this is rare and short.
+    Node* prev = overdue.tail;
+    while (prev != nullptr && node->event < prev->event) {
+        prev = prev->prev;
+    }
+    node->level = OVERDUE_LEVEL;
+    node->prev = prev;
+    node->next = prev != nullptr ? prev->next : overdue.head;
+    (prev != nullptr ? prev->next : overdue.head) = node;
+    (node->next != nullptr ? node->next->prev : overdue.tail) = node;
+}
+
+void Timing::EventQueue::Release(Node* node) {
+    NodeList& list = node->level == OVERDUE_LEVEL ? overdue : slots[node->level][node->slot];
+    (node->prev != nullptr ? node->prev->next : list.head) = node->next;
+    (node->next != nullptr ? node->next->prev : list.tail) = node->prev;
+    if (list.head == nullptr && node->level != OVERDUE_LEVEL) {
+        occupied[node->level] &= ~(u64{1} << node->slot);
+    }
+    if (next_time_valid && node->event.time == next_time) {
+        next_time_valid = false;
+    }
+
+    --size;
+    node->level = FREE_LEVEL;
+    node->next = free_nodes;
+    free_nodes = node;
+}
+
+void Timing::EventQueue::Erase(Node* node) {
+    if (node->prev_match != nullptr) {
+        node->prev_match->next_match = node->next_match;
+    } else if (node->next_match != nullptr) {
+        matches.find(MatchKey{node->event.type, node->event.user_data})->second = node->next_match;
+    } else {
+        matches.erase(MatchKey{node->event.type, node->event.user_data});
+    }
+    if (node->next_match != nullptr) {
+        node->next_match->prev_match = node->prev_match;
+    }
+    Release(node);
+}
+
 } // namespace Core
@@ -18,9 +18,12 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <array>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <limits>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -176,6 +179,119 @@ public:
         BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
+    /**
+     * Hierarchical timing wheel holding the pending events of a timer, ordered by time and then by
+     * the order they were scheduled in. Level 0 has a slot for each of the next 64 cycles and each
+     * further level covers 64 times the range of the previous one. The events of a slot move down
+     * to the lower levels when the wheel reaches it, so scheduling, cancelling and firing an event
+     * take constant time no matter how many events are pending.
+     */
+    class EventQueue {
+        struct Node;
+
+    public:
+        /**
+         * Refers to a pushed event, so that it can be removed without looking it up. Removing an
+         * event through a handle after it was popped or removed does nothing.
+         */
+        struct Handle {
+            Node* node;
+            u64 fifo_order;
+        };
+
+        explicit EventQueue(s64 time = 0);
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        bool Empty() const {
+            return size == 0;
+        }
+
+        Handle Push(const Event& event);
+
+        /// Returns the time of the earliest event. The queue must not be empty.
+        s64 NextTime() const;
+
+        /// Removes and returns the earliest event if it is due at the given time.
+        std::optional<Event> PopDue(s64 time);
+
+        /// Moves the wheel forward to the given time, all events before it must have been popped.
+        void AdvanceTo(s64 time);
+
+        /// Removes the events of the given type with the given user data.
+        void Remove(const TimingEventType* type, std::uintptr_t user_data);
+
+        /// Removes the events of the given type.
+        void Remove(const TimingEventType* type);
+
+        /// Removes the event the handle refers to, if it is still queued.
+        void Remove(const Handle& handle);
+
+        /// Returns all the events in the order they are going to fire.
+        std::vector<Event> GetEvents() const;
+
+        /// Removes all events, invalidating their handles, and moves the wheel to the given time.
+        void Reset(s64 time);
+
+    private:
+        static constexpr std::size_t LEVEL_BITS = 6;
+        static constexpr std::size_t SLOTS_PER_LEVEL = 1 << LEVEL_BITS;
+        static constexpr std::size_t NUM_LEVELS = (64 + LEVEL_BITS - 1) / LEVEL_BITS;
+        /// Level of the events that were scheduled before the current time of the wheel
+        static constexpr u8 OVERDUE_LEVEL = NUM_LEVELS;
+        /// Level of the nodes that don't hold an event
+        static constexpr u8 FREE_LEVEL = NUM_LEVELS + 1;
+
+        struct Node {
+            Event event;
+            Node* prev;
+            Node* next;
+            // Events with the same type and user data, for UnscheduleEvent
+            Node* prev_match;
+            Node* next_match;
+            u8 level;
+            u8 slot;
+        };
+
+        struct NodeList {
+            Node* head = nullptr;
+            Node* tail = nullptr;
+        };
+
+        struct MatchKey {
+            const TimingEventType* type;
+            std::uintptr_t user_data;
+
+            bool operator==(const MatchKey&) const = default;
+        };
+
+        struct MatchKeyHash {
+            std::size_t operator()(const MatchKey& key) const noexcept;
+        };
+
+        void Place(Node* node);
+        void PushOverdue(Node* node);
+        /// Frees an event, leaving the list of events with the same type and user data as is.
+        void Release(Node* node);
+        void Erase(Node* node);
+
+        s64 wheel_time;
+        std::size_t size = 0;
+        std::array<u64, NUM_LEVELS> occupied{};
+        std::array<std::array<NodeList, SLOTS_PER_LEVEL>, NUM_LEVELS> slots{};
+        /// Events scheduled before the current time of the wheel, sorted.
+        NodeList overdue;
+        std::unordered_map<MatchKey, Node*, MatchKeyHash> matches;
+
+        /// Earliest event time, computed lazily when the earliest slot holds several times.
+        mutable s64 next_time = 0;
+        mutable bool next_time_valid = false;
+
+        std::deque<Node> node_storage;
+        Node* free_nodes = nullptr;
+    };
+
     // currently Service::HID::pad_update_ticks is the smallest interval for an event that gets
     // always scheduled. Therfore we use this as orientation for the MAX_SLICE_LENGTH
     // For performance bigger slice length are desired, though this will lead to cores desync
@@ -184,6 +300,14 @@ public:
     // scheduled and repated.
     static constexpr int MAX_SLICE_LENGTH = BASE_CLOCK_RATE_ARM11 / 234;
 
+    class Timer;
+
+    /// Refers to a scheduled event, so that it can be unscheduled in constant time.
+    struct EventHandle {
+        Timer* timer;
+        EventQueue::Handle handle;
+    };
+
     class Timer {
     public:
         Timer(s64 base_ticks = 0);
@@ -214,11 +338,7 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+        EventQueue event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
@@ -245,12 +365,23 @@ public:
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
-            ar & event_queue;
+            // The events are stored as a sorted vector, as the heap they used to be kept in was.
+            std::vector<Event> events;
+            if (Archive::is_saving::value) {
+                events = event_queue.GetEvents();
+            }
+            ar & events;
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
             ar & executed_ticks;
             ar & idled_cycles;
+            if (Archive::is_loading::value) {
+                event_queue.Reset(executed_ticks);
+                for (const Event& event : events) {
+                    event_queue.Push(event);
+                }
+            }
         }
         friend class boost::serialization::access;
     };
@@ -266,13 +397,18 @@ public:
 
     // Make sure to use thread_safe_mode = true if called from a different thread than the
     // emulator thread, such as coroutines.
-    void ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                       std::uintptr_t user_data = 0,
-                       std::size_t core_id = std::numeric_limits<std::size_t>::max(),
-                       bool thread_safe_mode = false);
+    // Returns a handle to the event, or std::nullopt if it was passed to the timer through its
+    // thread safe queue, where it can't be unscheduled from.
+    std::optional<EventHandle> ScheduleEvent(
+        s64 cycles_into_future, const TimingEventType* event_type, std::uintptr_t user_data = 0,
+        std::size_t core_id = std::numeric_limits<std::size_t>::max(),
+        bool thread_safe_mode = false);
 
     void UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t user_data);
 
+    /// Unschedules the event the handle refers to, if it didn't fire yet.
+    void UnscheduleEvent(const EventHandle& handle);
+
     /// We only permit one event of each type in the queue at a time.
     void RemoveEvent(const TimingEventType* event_type);
 
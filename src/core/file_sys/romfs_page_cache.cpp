@@ -0,0 +1,105 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include "common/assert.h"
+#include "core/file_sys/romfs_page_cache.h"
+
+namespace FileSys {
+
+RomFSPageCache::RomFSPageCache(std::size_t capacity) {
+    for (auto& shard : shards) {
+        shard.num_slots = SlotsPerShard(capacity);
+    }
+}
+
+RomFSPageCache::~RomFSPageCache() = default;
+
+std::size_t RomFSPageCache::SlotsPerShard(std::size_t capacity) {
+    return std::max<std::size_t>(capacity / PAGE_SIZE / NUM_SHARDS, 1);
+}
+
+std::optional<std::size_t> RomFSPageCache::Read(u64 file, std::size_t page, std::size_t offset,
+                                                std::size_t length, u8* out) {
+    const Key key{file, page};
+    auto& shard = ShardOf(key);
+    std::shared_lock lock{shard.mutex};
+    const auto it = shard.slot_of_page.find(key);
+    if (it == shard.slot_of_page.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+
+    Slot& slot = shard.slots[it->second];
+    slot.referenced.store(true, std::memory_order_relaxed);
+    const std::size_t copy_amount = offset < slot.size ? std::min(length, slot.size - offset) : 0;
+    std::memcpy(out, slot.data.data() + offset, copy_amount);
+    return copy_amount;
+}
+
+bool RomFSPageCache::Contains(u64 file, std::size_t page) const {
+    const Key key{file, page};
+    const auto& shard = ShardOf(key);
+    std::shared_lock lock{shard.mutex};
+    return shard.slot_of_page.contains(key);
+}
+
+void RomFSPageCache::Insert(u64 file, std::size_t page, std::span<const u8> data) {
+    ASSERT(data.size() <= PAGE_SIZE);
+    const Key key{file, page};
+    auto& shard = ShardOf(key);
+    std::unique_lock lock{shard.mutex};
+    if (shard.slot_of_page.contains(key)) {
+        // Another thread read the same page in the meantime.
+        return;
+    }
+
+    std::size_t index;
+    if (shard.slots.size() < shard.num_slots) {
+        index = shard.slots.size();
+        shard.slots.emplace_back();
+    } else {
+        // Pages that were read since the hand last passed them get a second chance.
+        index = shard.clock_hand;
+        while (shard.slots[index].referenced.exchange(false, std::memory_order_relaxed)) {
+            index = (index + 1) % shard.num_slots;
+        }
+        shard.slot_of_page.erase(shard.slots[index].key);
+        shard.clock_hand = (index + 1) % shard.num_slots;
+    }
+
+    Slot& slot = shard.slots[index];
+    slot.key = key;
+    slot.size = data.size();
+    slot.referenced.store(false, std::memory_order_relaxed);
+    std::memcpy(slot.data.data(), data.data(), data.size());
+    shard.slot_of_page.emplace(key, index);
+}
+
+void RomFSPageCache::SetCapacity(std::size_t capacity) {
+    const std::size_t slots_per_shard = SlotsPerShard(capacity);
+    for (auto& shard : shards) {
+        std::unique_lock lock{shard.mutex};
+        shard.num_slots = slots_per_shard;
+        while (shard.slots.size() > slots_per_shard) {
+            shard.slot_of_page.erase(shard.slots.back().key);
+            shard.slots.pop_back();
+        }
+        if (shard.clock_hand >= slots_per_shard) {
+            shard.clock_hand = 0;
+        }
+    }
+}
+
+RomFSPageCache::Stats RomFSPageCache::GetStats() const {
+    return {
+        .hits = hits.load(std::memory_order_relaxed),
+        .misses = misses.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace FileSys
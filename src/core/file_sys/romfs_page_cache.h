@@ -0,0 +1,112 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * Thread safe cache of fixed size pages of files, pages are identified by a key of their file and
+ * their offset. Pages are spread over shards that are locked independently, lookups only take a
+ * shared lock so concurrent readers don't block each other. Pages are evicted with the CLOCK
+ * algorithm, which approximates LRU without having to reorder entries on every hit. The memory of
+ * the pages is only allocated once they are used.
+ */
+class RomFSPageCache {
+public:
+    static constexpr std::size_t PAGE_SIZE = 1 << 13;
+
+    struct Stats {
+        u64 hits;
+        u64 misses;
+    };
+
+    /// @param capacity the number of bytes of pages to keep, at least one page per shard is kept.
+    explicit RomFSPageCache(std::size_t capacity);
+    ~RomFSPageCache();
+
+    /**
+     * Copies data from a cached page.
+     * @param file key of the file the page belongs to.
+     * @param page offset of the page, aligned to PAGE_SIZE.
+     * @param offset offset of the data inside the page.
+     * @param length number of bytes to copy.
+     * @param out buffer the data is copied to.
+     * @return the number of bytes copied, which is less than length if the page is the short last
+     *         page of the file, or std::nullopt if the page isn't cached.
+     */
+    std::optional<std::size_t> Read(u64 file, std::size_t page, std::size_t offset,
+                                    std::size_t length, u8* out);
+
+    /// Returns whether a page is cached, without counting it as a hit or miss.
+    bool Contains(u64 file, std::size_t page) const;
+
+    /// Adds a page to the cache, data may be shorter than PAGE_SIZE for the last page of a file.
+    void Insert(u64 file, std::size_t page, std::span<const u8> data);
+
+    /// Changes the number of bytes of pages to keep, pages above the new capacity are dropped.
+    void SetCapacity(std::size_t capacity);
+
+    Stats GetStats() const;
+
+private:
+    static constexpr std::size_t NUM_SHARDS = 8;
+
+    struct Key {
+        u64 file;
+        std::size_t page;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept {
+            return static_cast<std::size_t>(key.file ^ (key.page * 0x9E3779B97F4A7C15ULL));
+        }
+    };
+
+    struct Slot {
+        // User provided so that new slots don't zero their data.
+        Slot() {}
+
+        Key key{};
+        std::size_t size = 0;
+        std::atomic<bool> referenced{};
+        std::array<u8, PAGE_SIZE> data;
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, std::size_t, KeyHash> slot_of_page;
+        std::deque<Slot> slots; ///< Grows up to num_slots as pages are inserted
+        std::size_t num_slots = 0;
+        std::size_t clock_hand = 0;
+    };
+
+    static std::size_t SlotsPerShard(std::size_t capacity);
+
+    // Consecutive pages of a file are spread over the shards.
+    Shard& ShardOf(const Key& key) {
+        return shards[(key.file + key.page / PAGE_SIZE) % NUM_SHARDS];
+    }
+
+    const Shard& ShardOf(const Key& key) const {
+        return shards[(key.file + key.page / PAGE_SIZE) % NUM_SHARDS];
+    }
+
+    std::array<Shard, NUM_SHARDS> shards;
+    std::atomic<u64> hits{};
+    std::atomic<u64> misses{};
+};
+
+} // namespace FileSys
@@ -1,9 +1,14 @@
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <cryptopp/aes.h>
 #include <cryptopp/modes.h>
 #include "common/archives.h"
+#include "common/hash.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/file_sys/archive_artic.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/romfs_reader.h"
@@ -14,58 +19,125 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+using namespace Common::Literals;
+
+namespace {
+
+/// Games open their RomFS again for every archive, so all readers share one cache and read ahead
+/// on one thread instead of each having their own.
+struct SharedRomFSCache {
+    RomFSPageCache cache{0};
+    Common::ThreadWorker prefetch_worker{1, "RomFSPrefetch"};
+};
+
+SharedRomFSCache& GetSharedCache() {
+    static SharedRomFSCache shared;
+    return shared;
+}
+
+} // Anonymous namespace
+
+DirectRomFSReader::~DirectRomFSReader() {
+    auto& shared = GetSharedCache();
+    // The queued read-ahead uses this reader.
+    if (prefetch_pending) {
+        shared.prefetch_worker.WaitForRequests();
+    }
+    const auto stats = shared.cache.GetStats();
+    LOG_DEBUG(Service_FS, "RomFS cache: hits={}, misses={}", stats.hits, stats.misses);
+}
+
+void DirectRomFSReader::OpenCache() {
+    const std::string& path = file.GetPath();
+    cache_key = Common::HashCombine(Common::ComputeHash64(path.data(), path.size()), file_offset);
+    if (is_encrypted) {
+        cache_key = Common::HashCombine(cache_key, Common::ComputeHash64(key.data(), key.size()));
+        cache_key = Common::HashCombine(cache_key, Common::ComputeHash64(ctr.data(), ctr.size()));
+        cache_key = Common::HashCombine(cache_key, crypto_offset);
+    }
+    GetSharedCache().cache.SetCapacity(Settings::values.romfs_cache_size.GetValue() * 1_MiB);
+}
+
+std::size_t DirectRomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
+    length = file.ReadAtBytes(buffer, length, file_offset + offset);
+    if (is_encrypted && length) {
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
+        d.Seek(crypto_offset + offset);
+        d.ProcessData(buffer, buffer, length);
+    }
+    return length;
+}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
 
     const auto segments = BreakupRead(offset, length);
+    auto& cache = GetSharedCache().cache;
     std::size_t read_progress = 0;
 
     // Skip cache if the read is too big
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
-        length = file.ReadAtBytes(buffer, length, file_offset + offset);
-        if (is_encrypted) {
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-            d.Seek(crypto_offset + offset);
-            d.ProcessData(buffer, buffer, length);
-        }
+        length = ReadUncached(offset, length, buffer);
         LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
         return length;
     }
 
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
     for (const auto& seg : segments) {
-        std::size_t read_size = cache_line_size;
-        std::size_t page = OffsetToPage(seg.first);
+        const std::size_t page = OffsetToPage(seg.first);
+        const std::size_t into = seg.first - page;
         // Check if segment is in cache
-        auto cache_entry = cache.request(page);
-        if (!cache_entry.first) {
+        auto copy_amount = cache.Read(cache_key, page, into, seg.second, buffer + read_progress);
+        if (!copy_amount) {
             // If not found, read from disk and cache the data
-            read_size = file.ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
-            if (is_encrypted && read_size) {
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-                d.Seek(crypto_offset + page);
-                d.ProcessData(cache_entry.second.data(), cache_entry.second.data(), read_size);
-            }
+            std::array<u8, cache_line_size> data;
+            const std::size_t read_size = ReadUncached(page, data.size(), data.data());
+            cache.Insert(cache_key, page, std::span{data}.first(read_size));
+            copy_amount = read_size > into ? std::min(seg.second, read_size - into) : 0;
+            std::memcpy(buffer + read_progress, data.data() + into, *copy_amount);
             LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
+                      into);
         } else {
             LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
+                      into);
         }
-        std::size_t copy_amount =
-            (read_size > (seg.first - page))
-                ? std::min((seg.first - page) + seg.second, read_size) - (seg.first - page)
-                : 0;
-        std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
-                    copy_amount);
-        read_progress += copy_amount;
+        read_progress += *copy_amount;
+    }
+
+    // Games streaming data read files in small consecutive chunks, load the following pages
+    // before they are requested.
+    if (sequential_read_end.exchange(offset + length) == offset) {
+        Prefetch(offset + length);
     }
     return read_progress;
 }
 
+void DirectRomFSReader::Prefetch(std::size_t offset) {
+    if (prefetch_pending.exchange(true)) {
+        return;
+    }
+    GetSharedCache().prefetch_worker.QueueWork([this, offset] {
+        auto& cache = GetSharedCache().cache;
+        // Read the missing pages with a single read and decryption.
+        std::size_t first_page = OffsetToPage(offset);
+        const std::size_t end_page = std::min<std::size_t>(
+            first_page + prefetch_page_count * cache_line_size, data_size);
+        while (first_page < end_page && cache.Contains(cache_key, first_page)) {
+            first_page += cache_line_size;
+        }
+        if (first_page < end_page) {
+            std::vector<u8> data(end_page - first_page);
+            const std::size_t read_size = ReadUncached(first_page, data.size(), data.data());
+            for (std::size_t pos = 0; pos < read_size; pos += cache_line_size) {
+                const std::size_t page_size = std::min(cache_line_size, read_size - pos);
+                cache.Insert(cache_key, first_page + pos, std::span{data}.subspan(pos, page_size));
+            }
+        }
+        prefetch_pending = false;
+    });
+}
+
 bool DirectRomFSReader::AllowsCachedReads() const {
     return true;
 }
@@ -74,21 +146,12 @@ bool DirectRomFSReader::CacheReady(std::size_t file_offset, std::size_t length)
     auto segments = BreakupRead(file_offset, length);
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         return false;
-    } else {
-        // TODO(PabloMK7): Since the LRU cache is not thread safe, a lock must be used.
-        // However, this completely breaks the point of using a cache, because
-        // smaller reads may be blocked by bigger reads. For now, always return
-        // data being in cache to prevent the need of a lock, and only read data
-        // asynchronously if it is too big to use the cache.
-        /*
-        std::shared_lock<std::shared_mutex> read_guard(cache_mutex);
-        for (auto it = segments.begin(); it != segments.end(); it++) {
-            if (!cache.contains(OffsetToPage(it->first)))
-                return false;
-        }
-        */
-        return true;
     }
+    // Reads of pages that aren't cached yet are done asynchronously, the cache is thread safe.
+    const auto& cache = GetSharedCache().cache;
+    return std::all_of(segments.begin(), segments.end(), [this, &cache](const auto& seg) {
+        return cache.Contains(cache_key, OffsetToPage(seg.first));
+    });
 }
 
 std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
@@ -1,15 +1,15 @@
 #pragma once
 
 #include <array>
-#include <shared_mutex>
+#include <atomic>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "common/static_lru_cache.h"
 #include "core/file_sys/artic_cache.h"
+#include "core/file_sys/romfs_page_cache.h"
 #include "network/artic_base/artic_base_client.h"
 
 namespace Loader {
@@ -43,15 +43,19 @@ class DirectRomFSReader : public RomFSReader {
 public:
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
         : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+          data_size(data_size) {
+        OpenCache();
+    }
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
                       std::size_t crypto_offset)
         : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+          crypto_offset(crypto_offset), data_size(data_size) {
+        OpenCache();
+    }
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -72,16 +76,21 @@ private:
     u64 crypto_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
-    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    static constexpr std::size_t cache_line_size = RomFSPageCache::PAGE_SIZE;
+    // Number of pages read ahead of sequential reads
+    static constexpr std::size_t prefetch_page_count = 8;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::shared_mutex cache_mutex;
+    /// Identifies the data in the page cache shared by all readers, readers of the same data
+    /// share its pages.
+    u64 cache_key{};
+    std::atomic<std::size_t> sequential_read_end{};
+    std::atomic<bool> prefetch_pending{};
 
     DirectRomFSReader() = default;
 
+    /// Computes the cache key and applies the configured cache size.
+    void OpenCache();
+
     std::size_t OffsetToPage(std::size_t offset) {
         return Common::AlignDown<std::size_t>(offset, cache_line_size);
     }
@@ -89,6 +98,12 @@ private:
     std::vector<std::pair<std::size_t, std::size_t>> BreakupRead(std::size_t offset,
                                                                  std::size_t length);
 
+    /// Reads and decrypts data from the file, bypassing the cache.
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+
+    /// Fills the cache with the pages following a sequential read in the background.
+    void Prefetch(std::size_t offset);
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
         ar& boost::serialization::base_object<RomFSReader>(*this);
@@ -99,6 +114,9 @@ private:
         ar & file_offset;
         ar & crypto_offset;
         ar & data_size;
+        if (Archive::is_loading::value) {
+            OpenCache();
+        }
     }
     friend class boost::serialization::access;
 };
@@ -24,61 +24,85 @@ SERIALIZE_EXPORT_IMPL(Kernel::AddressArbiter::Callback)
 namespace Kernel {
 
 void AddressArbiter::WaitThread(std::shared_ptr<Thread> thread, VAddr wait_address) {
+    SortLoadedThreads();
     thread->wait_address = wait_address;
+    thread->waiting_arbiter = this;
     thread->status = ThreadStatus::WaitArb;
-    waiting_threads.emplace_back(std::move(thread));
+    waiting_threads[wait_address].Insert(std::move(thread));
 }
 
 u64 AddressArbiter::ResumeAllThreads(VAddr address) {
-    // Determine which threads are waiting on this address, those should be woken up.
-    auto itr = std::stable_partition(waiting_threads.begin(), waiting_threads.end(),
-                                     [address](const auto& thread) {
-                                         ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                                                    "Inconsistent AddressArbiter state");
-                                         return thread->wait_address != address;
-                                     });
-
-    // Wake up all the found threads
-    const u64 num_threads = std::distance(itr, waiting_threads.end());
-    std::for_each(itr, waiting_threads.end(), [](auto& thread) { thread->ResumeFromWait(); });
-
-    // Remove the woken up threads from the wait list.
-    waiting_threads.erase(itr, waiting_threads.end());
-    return num_threads;
+    SortLoadedThreads();
+    const auto list = waiting_threads.find(address);
+    if (list == waiting_threads.end()) {
+        return 0;
+    }
+
+    // Wake up all the threads waiting on this address, in the order they started waiting.
+    const auto threads = list->second.GetThreadsInWaitOrder();
+    waiting_threads.erase(list);
+    for (const auto& thread : threads) {
+        ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+        thread->waiting_arbiter = nullptr;
+        thread->ResumeFromWait();
+    }
+    return threads.size();
 }
 
 bool AddressArbiter::ResumeHighestPriorityThread(VAddr address) {
-    // Determine which threads are waiting on this address, those should be considered for wakeup.
-    auto matches_start = std::stable_partition(
-        waiting_threads.begin(), waiting_threads.end(), [address](const auto& thread) {
-            ASSERT_MSG(thread->status == ThreadStatus::WaitArb,
-                       "Inconsistent AddressArbiter state");
-            return thread->wait_address != address;
-        });
-
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated.
-    // Note: The real kernel will pick the first thread in the list if more than one have the
-    // same highest priority value. Lower priority values mean higher priority.
-    auto itr = std::min_element(matches_start, waiting_threads.end(),
-                                [](const auto& lhs, const auto& rhs) {
-                                    return lhs->current_priority < rhs->current_priority;
-                                });
-
-    if (itr == waiting_threads.end()) {
+    SortLoadedThreads();
+    const auto list = waiting_threads.find(address);
+    if (list == waiting_threads.end()) {
         return false;
     }
 
-    auto thread = *itr;
+    // Note: The real kernel will pick the first thread in the list if more than one have the
+    // same highest priority value. Lower priority values mean higher priority. The waiting list
+    // is kept in that order, so its front is the thread to wake up.
+    auto thread = list->second.PopFront();
+    if (list->second.empty()) {
+        waiting_threads.erase(list);
+    }
+
+    ASSERT_MSG(thread->status == ThreadStatus::WaitArb, "Inconsistent AddressArbiter state");
+    thread->waiting_arbiter = nullptr;
     thread->ResumeFromWait();
-    waiting_threads.erase(itr);
 
     return true;
 }
 
+void AddressArbiter::UpdateWaitingThreadPriority(const Thread* thread) {
+    SortLoadedThreads();
+    const auto list = waiting_threads.find(thread->wait_address);
+    if (list != waiting_threads.end()) {
+        list->second.Reorder(thread);
+    }
+}
+
+void AddressArbiter::SortLoadedThreads() {
+    if (loaded_threads.empty()) {
+        return;
+    }
+    // Savestates store the threads of all addresses in one list, the threads of each address in
+    // the order they started waiting.
+    for (auto& thread : loaded_threads) {
+        waiting_threads[thread->wait_address].Insert(std::move(thread));
+    }
+    loaded_threads.clear();
+}
+
 AddressArbiter::AddressArbiter(KernelSystem& kernel)
     : Object(kernel), kernel(kernel), timeout_callback(std::make_shared<Callback>(*this)) {}
 
 AddressArbiter::~AddressArbiter() {
+    for (auto& [address, list] : waiting_threads) {
+        for (const auto& thread : list.GetThreads()) {
+            thread->waiting_arbiter = nullptr;
+        }
+    }
+    for (const auto& thread : loaded_threads) {
+        thread->waiting_arbiter = nullptr;
+    }
     if (resource_limit) {
         resource_limit->Release(ResourceLimitType::AddressArbiter, 1);
     }
@@ -112,8 +136,14 @@ void AddressArbiter::WakeUp(ThreadWakeupReason reason, std::shared_ptr<Thread> t
                             std::shared_ptr<WaitObject> object) {
     ASSERT(reason == ThreadWakeupReason::Timeout);
     // Remove the newly-awakened thread from the Arbiter's waiting list.
-    waiting_threads.erase(std::remove(waiting_threads.begin(), waiting_threads.end(), thread),
-                          waiting_threads.end());
+    SortLoadedThreads();
+    const auto list = waiting_threads.find(thread->wait_address);
+    if (list != waiting_threads.end() && list->second.Remove(thread.get())) {
+        thread->waiting_arbiter = nullptr;
+        if (list->second.empty()) {
+            waiting_threads.erase(list);
+        }
+    }
 };
 
 Result AddressArbiter::ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type,
@@ -195,7 +225,23 @@ template <class Archive>
 void AddressArbiter::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Object>(*this);
     ar & name;
-    ar & waiting_threads;
+    // The waiting threads of all addresses are stored in one list
+    std::vector<std::shared_ptr<Thread>> threads;
+    if (Archive::is_saving::value) {
+        SortLoadedThreads();
+        for (const auto& [address, list] : waiting_threads) {
+            const auto list_threads = list.GetThreadsInWaitOrder();
+            threads.insert(threads.end(), list_threads.begin(), list_threads.end());
+        }
+    }
+    ar & threads;
+    if (Archive::is_loading::value) {
+        waiting_threads.clear();
+        for (const auto& thread : threads) {
+            thread->waiting_arbiter = this;
+        }
+        loaded_threads = std::move(threads);
+    }
     ar & timeout_callback;
     ar & resource_limit;
 }
@@ -6,11 +6,13 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <boost/serialization/export.hpp>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/wait_list.h"
 #include "core/hle/result.h"
 
 // Address arbiters are an underlying kernel synchronization object that can be created/used via
@@ -54,6 +56,9 @@ public:
     Result ArbitrateAddress(std::shared_ptr<Thread> thread, ArbitrationType type, VAddr address,
                             s32 value, u64 nanoseconds);
 
+    /// Moves a waiting thread to its place in the waiting list after its priority changed.
+    void UpdateWaitingThreadPriority(const Thread* thread);
+
     class Callback;
 
 private:
@@ -69,8 +74,15 @@ private:
     /// the resumed thread.
     bool ResumeHighestPriorityThread(VAddr address);
 
-    /// Threads waiting for the address arbiter to be signaled.
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Moves threads loaded from a savestate to the waiting list of their address.
+    void SortLoadedThreads();
+
+    /// Threads waiting for the address arbiter to be signaled, by arbitration address.
+    std::unordered_map<VAddr, WaitList> waiting_threads;
+
+    /// Threads loaded from a savestate, which are only sorted into waiting_threads once they are
+    /// completely loaded.
+    std::vector<std::shared_ptr<Thread>> loaded_threads;
 
     std::shared_ptr<Callback> timeout_callback;
 
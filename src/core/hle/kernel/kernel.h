@@ -168,6 +168,14 @@ public:
 
     std::shared_ptr<Process> CreateProcess(std::shared_ptr<CodeSet> code_set);
 
+    /**
+     * Keeps the page table of an exited process, so that a new process running the same code can
+     * reuse it along with the code the JITs translated for it.
+     * @param code_set Code set of the exited process.
+     * @param page_table Page table of the exited process.
+     */
+    void RetirePageTable(const CodeSet& code_set, std::shared_ptr<Memory::PageTable> page_table);
+
     /**
      * Terminates a process, killing its threads and removing it from the process list.
      * @param process Process to terminate.
@@ -350,18 +358,34 @@ public:
 private:
     void MemoryInit(MemoryMode memory_mode, New3dsMemoryMode n3ds_mode, u64 override_init_time);
 
+    /// Takes a retired page table that ran the same code as the code set, or returns nullptr.
+    std::shared_ptr<Memory::PageTable> TakeRetiredPageTable(const CodeSet& code_set);
+
     std::function<void()> prepare_reschedule_callback;
 
     std::unique_ptr<ResourceLimitList> resource_limits;
     std::atomic<u32> next_object_id{0};
 
+    struct RetiredPageTable {
+        u64 program_id;
+        VAddr code_addr;
+        u64 code_hash;
+        std::shared_ptr<Memory::PageTable> page_table;
+    };
+
     // Note: keep the member order below in order to perform correct destruction.
     // Thread manager is destructed before process list in order to Stop threads and clear thread
     // info from their parent processes first. Timer manager is destructed after process list
     // because timers are destructed along with process list and they need to clear info from the
-    // timer manager.
+    // timer manager. Retired page tables are destructed after process list because processes
+    // retire their page tables when they are destructed.
     // TODO (wwylele): refactor the cleanup sequence to make this less complicated and sensitive.
 
+    // Page tables of exited processes, oldest first.
+    std::vector<RetiredPageTable> retired_page_tables;
+    u64 page_table_reuse_hits = 0;
+    u64 page_table_reuse_misses = 0;
+
     std::unique_ptr<TimerManager> timer_manager;
 
     // TODO(Subv): Start the process ids from 10 for now, as lower PIDs are
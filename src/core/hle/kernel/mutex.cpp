@@ -3,6 +3,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/string.hpp>
@@ -120,9 +121,8 @@ void Mutex::UpdatePriority() {
         return;
 
     u32 best_priority = ThreadPrioLowest;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
+    if (const auto waiter = GetHighestPriorityWaitingThread()) {
+        best_priority = std::min(best_priority, waiter->current_priority);
     }
 
     if (best_priority != priority) {
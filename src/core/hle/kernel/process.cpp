@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -14,6 +15,7 @@
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_funcs.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/serialization/boost_vector.hpp"
 #include "core/core.h"
@@ -110,10 +112,107 @@ std::shared_ptr<Process> KernelSystem::CreateProcess(std::shared_ptr<CodeSet> co
     process->process_id = ++next_process_id;
     process->creation_time_ticks = timing.GetTicks();
 
+    // Reuse the page table of an exited process that ran the same code, so that the JITs keep the
+    // code they translated for it. Nothing is mapped until the process runs.
+    if (auto page_table = TakeRetiredPageTable(*process->codeset)) {
+        memory.UnregisterPageTable(process->vm_manager.page_table);
+        process->vm_manager.page_table = std::move(page_table);
+        process->vm_manager.Reset();
+        memory.RegisterPageTable(process->vm_manager.page_table);
+    }
+
     process_list.push_back(process);
     return process;
 }
 
+namespace {
+
+/// Maximum number of retired page tables. Each of them keeps about 40 MiB of page table and the
+/// JIT instances bound to it alive.
+constexpr std::size_t MAX_RETIRED_PAGE_TABLES = 2;
+
+u64 HashCodeSegment(const CodeSet& code_set) {
+    const auto& code = code_set.CodeSegment();
+    if (code.offset + code.size > code_set.memory.size()) {
+        return 0;
+    }
+    return Common::ComputeHash64(code_set.memory.data() + code.offset, code.size);
+}
+
+/**
+ * Whether the code segment mapped by the page table still holds the code of the load image. Code
+ * can be patched at runtime by the application, the debugger or cheats, and the JIT code
+ * translated from patched code must not be reused for processes that load the original image.
+ */
+bool IsCodeUnmodified(const CodeSet& code_set, Memory::PageTable& page_table) {
+    const auto& code = code_set.CodeSegment();
+    if (code.offset + code.size > code_set.memory.size()) {
+        return false;
+    }
+    const u8* const image = code_set.memory.data() + code.offset;
+    const auto& pointers = page_table.GetPointerArray();
+    for (u32 offset = 0; offset < code.size;) {
+        const VAddr addr = code.addr + offset;
+        const u32 page_offset = addr & Memory::BORKED3DS_PAGE_MASK;
+        const u32 size = std::min(Memory::BORKED3DS_PAGE_SIZE - page_offset, code.size - offset);
+        const u8* const page = pointers[addr >> Memory::BORKED3DS_PAGE_BITS];
+        if (!page || std::memcmp(page + page_offset, image + offset, size) != 0) {
+            return false;
+        }
+        offset += size;
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+void KernelSystem::RetirePageTable(const CodeSet& code_set,
+                                   std::shared_ptr<Memory::PageTable> page_table) {
+    const VAddr code_addr = code_set.CodeSegment().addr;
+    const u64 code_hash = HashCodeSegment(code_set);
+    std::erase_if(retired_page_tables, [&](const RetiredPageTable& retired) {
+        return retired.program_id == code_set.program_id && retired.code_addr == code_addr &&
+               retired.code_hash == code_hash;
+    });
+    if (retired_page_tables.size() >= MAX_RETIRED_PAGE_TABLES) {
+        retired_page_tables.erase(retired_page_tables.begin());
+    }
+
+    // Release the memory the process had mapped
+    page_table->Clear();
+    retired_page_tables.push_back({
+        .program_id = code_set.program_id,
+        .code_addr = code_addr,
+        .code_hash = code_hash,
+        .page_table = std::move(page_table),
+    });
+}
+
+std::shared_ptr<Memory::PageTable> KernelSystem::TakeRetiredPageTable(const CodeSet& code_set) {
+    const auto& code = code_set.CodeSegment();
+    const u64 code_hash = HashCodeSegment(code_set);
+    const auto it = std::find_if(
+        retired_page_tables.begin(), retired_page_tables.end(), [&](const auto& retired) {
+            return retired.program_id == code_set.program_id && retired.code_addr == code.addr &&
+                   retired.code_hash == code_hash;
+        });
+    if (it == retired_page_tables.end()) {
+        ++page_table_reuse_misses;
+        return nullptr;
+    }
+
+    auto page_table = std::move(it->page_table);
+    retired_page_tables.erase(it);
+    ++page_table_reuse_hits;
+    LOG_INFO(Kernel, "Reusing the page table and JIT code of {} ({} hits, {} misses)",
+             code_set.GetName(), page_table_reuse_hits, page_table_reuse_misses);
+
+    ++page_table->reuse_count;
+    page_table->reused_code_start = code.addr;
+    page_table->reused_code_size = code.size;
+    return page_table;
+}
+
 void KernelSystem::TerminateProcess(std::shared_ptr<Process> process) {
     LOG_INFO(Kernel_SVC, "Process {} exiting", process->process_id);
 
@@ -640,8 +739,14 @@ Kernel::Process::~Process() {
     // memory etc.) even if they are still referenced by other processes.
     handle_table.Clear();
 
+    // The page table is only reused for the same image if the code that ran is that image
+    const bool code_unmodified = codeset && IsCodeUnmodified(*codeset, *vm_manager.page_table);
+
     FreeAllMemory();
     kernel.memory.UnregisterPageTable(vm_manager.page_table);
+    if (code_unmodified) {
+        kernel.RetirePageTable(*codeset, vm_manager.page_table);
+    }
 }
 
 std::shared_ptr<Process> KernelSystem::GetProcessById(u32 process_id) const {
@@ -18,6 +18,7 @@
 #include "core/arm/arm_interface.h"
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/core.h"
+#include "core/hle/kernel/address_arbiter.h"
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
@@ -61,6 +62,11 @@ void Thread::serialize(Archive& ar, const unsigned int file_version) {
     ar & wait_address;
     ar & name;
     ar & wakeup_callback;
+    if (Archive::is_loading::value) {
+        // Wakeup event handles aren't saved, the event queue is rebuilt when loading
+        wakeup_event.reset();
+        wakeup_event_untracked = true;
+    }
 }
 SERIALIZE_IMPL(Thread)
 
@@ -87,7 +93,7 @@ Thread* ThreadManager::GetCurrentThread() const {
 
 void Thread::Stop() {
     // Cancel any outstanding wakeup events for this thread
-    thread_manager.kernel.timing.UnscheduleEvent(thread_manager.ThreadWakeupEventType, thread_id);
+    CancelWakeup();
     thread_manager.wakeup_callback_table.erase(thread_id);
 
     // Clean up thread from ready queue
@@ -123,8 +129,6 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
     Thread* previous_thread = GetCurrentThread();
     std::shared_ptr<Process> previous_process = nullptr;
 
-    Core::Timing& timing = kernel.timing;
-
     // Save context for previous thread
     if (previous_thread) {
         previous_process = previous_thread->owner_process.lock();
@@ -145,7 +149,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
                    "Thread must be ready to become running.");
 
         // Cancel any outstanding wakeup events for this thread
-        timing.UnscheduleEvent(ThreadWakeupEventType, new_thread->thread_id);
+        new_thread->CancelWakeup();
 
         current_thread = SharedFrom(new_thread);
 
@@ -170,36 +174,17 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
 }
 
 Thread* ThreadManager::PopNextReadyThread() {
-    Thread* next = nullptr;
     Thread* thread = GetCurrentThread();
+    const auto can_schedule = [](const Thread* next) { return next->can_schedule; };
 
     if (thread && thread->status == ThreadStatus::Running) {
-        do {
-            // We have to do better than the current thread.
-            // This call returns null when that's not possible.
-            next = ready_queue.pop_first_better(thread->current_priority);
-            if (!next) {
-                // Otherwise just keep going with the current thread
-                next = thread;
-                break;
-            } else if (!next->can_schedule)
-                unscheduled_ready_queue.push_back(next);
-        } while (!next->can_schedule);
-    } else {
-        do {
-            next = ready_queue.pop_first();
-            if (next && !next->can_schedule)
-                unscheduled_ready_queue.push_back(next);
-        } while (next && !next->can_schedule);
-    }
-
-    while (!unscheduled_ready_queue.empty()) {
-        auto t = std::move(unscheduled_ready_queue.back());
-        ready_queue.push_back(t->current_priority, t);
-        unscheduled_ready_queue.pop_back();
+        // We have to do better than the current thread.
+        // This call returns null when that's not possible.
+        Thread* next = ready_queue.pop_first_better(thread->current_priority, can_schedule);
+        // Otherwise just keep going with the current thread
+        return next ? next : thread;
     }
-
-    return next;
+    return ready_queue.pop_first(can_schedule);
 }
 
 void ThreadManager::WaitCurrentThread_Sleep() {
@@ -244,6 +229,7 @@ void ThreadManager::ThreadWakeupCallback(u64 thread_id, s64 cycles_late) {
         LOG_CRITICAL(Kernel, "Callback fired for invalid thread {:08X}", thread_id);
         return;
     }
+    thread->wakeup_event.reset();
 
     if (thread->status == ThreadStatus::WaitSynchAny ||
         thread->status == ThreadStatus::WaitSynchAll || thread->status == ThreadStatus::WaitArb ||
@@ -273,9 +259,27 @@ void Thread::WakeAfterDelay(s64 nanoseconds, bool thread_safe_mode) {
         nanoseconds &= 0xFFFFFFFF;
     }
 
-    thread_manager.kernel.timing.ScheduleEvent(nsToCycles(nanoseconds),
-                                               thread_manager.ThreadWakeupEventType, thread_id,
-                                               core, thread_safe_mode);
+    const auto event = thread_manager.kernel.timing.ScheduleEvent(
+        nsToCycles(nanoseconds), thread_manager.ThreadWakeupEventType, thread_id, core,
+        thread_safe_mode);
+    if (event && !wakeup_event && !wakeup_event_untracked) {
+        wakeup_event = event;
+    } else {
+        // Cancel all the wakeups of the thread by looking them up
+        wakeup_event.reset();
+        wakeup_event_untracked = true;
+    }
+}
+
+void Thread::CancelWakeup() {
+    auto& timing = thread_manager.kernel.timing;
+    if (wakeup_event_untracked) {
+        timing.UnscheduleEvent(thread_manager.ThreadWakeupEventType, thread_id);
+        wakeup_event_untracked = false;
+    } else if (wakeup_event) {
+        timing.UnscheduleEvent(*wakeup_event);
+    }
+    wakeup_event.reset();
 }
 
 void Thread::ResumeFromWait() {
@@ -374,7 +378,6 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(
     auto thread = std::make_shared<Thread>(*this, processor_id);
 
     thread_managers[processor_id]->thread_list.push_back(thread);
-    thread_managers[processor_id]->ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = ThreadStatus::Dormant;
@@ -409,10 +412,9 @@ void Thread::SetPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
+    UpdateWaitingPriority();
 }
 
 void Thread::UpdatePriority() {
@@ -428,9 +430,18 @@ void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
         thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
     current_priority = priority;
+    UpdateWaitingPriority();
+}
+
+void Thread::UpdateWaitingPriority() {
+    // Waiting threads are woken up in priority order, so their place in the lists depends on it
+    for (auto& object : wait_objects) {
+        object->UpdateWaitingThreadPriority(this);
+    }
+    if (status == ThreadStatus::WaitArb && waiting_arbiter) {
+        waiting_arbiter->UpdateWaitingThreadPriority(this);
+    }
 }
 
 std::shared_ptr<Thread> SetupMainThread(KernelSystem& kernel, u32 entry_point, u32 priority,
@@ -22,6 +22,7 @@
 
 namespace Kernel {
 
+class AddressArbiter;
 class Mutex;
 class Process;
 
@@ -150,8 +151,7 @@ private:
     Core::ARM_Interface* cpu;
 
     std::shared_ptr<Thread> current_thread;
-    Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
-    std::deque<Thread*> unscheduled_ready_queue;
+    Common::ThreadQueueList<Thread, ThreadPrioLowest + 1> ready_queue;
     std::unordered_map<u64, Thread*> wakeup_callback_table;
 
     /// Event type for the thread wake up event
@@ -168,7 +168,7 @@ private:
     void serialize(Archive& ar, const unsigned int);
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public Common::ThreadQueueListHook<Thread> {
 public:
     explicit Thread(KernelSystem&, u32 core_id);
     ~Thread() override;
@@ -235,6 +235,11 @@ public:
      */
     void WakeAfterDelay(s64 nanoseconds, bool thread_safe_mode = false);
 
+    /**
+     * Cancels the pending wakeup event of the thread, if any
+     */
+    void CancelWakeup();
+
     /**
      * Sets the result after the thread awakens (from either WaitSynchronization SVC)
      * @param result Value to set to the returned result
@@ -317,6 +322,9 @@ public:
     std::vector<std::shared_ptr<WaitObject>> wait_objects{};
 
     VAddr wait_address; ///< If waiting on an AddressArbiter, this is the arbitration address
+    /// If waiting on an AddressArbiter, this is the arbiter. Not serialized, the arbiter sets it
+    /// again when it's loaded.
+    AddressArbiter* waiting_arbiter = nullptr;
 
     std::string name{};
 
@@ -328,8 +336,19 @@ public:
     const u32 core_id;
 
 private:
+    /// Moves the thread to its new place in the waiting lists it's in after a priority change.
+    void UpdateWaitingPriority();
+
     ThreadManager& thread_manager;
 
+    /// Handle of the pending wakeup event, used to cancel it without looking it up.
+    std::optional<Core::Timing::EventHandle> wakeup_event{};
+    /// Set when a wakeup may be pending without a handle, because it was scheduled from another
+    /// host thread, or before the savestate the thread was loaded from was made. It is then
+    /// cancelled by looking it up.
+    bool wakeup_event_untracked{false};
+
+    friend class ThreadManager;
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
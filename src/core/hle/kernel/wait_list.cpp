@@ -0,0 +1,129 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <utility>
+#include "common/assert.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hle/kernel/wait_list.h"
+
+namespace Kernel {
+
+namespace {
+
+/// Lower priority values mean higher priority, ties are broken by the order of waiting.
+bool WakesUpBefore(const Thread* thread, u64 order, const Thread* other, u64 other_order) {
+    if (thread->current_priority != other->current_priority) {
+        return thread->current_priority < other->current_priority;
+    }
+    return order < other_order;
+}
+
+} // Anonymous namespace
+
+bool WaitList::Contains(const Thread* thread) const {
+    return std::any_of(entries.begin(), entries.end(),
+                       [thread](const Entry& entry) { return entry.thread.get() == thread; });
+}
+
+void WaitList::Insert(std::shared_ptr<Thread> thread) {
+    Sort();
+    const u32 priority = thread->current_priority;
+    const auto itr =
+        std::partition_point(entries.begin(), entries.end(), [priority](const Entry& entry) {
+            return entry.thread->current_priority <= priority;
+        });
+    entries.insert(itr, Entry{std::move(thread), next_order++});
+}
+
+bool WaitList::Remove(const Thread* thread) {
+    const auto itr = std::find_if(entries.begin(), entries.end(), [thread](const Entry& entry) {
+        return entry.thread.get() == thread;
+    });
+    if (itr == entries.end()) {
+        return false;
+    }
+    entries.erase(itr);
+    return true;
+}
+
+std::shared_ptr<Thread> WaitList::PopFront() {
+    ASSERT(!entries.empty());
+    Sort();
+    auto thread = std::move(entries.front().thread);
+    entries.erase(entries.begin());
+    return thread;
+}
+
+void WaitList::Reorder(const Thread* thread) {
+    Sort();
+    const auto itr = std::find_if(entries.begin(), entries.end(), [thread](const Entry& entry) {
+        return entry.thread.get() == thread;
+    });
+    if (itr == entries.end()) {
+        return;
+    }
+
+    // Rotate the entry towards the front or the back until it's in order again
+    const u64 order = itr->order;
+    const auto before = [&](const Entry& entry) {
+        return WakesUpBefore(entry.thread.get(), entry.order, thread, order);
+    };
+    const auto front_end = std::partition_point(entries.begin(), itr, before);
+    if (front_end != itr) {
+        std::rotate(front_end, itr, itr + 1);
+        return;
+    }
+    const auto back_end = std::partition_point(itr + 1, entries.end(), before);
+    std::rotate(itr, itr + 1, back_end);
+}
+
+std::vector<std::shared_ptr<Thread>> WaitList::GetThreads() const {
+    Sort();
+    std::vector<std::shared_ptr<Thread>> threads;
+    threads.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        threads.push_back(entry.thread);
+    }
+    return threads;
+}
+
+std::vector<std::shared_ptr<Thread>> WaitList::GetThreadsInWaitOrder() const {
+    std::vector<const Entry*> ordered;
+    ordered.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        ordered.push_back(&entry);
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const Entry* lhs, const Entry* rhs) { return lhs->order < rhs->order; });
+
+    std::vector<std::shared_ptr<Thread>> threads;
+    threads.reserve(ordered.size());
+    for (const Entry* entry : ordered) {
+        threads.push_back(entry->thread);
+    }
+    return threads;
+}
+
+void WaitList::Load(std::vector<std::shared_ptr<Thread>> threads) {
+    entries.clear();
+    entries.reserve(threads.size());
+    for (auto& thread : threads) {
+        entries.push_back(Entry{std::move(thread), entries.size()});
+    }
+    next_order = entries.size();
+    sorted = false;
+}
+
+void WaitList::Sort() const {
+    if (sorted) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return WakesUpBefore(lhs.thread.get(), lhs.order, rhs.thread.get(), rhs.order);
+    });
+    sorted = true;
+}
+
+} // namespace Kernel
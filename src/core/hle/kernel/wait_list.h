@@ -0,0 +1,81 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+class Thread;
+
+/**
+ * Threads waiting on a kernel object, in the order the kernel wakes them up: by priority, and
+ * threads of the same priority in the order they started waiting. When the priority of a thread
+ * changes while it's waiting, Reorder has to be called to move it to its new place.
+ */
+class WaitList {
+public:
+    [[nodiscard]] bool empty() const {
+        return entries.empty();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return entries.size();
+    }
+
+    [[nodiscard]] bool Contains(const Thread* thread) const;
+
+    /// Adds the thread behind the waiting threads of a higher or the same priority.
+    void Insert(std::shared_ptr<Thread> thread);
+
+    /// Removes the thread from the list, returns false if it wasn't in it.
+    bool Remove(const Thread* thread);
+
+    /// Removes and returns the thread that is woken up first, the list must not be empty.
+    std::shared_ptr<Thread> PopFront();
+
+    /// Moves the thread to the place for its current priority, if it's in the list.
+    void Reorder(const Thread* thread);
+
+    /// Returns the first thread in wakeup order for which pred returns true, or nullptr.
+    template <typename Pred>
+    [[nodiscard]] std::shared_ptr<Thread> FindFirst(Pred&& pred) const {
+        Sort();
+        for (const Entry& entry : entries) {
+            if (pred(entry.thread)) {
+                return entry.thread;
+            }
+        }
+        return nullptr;
+    }
+
+    /// Returns the threads in wakeup order.
+    [[nodiscard]] std::vector<std::shared_ptr<Thread>> GetThreads() const;
+
+    /// Returns the threads in the order they started waiting, which is how savestates store them.
+    [[nodiscard]] std::vector<std::shared_ptr<Thread>> GetThreadsInWaitOrder() const;
+
+    /**
+     * Replaces the list with threads loaded from a savestate, in the order they started waiting.
+     * The threads may not be completely loaded yet, so they are only sorted on the next use.
+     */
+    void Load(std::vector<std::shared_ptr<Thread>> threads);
+
+private:
+    struct Entry {
+        std::shared_ptr<Thread> thread;
+        u64 order; ///< Position in the order the threads started waiting
+    };
+
+    void Sort() const;
+
+    mutable std::vector<Entry> entries;
+    mutable bool sorted = true;
+    u64 next_order = 0;
+};
+
+} // namespace Kernel
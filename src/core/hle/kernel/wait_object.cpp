@@ -26,62 +26,58 @@ namespace Kernel {
 template <class Archive>
 void WaitObject::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Object>(*this);
-    ar & waiting_threads;
+    // The waiting threads are stored in the order they started waiting
+    std::vector<std::shared_ptr<Thread>> threads;
+    if (Archive::is_saving::value) {
+        threads = waiting_threads.GetThreadsInWaitOrder();
+    }
+    ar & threads;
+    if (Archive::is_loading::value) {
+        waiting_threads.Load(std::move(threads));
+    }
     // NB: hle_notifier *not* serialized since it's a callback!
     // Fortunately it's only used in one place (DSP) so we can reconstruct it there
 }
 SERIALIZE_IMPL(WaitObject)
 
 void WaitObject::AddWaitingThread(std::shared_ptr<Thread> thread) {
-    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
-    if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+    if (!waiting_threads.Contains(thread.get()))
+        waiting_threads.Insert(std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
-    auto itr = std::find_if(waiting_threads.begin(), waiting_threads.end(),
-                            [thread](const auto& p) { return p.get() == thread; });
     // If a thread passed multiple handles to the same object,
     // the kernel might attempt to remove the thread from the object's
     // waiting threads list multiple times.
-    if (itr != waiting_threads.end())
-        waiting_threads.erase(itr);
+    waiting_threads.Remove(thread);
 }
 
 std::shared_ptr<Thread> WaitObject::GetHighestPriorityReadyThread() const {
-    Thread* candidate = nullptr;
-    u32 candidate_priority = ThreadPrioLowest + 1;
-
-    for (const auto& thread : waiting_threads) {
+    // The waiting list is ordered by priority, and the real kernel picks the thread that started
+    // waiting first among the ones with the same priority, so the first ready thread is woken up.
+    return waiting_threads.FindFirst([this](const std::shared_ptr<Thread>& thread) {
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == ThreadStatus::WaitSynchAny ||
                        thread->status == ThreadStatus::WaitSynchAll ||
                        thread->status == ThreadStatus::WaitHleEvent,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
-            continue;
+            return false;
 
         // A thread is ready to run if it's either in ThreadStatus::WaitSynchAny or
         // in ThreadStatus::WaitSynchAll and the rest of the objects it is waiting on are ready.
-        bool ready_to_run = true;
-        if (thread->status == ThreadStatus::WaitSynchAll) {
-            ready_to_run = std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
-                                        [&thread](const std::shared_ptr<WaitObject>& object) {
-                                            return object->ShouldWait(thread.get());
-                                        });
-        }
-
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
-        }
-    }
+        if (thread->status != ThreadStatus::WaitSynchAll)
+            return true;
+        return std::none_of(thread->wait_objects.begin(), thread->wait_objects.end(),
+                            [&thread](const std::shared_ptr<WaitObject>& object) {
+                                return object->ShouldWait(thread.get());
+                            });
+    });
+}
 
-    return SharedFrom(candidate);
+std::shared_ptr<Thread> WaitObject::GetHighestPriorityWaitingThread() const {
+    return waiting_threads.FindFirst([](const std::shared_ptr<Thread>&) { return true; });
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
@@ -109,8 +105,12 @@ void WaitObject::WakeupAllWaitingThreads() {
         hle_notifier();
 }
 
-const std::vector<std::shared_ptr<Thread>>& WaitObject::GetWaitingThreads() const {
-    return waiting_threads;
+std::vector<std::shared_ptr<Thread>> WaitObject::GetWaitingThreads() const {
+    return waiting_threads.GetThreads();
+}
+
+void WaitObject::UpdateWaitingThreadPriority(const Thread* thread) {
+    waiting_threads.Reorder(thread);
 }
 
 void WaitObject::SetHLENotifier(std::function<void()> callback) {
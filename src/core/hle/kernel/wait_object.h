@@ -10,6 +10,7 @@
 #include <vector>
 #include "common/common_types.h"
 #include "core/hle/kernel/object.h"
+#include "core/hle/kernel/wait_list.h"
 
 namespace Kernel {
 
@@ -51,15 +52,24 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     std::shared_ptr<Thread> GetHighestPriorityReadyThread() const;
 
-    /// Get a const reference to the waiting threads list for debug use
-    const std::vector<std::shared_ptr<Thread>>& GetWaitingThreads() const;
+    /// Obtains the highest priority thread waiting on this object, ready or not.
+    std::shared_ptr<Thread> GetHighestPriorityWaitingThread() const;
+
+    /// Get the waiting threads, in the order they are woken up, for debug use
+    std::vector<std::shared_ptr<Thread>> GetWaitingThreads() const;
+
+    /**
+     * Moves a waiting thread to its place in the waiting list after its priority changed
+     * @param thread Pointer to the thread whose priority changed
+     */
+    void UpdateWaitingThreadPriority(const Thread* thread);
 
     /// Sets a callback which is called when the object becomes available
     void SetHLENotifier(std::function<void()> callback);
 
 private:
-    /// Threads waiting for this object to become available
-    std::vector<std::shared_ptr<Thread>> waiting_threads;
+    /// Threads waiting for this object to become available, in the order they are woken up
+    WaitList waiting_threads;
 
     /// Function to call when this object becomes available
     std::function<void()> hle_notifier;
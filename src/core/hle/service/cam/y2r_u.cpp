@@ -3,8 +3,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstring>
+#include <thread>
 #include "common/archives.h"
 #include "common/common_funcs.h"
 #include "common/logging/log.h"
@@ -522,7 +524,7 @@ void Y2R_U::StartConversion(Kernel::HLERequestContext& ctx) {
     system.Memory().RasterizerFlushVirtualRegion(conversion.dst.address, total_output_size,
                                                  Memory::FlushMode::FlushAndInvalidate);
 
-    HW::Y2R::PerformConversion(system.Memory(), conversion);
+    HW::Y2R::PerformConversion(system.Memory(), conversion, &conversion_workers);
 
     if (is_busy_conversion) {
         system.CoreTiming().RemoveEvent(completion_signal_event);
@@ -664,7 +666,9 @@ void Y2R_U::GetPackageParameter(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Service_Y2R, "called");
 }
 
-Y2R_U::Y2R_U(Core::System& system) : ServiceFramework("y2r:u", 1), system(system) {
+Y2R_U::Y2R_U(Core::System& system)
+    : ServiceFramework("y2r:u", 1), system(system),
+      conversion_workers{std::max(std::thread::hardware_concurrency(), 2U) >> 1, "Y2R"} {
     static const FunctionInfo functions[] = {
         // clang-format off
         {0x0001, &Y2R_U::SetInputFormat, "SetInputFormat"},
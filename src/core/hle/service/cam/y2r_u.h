@@ -10,6 +10,7 @@
 #include <string>
 #include <boost/serialization/array.hpp>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "core/hle/result.h"
 #include "core/hle/service/service.h"
 
@@ -357,6 +358,7 @@ private:
     bool transfer_end_interrupt_enabled = false;
     bool spacial_dithering_enabled = false;
     bool is_busy_conversion = false;
+    Common::ThreadWorker conversion_workers;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int);
@@ -6,11 +6,13 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <memory>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/profiling.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 #include "core/core.h"
 #include "core/hle/service/cam/y2r_u.h"
@@ -25,11 +27,290 @@ static const std::size_t MAX_TILES = 1024 / 8;
 static const std::size_t TILE_SIZE = 8 * 8;
 using ImageTile = std::array<u32, TILE_SIZE>;
 
-/// Converts a image strip from the source YUV format into individual 8x8 RGB32 tiles.
+/// Conversions of at least this many pixels are split across the worker threads.
+static const std::size_t PARALLEL_CONVERSION_THRESHOLD = 64 * 1024;
+/// Minimum number of image strips converted by a single worker.
+static const std::size_t MIN_STRIPS_PER_TASK = 4;
+
+static const s32 ROUNDING_OFFSET = 0x18;
+
+constexpr std::size_t BytesPerPixel(OutputFormat output_format) {
+    switch (output_format) {
+    case OutputFormat::RGBA8:
+        return 4;
+    case OutputFormat::RGB8:
+        return 3;
+    case OutputFormat::RGB5A1:
+    case OutputFormat::RGB565:
+        return 2;
+    }
+    return 0;
+}
+
+#if defined(HAVE_SSE4_1) || defined(HAVE_NEON)
+#define HAVE_Y2R_SIMD
+#endif
+
+#if defined(HAVE_SSE4_1)
+
+using PixelVec = __m128i;
+
+/// Conversion coefficients splatted to every lane. The offsets include the rounding offset.
+struct VectorCoefficients {
+    explicit VectorCoefficients(const CoefficientSet& c) {
+        for (std::size_t i = 0; i < 5; ++i) {
+            coef[i] = _mm_set1_epi32(c[i]);
+        }
+        for (std::size_t i = 5; i < 8; ++i) {
+            coef[i] = _mm_set1_epi32(c[i] + ROUNDING_OFFSET);
+        }
+    }
+
+    __m128i coef[8];
+};
+
+/// Loads the luma of 8 pixels.
+static PixelVec LoadLuma(const u8* src) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+}
+
+/// Loads 4 chroma samples, repeating each of them for the 2 pixels sharing it.
+static PixelVec LoadChroma(const u8* src) {
+    u32 samples;
+    std::memcpy(&samples, src, sizeof(samples));
+    const __m128i vec = _mm_cvtsi32_si128(static_cast<int>(samples));
+    return _mm_unpacklo_epi8(vec, vec);
+}
+
+/// Splits 8 pixels of YUYV data into their components.
+static void LoadYUYV(const u8* src, PixelVec& Y, PixelVec& U, PixelVec& V) {
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    Y = _mm_shuffle_epi8(data, _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1,
+                                              -1, -1));
+    U = _mm_shuffle_epi8(data, _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, -1, -1, -1, -1, -1, -1, -1,
+                                              -1));
+    V = _mm_shuffle_epi8(data, _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, -1, -1, -1, -1, -1, -1,
+                                              -1, -1));
+}
+
+/// Converts 8 pixels to RGB32 using the same fixed point math as the scalar path.
+static void ConvertPixels(PixelVec Y, PixelVec U, PixelVec V, const VectorCoefficients& c,
+                          u32* out) {
+    struct Channels {
+        __m128i r, g, b;
+    };
+    const auto convert = [&c](__m128i y, __m128i u, __m128i v) {
+        const auto scale = [](__m128i value, __m128i offset) {
+            return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(value, 3), offset), 5);
+        };
+        const __m128i cY = _mm_mullo_epi32(c.coef[0], y);
+        const __m128i r = _mm_add_epi32(cY, _mm_mullo_epi32(c.coef[1], v));
+        const __m128i g = _mm_sub_epi32(_mm_sub_epi32(cY, _mm_mullo_epi32(c.coef[2], v)),
+                                        _mm_mullo_epi32(c.coef[3], u));
+        const __m128i b = _mm_add_epi32(cY, _mm_mullo_epi32(c.coef[4], u));
+        return Channels{scale(r, c.coef[5]), scale(g, c.coef[6]), scale(b, c.coef[7])};
+    };
+    const Channels lo =
+        convert(_mm_cvtepu8_epi32(Y), _mm_cvtepu8_epi32(U), _mm_cvtepu8_epi32(V));
+    const Channels hi = convert(_mm_cvtepu8_epi32(_mm_srli_si128(Y, 4)),
+                                _mm_cvtepu8_epi32(_mm_srli_si128(U, 4)),
+                                _mm_cvtepu8_epi32(_mm_srli_si128(V, 4)));
+
+    // Saturating to 16 and then to 8 bits clamps every channel to [0, 255].
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i r = _mm_packus_epi16(_mm_packs_epi32(lo.r, hi.r), zero);
+    const __m128i g = _mm_packus_epi16(_mm_packs_epi32(lo.g, hi.g), zero);
+    const __m128i b = _mm_packus_epi16(_mm_packs_epi32(lo.b, hi.b), zero);
+    const __m128i zb = _mm_unpacklo_epi8(zero, b);
+    const __m128i gr = _mm_unpacklo_epi8(g, r);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(zb, gr));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(zb, gr));
+}
+
+/// Encodes 4 RGB32 pixels to the output format.
+template <OutputFormat output_format>
+static void EncodePixels(const u32* input, u8* output, u8 alpha) {
+    const __m128i color = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    if constexpr (output_format == OutputFormat::RGBA8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output),
+                         _mm_or_si128(color, _mm_set1_epi32(alpha)));
+    } else if constexpr (output_format == OutputFormat::RGB8) {
+        const __m128i rgb = _mm_shuffle_epi8(
+            color, _mm_setr_epi8(1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1));
+        const u32 last = static_cast<u32>(_mm_extract_epi32(rgb, 2));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), rgb);
+        std::memcpy(output + 8, &last, sizeof(last));
+    } else {
+        const __m128i r = _mm_slli_epi32(_mm_srli_epi32(color, 27), 11);
+        __m128i data;
+        if constexpr (output_format == OutputFormat::RGB565) {
+            const __m128i g = _mm_and_si128(_mm_srli_epi32(color, 18), _mm_set1_epi32(0x3F));
+            const __m128i b = _mm_and_si128(_mm_srli_epi32(color, 11), _mm_set1_epi32(0x1F));
+            data = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)), b);
+        } else {
+            const __m128i g = _mm_and_si128(_mm_srli_epi32(color, 19), _mm_set1_epi32(0x1F));
+            const __m128i b = _mm_and_si128(_mm_srli_epi32(color, 11), _mm_set1_epi32(0x1F));
+            const __m128i a = _mm_set1_epi32(alpha >> 7);
+            data = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 6)),
+                                _mm_or_si128(_mm_slli_epi32(b, 1), a));
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi32(data, data));
+    }
+}
+
+#elif defined(HAVE_NEON)
+
+using PixelVec = uint8x8_t;
+
+/// Conversion coefficients splatted to every lane. The offsets include the rounding offset.
+struct VectorCoefficients {
+    explicit VectorCoefficients(const CoefficientSet& c) {
+        for (std::size_t i = 0; i < 5; ++i) {
+            coef[i] = vdupq_n_s32(c[i]);
+        }
+        for (std::size_t i = 5; i < 8; ++i) {
+            coef[i] = vdupq_n_s32(c[i] + ROUNDING_OFFSET);
+        }
+    }
+
+    int32x4_t coef[8];
+};
+
+/// Loads the luma of 8 pixels.
+static PixelVec LoadLuma(const u8* src) {
+    return vld1_u8(src);
+}
+
+/// Loads 4 chroma samples, repeating each of them for the 2 pixels sharing it.
+static PixelVec LoadChroma(const u8* src) {
+    u32 samples;
+    std::memcpy(&samples, src, sizeof(samples));
+    const uint8x8_t vec = vreinterpret_u8_u32(vdup_n_u32(samples));
+    return vzip1_u8(vec, vec);
+}
+
+/// Splits 8 pixels of YUYV data into their components.
+static void LoadYUYV(const u8* src, PixelVec& Y, PixelVec& U, PixelVec& V) {
+    const uint8x16_t data = vld1q_u8(src);
+    Y = vqtbl1_u8(data, vcreate_u8(0x0E0C0A0806040200ULL));
+    U = vqtbl1_u8(data, vcreate_u8(0x0D0D090905050101ULL));
+    V = vqtbl1_u8(data, vcreate_u8(0x0F0F0B0B07070303ULL));
+}
+
+/// Converts 8 pixels to RGB32 using the same fixed point math as the scalar path.
+static void ConvertPixels(PixelVec Y, PixelVec U, PixelVec V, const VectorCoefficients& c,
+                          u32* out) {
+    const auto widen = [](uint16x4_t value) {
+        return vreinterpretq_s32_u32(vmovl_u16(value));
+    };
+    const auto convert = [&c](int32x4_t y, int32x4_t u, int32x4_t v, int32x4_t& r, int32x4_t& g,
+                              int32x4_t& b) {
+        const auto scale = [](int32x4_t value, int32x4_t offset) {
+            return vshrq_n_s32(vaddq_s32(vshrq_n_s32(value, 3), offset), 5);
+        };
+        const int32x4_t cY = vmulq_s32(c.coef[0], y);
+        r = scale(vmlaq_s32(cY, c.coef[1], v), c.coef[5]);
+        g = scale(vmlsq_s32(vmlsq_s32(cY, c.coef[2], v), c.coef[3], u), c.coef[6]);
+        b = scale(vmlaq_s32(cY, c.coef[4], u), c.coef[7]);
+    };
+    const uint16x8_t y16 = vmovl_u8(Y);
+    const uint16x8_t u16 = vmovl_u8(U);
+    const uint16x8_t v16 = vmovl_u8(V);
+    int32x4_t r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+    convert(widen(vget_low_u16(y16)), widen(vget_low_u16(u16)), widen(vget_low_u16(v16)), r_lo,
+            g_lo, b_lo);
+    convert(widen(vget_high_u16(y16)), widen(vget_high_u16(u16)), widen(vget_high_u16(v16)), r_hi,
+            g_hi, b_hi);
+
+    // Saturating to 16 and then to 8 bits clamps every channel to [0, 255].
+    const auto narrow = [](int32x4_t lo, int32x4_t hi) {
+        return vqmovun_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    };
+    const uint8x8x4_t pixels{{vdup_n_u8(0), narrow(b_lo, b_hi), narrow(g_lo, g_hi),
+                              narrow(r_lo, r_hi)}};
+    vst4_u8(reinterpret_cast<u8*>(out), pixels);
+}
+
+/// Encodes 4 RGB32 pixels to the output format.
+template <OutputFormat output_format>
+static void EncodePixels(const u32* input, u8* output, u8 alpha) {
+    const uint32x4_t color = vld1q_u32(input);
+    if constexpr (output_format == OutputFormat::RGBA8) {
+        vst1q_u8(output, vreinterpretq_u8_u32(vorrq_u32(color, vdupq_n_u32(alpha))));
+    } else if constexpr (output_format == OutputFormat::RGB8) {
+        static constexpr u8 rgb_indices[16] = {1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15};
+        const uint8x16_t rgb = vqtbl1q_u8(vreinterpretq_u8_u32(color), vld1q_u8(rgb_indices));
+        const u32 last = vgetq_lane_u32(vreinterpretq_u32_u8(rgb), 2);
+        vst1_u8(output, vget_low_u8(rgb));
+        std::memcpy(output + 8, &last, sizeof(last));
+    } else {
+        const uint32x4_t r = vshlq_n_u32(vshrq_n_u32(color, 27), 11);
+        uint32x4_t data;
+        if constexpr (output_format == OutputFormat::RGB565) {
+            const uint32x4_t g = vandq_u32(vshrq_n_u32(color, 18), vdupq_n_u32(0x3F));
+            const uint32x4_t b = vandq_u32(vshrq_n_u32(color, 11), vdupq_n_u32(0x1F));
+            data = vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 5)), b);
+        } else {
+            const uint32x4_t g = vandq_u32(vshrq_n_u32(color, 19), vdupq_n_u32(0x1F));
+            const uint32x4_t b = vandq_u32(vshrq_n_u32(color, 11), vdupq_n_u32(0x1F));
+            const uint32x4_t a = vdupq_n_u32(alpha >> 7);
+            data = vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 6)), vorrq_u32(vshlq_n_u32(b, 1), a));
+        }
+        vst1_u8(output, vreinterpret_u8_u16(vmovn_u32(data)));
+    }
+}
+
+#endif
+
+#ifdef HAVE_Y2R_SIMD
+/// Vectorized version of ConvertYUVToRGB, converting the 8 pixels of a tile line at a time.
+template <InputFormat input_format>
+static void ConvertYUVToRGBVector(const u8* input_Y, const u8* input_U, const u8* input_V,
+                                  u32* output, std::size_t tile_stride, std::size_t line_stride,
+                                  unsigned int width, unsigned int height,
+                                  const CoefficientSet& coefficients) {
+    const VectorCoefficients coef{coefficients};
+
+    for (unsigned int y = 0; y < height; ++y) {
+        for (unsigned int x = 0; x < width; x += 8) {
+            PixelVec Y;
+            PixelVec U;
+            PixelVec V;
+            if constexpr (input_format == InputFormat::YUV422_Indiv8 ||
+                          input_format == InputFormat::YUV422_Indiv16) {
+                Y = LoadLuma(input_Y + y * width + x);
+                U = LoadChroma(input_U + (y * width + x) / 2);
+                V = LoadChroma(input_V + (y * width + x) / 2);
+            } else if constexpr (input_format == InputFormat::YUV420_Indiv8 ||
+                                 input_format == InputFormat::YUV420_Indiv16) {
+                Y = LoadLuma(input_Y + y * width + x);
+                U = LoadChroma(input_U + ((y / 2) * width + x) / 2);
+                V = LoadChroma(input_V + ((y / 2) * width + x) / 2);
+            } else if constexpr (input_format == InputFormat::YUYV422_Interleaved) {
+                LoadYUYV(input_Y + (y * width + x) * 2, Y, U, V);
+            }
+            ConvertPixels(Y, U, V, coef, output + (x / 8) * tile_stride + y * line_stride);
+        }
+    }
+}
+#endif
+
+/**
+ * Converts a image strip from the source YUV format into RGB32. Each 8 pixel wide tile of the strip
+ * is written `tile_stride` pixels after the previous one, with lines `line_stride` pixels apart.
+ */
 template <InputFormat input_format>
-static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V,
-                            ImageTile output[], unsigned int width, unsigned int height,
-                            const CoefficientSet& coefficients) {
+static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* input_V, u32* output,
+                            std::size_t tile_stride, std::size_t line_stride, unsigned int width,
+                            unsigned int height, const CoefficientSet& coefficients,
+                            bool scalar) {
+#ifdef HAVE_Y2R_SIMD
+    if (!scalar) {
+        ConvertYUVToRGBVector<input_format>(input_Y, input_U, input_V, output, tile_stride,
+                                            line_stride, width, height, coefficients);
+        return;
+    }
+#endif
 
     for (unsigned int y = 0; y < height; ++y) {
         for (unsigned int x = 0; x < width; ++x) {
@@ -63,14 +344,13 @@ static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* inpu
             s32 g = cY - c[2] * V - c[3] * U;
             s32 b = cY + c[4] * U;
 
-            const s32 rounding_offset = 0x18;
-            r = (r >> 3) + c[5] + rounding_offset;
-            g = (g >> 3) + c[6] + rounding_offset;
-            b = (b >> 3) + c[7] + rounding_offset;
+            r = (r >> 3) + c[5] + ROUNDING_OFFSET;
+            g = (g >> 3) + c[6] + ROUNDING_OFFSET;
+            b = (b >> 3) + c[7] + ROUNDING_OFFSET;
 
             unsigned int tile = x / 8;
             unsigned int tile_x = x % 8;
-            u32* out = &output[tile][y * 8 + tile_x];
+            u32* out = &output[tile * tile_stride + y * line_stride + tile_x];
             *out = ((u32)std::clamp(r >> 5, 0, 0xFF) << 24) |
                    ((u32)std::clamp(g >> 5, 0, 0xFF) << 16) |
                    ((u32)std::clamp(b >> 5, 0, 0xFF) << 8);
@@ -78,6 +358,12 @@ static void ConvertYUVToRGB(const u8* input_Y, const u8* input_U, const u8* inpu
     }
 }
 
+/// Moves a buffer past a number of CDMA transfers.
+static void AdvanceBuffer(ConversionBuffer& buf, std::size_t num_transfers) {
+    buf.address += static_cast<VAddr>(num_transfers * (buf.transfer_unit + buf.gap));
+    buf.image_size -= static_cast<u32>(num_transfers * buf.transfer_unit);
+}
+
 /// Simulates an incoming CDMA transfer. The N parameter is used to automatically convert 16-bit
 /// formats to 8-bit.
 template <std::size_t N>
@@ -89,55 +375,79 @@ static void ReceiveData(Memory::MemorySystem& memory, u8* output, ConversionBuff
     ASSERT(amount_of_data % output_unit == 0);
 
     while (amount_of_data > 0) {
-        for (std::size_t i = 0; i < output_unit; ++i) {
-            output[i] = input[i * N];
+        if constexpr (N == 1) {
+            std::memcpy(output, input, output_unit);
+        } else {
+            for (std::size_t i = 0; i < output_unit; ++i) {
+                output[i] = input[i * N];
+            }
         }
 
         output += output_unit;
         input += buf.transfer_unit + buf.gap;
 
-        buf.address += buf.transfer_unit + buf.gap;
-        buf.image_size -= buf.transfer_unit;
+        AdvanceBuffer(buf, 1);
         amount_of_data -= output_unit;
     }
 }
 
+/// Number of pixels sent by each transfer. Transfers always end on a whole pixel, which is written
+/// past the end of the transfer unit if it doesn't fit.
+static std::size_t PixelsPerTransfer(OutputFormat output_format, const ConversionBuffer& buf) {
+    const std::size_t bytes_per_pixel = BytesPerPixel(output_format);
+    return (buf.transfer_unit + bytes_per_pixel - 1) / bytes_per_pixel;
+}
+
+/// Encodes a run of pixels from the intermediate RGB32 format to the final output format.
+template <OutputFormat output_format>
+static void EncodeRun(const u32* input, u8* output, std::size_t count, u8 alpha, bool scalar) {
+    constexpr std::size_t bytes_per_pixel = BytesPerPixel(output_format);
+
+    std::size_t i = 0;
+#ifdef HAVE_Y2R_SIMD
+    if (!scalar) {
+        for (; i + 4 <= count; i += 4) {
+            EncodePixels<output_format>(input + i, output + i * bytes_per_pixel, alpha);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const u32 color = input[i];
+        Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
+        u8* out = output + i * bytes_per_pixel;
+
+        if constexpr (output_format == OutputFormat::RGBA8) {
+            Common::Color::EncodeRGBA8(col_vec, out);
+        } else if constexpr (output_format == OutputFormat::RGB8) {
+            Common::Color::EncodeRGB8(col_vec, out);
+        } else if constexpr (output_format == OutputFormat::RGB5A1) {
+            Common::Color::EncodeRGB5A1(col_vec, out);
+        } else if constexpr (output_format == OutputFormat::RGB565) {
+            Common::Color::EncodeRGB565(col_vec, out);
+        } else {
+            UNREACHABLE_MSG("Unknown Y2R output format {}", output_format);
+        }
+    }
+}
+
 /// Convert intermediate RGB32 format to the final output format while simulating an outgoing CDMA
 /// transfer.
 template <OutputFormat output_format>
 static void SendData(Memory::MemorySystem& memory, const u32* input, ConversionBuffer& buf,
-                     int amount_of_data, u8 alpha) {
+                     int amount_of_data, u8 alpha, bool scalar) {
+    constexpr std::size_t bytes_per_pixel = BytesPerPixel(output_format);
+    const std::size_t unit_pixels = PixelsPerTransfer(output_format, buf);
 
     u8* output = memory.GetPointer(buf.address);
 
     while (amount_of_data > 0) {
-        u8* unit_end = output + buf.transfer_unit;
-        while (output < unit_end) {
-            u32 color = *input++;
-            Common::Vec4<u8> col_vec{(u8)(color >> 24), (u8)(color >> 16), (u8)(color >> 8), alpha};
-
-            if constexpr (output_format == OutputFormat::RGBA8) {
-                Common::Color::EncodeRGBA8(col_vec, output);
-                output += 4;
-            } else if constexpr (output_format == OutputFormat::RGB8) {
-                Common::Color::EncodeRGB8(col_vec, output);
-                output += 3;
-            } else if constexpr (output_format == OutputFormat::RGB5A1) {
-                Common::Color::EncodeRGB5A1(col_vec, output);
-                output += 2;
-            } else if constexpr (output_format == OutputFormat::RGB565) {
-                Common::Color::EncodeRGB565(col_vec, output);
-                output += 2;
-            } else {
-                UNREACHABLE_MSG("Unknown Y2R output format {}", output_format);
-            }
-
-            amount_of_data -= 1;
-        }
+        EncodeRun<output_format>(input, output, unit_pixels, alpha, scalar);
+        input += unit_pixels;
+        amount_of_data -= static_cast<int>(unit_pixels);
 
-        output += buf.gap;
-        buf.address += buf.transfer_unit + buf.gap;
-        buf.image_size -= buf.transfer_unit;
+        output += unit_pixels * bytes_per_pixel + buf.gap;
+        AdvanceBuffer(buf, 1);
     }
 }
 
@@ -210,64 +520,12 @@ static void WriteTileToOutput(u32* output, const ImageTile& tile, int height, in
     }
 }
 
-/**
- * Performs a Y2R colorspace conversion.
- *
- * The Y2R hardware implements hardware-accelerated YUV to RGB colorspace conversions. It is most
- * commonly used for video playback or to display camera input to the screen.
- *
- * The conversion process is quite configurable, and can be divided in distinct steps. From
- * observation, it appears that the hardware buffers a single 8-pixel tall strip of image data
- * internally and converts it in one go before writing to the output and loading the next strip.
- *
- * The steps taken to convert one strip of image data are:
- *
- * - The hardware receives data via CDMA (http://3dbrew.org/wiki/Corelink_DMA_Engines), which is
- *   presumably stored in one or more internal buffers. This process can be done in several separate
- *   transfers, as long as they don't exceed the size of the internal image buffer. This allows
- *   flexibility in input strides.
- * - The input data is decoded into a YUV tuple. Several formats are suported, see the `InputFormat`
- *   enum.
- * - The YUV tuple is converted, using fixed point calculations, to RGB. This step can be configured
- *   using a set of coefficients to support different colorspace standards. See `CoefficientSet`.
- * - The strip can be optionally rotated 90, 180 or 270 degrees. Since each strip is processed
- *   independently, this notably rotates each *strip*, not the entire image. This means that for 90
- *   or 270 degree rotations, the output will be in terms of several 8 x height images, and for any
- *   non-zero rotation the strips will have to be re-arranged so that the parts of the image will
- *   not be shuffled together. This limitation makes this a feature of somewhat dubious utility. 90
- *   or 270 degree rotations in images with non-even height don't seem to work properly.
- * - The data is converted to the output RGB format. See the `OutputFormat` enum.
- * - The data can be output either linearly line-by-line or in the swizzled 8x8 tile format used by
- *   the PICA. This is decided by the `BlockAlignment` enum. If 8x8 alignment is used, then the
- *   image must have a height divisible by 8. The image width must always be divisible by 8.
- * - The final data is then CDMAed out to main memory and the next image strip is processed. This
- *   offers the same flexibility as the input stage.
- *
- * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
- * intermediate formats are used and where possible tables or parameters are used instead of
- * diverging code paths to keep the amount of branches in check. Some steps are also merged to
- * increase efficiency.
- *
- * Output for all valid settings combinations matches hardware, however output in some edge-cases
- * differs:
- *
- * - `Block8x8` alignment with non-mod8 height produces different garbage patterns on the last
- *   strip, especially when combined with rotation.
- * - Hardware, when using `Linear` alignment with a non-even height and 90 or 270 degree rotation
- *   produces misaligned output on the last strip. This implmentation produces output with the
- *   correct "expected" alignment.
- *
- * Hardware behaves strangely (doesn't fire the completion interrupt, for example) in these cases,
- * so they are believed to be invalid configurations anyway.
- */
-void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt) {
-    BORKED3DS_PROFILE("Y2R", "Perform Conversion");
-
-    ASSERT(cvt.input_line_width % 8 == 0);
-    ASSERT(cvt.block_alignment != BlockAlignment::Block8x8 || cvt.input_lines % 8 == 0);
+/// Converts the image strips starting at `first_line` up to `end_line`. The buffers must point to
+/// the data of the first strip.
+static void ConvertStrips(Memory::MemorySystem& memory, ConversionConfiguration& cvt,
+                          unsigned int first_line, unsigned int end_line, bool scalar) {
     // Tiles per row
     std::size_t num_tiles = cvt.input_line_width / 8;
-    ASSERT(num_tiles <= MAX_TILES);
 
     // Buffer used as a CDMA source/target.
     std::unique_ptr<u8[]> data_buffer(new u8[cvt.input_line_width * 8 * 4]);
@@ -287,7 +545,19 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
         break;
     }
 
-    for (unsigned int y = 0; y < cvt.input_lines; y += 8) {
+    // Without rotation, linear output is converted straight into the order it is sent in and the
+    // tiles are skipped. A partial last strip or transfers ending past a strip pick up whatever was
+    // left in the buffers by the previous strip, so those keep going through the tiles.
+    const std::size_t unit_pixels = PixelsPerTransfer(cvt.output_format, cvt.dst);
+    const bool direct_output = !scalar && cvt.rotation == Rotation::None &&
+                               cvt.block_alignment == BlockAlignment::Linear &&
+                               cvt.input_lines % 8 == 0 && unit_pixels != 0 &&
+                               cvt.input_line_width * 8 % unit_pixels == 0;
+    u32* rgb_buffer = tiles[0].data();
+    const std::size_t tile_stride = direct_output ? 8 : TILE_SIZE;
+    const std::size_t line_stride = direct_output ? cvt.input_line_width : 8;
+
+    for (unsigned int y = first_line; y < end_line; y += 8) {
         unsigned int row_height = std::min(cvt.input_lines - y, 8u);
 
         // Total size in pixels of incoming data required for this strip.
@@ -302,41 +572,41 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
             ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 2);
             ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 2);
-            ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(input_Y, input_U, input_V, tiles.get(),
-                                                        cvt.input_line_width, row_height,
-                                                        cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV422_Indiv8>(
+                input_Y, input_U, input_V, rgb_buffer, tile_stride, line_stride,
+                cvt.input_line_width, row_height, cvt.coefficients, scalar);
             break;
         case InputFormat::YUV420_Indiv8:
             ReceiveData<1>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<1>(memory, input_U, cvt.src_U, row_data_size / 4);
             ReceiveData<1>(memory, input_V, cvt.src_V, row_data_size / 4);
-            ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(input_Y, input_U, input_V, tiles.get(),
-                                                        cvt.input_line_width, row_height,
-                                                        cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV420_Indiv8>(
+                input_Y, input_U, input_V, rgb_buffer, tile_stride, line_stride,
+                cvt.input_line_width, row_height, cvt.coefficients, scalar);
             break;
         case InputFormat::YUV422_Indiv16:
             ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 2);
             ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 2);
-            ConvertYUVToRGB<InputFormat::YUV422_Indiv16>(input_Y, input_U, input_V, tiles.get(),
-                                                         cvt.input_line_width, row_height,
-                                                         cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV422_Indiv16>(
+                input_Y, input_U, input_V, rgb_buffer, tile_stride, line_stride,
+                cvt.input_line_width, row_height, cvt.coefficients, scalar);
             break;
         case InputFormat::YUV420_Indiv16:
             ReceiveData<2>(memory, input_Y, cvt.src_Y, row_data_size);
             ReceiveData<2>(memory, input_U, cvt.src_U, row_data_size / 4);
             ReceiveData<2>(memory, input_V, cvt.src_V, row_data_size / 4);
-            ConvertYUVToRGB<InputFormat::YUV420_Indiv16>(input_Y, input_U, input_V, tiles.get(),
-                                                         cvt.input_line_width, row_height,
-                                                         cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUV420_Indiv16>(
+                input_Y, input_U, input_V, rgb_buffer, tile_stride, line_stride,
+                cvt.input_line_width, row_height, cvt.coefficients, scalar);
             break;
         case InputFormat::YUYV422_Interleaved:
             input_U = nullptr;
             input_V = nullptr;
             ReceiveData<1>(memory, input_Y, cvt.src_YUYV, row_data_size * 2);
-            ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(input_Y, input_U, input_V,
-                                                              tiles.get(), cvt.input_line_width,
-                                                              row_height, cvt.coefficients);
+            ConvertYUVToRGB<InputFormat::YUYV422_Interleaved>(
+                input_Y, input_U, input_V, rgb_buffer, tile_stride, line_stride,
+                cvt.input_line_width, row_height, cvt.coefficients, scalar);
             break;
         default:
             UNREACHABLE_MSG("Unknown Y2R input format {}", cvt.input_format);
@@ -344,68 +614,71 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
         }
 
         u32* output_buffer = reinterpret_cast<u32*>(data_buffer.get());
-
-        for (std::size_t i = 0; i < num_tiles; ++i) {
-            int image_strip_width = 0;
-            int output_stride = 0;
-
-            switch (cvt.rotation) {
-            case Rotation::None:
-                RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_90:
-                RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            case Rotation::Clockwise_180:
-                // For 180 and 270 degree rotations we also invert the order of tiles in the strip,
-                // since the rotates are done individually on each tile.
-                RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = cvt.input_line_width;
-                output_stride = 8;
-                break;
-            case Rotation::Clockwise_270:
-                RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
-                image_strip_width = 8;
-                output_stride = 8 * row_height;
-                break;
-            }
-
-            switch (cvt.block_alignment) {
-            case BlockAlignment::Linear:
-                WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
-                output_buffer += output_stride;
-                break;
-            case BlockAlignment::Block8x8:
-                WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
-                output_buffer += TILE_SIZE;
-                break;
+        const u32* send_buffer = direct_output ? rgb_buffer : output_buffer;
+
+        if (!direct_output) {
+            for (std::size_t i = 0; i < num_tiles; ++i) {
+                int image_strip_width = 0;
+                int output_stride = 0;
+
+                switch (cvt.rotation) {
+                case Rotation::None:
+                    RotateTile0(tiles[i], tmp_tile, row_height, tile_remap);
+                    image_strip_width = cvt.input_line_width;
+                    output_stride = 8;
+                    break;
+                case Rotation::Clockwise_90:
+                    RotateTile90(tiles[i], tmp_tile, row_height, tile_remap);
+                    image_strip_width = 8;
+                    output_stride = 8 * row_height;
+                    break;
+                case Rotation::Clockwise_180:
+                    // For 180 and 270 degree rotations we also invert the order of tiles in the
+                    // strip, since the rotates are done individually on each tile.
+                    RotateTile180(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                    image_strip_width = cvt.input_line_width;
+                    output_stride = 8;
+                    break;
+                case Rotation::Clockwise_270:
+                    RotateTile270(tiles[num_tiles - i - 1], tmp_tile, row_height, tile_remap);
+                    image_strip_width = 8;
+                    output_stride = 8 * row_height;
+                    break;
+                }
+
+                switch (cvt.block_alignment) {
+                case BlockAlignment::Linear:
+                    WriteTileToOutput(output_buffer, tmp_tile, row_height, image_strip_width);
+                    output_buffer += output_stride;
+                    break;
+                case BlockAlignment::Block8x8:
+                    WriteTileToOutput(output_buffer, tmp_tile, 8, 8);
+                    output_buffer += TILE_SIZE;
+                    break;
+                }
             }
         }
 
         switch (cvt.output_format) {
         case OutputFormat::RGBA8:
-            SendData<OutputFormat::RGBA8>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                          cvt.dst, static_cast<int>(row_data_size),
-                                          static_cast<u8>(cvt.alpha));
+            SendData<OutputFormat::RGBA8>(memory, send_buffer, cvt.dst,
+                                          static_cast<int>(row_data_size),
+                                          static_cast<u8>(cvt.alpha), scalar);
             break;
         case OutputFormat::RGB8:
-            SendData<OutputFormat::RGB8>(memory, reinterpret_cast<u32*>(data_buffer.get()), cvt.dst,
+            SendData<OutputFormat::RGB8>(memory, send_buffer, cvt.dst,
                                          static_cast<int>(row_data_size),
-                                         static_cast<u8>(cvt.alpha));
+                                         static_cast<u8>(cvt.alpha), scalar);
             break;
         case OutputFormat::RGB5A1:
-            SendData<OutputFormat::RGB5A1>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                           cvt.dst, static_cast<int>(row_data_size),
-                                           static_cast<u8>(cvt.alpha));
+            SendData<OutputFormat::RGB5A1>(memory, send_buffer, cvt.dst,
+                                           static_cast<int>(row_data_size),
+                                           static_cast<u8>(cvt.alpha), scalar);
             break;
         case OutputFormat::RGB565:
-            SendData<OutputFormat::RGB565>(memory, reinterpret_cast<u32*>(data_buffer.get()),
-                                           cvt.dst, static_cast<int>(row_data_size),
-                                           static_cast<u8>(cvt.alpha));
+            SendData<OutputFormat::RGB565>(memory, send_buffer, cvt.dst,
+                                           static_cast<int>(row_data_size),
+                                           static_cast<u8>(cvt.alpha), scalar);
             break;
         default:
             UNREACHABLE_MSG("Unknown Y2R output format {}", cvt.output_format);
@@ -413,4 +686,163 @@ void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt
         }
     }
 }
+
+/// Moves the buffers past the CDMA transfers of the image strips starting at `first_line` up to
+/// `end_line`, without converting them.
+static void SkipStrips(ConversionConfiguration& cvt, unsigned int first_line,
+                       unsigned int end_line) {
+    const auto skip = [](ConversionBuffer& buf, std::size_t amount_of_data, std::size_t N) {
+        AdvanceBuffer(buf, amount_of_data / (buf.transfer_unit / N));
+    };
+
+    for (unsigned int y = first_line; y < end_line; y += 8) {
+        const unsigned int row_height = std::min(cvt.input_lines - y, 8u);
+        const std::size_t row_data_size = row_height * cvt.input_line_width;
+
+        switch (cvt.input_format) {
+        case InputFormat::YUV422_Indiv8:
+        case InputFormat::YUV422_Indiv16: {
+            const std::size_t N = cvt.input_format == InputFormat::YUV422_Indiv16 ? 2 : 1;
+            skip(cvt.src_Y, row_data_size, N);
+            skip(cvt.src_U, row_data_size / 2, N);
+            skip(cvt.src_V, row_data_size / 2, N);
+            break;
+        }
+        case InputFormat::YUV420_Indiv8:
+        case InputFormat::YUV420_Indiv16: {
+            const std::size_t N = cvt.input_format == InputFormat::YUV420_Indiv16 ? 2 : 1;
+            skip(cvt.src_Y, row_data_size, N);
+            skip(cvt.src_U, row_data_size / 4, N);
+            skip(cvt.src_V, row_data_size / 4, N);
+            break;
+        }
+        case InputFormat::YUYV422_Interleaved:
+            skip(cvt.src_YUYV, row_data_size * 2, 1);
+            break;
+        }
+
+        const std::size_t unit_pixels = PixelsPerTransfer(cvt.output_format, cvt.dst);
+        AdvanceBuffer(cvt.dst, (row_data_size + unit_pixels - 1) / unit_pixels);
+    }
+}
+
+/**
+ * Checks if the image strips of a conversion can be converted out of order. This requires every
+ * strip to send whole transfer units, and the output to not overlap any of the input.
+ */
+static bool CanConvertInParallel(const ConversionConfiguration& cvt) {
+    const std::size_t bytes_per_pixel = BytesPerPixel(cvt.output_format);
+    const std::size_t strip_pixels = cvt.input_line_width * 8;
+    if (cvt.input_lines % 8 != 0 || cvt.dst.transfer_unit == 0 ||
+        cvt.dst.transfer_unit % bytes_per_pixel != 0 ||
+        strip_pixels % (cvt.dst.transfer_unit / bytes_per_pixel) != 0) {
+        return false;
+    }
+
+    ConversionConfiguration end = cvt;
+    SkipStrips(end, 0, cvt.input_lines);
+    const auto overlaps_output = [&](ConversionBuffer ConversionConfiguration::*buffer) {
+        return std::max((cvt.*buffer).address, cvt.dst.address) <
+               std::min((end.*buffer).address, end.dst.address);
+    };
+
+    if (cvt.input_format == InputFormat::YUYV422_Interleaved) {
+        return !overlaps_output(&ConversionConfiguration::src_YUYV);
+    }
+    return !overlaps_output(&ConversionConfiguration::src_Y) &&
+           !overlaps_output(&ConversionConfiguration::src_U) &&
+           !overlaps_output(&ConversionConfiguration::src_V);
+}
+
+/**
+ * Performs a Y2R colorspace conversion.
+ *
+ * The Y2R hardware implements hardware-accelerated YUV to RGB colorspace conversions. It is most
+ * commonly used for video playback or to display camera input to the screen.
+ *
+ * The conversion process is quite configurable, and can be divided in distinct steps. From
+ * observation, it appears that the hardware buffers a single 8-pixel tall strip of image data
+ * internally and converts it in one go before writing to the output and loading the next strip.
+ *
+ * The steps taken to convert one strip of image data are:
+ *
+ * - The hardware receives data via CDMA (http://3dbrew.org/wiki/Corelink_DMA_Engines), which is
+ *   presumably stored in one or more internal buffers. This process can be done in several separate
+ *   transfers, as long as they don't exceed the size of the internal image buffer. This allows
+ *   flexibility in input strides.
+ * - The input data is decoded into a YUV tuple. Several formats are suported, see the `InputFormat`
+ *   enum.
+ * - The YUV tuple is converted, using fixed point calculations, to RGB. This step can be configured
+ *   using a set of coefficients to support different colorspace standards. See `CoefficientSet`.
+ * - The strip can be optionally rotated 90, 180 or 270 degrees. Since each strip is processed
+ *   independently, this notably rotates each *strip*, not the entire image. This means that for 90
+ *   or 270 degree rotations, the output will be in terms of several 8 x height images, and for any
+ *   non-zero rotation the strips will have to be re-arranged so that the parts of the image will
+ *   not be shuffled together. This limitation makes this a feature of somewhat dubious utility. 90
+ *   or 270 degree rotations in images with non-even height don't seem to work properly.
+ * - The data is converted to the output RGB format. See the `OutputFormat` enum.
+ * - The data can be output either linearly line-by-line or in the swizzled 8x8 tile format used by
+ *   the PICA. This is decided by the `BlockAlignment` enum. If 8x8 alignment is used, then the
+ *   image must have a height divisible by 8. The image width must always be divisible by 8.
+ * - The final data is then CDMAed out to main memory and the next image strip is processed. This
+ *   offers the same flexibility as the input stage.
+ *
+ * In this implementation, to avoid the combinatorial explosion of parameter combinations, common
+ * intermediate formats are used and where possible tables or parameters are used instead of
+ * diverging code paths to keep the amount of branches in check. Some steps are also merged to
+ * increase efficiency.
+ *
+ * Output for all valid settings combinations matches hardware, however output in some edge-cases
+ * differs:
+ *
+ * - `Block8x8` alignment with non-mod8 height produces different garbage patterns on the last
+ *   strip, especially when combined with rotation.
+ * - Hardware, when using `Linear` alignment with a non-even height and 90 or 270 degree rotation
+ *   produces misaligned output on the last strip. This implmentation produces output with the
+ *   correct "expected" alignment.
+ *
+ * Hardware behaves strangely (doesn't fire the completion interrupt, for example) in these cases,
+ * so they are believed to be invalid configurations anyway.
+ *
+ * Since strips are independent, large conversions are split in blocks of strips converted by the
+ * worker threads when the transfers of the strips don't depend on each other.
+ */
+void PerformConversion(Memory::MemorySystem& memory, ConversionConfiguration cvt,
+                       Common::ThreadWorker* workers, bool scalar) {
+    BORKED3DS_PROFILE("Y2R", "Perform Conversion");
+
+    ASSERT(cvt.input_line_width % 8 == 0);
+    ASSERT(cvt.block_alignment != BlockAlignment::Block8x8 || cvt.input_lines % 8 == 0);
+    // Tiles per row
+    std::size_t num_tiles = cvt.input_line_width / 8;
+    ASSERT(num_tiles <= MAX_TILES);
+
+    const std::size_t num_strips = (cvt.input_lines + 7) / 8;
+    std::size_t num_tasks = 1;
+    if (workers && std::size_t{cvt.input_line_width} * cvt.input_lines >=
+                       PARALLEL_CONVERSION_THRESHOLD) {
+        num_tasks = std::min(workers->NumWorkers() + 1, num_strips / MIN_STRIPS_PER_TASK);
+    }
+    if (num_tasks <= 1 || !CanConvertInParallel(cvt)) {
+        ConvertStrips(memory, cvt, 0, cvt.input_lines, scalar);
+        return;
+    }
+
+    // Each block starts with the buffers where the transfers of the blocks before it left them.
+    // The first block is converted on this thread.
+    const unsigned int block_lines = static_cast<unsigned int>((num_strips + num_tasks - 1) /
+                                                               num_tasks * 8);
+    ConversionConfiguration first_block = cvt;
+    SkipStrips(cvt, 0, block_lines);
+    for (unsigned int y = block_lines; y < cvt.input_lines; y += block_lines) {
+        const unsigned int end_line = std::min<unsigned int>(y + block_lines, cvt.input_lines);
+        workers->QueueWork([&memory, block = cvt, y, end_line, scalar]() mutable {
+            ConvertStrips(memory, block, y, end_line, scalar);
+        });
+        SkipStrips(cvt, y, end_line);
+    }
+
+    ConvertStrips(memory, first_block, 0, block_lines, scalar);
+    workers->WaitForRequests();
+}
 } // namespace HW::Y2R
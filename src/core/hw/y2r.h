@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "common/thread_worker.h"
+
 namespace Memory {
 class MemorySystem;
 }
@@ -14,5 +16,11 @@ struct ConversionConfiguration;
 } // namespace Service::Y2R
 
 namespace HW::Y2R {
-void PerformConversion(Memory::MemorySystem& memory, Service::Y2R::ConversionConfiguration cvt);
+/**
+ * Performs a Y2R colorspace conversion.
+ * @param workers Optional thread pool used to split large conversions.
+ * @param scalar Disables the vectorized conversion, used to test it against the scalar one.
+ */
+void PerformConversion(Memory::MemorySystem& memory, Service::Y2R::ConversionConfiguration cvt,
+                       Common::ThreadWorker* workers = nullptr, bool scalar = false);
 } // namespace HW::Y2R
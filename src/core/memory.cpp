@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
@@ -31,10 +32,24 @@ SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::N3DS>
 
 namespace Memory {
 
+namespace {
+
+/// Size of the fastmem arena of a page table, covering the whole guest address space.
+constexpr std::size_t FASTMEM_ARENA_SIZE = std::size_t{PAGE_TABLE_NUM_ENTRIES}
+                                           << BORKED3DS_PAGE_BITS;
+
+} // Anonymous namespace
+
+PageTable::PageTable() = default;
+PageTable::~PageTable() = default;
+
 void PageTable::Clear() {
     pointers.raw.fill(nullptr);
     pointers.refs.fill(MemoryRef());
     attributes.fill(PageType::Unmapped);
+    if (fastmem_view) {
+        fastmem_view->Unmap(0, FASTMEM_ARENA_SIZE);
+    }
 }
 
 class RasterizerCacheMarker {
@@ -87,16 +102,20 @@ private:
 
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time
-    // if they are std::array which would exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // FCRAM, VRAM and the New 3DS extra memory are allocated in one block of host memory that
+    // can be mirrored into the fastmem arenas of the page tables. DSP memory is owned by the DSP
+    // and is only accessible through the page tables.
+    Common::HostMemory host_memory{Memory::FCRAM_N3DS_SIZE + Memory::VRAM_SIZE +
+                                   Memory::N3DS_EXTRA_RAM_SIZE};
+    u8* const fcram = host_memory.BackingBasePointer();
+    u8* const vram = fcram + Memory::FCRAM_N3DS_SIZE;
+    u8* const n3ds_extra_ram = vram + Memory::VRAM_SIZE;
 
     Core::System& system;
     std::shared_ptr<PageTable> current_page_table = nullptr;
     RasterizerCacheMarker cache_marker;
     std::vector<std::shared_ptr<PageTable>> page_table_list;
+    std::atomic<u64> page_table_generation{};
 
     AudioCore::DspInterface* dsp = nullptr;
 
@@ -110,13 +129,13 @@ public:
     const u8* GetPtr(Region r) const {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -125,13 +144,13 @@ public:
     u8* GetPtr(Region r) {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -251,6 +270,61 @@ public:
         }
     }
 
+    /// Whether the page pointer can be mirrored in a fastmem arena.
+    bool IsFastmemPage(const u8* pointer) const {
+        return host_memory.IsInBacking(pointer) &&
+               ((pointer - host_memory.BackingBasePointer()) & BORKED3DS_PAGE_MASK) == 0;
+    }
+
+    /**
+     * Mirrors the pointers of a range of pages in the fastmem arena of the page table. Pages that
+     * don't point into the host memory block (unmapped, rasterizer-cached and DSP memory) are made
+     * inaccessible, so that JIT accesses to them fault and fall back to the page table.
+     */
+    void UpdateFastmem(PageTable& page_table, u32 first_page, u32 num_pages) {
+        if (!page_table.fastmem_view) {
+            return;
+        }
+
+        const auto& pointers = page_table.GetPointerArray();
+        const u32 end = first_page + num_pages;
+        u32 page = first_page;
+        while (page != end) {
+            // Coalesce pages that are contiguous in the host memory as well into one mapping
+            const u8* const pointer = pointers[page];
+            const bool mapped = IsFastmemPage(pointer);
+            u32 run_end = page + 1;
+            while (run_end != end &&
+                   (mapped ? pointers[run_end] ==
+                                 pointer + std::size_t{run_end - page} * BORKED3DS_PAGE_SIZE
+                           : !IsFastmemPage(pointers[run_end]))) {
+                ++run_end;
+            }
+
+            const std::size_t virtual_offset = std::size_t{page} << BORKED3DS_PAGE_BITS;
+            const std::size_t length = std::size_t{run_end - page} << BORKED3DS_PAGE_BITS;
+            if (mapped) {
+                page_table.fastmem_view->Map(virtual_offset,
+                                             pointer - host_memory.BackingBasePointer(), length);
+            } else {
+                page_table.fastmem_view->Unmap(virtual_offset, length);
+            }
+            page = run_end;
+        }
+    }
+
+    /// Creates the fastmem arena of the page table and mirrors its current mappings in it.
+    void AttachFastmem(PageTable& page_table) {
+        if constexpr (sizeof(std::size_t) < sizeof(u64)) {
+            // The guest address space doesn't fit in the host one
+            return;
+        }
+        if (!page_table.fastmem_view) {
+            page_table.fastmem_view = host_memory.CreateView(FASTMEM_ARENA_SIZE);
+        }
+        UpdateFastmem(page_table, 0, PAGE_TABLE_NUM_ENTRIES);
+    }
+
     MemoryRef GetPointerForRasterizerCache(VAddr addr) const {
         if (addr >= LINEAR_HEAP_VADDR && addr < LINEAR_HEAP_VADDR_END) {
             return {fcram_mem, addr - LINEAR_HEAP_VADDR};
@@ -317,11 +391,14 @@ private:
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds.GetValue();
         ar & save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        // The rewind buffer stores the contents itself
+        if (system.SerializesStateRegions()) {
+            ar& boost::serialization::make_binary_object(vram, Memory::VRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                fcram, save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+            ar& boost::serialization::make_binary_object(
+                n3ds_extra_ram, save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        }
         ar & cache_marker;
         ar & page_table_list;
         // dsp is set from Core::System at startup
@@ -330,6 +407,12 @@ private:
         ar & vram_mem;
         ar & n3ds_extra_ram_mem;
         ar & dsp_mem;
+        if (Archive::is_loading::value) {
+            ++page_table_generation;
+            for (auto& page_table : page_table_list) {
+                AttachFastmem(*page_table);
+            }
+        }
     }
 };
 
@@ -378,12 +461,17 @@ SERIALIZE_IMPL(MemorySystem)
 
 void MemorySystem::SetCurrentPageTable(std::shared_ptr<PageTable> page_table) {
     impl->current_page_table = page_table;
+    ++impl->page_table_generation;
 }
 
 std::shared_ptr<PageTable> MemorySystem::GetCurrentPageTable() const {
     return impl->current_page_table;
 }
 
+u64 MemorySystem::GetPageTableGeneration() const {
+    return impl->page_table_generation;
+}
+
 void MemorySystem::RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode) {
     impl->RasterizerFlushVirtualRegion(start, size, mode);
 }
@@ -398,6 +486,9 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
                                      FlushMode::FlushAndInvalidate);
     }
 
+    ++impl->page_table_generation;
+
+    const u32 first_page = base;
     u32 end = base + size;
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at {:08X}", base);
@@ -415,6 +506,8 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
         if (memory != nullptr && memory.GetSize() > BORKED3DS_PAGE_SIZE)
             memory += BORKED3DS_PAGE_SIZE;
     }
+
+    impl->UpdateFastmem(page_table, first_page, size);
 }
 
 void MemorySystem::MapMemoryRegion(PageTable& page_table, VAddr base, u32 size, MemoryRef target) {
@@ -437,6 +530,7 @@ MemoryRef MemorySystem::GetPointerForRasterizerCache(VAddr addr) const {
 
 void MemorySystem::RegisterPageTable(std::shared_ptr<PageTable> page_table) {
     impl->page_table_list.push_back(page_table);
+    impl->AttachFastmem(*page_table);
 }
 
 void MemorySystem::UnregisterPageTable(std::shared_ptr<PageTable> page_table) {
@@ -645,6 +739,15 @@ MemoryRef MemorySystem::GetPhysicalRef(PAddr address) {
         return physical_ptr_cache.second;
     }
 
+    physical_ptr_cache = {address, LookupPhysicalRef(address)};
+    return physical_ptr_cache.second;
+}
+
+u8* MemorySystem::GetPhysicalPointerUncached(PAddr address) const {
+    return LookupPhysicalRef(address);
+}
+
+MemoryRef MemorySystem::LookupPhysicalRef(PAddr address) const {
     constexpr std::array memory_areas = {
         std::make_pair(VRAM_PADDR, VRAM_SIZE),
         std::make_pair(DSP_RAM_PADDR, DSP_RAM_SIZE),
@@ -661,8 +764,7 @@ MemoryRef MemorySystem::GetPhysicalRef(PAddr address) {
     if (area == memory_areas.end()) [[unlikely]] {
         LOG_ERROR(HW_Memory, "Unknown GetPhysicalPointer @ {:#08X} at PC {:#08X}", address,
                   impl->GetPC());
-        physical_ptr_cache = {address, {nullptr}};
-        return physical_ptr_cache.second;
+        return {nullptr};
     }
 
     u32 offset_into_region = address - area->first;
@@ -685,12 +787,10 @@ MemoryRef MemorySystem::GetPhysicalRef(PAddr address) {
         UNREACHABLE();
     }
     if (offset_into_region > target_mem->GetSize()) [[unlikely]] {
-        physical_ptr_cache = {address, {nullptr}};
-        return physical_ptr_cache.second;
+        return {nullptr};
     }
 
-    physical_ptr_cache = {address, {target_mem, offset_into_region}};
-    return physical_ptr_cache.second;
+    return {target_mem, offset_into_region};
 }
 
 std::vector<VAddr> MemorySystem::PhysicalToVirtualAddressForRasterizer(PAddr addr) {
@@ -727,14 +827,40 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         return;
     }
 
+    ++impl->page_table_generation;
+
     u32 num_pages =
         ((start + size - 1) >> BORKED3DS_PAGE_BITS) - (start >> BORKED3DS_PAGE_BITS) + 1;
     PAddr paddr = start;
 
+    // Each fastmem update is a host mapping call, collect the contiguous pages changed in each page
+    // table and alias of the physical address to update them at once.
+    struct FastmemRun {
+        u32 first_page;
+        u32 num_pages;
+    };
+    std::vector<std::array<FastmemRun, 2>> fastmem_runs(impl->page_table_list.size());
+    const auto update_fastmem = [this, &fastmem_runs](std::size_t table, std::size_t alias,
+                                                      u32 page) {
+        FastmemRun& run = fastmem_runs[table][alias];
+        if (run.num_pages != 0 && run.first_page + run.num_pages == page) {
+            ++run.num_pages;
+            return;
+        }
+        if (run.num_pages != 0) {
+            impl->UpdateFastmem(*impl->page_table_list[table], run.first_page, run.num_pages);
+        }
+        run = {page, 1};
+    };
+
     for (unsigned i = 0; i < num_pages; ++i, paddr += BORKED3DS_PAGE_SIZE) {
-        for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
+        const auto vaddrs = PhysicalToVirtualAddressForRasterizer(paddr);
+        ASSERT(vaddrs.size() <= 2);
+        for (std::size_t alias = 0; alias < vaddrs.size(); ++alias) {
+            const VAddr vaddr = vaddrs[alias];
             impl->cache_marker.Mark(vaddr, cached);
-            for (auto& page_table : impl->page_table_list) {
+            for (std::size_t table = 0; table < impl->page_table_list.size(); ++table) {
+                auto& page_table = impl->page_table_list[table];
                 PageType& page_type = page_table->attributes[vaddr >> BORKED3DS_PAGE_BITS];
 
                 if (cached) {
@@ -747,6 +873,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                     case PageType::Memory:
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> BORKED3DS_PAGE_BITS] = nullptr;
+                        update_fastmem(table, alias, vaddr >> BORKED3DS_PAGE_BITS);
                         break;
                     default:
                         UNREACHABLE();
@@ -762,6 +889,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::Memory;
                         page_table->pointers[vaddr >> BORKED3DS_PAGE_BITS] =
                             GetPointerForRasterizerCache(vaddr & ~BORKED3DS_PAGE_MASK);
+                        update_fastmem(table, alias, vaddr >> BORKED3DS_PAGE_BITS);
                         break;
                     }
                     default:
@@ -771,6 +899,14 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
             }
         }
     }
+
+    for (std::size_t table = 0; table < fastmem_runs.size(); ++table) {
+        for (const FastmemRun& run : fastmem_runs[table]) {
+            if (run.num_pages != 0) {
+                impl->UpdateFastmem(*impl->page_table_list[table], run.first_page, run.num_pages);
+            }
+        }
+    }
 }
 
 u8 MemorySystem::Read8(const VAddr addr) {
@@ -934,18 +1070,28 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) const {
-    ASSERT(pointer >= impl->fcram.get() && pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    ASSERT(pointer >= impl->fcram && pointer <= impl->fcram + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram);
 }
 
 u8* MemorySystem::GetFCRAMPointer(std::size_t offset) {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 const u8* MemorySystem::GetFCRAMPointer(std::size_t offset) const {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
+}
+
+std::array<std::span<u8>, 4> MemorySystem::GetStateRegions() {
+    const bool is_new_3ds = Settings::values.is_new_3ds.GetValue();
+    return {
+        std::span{impl->vram, VRAM_SIZE},
+        std::span{impl->fcram, is_new_3ds ? FCRAM_N3DS_SIZE : FCRAM_SIZE},
+        std::span{impl->n3ds_extra_ram, is_new_3ds ? N3DS_EXTRA_RAM_SIZE : 0},
+        std::span{impl->dsp->GetDspMemory()},
+    };
 }
 
 MemoryRef MemorySystem::GetFCRAMRef(std::size_t offset) const {
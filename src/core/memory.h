@@ -6,10 +6,12 @@
 #pragma once
 #include <array>
 #include <cstddef>
+#include <span>
 #include <string>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
+#include "common/host_memory.h"
 #include "common/memory_ref.h"
 
 namespace Kernel {
@@ -52,6 +54,9 @@ enum class PageType {
  * requires an indexed fetch and a check for NULL.
  */
 struct PageTable {
+    PageTable();
+    ~PageTable();
+
     /**
      * Array of memory pointers backing each page. An entry can only be non-null if the
      * corresponding entry in the `attributes` array is of type `Memory`.
@@ -103,6 +108,22 @@ struct PageTable {
 
     void Clear();
 
+    /**
+     * Host address range mirroring the pages that point into the emulated physical memory, so
+     * that the JIT can access them with plain host loads and stores (fastmem). Other pages are
+     * inaccessible in it. Set up by MemorySystem when the page table is registered, nullptr if
+     * the host can't provide it.
+     */
+    std::unique_ptr<Common::HostMemory::View> fastmem_view;
+
+    /**
+     * Incremented when the page table is reused for a new process running the same code, so that
+     * the JITs bound to it drop what they translated outside of that code.
+     */
+    u32 reuse_count = 0;
+    VAddr reused_code_start = 0;
+    u32 reused_code_size = 0;
+
 private:
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -257,6 +278,12 @@ public:
     void SetCurrentPageTable(std::shared_ptr<PageTable> page_table);
     std::shared_ptr<PageTable> GetCurrentPageTable() const;
 
+    /**
+     * Returns a counter incremented whenever the current page table or the pointers of any page
+     * table change. Host pointers looked up in the page table stay valid until it changes.
+     */
+    u64 GetPageTableGeneration() const;
+
     /**
      * Gets a pointer to the given address.
      *
@@ -526,6 +553,12 @@ public:
     /// Returns a reference to the memory region beginning at the specified physical address
     MemoryRef GetPhysicalRef(PAddr address);
 
+    /**
+     * Gets a pointer to the memory region beginning at the specified physical address without
+     * going through the lookup cache of GetPhysicalPointer, so it can be used from worker threads.
+     */
+    u8* GetPhysicalPointerUncached(PAddr address) const;
+
     /// Determines if the given VAddr is valid for the specified process.
     bool IsValidVirtualAddress(const Kernel::Process& process, VAddr vaddr);
 
@@ -544,6 +577,10 @@ public:
     /// Gets a serializable ref to FCRAM with the given offset
     MemoryRef GetFCRAMRef(std::size_t offset) const;
 
+    /// Returns the memory kept in save states: VRAM, FCRAM, the New 3DS extra RAM and DSP RAM.
+    /// The New 3DS parts of FCRAM and the extra RAM are only included on a New 3DS.
+    std::array<std::span<u8>, 4> GetStateRegions();
+
     /// Registers page table for rasterizer cache marking
     void RegisterPageTable(std::shared_ptr<PageTable> page_table);
 
@@ -572,6 +609,9 @@ private:
      */
     MemoryRef GetPointerForRasterizerCache(VAddr addr) const;
 
+    /// Finds the memory region beginning at the specified physical address.
+    MemoryRef LookupPhysicalRef(PAddr address) const;
+
     void MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef memory, PageType type);
 
     std::pair<PAddr, MemoryRef> physical_ptr_cache;
@@ -0,0 +1,224 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include "common/assert.h"
+#include "common/fast_hash.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/rewind_buffer.h"
+
+namespace Core {
+
+namespace {
+
+/// Fastest zstd level, most pages are either mostly zeros or small changes to code and data.
+constexpr s32 COMPRESSION_LEVEL = 1;
+
+std::span<const u8> AsBytes(const std::string& str) {
+    return {reinterpret_cast<const u8*>(str.data()), str.size()};
+}
+
+std::size_t RegionSize(std::span<u8> region) {
+    return region.size();
+}
+
+} // Anonymous namespace
+
+RewindBuffer::RewindBuffer(std::size_t memory_budget_)
+    : memory_budget{memory_budget_}, requested_budget{memory_budget_},
+      hash_workers{std::clamp(std::thread::hardware_concurrency() / 2, 1U, 4U),
+                   "RewindBuffer:Hash"} {}
+
+RewindBuffer::~RewindBuffer() = default;
+
+bool RewindBuffer::IsEncoding() const {
+    return encoding.load(std::memory_order_acquire);
+}
+
+void RewindBuffer::Push(std::string state, std::span<const std::span<u8>> regions) {
+    if (IsEncoding()) {
+        return;
+    }
+    if (!std::ranges::equal(regions, region_sizes, {}, RegionSize)) {
+        Reset(regions);
+    }
+
+    // Hash the pages on the workers, the emulation thread is paused so memory doesn't change.
+    const std::size_t num_pages = page_locations.size();
+    const std::size_t pages_per_worker =
+        (num_pages + hash_workers.NumWorkers() - 1) / hash_workers.NumWorkers();
+    for (std::size_t begin = 0; begin < num_pages; begin += pages_per_worker) {
+        const std::size_t end = std::min(begin + pages_per_worker, num_pages);
+        hash_workers.QueueWork([this, regions, begin, end] {
+            for (std::size_t i = begin; i < end; ++i) {
+                const PageLocation& location = page_locations[i];
+                new_hashes[i] = Common::FastHash64(
+                    regions[location.region].data() + location.offset, location.size);
+            }
+        });
+    }
+    hash_workers.WaitForRequests();
+
+    // Copy the pages that changed, all of them if there is no snapshot to compare to.
+    std::vector<Page> pages;
+    std::size_t raw_size = 0;
+    for (std::size_t i = 0; i < num_pages; ++i) {
+        if (page_hashes.empty() || page_hashes[i] != new_hashes[i]) {
+            pages.push_back({static_cast<u32>(i), new_hashes[i], {}});
+            raw_size += page_locations[i].size;
+        }
+    }
+    std::vector<u8> raw(raw_size);
+    std::size_t offset = 0;
+    for (const Page& page : pages) {
+        const PageLocation& location = page_locations[page.index];
+        std::memcpy(raw.data() + offset, regions[location.region].data() + location.offset,
+                    location.size);
+        offset += location.size;
+    }
+    page_hashes = new_hashes;
+
+    // Only one snapshot is queued at a time, which bounds the uncompressed copies to one.
+    encoding.store(true, std::memory_order_release);
+    worker.QueueWork([this, state = std::move(state), pages = std::move(pages),
+                      raw = std::move(raw)]() mutable {
+        Snapshot snapshot;
+        snapshot.state = Common::Compression::CompressDataZSTD(AsBytes(state), COMPRESSION_LEVEL);
+        snapshot.size = snapshot.state.size();
+
+        std::size_t offset = 0;
+        for (Page& page : pages) {
+            const std::size_t size = page_locations[page.index].size;
+            page.data = Common::Compression::CompressDataZSTD(
+                std::span{raw}.subspan(offset, size), COMPRESSION_LEVEL);
+            snapshot.size += sizeof(Page) + page.data.size();
+            offset += size;
+        }
+        snapshot.pages = std::move(pages);
+
+        snapshots_size += snapshot.size;
+        snapshots.push_back(std::move(snapshot));
+        while (snapshots.size() > 1 && snapshots_size > memory_budget) {
+            DropOldest();
+        }
+        encoding.store(false, std::memory_order_release);
+    });
+}
+
+std::optional<std::string> RewindBuffer::GetNewestState() {
+    worker.WaitForRequests();
+    if (snapshots.empty()) {
+        return std::nullopt;
+    }
+
+    const auto state = Common::Compression::DecompressDataZSTD(snapshots.back().state);
+    return std::string{reinterpret_cast<const char*>(state.data()), state.size()};
+}
+
+void RewindBuffer::Pop(std::span<const std::span<u8>> regions) {
+    worker.WaitForRequests();
+    if (snapshots.empty()) {
+        return;
+    }
+    ASSERT(std::ranges::equal(regions, region_sizes, {}, RegionSize));
+
+    // Each page is restored from the newest snapshot holding it, the oldest one holds all.
+    std::vector<bool> restored(page_locations.size());
+    for (auto it = snapshots.rbegin(); it != snapshots.rend(); ++it) {
+        for (const Page& page : it->pages) {
+            if (restored[page.index]) {
+                continue;
+            }
+            restored[page.index] = true;
+
+            const PageLocation& location = page_locations[page.index];
+            const auto data = Common::Compression::DecompressDataZSTD(page.data);
+            ASSERT(data.size() == location.size);
+            std::memcpy(regions[location.region].data() + location.offset, data.data(),
+                        location.size);
+        }
+    }
+
+    snapshots_size -= snapshots.back().size;
+    snapshots.pop_back();
+
+    // The next snapshot follows the one that is now the newest, compare against its pages.
+    page_hashes.clear();
+    if (!snapshots.empty()) {
+        page_hashes.resize(page_locations.size());
+        std::fill(restored.begin(), restored.end(), false);
+        for (auto it = snapshots.rbegin(); it != snapshots.rend(); ++it) {
+            for (const Page& page : it->pages) {
+                if (!restored[page.index]) {
+                    restored[page.index] = true;
+                    page_hashes[page.index] = page.hash;
+                }
+            }
+        }
+    }
+}
+
+std::size_t RewindBuffer::GetSize() {
+    worker.WaitForRequests();
+    return snapshots_size;
+}
+
+void RewindBuffer::Reset(std::span<const std::span<u8>> regions) {
+    worker.WaitForRequests();
+    snapshots.clear();
+    snapshots_size = 0;
+
+    region_sizes.clear();
+    page_locations.clear();
+    std::size_t total_size = 0;
+    for (std::size_t region = 0; region < regions.size(); ++region) {
+        const std::size_t size = regions[region].size();
+        for (std::size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+            page_locations.push_back({region, offset, std::min(PAGE_SIZE, size - offset)});
+        }
+        region_sizes.push_back(size);
+        total_size += size;
+    }
+    page_hashes.clear();
+    new_hashes.resize(page_locations.size());
+
+    memory_budget = std::max(requested_budget, total_size);
+    if (memory_budget != requested_budget) {
+        LOG_WARNING(Core, "Rewind buffer size raised to {} MiB to fit one state",
+                    memory_budget >> 20);
+    }
+}
+
+void RewindBuffer::DropOldest() {
+    Snapshot& oldest = snapshots[0];
+    Snapshot& next = snapshots[1];
+
+    // Keep the pages of the oldest snapshot that the next one doesn't replace.
+    std::vector<Page> pages;
+    pages.reserve(oldest.pages.size());
+    auto next_it = next.pages.begin();
+    for (Page& page : oldest.pages) {
+        while (next_it != next.pages.end() && next_it->index < page.index) {
+            pages.push_back(std::move(*next_it++));
+        }
+        if (next_it != next.pages.end() && next_it->index == page.index) {
+            pages.push_back(std::move(*next_it++));
+        } else {
+            next.size += sizeof(Page) + page.data.size();
+            snapshots_size += sizeof(Page) + page.data.size();
+            pages.push_back(std::move(page));
+        }
+    }
+    std::move(next_it, next.pages.end(), std::back_inserter(pages));
+    next.pages = std::move(pages);
+
+    snapshots_size -= oldest.size;
+    snapshots.pop_front();
+}
+
+} // namespace Core
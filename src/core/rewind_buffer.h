@@ -0,0 +1,107 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+
+namespace Core {
+
+/**
+ * Ring buffer of system snapshots used to step emulation back in time. A snapshot is made of the
+ * serialized state without the emulated memory, and of the pages of the memory regions. Pages are
+ * hashed on every push and only the ones that changed since the previous snapshot are copied, so
+ * the emulation thread pays for one read of the memory plus a copy of what was written to. The
+ * copies are compressed with a fast zstd level on a worker thread.
+ *
+ * The oldest snapshot holds every page, later ones only the pages that changed. Functions of this
+ * class must be called from the emulation thread.
+ */
+class RewindBuffer {
+public:
+    /// Size of the blocks of memory that are compared and stored
+    static constexpr std::size_t PAGE_SIZE = 0x1000;
+
+    /// @param memory_budget the number of bytes the snapshots may use, the oldest snapshots are
+    ///                      dropped once it is exceeded. It is raised to the size of the memory
+    ///                      regions, so that a full copy of them always fits.
+    explicit RewindBuffer(std::size_t memory_budget);
+    ~RewindBuffer();
+
+    /// Returns whether the previous snapshot is still being compressed, Push drops snapshots taken
+    /// in the meantime.
+    [[nodiscard]] bool IsEncoding() const;
+
+    /**
+     * Adds a snapshot as the newest one. Does nothing while IsEncoding() is true. The buffer is
+     * emptied when the sizes of the regions change.
+     * @param state the serialized state, without the contents of the memory regions
+     * @param regions the memory regions to store the changed pages of
+     */
+    void Push(std::string state, std::span<const std::span<u8>> regions);
+
+    /// Returns the serialized state of the newest snapshot, or std::nullopt if the buffer is empty.
+    [[nodiscard]] std::optional<std::string> GetNewestState();
+
+    /**
+     * Writes the memory of the newest snapshot into regions and removes it. The regions must have
+     * the sizes of the ones it was pushed with.
+     */
+    void Pop(std::span<const std::span<u8>> regions);
+
+    /// Returns the number of bytes the stored snapshots use
+    [[nodiscard]] std::size_t GetSize();
+
+private:
+    struct Page {
+        u32 index;
+        u64 hash;
+        std::vector<u8> data; ///< zstd compressed
+    };
+
+    struct Snapshot {
+        std::vector<u8> state;     ///< zstd compressed
+        std::vector<Page> pages; ///< Sorted by index
+        std::size_t size = 0;
+    };
+
+    struct PageLocation {
+        std::size_t region;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    /// Sets up the pages of regions with the given sizes, dropping every snapshot
+    void Reset(std::span<const std::span<u8>> regions);
+
+    /// Merges the pages still needed of the oldest snapshot into the next one and drops it
+    void DropOldest();
+
+    std::size_t memory_budget;
+    std::size_t requested_budget;
+
+    /// Written by the worker, read by the emulation thread after waiting for it
+    std::deque<Snapshot> snapshots; ///< Oldest first
+    std::size_t snapshots_size = 0;
+
+    /// Only used by the emulation thread
+    std::vector<std::size_t> region_sizes;
+    std::vector<PageLocation> page_locations;
+    std::vector<u64> page_hashes; ///< Hashes of the pages in the newest snapshot
+    std::vector<u64> new_hashes;
+
+    std::atomic<bool> encoding{false};
+    Common::ThreadWorker hash_workers;
+    Common::ThreadWorker worker{1, "RewindBuffer"};
+};
+
+} // namespace Core
@@ -4,13 +4,20 @@
 // Refer to the license.txt file included.
 
 #include <chrono>
+#include <cstdlib>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 #include <cryptopp/hex.h>
 #include <fmt/ranges.h>
 #include "common/archives.h"
+#include "common/delta_encoding.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/scope_exit.h"
 #include "common/scm_rev.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
@@ -19,6 +26,8 @@
 #include "core/savestate.h"
 #include "core/savestate_data.h"
 #include "network/network.h"
+#include "video_core/gpu.h"
+#include "video_core/renderer_base.h"
 
 namespace Core {
 
@@ -30,8 +39,9 @@ struct CSTHeader {
     u64_le time;                   /// The time when this save state was created
     std::array<u8, 20> build_name; /// The build name (Canary/Nightly) with the version number
     u32_le zero = 0;               /// Should be zero, just in case.
+    u64_le base_id;                /// The base state the data is a delta against, 0 if none
 
-    std::array<u8, 192> reserved{}; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 184> reserved{}; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CSTHeader) == 256, "CSTHeader should be 256 bytes");
 #pragma pack(pop)
@@ -49,6 +59,108 @@ static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
     }
 }
 
+static std::string GetSaveStateBasePrefix(u64 program_id, u64 movie_id) {
+    if (movie_id) {
+        return fmt::format("{:016X}.movie{:016X}.base", program_id, movie_id);
+    } else {
+        return fmt::format("{:016X}.base", program_id);
+    }
+}
+
+static std::string GetSaveStateBasePath(u64 program_id, u64 movie_id, u64 base_id) {
+    return fmt::format("{}{}{:016X}.cst", FileUtil::GetUserPath(FileUtil::UserPath::StatesDir),
+                       GetSaveStateBasePrefix(program_id, movie_id), base_id);
+}
+
+static std::span<const u8> AsBytes(const std::string& str) {
+    return {reinterpret_cast<const u8*>(str.data()), str.size()};
+}
+
+static CSTHeader MakeSaveStateHeader(u64 program_id) {
+    CSTHeader header{};
+    header.filetype = header_magic_bytes;
+    header.program_id = program_id;
+    std::string rev_bytes;
+    CryptoPP::StringSource ss(Common::g_scm_rev, true,
+                              new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
+    std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(header.revision));
+    header.time = std::chrono::duration_cast<std::chrono::seconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+    const std::string build_fullname = Common::g_build_fullname;
+    std::memset(header.build_name.data(), 0, sizeof(header.build_name));
+    std::memcpy(header.build_name.data(), build_fullname.c_str(),
+                std::min(build_fullname.length(), sizeof(header.build_name) - 1));
+    return header;
+}
+
+static void WriteSaveStateFile(const std::string& path, const CSTHeader& header,
+                               std::span<const u8> data) {
+    const auto buffer = Common::Compression::CompressDataZSTDDefault(data);
+
+    if (!FileUtil::CreateFullPath(path)) {
+        throw std::runtime_error("Could not create path " + path);
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file) {
+        throw std::runtime_error("Could not open file " + path);
+    }
+
+    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
+        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+        throw std::runtime_error("Could not write to file " + path);
+    }
+}
+
+static std::vector<u8> ReadSaveStateFile(const std::string& path, CSTHeader& header) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file || file.GetSize() < sizeof(header)) {
+        throw std::runtime_error("Could not open file at " + path);
+    }
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+
+    std::vector<u8> buffer(file.GetSize() - sizeof(header));
+    if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
+    return Common::Compression::DecompressDataZSTD(buffer);
+}
+
+/// Deletes the base states of a game that no save state slot is a delta against anymore.
+static void DeleteUnusedSaveStateBases(u64 program_id, u64 movie_id) {
+    std::unordered_set<u64> used_bases;
+    for (u32 slot = 0; slot <= SaveStateSlotCount; ++slot) {
+        FileUtil::IOFile file(GetSaveStatePath(program_id, movie_id, slot), "rb");
+        CSTHeader header;
+        if (file && file.ReadBytes(&header, sizeof(header)) == sizeof(header)) {
+            used_bases.insert(header.base_id);
+        }
+    }
+
+    const auto states_dir = FileUtil::GetUserPath(FileUtil::UserPath::StatesDir);
+    const auto prefix = GetSaveStateBasePrefix(program_id, movie_id);
+    std::vector<std::string> unused;
+    FileUtil::ForeachDirectoryEntry(
+        nullptr, states_dir,
+        [&](u64*, const std::string&, const std::string& virtual_name) {
+            if (virtual_name.size() == prefix.size() + 20 && virtual_name.starts_with(prefix) &&
+                virtual_name.ends_with(".cst")) {
+                const u64 base_id =
+                    std::strtoull(virtual_name.c_str() + prefix.size(), nullptr, 16);
+                if (!used_bases.contains(base_id)) {
+                    unused.push_back(states_dir + virtual_name);
+                }
+            }
+            return true;
+        });
+    for (const auto& path : unused) {
+        FileUtil::Delete(path);
+    }
+}
+
 static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64 program_id,
                               u64 movie_id) {
     const auto path = GetSaveStatePath(program_id, movie_id, info.slot);
@@ -123,7 +235,7 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
+void System::SaveState(u32 slot) {
     if (app_loader) {
         if (!app_loader->SupportsSaveStates()) {
             throw std::runtime_error("The current app loader doesn't support save states");
@@ -131,44 +243,57 @@ void System::SaveState(u32 slot) const {
     }
 
     std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
-
-    const std::string& str{sstream.str()};
-    const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
+    {
+        // Serialize
+        oarchive oa{sstream};
+        oa&* this;
+    }
 
     const u64 movie_id = movie.GetCurrentMovieID();
     const auto path = GetSaveStatePath(title_id, movie_id, slot);
-    if (!FileUtil::CreateFullPath(path)) {
-        throw std::runtime_error("Could not create path " + path);
-    }
+    auto header = MakeSaveStateHeader(title_id);
 
-    FileUtil::IOFile file(path, "wb");
-    if (!file) {
-        throw std::runtime_error("Could not open file " + path);
+    if (!Settings::values.incremental_save_states.GetValue()) {
+        WriteSaveStateFile(path, header, AsBytes(sstream.str()));
+        return;
     }
 
-    CSTHeader header{};
-    header.filetype = header_magic_bytes;
-    header.program_id = title_id;
-    std::string rev_bytes;
-    CryptoPP::StringSource ss(Common::g_scm_rev, true,
-                              new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
-    std::memcpy(header.revision.data(), rev_bytes.data(), sizeof(header.revision));
-    header.time = std::chrono::duration_cast<std::chrono::seconds>(
-                      std::chrono::system_clock::now().time_since_epoch())
-                      .count();
-    const std::string build_fullname = Common::g_build_fullname;
-    std::memset(header.build_name.data(), 0, sizeof(header.build_name));
-    std::memcpy(header.build_name.data(), build_fullname.c_str(),
-                std::min(build_fullname.length(), sizeof(header.build_name) - 1));
-
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
-        throw std::runtime_error("Could not write to file " + path);
+    // Only serialization needs the emulation to be stopped, encoding and writing the state
+    // happens in the background while the game keeps running.
+    if (!savestate_worker) {
+        savestate_worker = std::make_unique<Common::ThreadWorker>(1, "SaveState");
     }
+    auto state = std::make_shared<const std::string>(std::move(sstream).str());
+    savestate_worker->QueueWork([this, state = std::move(state), path, header,
+                                 program_id = title_id, movie_id]() mutable {
+        try {
+            // Consecutive states of a game mostly differ in a few pages of memory, so they are
+            // stored as a delta against a shared base. A new base is started once the state
+            // drifted so far from it that the delta stops paying off.
+            std::vector<u8> delta;
+            if (savestate_base && savestate_base->program_id == program_id &&
+                savestate_base->movie_id == movie_id) {
+                delta = Common::Delta::Encode(AsBytes(*savestate_base->data), AsBytes(*state));
+            }
+            if (delta.empty() || delta.size() > state->size() / 2) {
+                // Zero marks a full state in the header, so keep it out of the base ids.
+                const u64 base_id = Common::ComputeHash64(state->data(), state->size()) | 1;
+                WriteSaveStateFile(GetSaveStateBasePath(program_id, movie_id, base_id),
+                                   MakeSaveStateHeader(program_id), AsBytes(*state));
+                savestate_base = SaveStateBase{program_id, movie_id, base_id, state};
+                delta = Common::Delta::Encode(AsBytes(*state), AsBytes(*state));
+            }
+
+            header.base_id = savestate_base->id;
+            WriteSaveStateFile(path, header, delta);
+            DeleteUnusedSaveStateBases(program_id, movie_id);
+            LOG_INFO(Core, "Wrote save state {} as a {} byte delta", path, delta.size());
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error writing save state {}: {}", path, e.what());
+            std::scoped_lock lock{signal_mutex};
+            savestate_error = e.what();
+        }
+    });
 }
 
 void System::LoadState(u32 slot) {
@@ -181,20 +306,18 @@ void System::LoadState(u32 slot) {
         throw std::runtime_error("Unable to load while connected to multiplayer");
     }
 
+    // The slot may still be written in the background.
+    if (savestate_worker) {
+        savestate_worker->WaitForRequests();
+    }
+
     const u64 movie_id = movie.GetCurrentMovieID();
     const auto path = GetSaveStatePath(title_id, movie_id, slot);
 
     std::vector<u8> decompressed;
     {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
-
-        FileUtil::IOFile file(path, "rb");
-
-        // load header
         CSTHeader header;
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            throw std::runtime_error("Could not read from file at " + path);
-        }
+        decompressed = ReadSaveStateFile(path, header);
 
         // validate header
         SaveStateInfo info;
@@ -203,10 +326,26 @@ void System::LoadState(u32 slot) {
             throw std::runtime_error("Invalid savestate");
         }
 
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+        if (header.base_id != 0) {
+            if (!savestate_base || savestate_base->id != header.base_id ||
+                savestate_base->program_id != title_id || savestate_base->movie_id != movie_id) {
+                const auto base_path = GetSaveStateBasePath(title_id, movie_id, header.base_id);
+                CSTHeader base_header;
+                const auto base = ReadSaveStateFile(base_path, base_header);
+                if (base_header.filetype != header_magic_bytes ||
+                    (Common::ComputeHash64(base.data(), base.size()) | 1) != header.base_id) {
+                    throw std::runtime_error("Invalid savestate base " + base_path);
+                }
+                savestate_base = SaveStateBase{
+                    title_id, movie_id, header.base_id,
+                    std::make_shared<const std::string>(base.begin(), base.end())};
+            }
+            auto target = Common::Delta::Decode(AsBytes(*savestate_base->data), decompressed);
+            if (!target) {
+                throw std::runtime_error("Savestate doesn't match its base");
+            }
+            decompressed = std::move(*target);
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
     }
     std::istringstream sstream{
         std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
@@ -218,4 +357,44 @@ void System::LoadState(u32 slot) {
     ia&* this;
 }
 
+void System::CaptureRewindState() {
+    std::ostringstream sstream{std::ios_base::binary};
+    serialize_state_regions = false;
+    SCOPE_EXIT({ serialize_state_regions = true; });
+    try {
+        oarchive oa{sstream};
+        oa&* this;
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error capturing rewind state, disabling rewind: {}", e.what());
+        rewind_buffer.reset();
+        return;
+    }
+
+    rewind_buffer->Push(std::move(sstream).str(), memory->GetStateRegions());
+}
+
+void System::Rewind() {
+    if (!rewind_buffer) {
+        throw std::runtime_error("Rewinding is disabled");
+    }
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        throw std::runtime_error("Unable to rewind while connected to multiplayer");
+    }
+
+    auto state = rewind_buffer->GetNewestState();
+    if (!state) {
+        throw std::runtime_error("No state to rewind to");
+    }
+    std::istringstream sstream{std::move(*state), std::ios_base::binary};
+
+    // Deserialize, then restore the memory of the newly created memory system
+    serialize_state_regions = false;
+    SCOPE_EXIT({ serialize_state_regions = true; });
+    iarchive ia{sstream};
+    ia&* this;
+    rewind_buffer->Pop(memory->GetStateRegions());
+
+    rewind_frame = gpu->Renderer().GetCurrentFrame();
+}
+
 } // namespace Core
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "common/common_types.h"
@@ -21,6 +22,14 @@ struct SaveStateInfo {
     std::string build_name;
 };
 
+/// Full state that incremental save states of a game are stored as a delta against
+struct SaveStateBase {
+    u64 program_id;
+    u64 movie_id;
+    u64 id;
+    std::shared_ptr<const std::string> data;
+};
+
 constexpr u32 SaveStateSlotCount = 11; // Maximum count of savestate slots
 
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id);
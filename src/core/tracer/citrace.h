@@ -11,6 +11,11 @@ namespace CiTrace {
 
 // NOTE: Things are stored in little-endian
 
+// File layout: CTHeader, the initial state and the stream. Since version 2 the stream is split in
+// zstd compressed chunks written while recording, indexed by a CTChunk array at the end of the
+// file that CTFooter points to. An uncompressed chunk holds the memory contents first loaded by
+// its elements, followed by the elements themselves.
+
 #pragma pack(1)
 
 struct CTHeader {
@@ -19,7 +24,7 @@ struct CTHeader {
     }
 
     static u32 ExpectedVersion() {
-        return 1;
+        return 2;
     }
 
     char magic[4];
@@ -57,8 +62,28 @@ struct CTHeader {
         // - Lookup tables for procedural textures
     } initial_state_offsets;
 
-    u32 stream_offset;
-    u32 stream_size;
+    u32 stream_offset; ///< Offset of the first chunk
+    u32 stream_size;   ///< Number of stream elements
+};
+
+struct CTChunk {
+    u64 file_offset; ///< Offset of the compressed chunk in the file
+    u32 compressed_size;
+    u32 uncompressed_size;
+    u32 elements_offset; ///< Offset of the stream elements in the uncompressed chunk
+    u32 first_element;   ///< Index of the first element of the chunk in the stream
+    u32 first_frame;     ///< Number of frames finished before the chunk starts
+    u32 pad;
+};
+
+struct CTFooter {
+    static const char* ExpectedMagicWord() {
+        return "CiTi";
+    }
+
+    u64 chunks_offset; ///< Offset of the CTChunk array
+    u32 num_chunks;
+    char magic[4];
 };
 
 enum CTStreamElementType : u32 {
@@ -68,10 +93,10 @@ enum CTStreamElementType : u32 {
 };
 
 struct CTMemoryLoad {
-    u32 file_offset;
+    u32 file_offset; ///< Offset of the memory contents in the uncompressed chunk
     u32 size;
     u32 physical_address;
-    u32 pad;
+    u32 chunk; ///< Index of the chunk holding the memory contents
 };
 
 struct CTRegisterWrite {
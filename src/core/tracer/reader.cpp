@@ -0,0 +1,165 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/tracer/reader.h"
+
+namespace CiTrace {
+
+namespace {
+
+/// Number of decompressed chunks kept around, memory loads may refer to earlier chunks.
+constexpr std::size_t CHUNK_CACHE_SIZE = 4;
+
+} // Anonymous namespace
+
+Reader::Reader(const std::string& filename) : file{filename, "rb"} {
+    try {
+        if (file.ReadAtBytes(&header, sizeof(header), 0) != sizeof(header))
+            throw "Failed to read header";
+        if (std::memcmp(header.magic, CTHeader::ExpectedMagicWord(), 4) != 0 ||
+            header.version != CTHeader::ExpectedVersion())
+            throw "Unsupported file format";
+
+        CTFooter footer;
+        const u64 size = file.GetSize();
+        if (size < sizeof(footer) ||
+            file.ReadAtBytes(&footer, sizeof(footer), size - sizeof(footer)) != sizeof(footer) ||
+            std::memcmp(footer.magic, CTFooter::ExpectedMagicWord(), 4) != 0)
+            throw "Failed to read footer";
+
+        // Don't trust the footer with the size of allocations
+        const u64 chunks_size = u64{footer.num_chunks} * sizeof(CTChunk);
+        const u64 chunks_end = size - sizeof(footer);
+        if (footer.chunks_offset < sizeof(header) || footer.chunks_offset > chunks_end ||
+            chunks_size > chunks_end - footer.chunks_offset)
+            throw "Invalid chunk index";
+
+        chunks.resize(footer.num_chunks);
+        if (file.ReadAtBytes(chunks.data(), chunks_size, footer.chunks_offset) != chunks_size)
+            throw "Failed to read chunk index";
+        for (const CTChunk& chunk : chunks) {
+            if (chunk.elements_offset > chunk.uncompressed_size ||
+                chunk.file_offset > footer.chunks_offset ||
+                chunk.compressed_size > footer.chunks_offset - chunk.file_offset)
+                throw "Invalid chunk";
+        }
+    } catch (const char* str) {
+        LOG_ERROR(HW_GPU, "Reading CiTrace file failed: {}", str);
+        chunks.clear();
+        return;
+    }
+    valid = true;
+}
+
+Recorder::InitialState Reader::ReadInitialState() {
+    const auto& initial = header.initial_state_offsets;
+    const auto read = [this](std::vector<u32>& data, u32 offset, u32 size) {
+        data.resize(size);
+        if (file.ReadAtBytes(data.data(), size * sizeof(u32), offset) != size * sizeof(u32)) {
+            LOG_ERROR(HW_GPU, "Reading CiTrace file failed: Failed to read initial state");
+            data.clear();
+        }
+    };
+
+    Recorder::InitialState state;
+    read(state.lcd_registers, initial.lcd_registers, initial.lcd_registers_size);
+    read(state.pica_registers, initial.pica_registers, initial.pica_registers_size);
+    read(state.default_attributes, initial.default_attributes, initial.default_attributes_size);
+    read(state.vs_program_binary, initial.vs_program_binary, initial.vs_program_binary_size);
+    read(state.vs_swizzle_data, initial.vs_swizzle_data, initial.vs_swizzle_data_size);
+    read(state.vs_float_uniforms, initial.vs_float_uniforms, initial.vs_float_uniforms_size);
+    read(state.gs_program_binary, initial.gs_program_binary, initial.gs_program_binary_size);
+    read(state.gs_swizzle_data, initial.gs_swizzle_data, initial.gs_swizzle_data_size);
+    read(state.gs_float_uniforms, initial.gs_float_uniforms, initial.gs_float_uniforms_size);
+    return state;
+}
+
+void Reader::SeekToFrame(u32 frame) {
+    // A chunk may start in the middle of a frame, so start from the last chunk that started
+    // before the frame and skip the remaining elements of the frames before it.
+    const auto it = std::partition_point(chunks.begin(), chunks.end(), [frame](const CTChunk& c) {
+        return c.first_frame < frame;
+    });
+    current_chunk = static_cast<u32>(std::max(it - chunks.begin(), std::ptrdiff_t{1}) - 1);
+    current_element = 0;
+    if (current_chunk >= chunks.size()) {
+        return;
+    }
+
+    u32 frames = chunks[current_chunk].first_frame;
+    while (frames < frame) {
+        const auto element = Next();
+        if (!element) {
+            return;
+        }
+        frames += element->type == FrameMarker;
+    }
+}
+
+std::optional<CTStreamElement> Reader::Next() {
+    while (current_chunk < chunks.size()) {
+        const CTChunk& chunk = chunks[current_chunk];
+        const u32 num_elements =
+            (chunk.uncompressed_size - chunk.elements_offset) / sizeof(CTStreamElement);
+        if (current_element < num_elements) {
+            const auto& data = GetChunk(current_chunk);
+            const std::size_t offset =
+                chunk.elements_offset + std::size_t{current_element} * sizeof(CTStreamElement);
+            if (offset + sizeof(CTStreamElement) > data.size()) {
+                break;
+            }
+            CTStreamElement element;
+            std::memcpy(&element, data.data() + offset, sizeof(CTStreamElement));
+            ++current_element;
+            return element;
+        }
+        ++current_chunk;
+        current_element = 0;
+    }
+    return std::nullopt;
+}
+
+std::span<const u8> Reader::GetMemory(const CTMemoryLoad& memory_load) {
+    if (memory_load.chunk >= chunks.size()) {
+        return {};
+    }
+    const auto& data = GetChunk(memory_load.chunk);
+    if (u64{memory_load.file_offset} + memory_load.size > data.size()) {
+        return {};
+    }
+    return std::span{data}.subspan(memory_load.file_offset, memory_load.size);
+}
+
+const std::vector<u8>& Reader::GetChunk(u32 index) {
+    const auto it = std::find_if(chunk_cache.begin(), chunk_cache.end(),
+                                 [index](const auto& cached) { return cached.first == index; });
+    if (it != chunk_cache.end()) {
+        chunk_cache.splice(chunk_cache.begin(), chunk_cache, it);
+        return chunk_cache.front().second;
+    }
+
+    const CTChunk& chunk = chunks[index];
+    std::vector<u8> compressed(chunk.compressed_size);
+    std::vector<u8> data;
+    if (file.ReadAtBytes(compressed.data(), compressed.size(), chunk.file_offset) ==
+        compressed.size()) {
+        data = Common::Compression::DecompressDataZSTD(compressed);
+    }
+    if (data.size() != chunk.uncompressed_size) {
+        LOG_ERROR(HW_GPU, "Reading CiTrace file failed: Chunk {} is corrupted", index);
+        data.clear();
+    }
+
+    if (chunk_cache.size() >= CHUNK_CACHE_SIZE) {
+        chunk_cache.pop_back();
+    }
+    chunk_cache.emplace_front(index, std::move(data));
+    return chunk_cache.front().second;
+}
+
+} // namespace CiTrace
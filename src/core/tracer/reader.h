@@ -0,0 +1,66 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "core/tracer/citrace.h"
+#include "core/tracer/recorder.h"
+
+namespace CiTrace {
+
+/**
+ * Reads back a CiTrace written by the Recorder. Chunks are decompressed on demand, so playback can
+ * start at any frame without loading the whole trace.
+ */
+class Reader {
+public:
+    explicit Reader(const std::string& filename);
+
+    /// Returns true if the file is a valid trace.
+    [[nodiscard]] bool IsValid() const {
+        return valid;
+    }
+
+    /// Reads the state the GPU was in when the recording started.
+    [[nodiscard]] Recorder::InitialState ReadInitialState();
+
+    /// Returns the number of elements in the stream.
+    [[nodiscard]] u32 NumElements() const {
+        return header.stream_size;
+    }
+
+    /// Moves to the first stream element after the given number of finished frames.
+    void SeekToFrame(u32 frame);
+
+    /// Returns the next stream element, or std::nullopt at the end of the stream.
+    [[nodiscard]] std::optional<CTStreamElement> Next();
+
+    /// Returns the memory contents loaded by a MemoryLoad element. They stay valid until the next
+    /// call to a function of the reader.
+    [[nodiscard]] std::span<const u8> GetMemory(const CTMemoryLoad& memory_load);
+
+private:
+    /// Returns the uncompressed contents of a chunk, keeping the last few in a cache.
+    const std::vector<u8>& GetChunk(u32 index);
+
+    FileUtil::IOFile file;
+    CTHeader header{};
+    std::vector<CTChunk> chunks;
+    bool valid = false;
+
+    std::list<std::pair<u32, std::vector<u8>>> chunk_cache; ///< Most recently used first
+
+    u32 current_chunk = 0;
+    u32 current_element = 0; ///< Index of the next element in the current chunk
+};
+
+} // namespace CiTrace
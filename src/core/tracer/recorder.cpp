@@ -4,191 +4,221 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <span>
 #include "common/assert.h"
-#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/zstd_compression.h"
 #include "core/tracer/recorder.h"
 
 namespace CiTrace {
 
-Recorder::Recorder(const InitialState& initial_state) : initial_state(initial_state) {}
+namespace {
+
+/// A chunk is flushed at the end of the first frame after it reaches this size.
+constexpr std::size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+/// A chunk is flushed in the middle of a frame once it reaches this size.
+constexpr std::size_t MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+
+/// Fast zstd level, the trace is compressed while the game is running.
+constexpr s32 CHUNK_COMPRESSION_LEVEL = 3;
+
+} // Anonymous namespace
+
+Recorder::Recorder(const InitialState& initial_state, std::string scratch_path_)
+    : scratch_path{std::move(scratch_path_)} {
+    if (scratch_path.empty()) {
+        scratch_path = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + "citrace.ctf.part";
+    }
 
-void Recorder::Finish(const std::string& filename) {
     // Setup CiTrace header
-    CTHeader header;
     std::memcpy(header.magic, CTHeader::ExpectedMagicWord(), 4);
     header.version = CTHeader::ExpectedVersion();
     header.header_size = sizeof(CTHeader);
 
     // Calculate file offsets
     auto& initial = header.initial_state_offsets;
-
+    u32 offset = sizeof(CTHeader);
+    const auto place = [&offset](u32& field_offset, u32& field_size, const std::vector<u32>& data) {
+        field_offset = offset;
+        field_size = static_cast<u32>(data.size());
+        offset += field_size * sizeof(u32);
+    };
+    initial.gpu_registers = offset;
     initial.gpu_registers_size = 0;
-    initial.pica_registers_size = static_cast<u32>(initial_state.pica_registers.size());
-    initial.lcd_registers_size = static_cast<u32>(initial_state.lcd_registers.size());
-    initial.default_attributes_size = static_cast<u32>(initial_state.default_attributes.size());
-    initial.vs_program_binary_size = static_cast<u32>(initial_state.vs_program_binary.size());
-    initial.vs_swizzle_data_size = static_cast<u32>(initial_state.vs_swizzle_data.size());
-    initial.vs_float_uniforms_size = static_cast<u32>(initial_state.vs_float_uniforms.size());
-    initial.gs_program_binary_size = static_cast<u32>(initial_state.gs_program_binary.size());
-    initial.gs_swizzle_data_size = static_cast<u32>(initial_state.gs_swizzle_data.size());
-    initial.gs_float_uniforms_size = static_cast<u32>(initial_state.gs_float_uniforms.size());
-    header.stream_size = static_cast<u32>(stream.size());
-
-    initial.gpu_registers = sizeof(header);
-    initial.lcd_registers = initial.gpu_registers + initial.gpu_registers_size * sizeof(u32);
-    initial.pica_registers = initial.lcd_registers + initial.lcd_registers_size * sizeof(u32);
-    ;
-    initial.default_attributes = initial.pica_registers + initial.pica_registers_size * sizeof(u32);
-    initial.vs_program_binary =
-        initial.default_attributes + initial.default_attributes_size * sizeof(u32);
-    initial.vs_swizzle_data =
-        initial.vs_program_binary + initial.vs_program_binary_size * sizeof(u32);
-    initial.vs_float_uniforms =
-        initial.vs_swizzle_data + initial.vs_swizzle_data_size * sizeof(u32);
-    initial.gs_program_binary =
-        initial.vs_float_uniforms + initial.vs_float_uniforms_size * sizeof(u32);
-    initial.gs_swizzle_data =
-        initial.gs_program_binary + initial.gs_program_binary_size * sizeof(u32);
-    initial.gs_float_uniforms =
-        initial.gs_swizzle_data + initial.gs_swizzle_data_size * sizeof(u32);
-    header.stream_offset = initial.gs_float_uniforms + initial.gs_float_uniforms_size * sizeof(u32);
-
-    // Iterate through stream elements, update relevant stream element data
-    for (auto& stream_element : stream) {
-        switch (stream_element.data.type) {
-        case MemoryLoad: {
-            auto& file_offset = memory_regions[stream_element.hash];
-            if (!stream_element.uses_existing_data) {
-                file_offset = header.stream_offset;
+    place(initial.lcd_registers, initial.lcd_registers_size, initial_state.lcd_registers);
+    place(initial.pica_registers, initial.pica_registers_size, initial_state.pica_registers);
+    place(initial.default_attributes, initial.default_attributes_size,
+          initial_state.default_attributes);
+    place(initial.vs_program_binary, initial.vs_program_binary_size,
+          initial_state.vs_program_binary);
+    place(initial.vs_swizzle_data, initial.vs_swizzle_data_size, initial_state.vs_swizzle_data);
+    place(initial.vs_float_uniforms, initial.vs_float_uniforms_size,
+          initial_state.vs_float_uniforms);
+    place(initial.gs_program_binary, initial.gs_program_binary_size,
+          initial_state.gs_program_binary);
+    place(initial.gs_swizzle_data, initial.gs_swizzle_data_size, initial_state.gs_swizzle_data);
+    place(initial.gs_float_uniforms, initial.gs_float_uniforms_size,
+          initial_state.gs_float_uniforms);
+    header.stream_offset = offset;
+
+    worker.QueueWork([this, initial_state] {
+        try {
+            // Open file and write header, the stream size is filled in by Finish.
+            file = FileUtil::IOFile(scratch_path, "wb");
+            if (file.WriteObject(header) != 1)
+                throw "Failed to write header";
+
+            // Write initial state
+            for (const auto* data :
+                 {&initial_state.lcd_registers, &initial_state.pica_registers,
+                  &initial_state.default_attributes, &initial_state.vs_program_binary,
+                  &initial_state.vs_swizzle_data, &initial_state.vs_float_uniforms,
+                  &initial_state.gs_program_binary, &initial_state.gs_swizzle_data,
+                  &initial_state.gs_float_uniforms}) {
+                if (file.WriteArray(data->data(), data->size()) != data->size())
+                    throw "Failed to write initial state";
             }
-            stream_element.data.memory_load.file_offset = file_offset;
-            break;
+            if (file.Tell() != header.stream_offset)
+                throw "Unexpected end of initial state";
+        } catch (const char* str) {
+            LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
+            write_failed = true;
         }
+    });
+}
 
-        default:
-            // Other commands don't use any extra data
-            DEBUG_ASSERT(stream_element.extra_data.size() == 0);
-            break;
-        }
-        header.stream_offset += static_cast<u32>(stream_element.extra_data.size());
+Recorder::~Recorder() {
+    worker.WaitForRequests();
+    if (!finished) {
+        file.Close();
+        FileUtil::Delete(scratch_path);
     }
+}
+
+void Recorder::Finish(const std::string& filename) {
+    FlushChunk();
+    worker.WaitForRequests();
+    finished = true;
 
     try {
-        // Open file and write header
-        FileUtil::IOFile file(filename, "wb");
-        std::size_t written = file.WriteObject(header);
-        if (written != 1 || file.Tell() != initial.gpu_registers)
+        if (write_failed)
+            throw "Failed to write stream";
+
+        // Write the chunk index and the footer
+        CTFooter footer{};
+        footer.chunks_offset = file.Tell();
+        footer.num_chunks = static_cast<u32>(chunks.size());
+        std::memcpy(footer.magic, CTFooter::ExpectedMagicWord(), 4);
+        if (file.WriteArray(chunks.data(), chunks.size()) != chunks.size() ||
+            file.WriteObject(footer) != 1)
+            throw "Failed to write chunk index";
+
+        // Fill in the size of the stream
+        header.stream_size = num_elements;
+        if (!file.Seek(0, SEEK_SET) || file.WriteObject(header) != 1)
             throw "Failed to write header";
+        file.Close();
 
-        // Write initial state
-        written = file.WriteArray(initial_state.pica_registers.data(),
-                                  initial_state.pica_registers.size());
-        if (written != initial_state.pica_registers.size() ||
-            file.Tell() != initial.default_attributes)
-            throw "Failed to write Pica registers";
-
-        written =
-            file.WriteArray(initial_state.lcd_registers.data(), initial_state.lcd_registers.size());
-        if (written != initial_state.lcd_registers.size() || file.Tell() != initial.pica_registers)
-            throw "Failed to write LCD registers";
-
-        written = file.WriteArray(initial_state.default_attributes.data(),
-                                  initial_state.default_attributes.size());
-        if (written != initial_state.default_attributes.size() ||
-            file.Tell() != initial.vs_program_binary)
-            throw "Failed to write default vertex attributes";
-
-        written = file.WriteArray(initial_state.vs_program_binary.data(),
-                                  initial_state.vs_program_binary.size());
-        if (written != initial_state.vs_program_binary.size() ||
-            file.Tell() != initial.vs_swizzle_data)
-            throw "Failed to write vertex shader program binary";
-
-        written = file.WriteArray(initial_state.vs_swizzle_data.data(),
-                                  initial_state.vs_swizzle_data.size());
-        if (written != initial_state.vs_swizzle_data.size() ||
-            file.Tell() != initial.vs_float_uniforms)
-            throw "Failed to write vertex shader swizzle data";
-
-        written = file.WriteArray(initial_state.vs_float_uniforms.data(),
-                                  initial_state.vs_float_uniforms.size());
-        if (written != initial_state.vs_float_uniforms.size() ||
-            file.Tell() != initial.gs_program_binary)
-            throw "Failed to write vertex shader float uniforms";
-
-        written = file.WriteArray(initial_state.gs_program_binary.data(),
-                                  initial_state.gs_program_binary.size());
-        if (written != initial_state.gs_program_binary.size() ||
-            file.Tell() != initial.gs_swizzle_data)
-            throw "Failed to write geomtry shader program binary";
-
-        written = file.WriteArray(initial_state.gs_swizzle_data.data(),
-                                  initial_state.gs_swizzle_data.size());
-        if (written != initial_state.gs_swizzle_data.size() ||
-            file.Tell() != initial.gs_float_uniforms)
-            throw "Failed to write geometry shader swizzle data";
-
-        written = file.WriteArray(initial_state.gs_float_uniforms.data(),
-                                  initial_state.gs_float_uniforms.size());
-        if (written != initial_state.gs_float_uniforms.size() ||
-            file.Tell() != initial.gs_float_uniforms + sizeof(u32) * initial.gs_float_uniforms_size)
-            throw "Failed to write geometry shader float uniforms";
-
-        // Iterate through stream elements, write "extra data"
-        for (const auto& stream_element : stream) {
-            if (stream_element.extra_data.size() == 0)
-                continue;
-
-            written =
-                file.WriteBytes(stream_element.extra_data.data(), stream_element.extra_data.size());
-            if (written != stream_element.extra_data.size())
-                throw "Failed to write extra data";
+        // Renaming fails when the destination exists on some platforms, or is on another device.
+        if (FileUtil::Exists(filename)) {
+            FileUtil::Delete(filename);
         }
-
-        if (file.Tell() != header.stream_offset)
-            throw "Unexpected end of extra data";
-
-        // Write actual stream elements
-        for (const auto& stream_element : stream) {
-            if (1 != file.WriteObject(stream_element.data))
-                throw "Failed to write stream element";
+        if (!FileUtil::Rename(scratch_path, filename)) {
+            if (!FileUtil::Copy(scratch_path, filename))
+                throw "Failed to move trace to its destination";
         }
     } catch (const char* str) {
         LOG_ERROR(HW_GPU, "Writing CiTrace file failed: {}", str);
     }
+
+    file.Close();
+    FileUtil::Delete(scratch_path);
 }
 
 void Recorder::FrameFinished() {
-    stream.push_back({{FrameMarker}});
+    current_chunk.elements.push_back({FrameMarker});
+    ++num_elements;
+    ++num_frames;
+
+    if (current_chunk.memory.size() +
+            current_chunk.elements.size() * sizeof(CTStreamElement) >=
+        CHUNK_SIZE) {
+        FlushChunk();
+    }
 }
 
 void Recorder::MemoryAccessed(const u8* data, u32 size, u32 physical_address) {
-    StreamElement element = {{MemoryLoad}};
-    element.data.memory_load.size = size;
-    element.data.memory_load.physical_address = physical_address;
-
-    // Compute hash over given memory region to check if the contents are already stored internally
-    boost::crc_32_type result;
-    result.process_bytes(data, size);
-    element.hash = result.checksum();
-
-    element.uses_existing_data = (memory_regions.find(element.hash) != memory_regions.end());
-    if (!element.uses_existing_data) {
-        element.extra_data.resize(size);
-        std::memcpy(element.extra_data.data(), data, size);
-        memory_regions.insert({element.hash, 0}); // file offset will be initialized in Finish()
+    CTStreamElement element{MemoryLoad};
+    element.memory_load.size = size;
+    element.memory_load.physical_address = physical_address;
+
+    // Compute hash over given memory region to check if the contents are already stored
+    const u64 hash = Common::ComputeHash64(data, size);
+    auto [it, inserted] = memory_regions.try_emplace(hash);
+    if (inserted || it->second.size != size) {
+        it->second = {num_chunks, static_cast<u32>(current_chunk.memory.size()), size};
+        current_chunk.memory.insert(current_chunk.memory.end(), data, data + size);
     }
+    element.memory_load.chunk = it->second.chunk;
+    element.memory_load.file_offset = it->second.offset;
+
+    current_chunk.elements.push_back(element);
+    ++num_elements;
 
-    stream.push_back(element);
+    if (current_chunk.memory.size() >= MAX_CHUNK_SIZE) {
+        FlushChunk();
+    }
 }
 
 void Recorder::RegisterWritten(u32 physical_address, u32 value) {
-    StreamElement element = {{RegisterWrite}};
-    element.data.register_write.physical_address = physical_address;
-    element.data.register_write.value = value;
+    CTStreamElement element{RegisterWrite};
+    element.register_write.physical_address = physical_address;
+    element.register_write.value = value;
+
+    current_chunk.elements.push_back(element);
+    ++num_elements;
+}
 
-    stream.push_back(element);
+void Recorder::FlushChunk() {
+    if (current_chunk.elements.empty()) {
+        return;
+    }
+
+    worker.QueueWork([this, chunk = std::move(current_chunk)] { WriteChunk(chunk); });
+    ++num_chunks;
+    current_chunk = {};
+    current_chunk.first_element = num_elements;
+    current_chunk.first_frame = num_frames;
+}
+
+void Recorder::WriteChunk(const Chunk& chunk) {
+    if (write_failed) {
+        return;
+    }
+
+    const auto elements = std::as_bytes(std::span{chunk.elements});
+    std::vector<u8> data;
+    data.reserve(chunk.memory.size() + elements.size());
+    data.insert(data.end(), chunk.memory.begin(), chunk.memory.end());
+    data.insert(data.end(), reinterpret_cast<const u8*>(elements.data()),
+                reinterpret_cast<const u8*>(elements.data()) + elements.size());
+    const auto compressed =
+        Common::Compression::CompressDataZSTD(data, CHUNK_COMPRESSION_LEVEL);
+
+    CTChunk& entry = chunks.emplace_back();
+    entry.file_offset = file.Tell();
+    entry.compressed_size = static_cast<u32>(compressed.size());
+    entry.uncompressed_size = static_cast<u32>(data.size());
+    entry.elements_offset = static_cast<u32>(chunk.memory.size());
+    entry.first_element = chunk.first_element;
+    entry.first_frame = chunk.first_frame;
+
+    if (file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(HW_GPU, "Writing CiTrace file failed: Failed to write chunk");
+        write_failed = true;
+    }
 }
 
 } // namespace CiTrace
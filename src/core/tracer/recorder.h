@@ -8,8 +8,9 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <boost/crc.hpp>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/thread_worker.h"
 #include "core/tracer/citrace.h"
 
 namespace CiTrace {
@@ -29,10 +30,16 @@ public:
     };
 
     /**
-     * Recorder constructor
+     * Recorder constructor. The trace is streamed to a scratch file while recording, compressed
+     * on a worker thread, so long captures don't have to fit in memory.
      * @param initial_state Initial recorder state
+     * @param scratch_path File the trace is written to until it is saved. A file in the cache
+     *                     directory is used if empty.
      */
-    explicit Recorder(const InitialState& initial_state);
+    explicit Recorder(const InitialState& initial_state, std::string scratch_path = {});
+
+    /// Discards the trace if it wasn't saved.
+    ~Recorder();
 
     /// Finish recording of this CiTrace and save it using the given filename.
     void Finish(const std::string& filename);
@@ -54,33 +61,45 @@ public:
     void RegisterWritten(u32 physical_address, u32 value);
 
 private:
-    // Initial state of recording start
-    InitialState initial_state;
+    /// Stream elements and memory contents of the chunk being recorded.
+    struct Chunk {
+        std::vector<u8> memory;
+        std::vector<CTStreamElement> elements;
+        u32 first_element = 0;
+        u32 first_frame = 0;
+    };
 
-    // Command stream
-    struct StreamElement {
-        CTStreamElement data;
+    /// Location of memory contents stored in the trace.
+    struct StoredMemory {
+        u32 chunk;
+        u32 offset;
+        u32 size;
+    };
 
-        /**
-         * Extra data to store along "core" data.
-         * This is e.g. used for data used in MemoryUpdates.
-         */
-        std::vector<u8> extra_data;
+    /// Hands the current chunk to the worker to be compressed and written, then starts a new one.
+    void FlushChunk();
 
-        /// Optional CRC hash (e.g. for hashing memory regions)
-        boost::crc_32_type::value_type hash;
+    /// Writes a compressed chunk at the end of the file. Called on the worker.
+    void WriteChunk(const Chunk& chunk);
 
-        /// If true, refer to data already written to the output file instead of extra_data
-        bool uses_existing_data;
-    };
+    std::string scratch_path;
+    bool finished = false;
 
-    std::vector<StreamElement> stream;
+    Chunk current_chunk;
+    u32 num_chunks = 0;
+    u32 num_elements = 0;
+    u32 num_frames = 0;
 
-    /**
-     * Internal cache which maps hashes of memory contents to file offsets at which those memory
-     * contents are stored.
-     */
-    std::unordered_map<boost::crc_32_type::value_type /*hash*/, u32 /*file_offset*/> memory_regions;
+    /// Maps a 64-bit hash of memory contents to where they are stored.
+    std::unordered_map<u64, StoredMemory> memory_regions;
+
+    // Only accessed by the worker while recording.
+    FileUtil::IOFile file;
+    CTHeader header{};
+    std::vector<CTChunk> chunks;
+    bool write_failed = false;
+
+    Common::ThreadWorker worker{1, "CiTrace"};
 };
 
 } // namespace CiTrace
@@ -0,0 +1,44 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "common/logging/binary_log.h"
+#include "common/logging/text_formatter.h"
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " <binary log file> [output file]\n"
+              << "Decodes a binary log written with binary_log enabled. The messages are written\n"
+                 "to the output file, or to the standard output if none is given.\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        PrintHelp(argv[0]);
+        return 1;
+    }
+
+    Common::Log::BinaryLogReader reader{argv[1]};
+    if (!reader.IsValid()) {
+        std::cerr << "Could not read the binary log file " << argv[1] << '\n';
+        return 1;
+    }
+
+    std::ofstream output_file;
+    if (argc == 3) {
+        output_file.open(argv[2]);
+        if (!output_file) {
+            std::cerr << "Could not open the output file " << argv[2] << '\n';
+            return 1;
+        }
+    }
+    std::ostream& output = argc == 3 ? output_file : std::cout;
+
+    while (const auto entry = reader.Next()) {
+        output << Common::Log::FormatLogMessage(*entry) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,245 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/filter.h"
+#include "audio_core/hle/mixers.h"
+#include "audio_core/interpolate.h"
+
+using namespace AudioCore;
+
+namespace {
+
+constexpr u64 scale_factor = 1 << 24;
+constexpr u64 scale_mask = scale_factor - 1;
+
+/// The scalar linear interpolation the vectorized kernels have to reproduce.
+void ReferenceLinear(AudioInterp::State& state, AudioInterp::StereoBuffer16& input, float rate,
+                     StereoFrame16& output, std::size_t& outputi) {
+    if (input.empty()) {
+        return;
+    }
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+        const u64 fraction = fposition & scale_mask;
+        const auto& x0 = input[inputi];
+        const auto& x1 = input[inputi + 1];
+        std::array<s16, 2> sample;
+        for (std::size_t i = 0; i < 2; i++) {
+            const s64 delta = std::clamp<s64>(x1[i] - x0[i], -32768, 32767);
+            sample[i] = static_cast<s16>(x0[i] + fraction * delta / scale_factor);
+        }
+        output[outputi++] = sample;
+        fposition += step_size;
+    }
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
+/// The scalar biquad filter, one sample at a time.
+struct ReferenceBiquad {
+    explicit ReferenceBiquad(const HLE::SourceConfiguration::Configuration::BiquadFilter& config)
+        : a1{config.a1}, a2{config.a2}, b0{config.b0}, b1{config.b1}, b2{config.b2} {}
+
+    s32 a1, a2, b0, b1, b2;
+    std::array<s16, 2> x1{}, x2{}, y1{}, y2{};
+
+    void ProcessFrame(StereoFrame16& frame) {
+        for (auto& x0 : frame) {
+            std::array<s16, 2> y0;
+            for (std::size_t i = 0; i < 2; i++) {
+                const s32 tmp =
+                    (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
+                y0[i] = static_cast<s16>(std::clamp(tmp, -32768, 32767));
+            }
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            x0 = y0;
+        }
+    }
+};
+
+std::array<s16, 2> RandomSample(std::mt19937& rng) {
+    return {static_cast<s16>(rng()), static_cast<s16>(rng())};
+}
+
+HLE::SourceConfiguration::Configuration::BiquadFilter MakeBiquadConfig(s16 b0, s16 b1, s16 b2,
+                                                                       s16 a1, s16 a2) {
+    HLE::SourceConfiguration::Configuration::BiquadFilter config;
+    config.b0 = b0;
+    config.b1 = b1;
+    config.b2 = b2;
+    config.a1 = a1;
+    config.a2 = a2;
+    return config;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Linear interpolation matches the scalar reference", "[audio_core][hle]") {
+    std::mt19937 rng{1};
+    for (u32 iteration = 0; iteration < 500; iteration++) {
+        const float rate = iteration % 4 == 0 ? 1.0f : 0.05f + (rng() % 4000) / 1000.0f;
+        AudioInterp::State state, expected_state;
+        AudioInterp::StereoBuffer16 input, expected_input;
+        for (u32 call = 0; call < 10; call++) {
+            for (u32 i = rng() % 200; i > 0; i--) {
+                const auto sample = RandomSample(rng);
+                input.push_back(sample);
+                expected_input.push_back(sample);
+            }
+            StereoFrame16 output{}, expected_output{};
+            std::size_t outputi = rng() % samples_per_frame;
+            std::size_t expected_outputi = outputi;
+            AudioInterp::Linear(state, input, rate, output, outputi);
+            ReferenceLinear(expected_state, expected_input, rate, expected_output,
+                            expected_outputi);
+            REQUIRE(outputi == expected_outputi);
+            REQUIRE(output == expected_output);
+            REQUIRE(input == expected_input);
+            REQUIRE(state.fposition == expected_state.fposition);
+        }
+    }
+}
+
+TEST_CASE("Polyphase interpolation", "[audio_core][hle]") {
+    std::mt19937 rng{2};
+
+    SECTION("passes samples through at unity rate") {
+        std::vector<std::array<s16, 2>> samples(samples_per_frame);
+        std::generate(samples.begin(), samples.end(), [&rng] { return RandomSample(rng); });
+        AudioInterp::State state;
+        AudioInterp::StereoBuffer16 input(samples.begin(), samples.end());
+        StereoFrame16 output{};
+        std::size_t outputi = 0;
+        AudioInterp::Polyphase(state, input, 1.0f, output, outputi);
+        // There is a two-sample predelay.
+        REQUIRE(outputi == samples_per_frame);
+        constexpr std::array<s16, 2> silence{};
+        REQUIRE(output[0] == silence);
+        REQUIRE(std::equal(samples.begin(), samples.end() - 2, output.begin() + 2));
+    }
+
+    SECTION("keeps a constant signal constant") {
+        for (const s16 value : {s16{32767}, s16{-32768}, s16{1234}}) {
+            AudioInterp::State state;
+            state.xn1 = state.xn2 = state.xn3 = {value, value};
+            AudioInterp::StereoBuffer16 input(400, {value, value});
+            StereoFrame16 output{};
+            std::size_t outputi = 0;
+            AudioInterp::Polyphase(state, input, 0.37f + (rng() % 100) / 100.0f, output, outputi);
+            REQUIRE(outputi == samples_per_frame);
+            const std::array<s16, 2> expected{value, value};
+            for (const auto& sample : output) {
+                REQUIRE(sample == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Biquad filter matches the scalar reference", "[audio_core][hle]") {
+    std::mt19937 rng{3};
+    for (u32 iteration = 0; iteration < 200; iteration++) {
+        const auto config = MakeBiquadConfig(static_cast<s16>(rng()), static_cast<s16>(rng()),
+                                             static_cast<s16>(rng()), static_cast<s16>(rng()),
+                                             static_cast<s16>(rng()));
+        HLE::SourceFilters filters;
+        filters.Enable(false, true);
+        filters.Configure(config);
+        ReferenceBiquad reference{config};
+        for (u32 frame_index = 0; frame_index < 4; frame_index++) {
+            StereoFrame16 frame;
+            std::generate(frame.begin(), frame.end(), [&rng] { return RandomSample(rng); });
+            StereoFrame16 expected = frame;
+            filters.ProcessFrame(frame);
+            reference.ProcessFrame(expected);
+            REQUIRE(frame == expected);
+        }
+    }
+}
+
+TEST_CASE("HLE sample processing benchmark", "[.][audio_core][hle][benchmark]") {
+    // A busy scene: 24 voices resampled from 32 kHz and filtered, then mixed down.
+    constexpr std::size_t num_voices = 24;
+    constexpr float rate = 32728.0f / 32000.0f;
+    std::mt19937 rng{4};
+    std::vector<std::array<s16, 2>> pcm(samples_per_frame * 2);
+    std::generate(pcm.begin(), pcm.end(), [&rng] { return RandomSample(rng); });
+    const auto config = MakeBiquadConfig(0x2000, 0x1000, 0x800, 0x400, -0x200);
+
+    std::array<AudioInterp::State, num_voices> states{};
+    std::array<HLE::SourceFilters, num_voices> filters;
+    std::vector<ReferenceBiquad> reference_filters(num_voices, ReferenceBiquad{config});
+    for (auto& filter : filters) {
+        filter.Enable(false, true);
+        filter.Configure(config);
+    }
+
+    const auto run_voices = [&](auto&& interpolate, auto&& filter) {
+        s32 sum = 0;
+        for (std::size_t voice = 0; voice < num_voices; voice++) {
+            AudioInterp::StereoBuffer16 input(pcm.begin(), pcm.end());
+            StereoFrame16 frame{};
+            std::size_t outputi = 0;
+            interpolate(states[voice], input, rate, frame, outputi);
+            filter(voice, frame);
+            sum += frame[voice][0];
+        }
+        return sum;
+    };
+
+    BENCHMARK("Voices reference") {
+        return run_voices(ReferenceLinear, [&](std::size_t voice, StereoFrame16& frame) {
+            reference_filters[voice].ProcessFrame(frame);
+        });
+    };
+    BENCHMARK("Voices linear") {
+        return run_voices(AudioInterp::Linear, [&](std::size_t voice, StereoFrame16& frame) {
+            filters[voice].ProcessFrame(frame);
+        });
+    };
+    BENCHMARK("Voices polyphase") {
+        return run_voices(AudioInterp::Polyphase, [&](std::size_t voice, StereoFrame16& frame) {
+            filters[voice].ProcessFrame(frame);
+        });
+    };
+
+    HLE::Mixers mixers;
+    HLE::DspConfiguration dsp_config{};
+    dsp_config.aux_bus_enable[0] = 1;
+    dsp_config.aux_bus_enable[1] = 1;
+    dsp_config.aux_bus_enable_0_dirty.Assign(1);
+    dsp_config.aux_bus_enable_1_dirty.Assign(1);
+    HLE::IntermediateMixSamples read_samples{};
+    HLE::IntermediateMixSamples write_samples{};
+    std::array<QuadFrame32, 3> input{};
+    for (auto& mix : input) {
+        for (auto& sample : mix) {
+            std::generate(sample.begin(), sample.end(), [&rng] { return s32{s16(rng())}; });
+        }
+    }
+    BENCHMARK("Mixers") {
+        mixers.Tick(dsp_config, read_samples, write_samples, input);
+        return mixers.GetOutput()[0][0];
+    };
+}
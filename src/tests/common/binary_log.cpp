@@ -0,0 +1,122 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/logging/binary_log.h"
+
+using namespace Common::Log;
+
+namespace {
+
+template <typename... Args>
+std::string EncodeAndFormat(std::string_view format, const Args&... args) {
+    BinaryArgsWriter writer;
+    (writer.Write(args), ...);
+    return FormatBinaryMessage(format, writer.Data());
+}
+
+template <typename... Args>
+bool FormatsLikeFmt(std::string_view format, const Args&... args) {
+    return EncodeAndFormat(format, args...) == fmt::vformat(format, fmt::make_format_args(args...));
+}
+
+enum class TestEnum : u16 { Value = 0x1234 };
+
+} // Anonymous namespace
+
+TEST_CASE("Binary log arguments are formatted like fmt", "[common][logging]") {
+    const std::string str = "string";
+    const std::string_view str_view = "view";
+    const char* c_str = "c string";
+    const void* ptr = &str;
+
+    REQUIRE(FormatsLikeFmt("{} {} {}", 1, -2, 3U));
+    REQUIRE(FormatsLikeFmt("{:08X} {:#x}", u32{0xDEADBEEF}, u64{0x123456789ABCDEF0}));
+    REQUIRE(FormatsLikeFmt("{} {}", s8{-5}, u8{200}));
+    REQUIRE(FormatsLikeFmt("{:.3f} {}", 1.5f, 2.25));
+    REQUIRE(FormatsLikeFmt("{} {} {}", true, false, 'c'));
+    REQUIRE(FormatsLikeFmt("{} {} {} {}", str, str_view, c_str, "literal"));
+    REQUIRE(FormatsLikeFmt("{}", ptr));
+    REQUIRE(EncodeAndFormat("{:#x}", TestEnum::Value) == "0x1234");
+}
+
+TEST_CASE("Binary log arguments that don't fit are truncated", "[common][logging]") {
+    const std::string long_str(MAX_BINARY_ARGS_SIZE * 2, 'a');
+    const std::string message = EncodeAndFormat("{}", long_str);
+    REQUIRE(!message.empty());
+    REQUIRE(message.size() < MAX_BINARY_ARGS_SIZE);
+    REQUIRE(long_str.starts_with(message));
+
+    // Arguments past the end of the buffer are missing altogether
+    REQUIRE(EncodeAndFormat("{} {}", long_str, 1).ends_with("<missing arguments>"));
+}
+
+TEST_CASE("Binary log files can be decoded", "[common][logging]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "borked3ds_test_log.bin").string();
+
+    static constexpr std::string_view format = "Value {:#x} of {}";
+    const auto make_entry = [](u32 line_num, u32 value, std::string_view name) {
+        BinaryEntry entry{
+            .timestamp = std::chrono::microseconds{line_num * 10},
+            .filename = "core/test.cpp",
+            .function = "Test",
+            .format = format.data(),
+            .format_size = static_cast<u32>(format.size()),
+            .line_num = line_num,
+            .log_class = Class::Core,
+            .log_level = Level::Debug,
+        };
+        BinaryArgsWriter writer;
+        writer.Write(value);
+        writer.Write(name);
+        const auto args = writer.Data();
+        entry.args_size = static_cast<u16>(args.size());
+        std::copy(args.begin(), args.end(), entry.args.begin());
+        return entry;
+    };
+
+    {
+        BinaryLogWriter writer{path};
+        writer.Write(make_entry(1, 0x10, "first"));
+        writer.Write(make_entry(2, 0x20, "second"));
+        writer.WriteDropped(3);
+        writer.Write(make_entry(4, 0x40, "third"));
+    }
+
+    BinaryLogReader reader{path};
+    REQUIRE(reader.IsValid());
+
+    const auto first = reader.Next();
+    REQUIRE(first.has_value());
+    REQUIRE(first->timestamp.count() == 10);
+    REQUIRE(first->log_class == Class::Core);
+    REQUIRE(first->log_level == Level::Debug);
+    REQUIRE(std::string{first->filename} == "core/test.cpp");
+    REQUIRE(first->line_num == 1);
+    REQUIRE(first->function == "Test");
+    REQUIRE(first->message == "Value 0x10 of first");
+
+    const auto second = reader.Next();
+    REQUIRE(second.has_value());
+    REQUIRE(second->message == "Value 0x20 of second");
+
+    const auto dropped = reader.Next();
+    REQUIRE(dropped.has_value());
+    REQUIRE(dropped->log_level == Level::Warning);
+    REQUIRE(dropped->message == "3 messages were dropped");
+
+    const auto third = reader.Next();
+    REQUIRE(third.has_value());
+    REQUIRE(third->line_num == 4);
+    REQUIRE(third->message == "Value 0x40 of third");
+
+    REQUIRE(!reader.Next().has_value());
+
+    FileUtil::Delete(path);
+}
@@ -0,0 +1,74 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/delta_encoding.h"
+
+namespace Common::Delta {
+
+namespace {
+
+std::vector<u8> RandomData(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Delta round trips", "[common]") {
+    const auto base = RandomData(64 * BLOCK_SIZE + 123, 1);
+
+    SECTION("identical") {
+        const auto delta = Encode(base, base);
+        REQUIRE(delta.size() < 256);
+        REQUIRE(Decode(base, delta) == base);
+    }
+
+    SECTION("modified in place") {
+        auto target = base;
+        target[5 * BLOCK_SIZE + 17] ^= 0xFF;
+        target[40 * BLOCK_SIZE] ^= 0xFF;
+        const auto delta = Encode(base, target);
+        REQUIRE(delta.size() < 3 * BLOCK_SIZE);
+        REQUIRE(Decode(base, delta) == target);
+    }
+
+    SECTION("shifted") {
+        // Bytes inserted near the start move the rest of the data off the block grid.
+        auto target = base;
+        const auto inserted = RandomData(37, 2);
+        target.insert(target.begin() + 1000, inserted.begin(), inserted.end());
+        const auto delta = Encode(base, target);
+        REQUIRE(delta.size() < 3 * BLOCK_SIZE);
+        REQUIRE(Decode(base, delta) == target);
+    }
+
+    SECTION("unrelated") {
+        const auto target = RandomData(10 * BLOCK_SIZE + 5, 3);
+        REQUIRE(Decode(base, Encode(base, target)) == target);
+    }
+
+    SECTION("empty") {
+        REQUIRE(Decode(base, Encode(base, {})) == std::vector<u8>{});
+        REQUIRE(Decode({}, Encode({}, base)) == base);
+    }
+}
+
+TEST_CASE("Delta rejects corrupt data", "[common]") {
+    const auto base = RandomData(8 * BLOCK_SIZE, 4);
+    auto delta = Encode(base, base);
+
+    REQUIRE(!Decode(base, std::span{delta}.first(delta.size() - 1)));
+    REQUIRE(!Decode(std::span{base}.first(4 * BLOCK_SIZE), delta));
+    delta[0] ^= 1;
+    REQUIRE(!Decode(base, delta));
+}
+
+} // namespace Common::Delta
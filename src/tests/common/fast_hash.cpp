@@ -0,0 +1,36 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/fast_hash.h"
+
+namespace Common {
+
+TEST_CASE("FastHash64 depends on every byte", "[common]") {
+    std::mt19937 rng{1};
+    std::vector<u8> data(3 * 1024 + 77);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+
+    // Lengths around the stripe and block boundaries.
+    std::unordered_set<u64> hashes;
+    for (const std::size_t len : {0, 1, 127, 128, 129, 1023, 1024, 1025, 2048, 3077}) {
+        const u64 hash = FastHash64(data.data(), len);
+        REQUIRE(hash == FastHash64(data.data(), len));
+        REQUIRE(hashes.insert(hash).second);
+    }
+
+    const u64 hash = FastHash64(data.data(), data.size());
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] ^= 1 << (i % 8);
+        REQUIRE(FastHash64(data.data(), data.size()) != hash);
+        data[i] ^= 1 << (i % 8);
+    }
+}
+
+} // namespace Common
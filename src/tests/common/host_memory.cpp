@@ -0,0 +1,52 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "common/host_memory.h"
+
+namespace Common {
+
+constexpr std::size_t BACKING_SIZE = 0x10000;
+constexpr std::size_t VIEW_SIZE = 0x100000;
+
+TEST_CASE("HostMemory backing is zeroed", "[common]") {
+    HostMemory memory{BACKING_SIZE};
+    const u8* const backing = memory.BackingBasePointer();
+    for (std::size_t i = 0; i < BACKING_SIZE; ++i) {
+        REQUIRE(backing[i] == 0);
+    }
+    REQUIRE(memory.IsInBacking(backing + BACKING_SIZE - 1));
+    REQUIRE(!memory.IsInBacking(backing + BACKING_SIZE));
+}
+
+TEST_CASE("HostMemory views mirror the backing memory", "[common]") {
+    HostMemory memory{BACKING_SIZE};
+    auto view = memory.CreateView(VIEW_SIZE);
+    if (!view) {
+        // The host doesn't support fastmem
+        REQUIRE(!memory.IsMappable());
+        return;
+    }
+
+    u8* const backing = memory.BackingBasePointer();
+    u8* const base = view->BasePointer();
+    view->Map(0x80000, 0x3000, 0x2000);
+    view->Map(0x1000, 0x3000, 0x1000);
+
+    backing[0x3010] = 0x12;
+    REQUIRE(base[0x80010] == 0x12);
+    REQUIRE(base[0x1010] == 0x12);
+
+    base[0x81020] = 0x34;
+    REQUIRE(backing[0x4020] == 0x34);
+
+    // Remapping and unmapping leave the backing memory alone
+    view->Unmap(0x80000, 0x1000);
+    view->Map(0x80000, 0x5000, 0x1000);
+    REQUIRE(base[0x80010] == 0);
+    REQUIRE(base[0x1010] == 0x12);
+    REQUIRE(backing[0x3010] == 0x12);
+}
+
+} // namespace Common
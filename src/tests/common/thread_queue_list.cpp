@@ -0,0 +1,78 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_queue_list.h"
+
+namespace {
+
+struct Element : Common::ThreadQueueListHook<Element> {
+    bool can_schedule = true;
+};
+
+using Queue = Common::ThreadQueueList<Element, 64>;
+
+} // Anonymous namespace
+
+TEST_CASE("ThreadQueueList pops by priority, then in order", "[common]") {
+    Queue queue;
+    Element low, first, second, front;
+    queue.push_back(40, &low);
+    queue.push_back(10, &first);
+    queue.push_back(10, &second);
+    queue.push_front(10, &front);
+
+    REQUIRE(queue.contains(&low) == 40);
+    REQUIRE(queue.get_first() == &front);
+    REQUIRE(queue.pop_first() == &front);
+    REQUIRE(queue.pop_first() == &first);
+    REQUIRE(queue.pop_first() == &second);
+    REQUIRE(queue.empty(10));
+    REQUIRE(queue.pop_first() == &low);
+    REQUIRE(queue.pop_first() == nullptr);
+    REQUIRE(queue.contains(&low) == static_cast<Queue::Priority>(-1));
+}
+
+TEST_CASE("ThreadQueueList pop_first_better", "[common]") {
+    Queue queue;
+    Element a, b, c;
+    queue.push_back(63, &a);
+    queue.push_back(20, &b);
+    queue.push_back(20, &c);
+
+    REQUIRE(queue.pop_first_better(20) == nullptr);
+    REQUIRE(queue.pop_first_better(21) == &b);
+
+    // Skipped elements keep their place
+    c.can_schedule = false;
+    const auto can_schedule = [](const Element* element) { return element->can_schedule; };
+    REQUIRE(queue.pop_first(can_schedule) == &a);
+    REQUIRE(queue.get_first() == &c);
+}
+
+TEST_CASE("ThreadQueueList move, remove and rotate", "[common]") {
+    Queue queue;
+    Element a, b, c;
+    queue.push_back(5, &a);
+    queue.push_back(5, &b);
+    queue.push_back(5, &c);
+
+    queue.rotate(5);
+    REQUIRE(queue.get_first() == &b);
+
+    queue.remove(5, &c);
+    queue.move(&b, 5, 0);
+    REQUIRE(queue.pop_first() == &b);
+    REQUIRE(queue.pop_first() == &a);
+    REQUIRE(queue.pop_first() == nullptr);
+
+    // Removing elements that aren't queued at the priority does nothing
+    queue.push_back(3, &a);
+    queue.remove(4, &a);
+    queue.remove(3, &b);
+    REQUIRE(queue.contains(&a) == 3);
+    queue.clear();
+    REQUIRE(queue.get_first() == nullptr);
+    REQUIRE(queue.contains(&a) == static_cast<Queue::Priority>(-1));
+}
@@ -0,0 +1,152 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "core/cheats/gateway_cheat.h"
+#include "core/core.h"
+#include "core/memory.h"
+
+using Cheats::GatewayCheat;
+
+namespace {
+
+constexpr VAddr BASE_VADDR = Memory::HEAP_VADDR;
+constexpr u32 MAPPED_SIZE = 0x10000;
+
+void FillRandom(Memory::MemorySystem& memory, u32 seed) {
+    std::mt19937 rng{seed};
+    u8* data = memory.GetPointer(BASE_VADDR);
+    std::generate_n(data, MAPPED_SIZE, [&rng] { return static_cast<u8>(rng()); });
+}
+
+/// Location of the pointer loaded by the test code.
+constexpr u32 POINTER_OFFSET = 0x100;
+
+// Static writes and compares, a pointer, a loop with incrementive writes and a patch.
+constexpr const char* TEST_CODE = R"(D3000000 08000000
+00000010 DEADBEEF
+10000014 00001234
+20000016 00000056
+50000010 DEADBEEF
+20000020 000000AA
+D0000000 00000000
+60000010 DEADBEEF
+00000024 11111111
+D0000000 00000000
+90000014 00FF1234
+00000028 22222222
+D0000000 00000000
+B0000100 00000000
+0000000C 33333333
+D3000000 08000000
+D5000000 00000007
+C0000000 00000003
+DA000000 00000200
+D4000000 00000001
+D1000000 00000000
+D2000000 00000000
+D3000000 08000000
+E0000300 0000000B
+01020304 05060708
+090A0B0C 0D0E0F10
+D9000010 00000000
+D6000000 00000400
+DC000000 00000010
+D8000000 00000400
+30000010 00000000
+D2000000 00000000
+D0000000 00000000
+70000014 00001233
+DB000016 00000000
+D7000000 00000500)";
+
+} // Anonymous namespace
+
+TEST_CASE("Compiled Gateway cheats match the interpreter", "[core][cheats]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    auto page_table = std::make_shared<Memory::PageTable>();
+    memory.MapMemoryRegion(*page_table, BASE_VADDR, MAPPED_SIZE, memory.GetFCRAMRef(0));
+    memory.SetCurrentPageTable(page_table);
+
+    const GatewayCheat cheat{"test", TEST_CODE, ""};
+    const auto run = [&](auto&& execute) {
+        FillRandom(memory, 1);
+        memory.Write32(BASE_VADDR + POINTER_OFFSET, BASE_VADDR + 0x800);
+        execute();
+        const u8* data = memory.GetPointer(BASE_VADDR);
+        return std::vector<u8>(data, data + MAPPED_SIZE);
+    };
+
+    const auto expected = run([&] { cheat.Interpret(system, memory); });
+    REQUIRE(run([&] { cheat.Execute(system, memory); }) == expected);
+    // The second run uses the host pointers resolved by the first one.
+    REQUIRE(run([&] { cheat.Execute(system, memory); }) == expected);
+}
+
+TEST_CASE("Compiled Gateway cheats follow remapped pages", "[core][cheats]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    auto page_table = std::make_shared<Memory::PageTable>();
+    memory.MapMemoryRegion(*page_table, BASE_VADDR, MAPPED_SIZE, memory.GetFCRAMRef(0));
+    memory.SetCurrentPageTable(page_table);
+
+    const GatewayCheat cheat{"test", "08000010 CAFEBABE\n18000020 00001234", ""};
+    const auto check = [&](u32 fcram_offset) {
+        u8* fcram = memory.GetFCRAMPointer(fcram_offset);
+        std::fill_n(fcram, MAPPED_SIZE, 0);
+        cheat.Execute(system, memory);
+        REQUIRE(memory.Read32(BASE_VADDR + 0x10) == 0xCAFEBABE);
+        REQUIRE(memory.Read16(BASE_VADDR + 0x20) == 0x1234);
+        REQUIRE(fcram[0x10] == 0xBE);
+        REQUIRE(fcram[0x20] == 0x34);
+    };
+
+    check(0);
+    memory.MapMemoryRegion(*page_table, BASE_VADDR, MAPPED_SIZE, memory.GetFCRAMRef(MAPPED_SIZE));
+    check(MAPPED_SIZE);
+}
+
+TEST_CASE("Gateway cheat benchmark", "[.][core][cheats][benchmark]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    auto page_table = std::make_shared<Memory::PageTable>();
+    memory.MapMemoryRegion(*page_table, BASE_VADDR, MAPPED_SIZE, memory.GetFCRAMRef(0));
+    memory.SetCurrentPageTable(page_table);
+    FillRandom(memory, 2);
+
+    // A few hundred codes of the usual shape, setting values behind a value check.
+    std::mt19937 rng{3};
+    std::vector<std::unique_ptr<GatewayCheat>> cheats;
+    for (u32 i = 0; i < 300; ++i) {
+        std::string code = fmt::format("6{:07X} {:08X}\n", BASE_VADDR + (rng() % MAPPED_SIZE & ~3U),
+                                       rng());
+        for (u32 line = 0; line < 8; ++line) {
+            code += fmt::format("0{:07X} {:08X}\n", BASE_VADDR + (rng() % MAPPED_SIZE & ~3U),
+                                rng());
+        }
+        code += "D2000000 00000000";
+        cheats.push_back(std::make_unique<GatewayCheat>("bench", code, ""));
+    }
+
+    BENCHMARK("Interpreter") {
+        for (const auto& cheat : cheats) {
+            cheat->Interpret(system, memory);
+        }
+        return memory.Read32(BASE_VADDR);
+    };
+    BENCHMARK("Compiled") {
+        for (const auto& cheat : cheats) {
+            cheat->Execute(system, memory);
+        }
+        return memory.Read32(BASE_VADDR);
+    };
+}
@@ -2,11 +2,14 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
 #include <bitset>
+#include <random>
 #include <string>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -196,4 +199,195 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    timing.ScheduleEvent(100, cb_a, CB_IDS[1], 0);
+    timing.ScheduleEvent(300, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(200, cb_b, CB_IDS[1], 0);
+    timing.ScheduleEvent(400, cb_a, CB_IDS[1], 0);
+    timing.ScheduleEvent(500, cb_c, CB_IDS[2], 0);
+    timing.ScheduleEvent(600, cb_c, CB_IDS[2], 0);
+    REQUIRE(100 == timing.GetTimer(0)->GetDowncount());
+
+    // Only removes the events with the same type and user data
+    timing.UnscheduleEvent(cb_a, CB_IDS[1]);
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(200 == timing.GetTimer(0)->GetDowncount());
+
+    AdvanceAndCheck(timing, 1, 100); // cb_b
+    AdvanceAndCheck(timing, 0, 200); // cb_a
+
+    timing.RemoveEvent(cb_c);
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
+}
+
+TEST_CASE("CoreTiming[UnscheduleHandle]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    const auto first = timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0);
+    const auto second = timing.ScheduleEvent(200, cb_a, CB_IDS[0], 0);
+    const auto third = timing.ScheduleEvent(300, cb_b, CB_IDS[1], 0);
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE(third.has_value());
+
+    // Only removes the event the handle refers to
+    timing.UnscheduleEvent(*first);
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(200 == timing.GetTimer(0)->GetDowncount());
+    AdvanceAndCheck(timing, 0, 100); // cb_a
+
+    // Handles of events that fired or were removed do nothing, even once their storage is reused
+    timing.ScheduleEvent(400, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(500, cb_a, CB_IDS[0], 0);
+    timing.UnscheduleEvent(*first);
+    timing.UnscheduleEvent(*second);
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(100 == timing.GetTimer(0)->GetDowncount());
+
+    timing.UnscheduleEvent(*third);
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(400 == timing.GetTimer(0)->GetDowncount());
+    AdvanceAndCheck(timing, 0, 100);              // cb_a
+    AdvanceAndCheck(timing, 0, MAX_SLICE_LENGTH); // cb_a
+}
+
+namespace FarEventsTest {
+static std::vector<s64> fired;
+} // namespace FarEventsTest
+
+TEST_CASE("CoreTiming[FarEvents]", "[core]") {
+    using namespace FarEventsTest;
+
+    Core::Timing timing(1, 100, 0);
+    auto timer = timing.GetTimer(0);
+    Core::TimingEventType* cb = timing.RegisterEvent(
+        "callback", [&timer](std::uintptr_t, s64) { fired.push_back(timer->GetTicks()); });
+
+    // Events far enough apart to end up in different levels of the timing wheel
+    const std::array<s64, 6> times{1, 63, 64, 4097, 300000, 100000000};
+    for (auto it = times.rbegin(); it != times.rend(); ++it) {
+        timing.ScheduleEvent(*it, cb, 0, 0);
+    }
+
+    fired.clear();
+    timer->Advance();
+    for (std::size_t i = 0; i < times.size(); i++) {
+        timer->SetNextSlice(std::numeric_limits<s64>::max());
+        REQUIRE(timer->GetDowncount() == times[i] - (i == 0 ? 0 : times[i - 1]));
+        timer->AddTicks(timer->GetDowncount());
+        timer->Advance();
+        REQUIRE(fired.size() == i + 1);
+        REQUIRE(fired.back() == times[i]);
+    }
+}
+
+TEST_CASE("CoreTiming benchmark", "[.][core][benchmark]") {
+    Core::Timing timing(1, 100);
+    auto timer = timing.GetTimer(0);
+    std::mt19937 rng{1};
+
+    // Periodic events rescheduling themselves, like the services' update ticks
+    constexpr std::size_t num_periodic = 64;
+    std::array<s64, num_periodic> periods;
+    for (s64& period : periods) {
+        period = 1000 + rng() % 500000;
+    }
+    Core::TimingEventType* periodic = nullptr;
+    periodic = timing.RegisterEvent("periodic", [&](std::uintptr_t index, s64 cycles_late) {
+        timing.ScheduleEvent(periods[index] - cycles_late, periodic, index, 0);
+    });
+    // Timeouts that are mostly cancelled before they fire, like thread wakeups
+    Core::TimingEventType* wakeup = timing.RegisterEvent("wakeup", [](std::uintptr_t, s64) {});
+
+    timer->Advance();
+    for (std::size_t i = 0; i < num_periodic; i++) {
+        timing.ScheduleEvent(periods[i], periodic, i, 0);
+    }
+    timer->SetNextSlice();
+
+    BENCHMARK("Slices") {
+        for (int slice = 0; slice < 1000; slice++) {
+            timer->AddTicks(timer->GetDowncount());
+            timer->Advance();
+            for (int i = 0; i < 8; i++) {
+                const std::uintptr_t thread = rng() % 256;
+                timing.UnscheduleEvent(wakeup, thread);
+                timing.ScheduleEvent(10000 + rng() % 1000000, wakeup, thread, 0);
+            }
+            timer->SetNextSlice();
+        }
+        return timer->GetTicks();
+    };
+}
+
+TEST_CASE("Kernel wakeup cancellation benchmark", "[.][core][kernel][benchmark]") {
+    // Mimics ThreadManager::SwitchContext cancelling the wakeup of the thread it switches to,
+    // which then waits with a timeout again, next to the periodic events of the services.
+    Core::Timing timing(1, 100);
+    auto timer = timing.GetTimer(0);
+    std::mt19937 rng{1};
+
+    constexpr std::size_t num_threads = 64;
+    Core::TimingEventType* wakeup = timing.RegisterEvent("wakeup", [](std::uintptr_t, s64) {});
+    Core::TimingEventType* periodic = timing.RegisterEvent("periodic", [](std::uintptr_t, s64) {});
+    std::array<std::optional<Core::Timing::EventHandle>, num_threads> wakeups{};
+
+    timer->Advance();
+    for (std::uintptr_t i = 0; i < 64; i++) {
+        timing.ScheduleEvent(100000000 + rng() % 1000000, periodic, i, 0);
+    }
+    for (std::uintptr_t thread = 0; thread < num_threads; thread++) {
+        wakeups[thread] = timing.ScheduleEvent(1000000 + rng() % 1000000, wakeup, thread, 0);
+    }
+
+    BENCHMARK("Switches, cancelling by lookup") {
+        for (int i = 0; i < 10000; i++) {
+            const std::uintptr_t thread = rng() % num_threads;
+            timing.UnscheduleEvent(wakeup, thread);
+            wakeups[thread] = timing.ScheduleEvent(1000000 + rng() % 1000000, wakeup, thread, 0);
+        }
+        return timer->GetTicks();
+    };
+
+    BENCHMARK("Switches, cancelling by handle") {
+        for (int i = 0; i < 10000; i++) {
+            const std::uintptr_t thread = rng() % num_threads;
+            timing.UnscheduleEvent(*wakeups[thread]);
+            wakeups[thread] = timing.ScheduleEvent(1000000 + rng() % 1000000, wakeup, thread, 0);
+        }
+        return timer->GetTicks();
+    };
+
+    BENCHMARK("Switches without pending wakeups") {
+        std::size_t cancelled = 0;
+        for (int i = 0; i < 10000; i++) {
+            auto& pending = wakeups[rng() % num_threads];
+            if (pending) {
+                timing.UnscheduleEvent(*pending);
+                pending.reset();
+                ++cancelled;
+            }
+        }
+        return cancelled;
+    };
+}
+
 // TODO: Add tests for multiple timers
@@ -0,0 +1,117 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/file_sys/romfs_page_cache.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t PAGE_SIZE = RomFSPageCache::PAGE_SIZE;
+
+std::vector<u8> PageData(std::size_t page, std::size_t size = PAGE_SIZE) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(page / PAGE_SIZE * 7 + i);
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RomFSPageCache reads inserted pages", "[core][file_sys]") {
+    RomFSPageCache cache{64 * PAGE_SIZE};
+    std::vector<u8> out(PAGE_SIZE);
+
+    REQUIRE(!cache.Read(0, 0, 0, PAGE_SIZE, out.data()));
+    cache.Insert(0, 0, PageData(0));
+    REQUIRE(cache.Contains(0, 0));
+    REQUIRE(cache.Read(0, 0, 16, 32, out.data()) == 32);
+    REQUIRE(std::equal(out.begin(), out.begin() + 32, PageData(0).begin() + 16));
+
+    // The last page of a file may be short.
+    cache.Insert(0, PAGE_SIZE, PageData(PAGE_SIZE, 100));
+    REQUIRE(cache.Read(0, PAGE_SIZE, 90, 32, out.data()) == 10);
+    REQUIRE(cache.Read(0, PAGE_SIZE, 200, 32, out.data()) == 0);
+
+    const auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 1);
+}
+
+TEST_CASE("RomFSPageCache keeps referenced pages", "[core][file_sys]") {
+    // One page per shard, 8 shards.
+    RomFSPageCache cache{8 * PAGE_SIZE};
+    std::vector<u8> out(PAGE_SIZE);
+
+    // Pages 0 and 8 map to the same shard, page 0 gets a second chance when it was read.
+    cache.Insert(0, 0, PageData(0));
+    REQUIRE(cache.Read(0, 0, 0, 1, out.data()));
+    cache.Insert(0, 8 * PAGE_SIZE, PageData(8 * PAGE_SIZE));
+    REQUIRE(cache.Contains(0, 8 * PAGE_SIZE));
+    REQUIRE(!cache.Contains(0, 0));
+}
+
+TEST_CASE("RomFSPageCache is thread safe", "[core][file_sys]") {
+    RomFSPageCache cache{16 * PAGE_SIZE};
+    std::atomic<bool> corrupted{};
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, &corrupted, t] {
+            std::vector<u8> out(PAGE_SIZE);
+            for (std::size_t i = 0; i < 2000; ++i) {
+                const std::size_t page = ((i * 13 + t) % 64) * PAGE_SIZE;
+                if (const auto read = cache.Read(0, page, 0, PAGE_SIZE, out.data())) {
+                    if (*read != PAGE_SIZE || out != PageData(page)) {
+                        corrupted = true;
+                    }
+                } else {
+                    cache.Insert(0, page, PageData(page));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(!corrupted);
+}
+
+TEST_CASE("RomFSPageCache keeps pages of files apart", "[core][file_sys]") {
+    RomFSPageCache cache{64 * PAGE_SIZE};
+    std::vector<u8> out(PAGE_SIZE);
+
+    cache.Insert(1, 0, PageData(0));
+    cache.Insert(2, 0, PageData(PAGE_SIZE));
+    REQUIRE(cache.Read(1, 0, 0, PAGE_SIZE, out.data()) == PAGE_SIZE);
+    REQUIRE(out == PageData(0));
+    REQUIRE(cache.Read(2, 0, 0, PAGE_SIZE, out.data()) == PAGE_SIZE);
+    REQUIRE(out == PageData(PAGE_SIZE));
+    REQUIRE(!cache.Contains(3, 0));
+}
+
+TEST_CASE("RomFSPageCache drops pages above a lowered capacity", "[core][file_sys]") {
+    RomFSPageCache cache{64 * PAGE_SIZE};
+    for (std::size_t i = 0; i < 64; ++i) {
+        cache.Insert(0, i * PAGE_SIZE, PageData(i * PAGE_SIZE));
+    }
+    cache.SetCapacity(8 * PAGE_SIZE);
+
+    std::size_t cached = 0;
+    for (std::size_t i = 0; i < 64; ++i) {
+        cached += cache.Contains(0, i * PAGE_SIZE);
+    }
+    REQUIRE(cached == 8);
+
+    // The remaining pages are still evicted once the lowered capacity is reached.
+    cache.Insert(0, 64 * PAGE_SIZE, PageData(64 * PAGE_SIZE));
+    REQUIRE(cache.Contains(0, 64 * PAGE_SIZE));
+}
+
+} // namespace FileSys
@@ -0,0 +1,71 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/memory_ref.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/memory.h"
+
+namespace Kernel {
+
+TEST_CASE("Page tables of exited processes are only reused for unmodified code",
+          "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+
+    constexpr VAddr code_addr = Memory::PROCESS_IMAGE_VADDR;
+    constexpr u32 code_size = Memory::BORKED3DS_PAGE_SIZE;
+    auto code_set = kernel.CreateCodeSet("test", 0x0004000000123400);
+    code_set->memory = std::vector<u8>(code_size, 0xAB);
+    code_set->CodeSegment().addr = code_addr;
+    code_set->CodeSegment().size = code_size;
+
+    // Maps the code like Process::Run, which needs a complete system
+    const auto launch = [&] {
+        auto process = kernel.CreateProcess(code_set);
+        process->vm_manager.MapBackingMemory(code_addr,
+                                             MemoryRef{std::make_shared<BufferMem>(code_size)},
+                                             code_size, MemoryState::Code);
+        memory.WriteBlock(*process, code_addr, code_set->memory.data(), code_size);
+        process->status = ProcessStatus::Running;
+        return process;
+    };
+    const auto read_code = [&](const Process& process) {
+        std::vector<u8> code(code_size);
+        memory.ReadBlock(process, code_addr, code.data(), code_size);
+        return code;
+    };
+
+    SECTION("unmodified code") {
+        kernel.TerminateProcess(launch());
+
+        const auto process = launch();
+        REQUIRE(process->vm_manager.page_table->reuse_count == 1);
+        REQUIRE(read_code(*process) == code_set->memory);
+    }
+
+    SECTION("code patched at runtime") {
+        {
+            const auto process = launch();
+            const u32 patch = 0xE12FFF1E;
+            memory.WriteBlock(*process, code_addr + 0x10, &patch, sizeof(patch));
+            kernel.TerminateProcess(process);
+        }
+
+        // The relaunched process gets a new page table, so no JIT code of the patched code is used
+        const auto process = launch();
+        REQUIRE(process->vm_manager.page_table->reuse_count == 0);
+        REQUIRE(read_code(*process) == code_set->memory);
+    }
+}
+
+} // namespace Kernel
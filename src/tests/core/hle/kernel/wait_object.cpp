@@ -0,0 +1,63 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/event.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/thread.h"
+
+namespace Kernel {
+
+TEST_CASE("WaitObject wakes up threads by priority", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+
+    auto event = kernel.CreateEvent(ResetType::OneShot);
+    const auto make_waiter = [&](u32 priority) {
+        auto thread = std::make_shared<Thread>(kernel, 0);
+        thread->status = ThreadStatus::WaitSynchAny;
+        thread->SetPriority(priority);
+        thread->wait_objects = {event};
+        event->AddWaitingThread(thread);
+        return thread;
+    };
+    const auto low = make_waiter(0x30);
+    const auto first = make_waiter(0x20);
+    const auto second = make_waiter(0x20);
+
+    REQUIRE(event->GetWaitingThreads() == std::vector{first, second, low});
+
+    SECTION("threads of the same priority wake up in the order they started waiting") {
+        event->Signal();
+        REQUIRE(first->status == ThreadStatus::Ready);
+        REQUIRE(second->status == ThreadStatus::WaitSynchAny);
+        REQUIRE(event->GetWaitingThreads() == std::vector{second, low});
+    }
+
+    SECTION("priority changes move waiting threads") {
+        low->SetPriority(0x10);
+        REQUIRE(event->GetWaitingThreads() == std::vector{low, first, second});
+
+        // Threads keep their place among the threads of the same priority
+        first->SetPriority(0x30);
+        first->SetPriority(0x20);
+        REQUIRE(event->GetWaitingThreads() == std::vector{low, first, second});
+    }
+
+    SECTION("removed threads are not woken up") {
+        event->RemoveWaitingThread(first.get());
+        first->wait_objects.clear();
+        event->Signal();
+        REQUIRE(first->status == ThreadStatus::WaitSynchAny);
+        REQUIRE(second->status == ThreadStatus::Ready);
+    }
+}
+
+} // namespace Kernel
@@ -0,0 +1,108 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/hle/service/cam/y2r_u.h"
+#include "core/hw/y2r.h"
+#include "core/memory.h"
+
+using namespace Service::Y2R;
+
+namespace {
+
+constexpr VAddr SRC_Y_VADDR = Memory::LINEAR_HEAP_VADDR;
+constexpr VAddr SRC_U_VADDR = SRC_Y_VADDR + 0x80000;
+constexpr VAddr SRC_V_VADDR = SRC_U_VADDR + 0x40000;
+constexpr VAddr DST_VADDR = SRC_V_VADDR + 0x40000;
+constexpr u32 DST_SIZE = 0x100000;
+constexpr u32 MAPPED_SIZE = DST_VADDR + DST_SIZE - SRC_Y_VADDR;
+
+/// Converts the same input with the scalar and the vectorized path and compares the output.
+void CheckConversion(Memory::MemorySystem& memory, Common::ThreadWorker& workers,
+                     ConversionConfiguration cvt) {
+    const u16 width = cvt.input_line_width;
+    const bool indiv16 = cvt.input_format == InputFormat::YUV422_Indiv16 ||
+                         cvt.input_format == InputFormat::YUV420_Indiv16;
+    const bool yuv420 = cvt.input_format == InputFormat::YUV420_Indiv8 ||
+                        cvt.input_format == InputFormat::YUV420_Indiv16;
+    const u16 sample_size = indiv16 ? 2 : 1;
+    const u16 chroma_width = yuv420 ? width / 4 : width / 2;
+    const u16 bytes_per_pixel = cvt.output_format == OutputFormat::RGBA8  ? 4
+                                : cvt.output_format == OutputFormat::RGB8 ? 3
+                                                                          : 2;
+    cvt.src_Y = {SRC_Y_VADDR, 0, static_cast<u16>(width * sample_size), 4};
+    cvt.src_U = {SRC_U_VADDR, 0, static_cast<u16>(chroma_width * sample_size), 0};
+    cvt.src_V = {SRC_V_VADDR, 0, static_cast<u16>(chroma_width * sample_size), 2};
+    cvt.src_YUYV = {SRC_Y_VADDR, 0, static_cast<u16>(width * 2), 6};
+    cvt.dst = {DST_VADDR, 0, static_cast<u16>(width * bytes_per_pixel), 8};
+
+    u8* dst = memory.GetPointer(DST_VADDR);
+    std::fill_n(dst, DST_SIZE, 0xCD);
+    HW::Y2R::PerformConversion(memory, cvt, nullptr, true);
+    const std::vector<u8> expected(dst, dst + DST_SIZE);
+
+    std::fill_n(dst, DST_SIZE, 0xCD);
+    HW::Y2R::PerformConversion(memory, cvt, &workers);
+    REQUIRE(std::equal(expected.begin(), expected.end(), dst));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Y2R vectorized conversion matches the scalar path", "[core][y2r]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    auto page_table = std::make_shared<Memory::PageTable>();
+    memory.MapMemoryRegion(*page_table, SRC_Y_VADDR, MAPPED_SIZE, memory.GetFCRAMRef(0));
+    memory.SetCurrentPageTable(page_table);
+    Common::ThreadWorker workers{2, "Y2R"};
+
+    std::mt19937 rng{1234};
+    u8* src = memory.GetPointer(SRC_Y_VADDR);
+    for (u32 i = 0; i < DST_VADDR - SRC_Y_VADDR; ++i) {
+        src[i] = static_cast<u8>(rng());
+    }
+
+    // A standard set and extreme values that push the channels out of range.
+    constexpr std::array<CoefficientSet, 2> coefficient_sets{{
+        {{0x100, 0x166, 0xB6, 0x58, 0x1C5, -0x166F, 0x10EE, -0x1C5B}},
+        {{0x7FFF, -0x8000, -0x8000, 0x7FFF, -0x8000, 0x7FFF, -0x8000, 0x3039}},
+    }};
+
+    // 256x256 is split across the workers, 40x13 has a partial strip at the end.
+    constexpr std::array<std::pair<u16, u16>, 2> sizes{{{256, 256}, {40, 13}}};
+
+    for (const auto& [width, lines] : sizes) {
+        for (u8 input = 0; input <= static_cast<u8>(InputFormat::YUYV422_Interleaved); ++input) {
+            for (u8 output = 0; output <= static_cast<u8>(OutputFormat::RGB565); ++output) {
+                for (u8 rotation = 0; rotation <= static_cast<u8>(Rotation::Clockwise_270);
+                     ++rotation) {
+                    for (u8 alignment = 0; alignment < 2; ++alignment) {
+                        if (alignment == 1 && lines % 8 != 0) {
+                            continue;
+                        }
+                        for (const auto& coefficients : coefficient_sets) {
+                            ConversionConfiguration cvt{};
+                            cvt.input_format = static_cast<InputFormat>(input);
+                            cvt.output_format = static_cast<OutputFormat>(output);
+                            cvt.rotation = static_cast<Rotation>(rotation);
+                            cvt.block_alignment = static_cast<BlockAlignment>(alignment);
+                            cvt.input_line_width = width;
+                            cvt.input_lines = lines;
+                            cvt.coefficients = coefficients;
+                            cvt.alpha = static_cast<u16>(rng() & 0xFF);
+                            CheckConversion(memory, workers, cvt);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
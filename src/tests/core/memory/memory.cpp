@@ -56,3 +56,12 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.GetPhysicalPointerUncached", "[core][memory]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    for (const PAddr address : {Memory::FCRAM_PADDR + 0x1234, Memory::DSP_RAM_PADDR,
+                                Memory::VRAM_PADDR + 0x10, Memory::FCRAM_PADDR + 0x1234}) {
+        CHECK(memory.GetPhysicalPointerUncached(address) == memory.GetPhysicalPointer(address));
+    }
+}
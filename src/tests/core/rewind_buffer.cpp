@@ -0,0 +1,141 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/rewind_buffer.h"
+
+namespace {
+
+constexpr std::size_t PAGE_SIZE = Core::RewindBuffer::PAGE_SIZE;
+
+/// Two regions, the first one ending with a partial page.
+struct Memory {
+    std::vector<u8> first = std::vector<u8>(4 * PAGE_SIZE + 100);
+    std::vector<u8> second = std::vector<u8>(2 * PAGE_SIZE);
+
+    std::array<std::span<u8>, 2> Regions() {
+        return {first, second};
+    }
+
+    bool operator==(const Memory&) const = default;
+};
+
+void Randomize(std::span<u8> data, std::mt19937& rng) {
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+}
+
+/// Pops the newest snapshot into a new memory, restoring its state.
+std::pair<std::string, Memory> Pop(Core::RewindBuffer& buffer) {
+    auto state = buffer.GetNewestState();
+    REQUIRE(state);
+    Memory memory;
+    buffer.Pop(memory.Regions());
+    return {std::move(*state), std::move(memory)};
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RewindBuffer restores pushed snapshots newest first", "[core][rewind]") {
+    std::mt19937 rng{1};
+    Core::RewindBuffer buffer{64 * PAGE_SIZE};
+    Memory memory;
+    std::vector<Memory> expected;
+
+    Randomize(memory.first, rng);
+    for (int i = 0; i < 4; ++i) {
+        // Change part of a page, the partial page and a whole region in turn.
+        Randomize(std::span{memory.first}.subspan(i * PAGE_SIZE + 10, 20), rng);
+        if (i == 1) {
+            Randomize(std::span{memory.first}.last(100), rng);
+        } else if (i == 2) {
+            Randomize(memory.second, rng);
+        }
+        // Serialized states of different lengths
+        buffer.Push(std::string(i * 1000 + 1, static_cast<char>('a' + i)), memory.Regions());
+        REQUIRE(buffer.GetSize() > 0);
+        expected.push_back(memory);
+    }
+
+    for (int i = 3; i >= 0; --i) {
+        const auto [state, restored] = Pop(buffer);
+        REQUIRE(state == std::string(i * 1000 + 1, static_cast<char>('a' + i)));
+        REQUIRE(restored == expected[i]);
+    }
+    REQUIRE(!buffer.GetNewestState());
+    REQUIRE(buffer.GetSize() == 0);
+}
+
+TEST_CASE("RewindBuffer compares against the newest snapshot after popping", "[core][rewind]") {
+    std::mt19937 rng{2};
+    Core::RewindBuffer buffer{64 * PAGE_SIZE};
+    Memory memory;
+
+    buffer.Push("a", memory.Regions());
+    const Memory first = memory;
+    Randomize(memory.first, rng);
+    buffer.Push("b", memory.Regions());
+
+    // Restore the second snapshot and push again with only the second region changed. The pages
+    // of the first region must be stored again, the snapshot follows the first one now.
+    auto [state, restored] = Pop(buffer);
+    REQUIRE(state == "b");
+    Randomize(restored.second, rng);
+    buffer.Push("c", restored.Regions());
+
+    REQUIRE(Pop(buffer) == std::pair{std::string{"c"}, restored});
+    REQUIRE(Pop(buffer) == std::pair{std::string{"a"}, first});
+}
+
+TEST_CASE("RewindBuffer starts over when the memory size changes", "[core][rewind]") {
+    Core::RewindBuffer buffer{64 * PAGE_SIZE};
+    Memory memory;
+    buffer.Push("a", memory.Regions());
+
+    std::vector<u8> region(PAGE_SIZE / 2, 7);
+    const std::array<std::span<u8>, 1> regions{region};
+    buffer.Push("b", regions);
+
+    REQUIRE(buffer.GetNewestState() == "b");
+    std::vector<u8> restored(region.size());
+    const std::array<std::span<u8>, 1> restored_regions{restored};
+    buffer.Pop(restored_regions);
+    REQUIRE(restored == region);
+    REQUIRE(!buffer.GetNewestState());
+}
+
+TEST_CASE("RewindBuffer drops the oldest snapshots over budget", "[core][rewind]") {
+    std::mt19937 rng{3};
+    // Smaller than the memory, the budget is raised to fit one full copy of it.
+    Core::RewindBuffer buffer{PAGE_SIZE};
+    constexpr std::size_t budget = 6 * PAGE_SIZE + 100;
+    Memory memory;
+    std::vector<Memory> expected;
+
+    constexpr int num_snapshots = 12;
+    for (int i = 0; i < num_snapshots; ++i) {
+        // Two pages per snapshot, half incompressible
+        Randomize(std::span{memory.first}.subspan((i % 4) * PAGE_SIZE, PAGE_SIZE / 2), rng);
+        Randomize(std::span{memory.second}.first(PAGE_SIZE / 2), rng);
+        buffer.Push(std::to_string(i), memory.Regions());
+        REQUIRE(buffer.GetSize() <= budget);
+        expected.push_back(memory);
+    }
+
+    // The newest snapshots are kept and the oldest one kept still restores in full.
+    int i = num_snapshots - 1;
+    for (; buffer.GetNewestState(); --i) {
+        const auto [state, restored] = Pop(buffer);
+        REQUIRE(state == std::to_string(i));
+        REQUIRE(restored == expected[i]);
+    }
+    REQUIRE(i >= 0);
+    REQUIRE(i < num_snapshots - 2);
+}
@@ -0,0 +1,163 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/tracer/reader.h"
+#include "core/tracer/recorder.h"
+
+using namespace CiTrace;
+
+namespace {
+
+/// An element as it was passed to the recorder.
+struct RecordedElement {
+    CTStreamElementType type;
+    u32 physical_address;
+    u32 value;
+    std::vector<u8> data;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("CiTrace recordings can be read back", "[core][tracer]") {
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    const std::string scratch_path = (temp_dir / "borked3ds_test_citrace.ctf.part").string();
+    const std::string trace_path = (temp_dir / "borked3ds_test_citrace.ctf").string();
+
+    Recorder::InitialState initial_state;
+    initial_state.pica_registers = {1, 2, 3, 4};
+    initial_state.lcd_registers = {5, 6};
+    initial_state.vs_program_binary = {7, 8, 9};
+    initial_state.gs_float_uniforms = {10};
+
+    // Enough frames of incompressible textures to span several chunks, some of them loaded again
+    // in later chunks.
+    constexpr u32 num_frames = 48;
+    std::mt19937 rng{1};
+    std::vector<std::vector<u8>> textures;
+
+    std::vector<RecordedElement> expected;
+    std::vector<std::size_t> frame_starts{0};
+    {
+        Recorder recorder{initial_state, scratch_path};
+        for (u32 frame = 0; frame < num_frames; frame++) {
+            for (u32 i = 0; i < 4; i++) {
+                const u32 address = 0x1EF00000 + (rng() % 0x100) * 4;
+                const u32 value = rng();
+                recorder.RegisterWritten(address, value);
+                expected.push_back({RegisterWrite, address, value, {}});
+
+                if (textures.empty() || rng() % 4 != 0) {
+                    auto& texture = textures.emplace_back(128 * 1024 + rng() % 4096);
+                    std::generate(texture.begin(), texture.end(),
+                                  [&rng] { return static_cast<u8>(rng()); });
+                }
+                const auto& texture = textures[rng() % textures.size()];
+                const u32 physical_address = 0x18000000 + rng() % 0x1000;
+                recorder.MemoryAccessed(texture.data(), static_cast<u32>(texture.size()),
+                                        physical_address);
+                expected.push_back({MemoryLoad, physical_address, 0, texture});
+            }
+            recorder.FrameFinished();
+            expected.push_back({FrameMarker, 0, 0, {}});
+            frame_starts.push_back(expected.size());
+        }
+        recorder.Finish(trace_path);
+    }
+    REQUIRE(!FileUtil::Exists(scratch_path));
+
+    Reader reader{trace_path};
+    REQUIRE(reader.IsValid());
+    REQUIRE(reader.NumElements() == expected.size());
+
+    const auto state = reader.ReadInitialState();
+    REQUIRE(state.pica_registers == initial_state.pica_registers);
+    REQUIRE(state.lcd_registers == initial_state.lcd_registers);
+    REQUIRE(state.vs_program_binary == initial_state.vs_program_binary);
+    REQUIRE(state.vs_swizzle_data.empty());
+    REQUIRE(state.gs_float_uniforms == initial_state.gs_float_uniforms);
+
+    const auto check_from = [&](std::size_t first) {
+        for (std::size_t i = first; i < expected.size(); i++) {
+            const auto element = reader.Next();
+            REQUIRE(element.has_value());
+            REQUIRE(element->type == expected[i].type);
+            if (element->type == RegisterWrite) {
+                REQUIRE(element->register_write.physical_address ==
+                        expected[i].physical_address);
+                REQUIRE(element->register_write.value == expected[i].value);
+            } else if (element->type == MemoryLoad) {
+                REQUIRE(element->memory_load.physical_address == expected[i].physical_address);
+                const auto data = reader.GetMemory(element->memory_load);
+                REQUIRE(std::ranges::equal(data, expected[i].data));
+            }
+        }
+        REQUIRE(!reader.Next().has_value());
+    };
+
+    check_from(0);
+    for (const u32 frame : {num_frames - 1, 1U, 17U, 30U, 0U}) {
+        reader.SeekToFrame(frame);
+        check_from(frame_starts[frame]);
+    }
+
+    FileUtil::Delete(trace_path);
+}
+
+TEST_CASE("Corrupt CiTrace files are rejected", "[core][tracer]") {
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    const std::string scratch_path = (temp_dir / "borked3ds_test_citrace_bad.ctf.part").string();
+    const std::string trace_path = (temp_dir / "borked3ds_test_citrace_bad.ctf").string();
+    {
+        Recorder recorder{{}, scratch_path};
+        recorder.RegisterWritten(0x1EF00000, 1);
+        recorder.FrameFinished();
+        recorder.Finish(trace_path);
+    }
+    REQUIRE(Reader{trace_path}.IsValid());
+
+    std::string trace;
+    REQUIRE(FileUtil::ReadFileToString(false, trace_path, trace) > 0);
+    CTFooter footer;
+    std::memcpy(&footer, trace.data() + trace.size() - sizeof(footer), sizeof(footer));
+    REQUIRE(footer.num_chunks == 1);
+
+    const auto is_valid_with = [&](auto patch) {
+        auto corrupt = trace;
+        patch(corrupt);
+        FileUtil::WriteStringToFile(false, trace_path, corrupt);
+        return Reader{trace_path}.IsValid();
+    };
+    const auto patch_footer = [&](auto patch) {
+        return is_valid_with([&](std::string& data) {
+            CTFooter corrupt_footer = footer;
+            patch(corrupt_footer);
+            std::memcpy(data.data() + data.size() - sizeof(footer), &corrupt_footer,
+                        sizeof(footer));
+        });
+    };
+    const auto patch_chunk = [&](auto patch) {
+        return is_valid_with([&](std::string& data) {
+            CTChunk chunk;
+            std::memcpy(&chunk, data.data() + footer.chunks_offset, sizeof(chunk));
+            patch(chunk);
+            std::memcpy(data.data() + footer.chunks_offset, &chunk, sizeof(chunk));
+        });
+    };
+
+    REQUIRE(!patch_footer([](CTFooter& f) { f.num_chunks = 0xFFFFFFFF; }));
+    REQUIRE(!patch_footer([](CTFooter& f) { f.num_chunks = 2; }));
+    REQUIRE(!patch_footer([](CTFooter& f) { f.chunks_offset = ~u64{0} - 8; }));
+    REQUIRE(!patch_chunk([](CTChunk& c) { c.elements_offset = c.uncompressed_size + 1; }));
+    REQUIRE(!patch_chunk([](CTChunk& c) { c.compressed_size = 0x7FFFFFFF; }));
+    REQUIRE(!patch_chunk([](CTChunk& c) { c.file_offset = ~u64{0}; }));
+
+    FileUtil::Delete(trace_path);
+}
@@ -7,6 +7,7 @@
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <memory>
 #include <span>
@@ -21,11 +22,16 @@
 #include "video_core/shader/shader_interpreter.h"
 #if BORKED3DS_ARCH(x86_64)
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_simd_compiler.h"
 #elif BORKED3DS_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
 
 using JitShader = Pica::Shader::JitShader;
+#if BORKED3DS_ARCH(x86_64)
+using JitShaderSimd = Pica::Shader::JitShaderSimd;
+using ShaderUnitSimd = Pica::Shader::ShaderUnitSimd;
+#endif
 using ShaderInterpreter = Pica::Shader::InterpreterEngine;
 
 using DestRegister = nihstro::DestRegister;
@@ -181,8 +187,73 @@ private:
     JitShader shader_jit{};
 };
 
+#if BORKED3DS_ARCH(x86_64)
+class ShaderJitSimdTest : public ShaderTest {
+public:
+    explicit ShaderJitSimdTest(std::initializer_list<nihstro::InlineAsm> code) : ShaderTest(code) {
+        Compile();
+    }
+
+    explicit ShaderJitSimdTest(std::unique_ptr<Pica::ShaderSetup> input_shader_setup)
+        : ShaderTest(std::move(input_shader_setup)) {
+        Compile();
+    }
+
+    void RunShader(Pica::ShaderUnit& shader_unit, std::span<const Common::Vec4f> inputs) override {
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            const Common::Vec4f& input = inputs[i];
+            shader_unit.input[i].x = Pica::f24::FromFloat32(input.x);
+            shader_unit.input[i].y = Pica::f24::FromFloat32(input.y);
+            shader_unit.input[i].z = Pica::f24::FromFloat32(input.z);
+            shader_unit.input[i].w = Pica::f24::FromFloat32(input.w);
+        }
+        shader_unit.temporary.fill(Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero()));
+
+        // Programs the SIMD JIT cannot run are covered by the scalar JIT, like in JitEngine.
+        if (!is_runnable) {
+            shader_jit.Run(*shader_setup, shader_unit, 0);
+            return;
+        }
+
+        // Every lane shades the same vertex, so they all have to agree with each other.
+        auto simd_unit = std::make_unique<ShaderUnitSimd>();
+        simd_unit->LoadState(shader_unit);
+        for (std::size_t reg = 0; reg < simd_unit->input.size(); ++reg) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                simd_unit->input[reg][comp].fill(shader_unit.input[reg][comp]);
+            }
+        }
+        shader_jit_simd.Run(*shader_setup, *simd_unit, 0);
+
+        for (std::size_t lane = 1; lane < Pica::Shader::SIMD_LANES; ++lane) {
+            Pica::ShaderUnit lane_unit{};
+            simd_unit->StoreState(lane_unit, lane);
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                REQUIRE(lane_unit.output[0][comp].ToFloat32() ==
+                        simd_unit->output[0][comp][0].ToFloat32());
+            }
+        }
+        simd_unit->StoreState(shader_unit, 0);
+    }
+
+private:
+    void Compile() {
+        shader_jit.Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+        shader_jit_simd.Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+        is_runnable = shader_jit_simd.IsRunnable(shader_setup->program_code, 0);
+    }
+
+    JitShader shader_jit{};
+    JitShaderSimd shader_jit_simd{};
+    bool is_runnable{};
+};
+
+#define SHADER_TEST_CASE(NAME, TAG)                                                                \
+    TEMPLATE_TEST_CASE(NAME, TAG, ShaderInterpreterTest, ShaderJitTest, ShaderJitSimdTest)
+#else
 #define SHADER_TEST_CASE(NAME, TAG)                                                                \
     TEMPLATE_TEST_CASE(NAME, TAG, ShaderInterpreterTest, ShaderJitTest)
+#endif
 
 SHADER_TEST_CASE("ADD", "[video_core][shader]") {
     const auto sh_input1 = SourceRegister::MakeInput(0);
@@ -816,4 +887,120 @@ SHADER_TEST_CASE("Source Swizzle", "[video_core][shader]") {
             Common::Vec4f(iota_vec.y, iota_vec.y, iota_vec.y, iota_vec.y));
 }
 
+#if BORKED3DS_ARCH(x86_64)
+TEST_CASE("JIT SIMD lanes match the interpreter", "[video_core][shader]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_c40 = SourceRegister::MakeFloat(40);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output1 = DestRegister::MakeOutput(0);
+    const auto sh_output2 = DestRegister::MakeOutput(1);
+
+    auto shader_setup = CompileShaderSetup({
+        // mova a0.xy, sh_input1.xy
+        {OpCode::Id::MOVA, DestRegister{}, "xy", sh_input1, "xy", SourceRegister{}, "",
+         nihstro::InlineAsm::RelativeAddress::A1},
+        // mov sh_temp.xyzw, c40[a0.x].wzyx
+        {OpCode::Id::MOV, sh_temp, "xyzw", sh_c40, "wzyx", SourceRegister{}, "",
+         nihstro::InlineAsm::RelativeAddress::A1},
+        // add sh_output1.xyzw, c40[a0.y].xyzw, sh_temp.xyzw
+        {OpCode::Id::ADD, sh_output1, "xyzw", sh_c40, "xyzw", sh_temp, "xyzw",
+         nihstro::InlineAsm::RelativeAddress::A2},
+        // CMP inserted below
+        {OpCode::Id::NOP},
+        {OpCode::Id::MUL, sh_output2, sh_input1, sh_input2},
+        {OpCode::Id::END},
+    });
+
+    // nihstro does not support the CMP instruction, so the instruction-binary must be manually
+    // inserted here: cmp sh_input2.xy, sh_input1.xy with x less than and y greater equal.
+    constexpr u32 cmp_operand_desc_id = 127;
+    nihstro::Instruction CMP = {};
+    CMP.opcode = nihstro::OpCode::Id::CMP;
+    CMP.common.operand_desc_id = cmp_operand_desc_id;
+    CMP.common.src1 = sh_input2;
+    CMP.common.src2 = sh_input1;
+    CMP.common.compare_op.x = nihstro::Instruction::Common::CompareOpType::Op::LessThan;
+    CMP.common.compare_op.y = nihstro::Instruction::Common::CompareOpType::Op::GreaterEqual;
+    shader_setup->program_code[3] = CMP.hex;
+
+    nihstro::SwizzlePattern swizzle = {};
+    for (int i = 0; i < 4; ++i) {
+        const auto selector = static_cast<SwizzlePattern::Selector>(i);
+        swizzle.SetSelectorSrc1(i, selector);
+        swizzle.SetSelectorSrc2(i, selector);
+    }
+    shader_setup->swizzle_data[cmp_operand_desc_id] = swizzle.hex;
+
+    // Every component of every uniform is different, so a lane reading another lane's uniform or
+    // component shows up in the output.
+    for (u32 i = 0; i < 96; ++i) {
+        const float base = static_cast<float>(i);
+        shader_setup->uniforms.f[i] = {
+            Pica::f24::FromFloat32(base), Pica::f24::FromFloat32(base + 0.25f),
+            Pica::f24::FromFloat32(-base), Pica::f24::FromFloat32(base * 0.5f + 100.0f)};
+    }
+
+    // Each lane gets different inputs, and with them different address registers and compare
+    // results.
+    constexpr std::size_t num_lanes = Pica::Shader::SIMD_LANES;
+    static_assert(num_lanes == 4);
+    const std::array<Common::Vec4f, num_lanes> inputs1 = {
+        Common::Vec4f{0.0f, 13.0f, 1.0f, 2.0f},
+        Common::Vec4f{-7.0f, 50.0f, -3.0f, 0.5f},
+        Common::Vec4f{21.5f, -40.0f, 4.0f, -1.0f},
+        Common::Vec4f{55.0f, 3.0f, 8.0f, 16.0f},
+    };
+    const std::array<Common::Vec4f, num_lanes> inputs2 = {
+        Common::Vec4f{1.0f, 13.0f, 2.0f, 3.0f},
+        Common::Vec4f{-8.0f, 60.0f, 5.0f, -6.0f},
+        Common::Vec4f{21.5f, -50.0f, 7.0f, 9.0f},
+        Common::Vec4f{54.0f, 2.0f, -0.25f, 0.75f},
+    };
+    const auto to_f24 = [](const Common::Vec4f& value) {
+        return Common::MakeVec(
+            Pica::f24::FromFloat32(value.x), Pica::f24::FromFloat32(value.y),
+            Pica::f24::FromFloat32(value.z), Pica::f24::FromFloat32(value.w));
+    };
+
+    JitShaderSimd shader_jit_simd{};
+    shader_jit_simd.Compile(&shader_setup->program_code, &shader_setup->swizzle_data);
+    REQUIRE(shader_jit_simd.IsRunnable(shader_setup->program_code, 0));
+
+    auto simd_unit = std::make_unique<ShaderUnitSimd>();
+    simd_unit->LoadState(Pica::ShaderUnit{});
+    for (std::size_t lane = 0; lane < num_lanes; ++lane) {
+        const auto input1 = to_f24(inputs1[lane]);
+        const auto input2 = to_f24(inputs2[lane]);
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            simd_unit->input[0][comp][lane] = input1[comp];
+            simd_unit->input[1][comp][lane] = input2[comp];
+        }
+    }
+    shader_jit_simd.Run(*shader_setup, *simd_unit, 0);
+
+    ShaderInterpreter shader_interpreter{};
+    for (std::size_t lane = 0; lane < num_lanes; ++lane) {
+        Pica::ShaderUnit expected{};
+        expected.input[0] = to_f24(inputs1[lane]);
+        expected.input[1] = to_f24(inputs2[lane]);
+        shader_interpreter.Run(*shader_setup, expected);
+
+        Pica::ShaderUnit actual{};
+        simd_unit->StoreState(actual, lane);
+        INFO("lane " << lane);
+        REQUIRE(actual.address_registers[0] == expected.address_registers[0]);
+        REQUIRE(actual.address_registers[1] == expected.address_registers[1]);
+        REQUIRE(actual.conditional_code[0] == expected.conditional_code[0]);
+        REQUIRE(actual.conditional_code[1] == expected.conditional_code[1]);
+        for (std::size_t reg = 0; reg < 2; ++reg) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                REQUIRE(actual.output[reg][comp].ToFloat32() ==
+                        expected.output[reg][comp].ToFloat32());
+            }
+        }
+    }
+}
+#endif
+
 #endif // BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
@@ -0,0 +1,145 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/settings.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+using namespace Pica::Shader;
+
+namespace {
+
+constexpr u64 TITLE_ID = 0x0004000000123400;
+
+/// Points the shader directory to a temporary one for the duration of a test.
+class ScopedShaderDir {
+public:
+    ScopedShaderDir()
+        : old_dir{FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)},
+          dir{(std::filesystem::temp_directory_path() / "borked3ds_test_shaders").string()} {
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, dir);
+        Settings::values.use_disk_shader_cache.SetValue(true);
+    }
+
+    ~ScopedShaderDir() {
+        FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, old_dir);
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string CachePath() const {
+        return (std::filesystem::path{dir} / "jit" / "0004000000123400.bin").string();
+    }
+
+private:
+    std::string old_dir;
+    std::string dir;
+};
+
+JitDiskCacheEntry MakeEntry(u32 seed) {
+    JitDiskCacheEntry entry;
+    for (u32 i = 0; i < 16; ++i) {
+        entry.program_code[i] = seed * 0x9E3779B9 + i;
+    }
+    entry.swizzle_data[0] = seed | 0x1B;
+    entry.swizzle_data[3] = seed;
+    // Same key as JitEngine::SetupBatch
+    entry.unique_identifier = Common::HashCombine(
+        Common::ComputeHash64(&entry.program_code, sizeof(entry.program_code)),
+        Common::ComputeHash64(&entry.swizzle_data, sizeof(entry.swizzle_data)));
+    return entry;
+}
+
+void Save(JitDiskCache& cache, const JitDiskCacheEntry& entry) {
+    cache.Save(entry.unique_identifier, entry.program_code, entry.swizzle_data);
+}
+
+bool Equal(const JitDiskCacheEntry& a, const JitDiskCacheEntry& b) {
+    return a.unique_identifier == b.unique_identifier && a.program_code == b.program_code &&
+           a.swizzle_data == b.swizzle_data;
+}
+
+/// Writes a cache holding the given entries and returns the contents of its file.
+std::string WriteCache(const ScopedShaderDir& shader_dir,
+                       std::initializer_list<JitDiskCacheEntry> entries) {
+    JitDiskCache cache{TITLE_ID};
+    REQUIRE(cache.Load().empty());
+    for (const auto& entry : entries) {
+        Save(cache, entry);
+    }
+
+    std::string contents;
+    FileUtil::ReadFileToString(false, shader_dir.CachePath(), contents);
+    return contents;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("JitDiskCache round trips programs", "[video_core][shader][shader_jit]") {
+    const ScopedShaderDir shader_dir;
+    const auto first = MakeEntry(1);
+    const auto second = MakeEntry(2);
+    {
+        JitDiskCache cache{TITLE_ID};
+        REQUIRE(cache.Load().empty());
+        Save(cache, first);
+        Save(cache, second);
+        // Already recorded, not written again
+        Save(cache, first);
+    }
+
+    JitDiskCache cache{TITLE_ID};
+    const auto entries = cache.Load();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(Equal(entries[0], first));
+    REQUIRE(Equal(entries[1], second));
+
+    // New programs are appended after the loaded ones
+    const auto third = MakeEntry(3);
+    Save(cache, third);
+    Save(cache, second);
+    const auto reloaded = JitDiskCache{TITLE_ID}.Load();
+    REQUIRE(reloaded.size() == 3);
+    REQUIRE(Equal(reloaded[2], third));
+}
+
+TEST_CASE("JitDiskCache rejects damaged files", "[video_core][shader][shader_jit]") {
+    const ScopedShaderDir shader_dir;
+    const std::string contents = WriteCache(shader_dir, {MakeEntry(1), MakeEntry(2)});
+    u32 version;
+    REQUIRE(contents.size() > sizeof(version));
+    std::memcpy(&version, contents.data(), sizeof(version));
+
+    const auto load_with = [&](const std::string& file) {
+        FileUtil::WriteStringToFile(false, shader_dir.CachePath(), file);
+        return JitDiskCache{TITLE_ID}.Load();
+    };
+    const auto with_version = [&](u32 new_version) {
+        std::string file = contents;
+        std::memcpy(file.data(), &new_version, sizeof(new_version));
+        return file;
+    };
+
+    REQUIRE(load_with(contents.substr(0, contents.size() - 3)).empty());
+    // The file is recreated with only the version
+    REQUIRE(FileUtil::GetSize(shader_dir.CachePath()) == sizeof(version));
+
+    std::string corrupt = contents;
+    corrupt[corrupt.size() - 5] ^= 1;
+    REQUIRE(load_with(corrupt).empty());
+    REQUIRE(FileUtil::GetSize(shader_dir.CachePath()) == sizeof(version));
+
+    REQUIRE(load_with(with_version(version - 1)).empty());
+    REQUIRE(FileUtil::GetSize(shader_dir.CachePath()) == sizeof(version));
+
+    // A newer version is left alone for the emulator that wrote it
+    REQUIRE(load_with(with_version(version + 1)).empty());
+    REQUIRE(FileUtil::GetSize(shader_dir.CachePath()) == contents.size());
+}
@@ -0,0 +1,332 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/renderer_software/sw_texturing.h"
+
+using namespace SwRenderer;
+using Pica::TexturingRegs;
+using TevStageConfig = TexturingRegs::TevStageConfig;
+using Source = TevStageConfig::Source;
+using ColorModifier = TevStageConfig::ColorModifier;
+using AlphaModifier = TevStageConfig::AlphaModifier;
+using Operation = TevStageConfig::Operation;
+
+namespace {
+
+struct Inputs {
+    std::array<Common::Vec4<u8>, 4> texture_color;
+    Common::Vec4<u8> primary_color;
+    Common::Vec4<u8> primary_fragment_color;
+    Common::Vec4<u8> secondary_fragment_color;
+};
+
+/// Combiner as evaluated per fragment before TevProgram, walking the registers of every stage.
+Common::Vec4<u8> ReferenceCombine(const TexturingRegs& regs, const Inputs& in) {
+    const auto tev_stages = regs.GetTevStages();
+    Common::Vec4<u8> combiner_output{};
+    Common::Vec4<u8> combiner_buffer{};
+    Common::Vec4<u8> next_combiner_buffer =
+        Common::MakeVec(regs.tev_combiner_buffer_color.r.Value(),
+                        regs.tev_combiner_buffer_color.g.Value(),
+                        regs.tev_combiner_buffer_color.b.Value(),
+                        regs.tev_combiner_buffer_color.a.Value())
+            .Cast<u8>();
+
+    for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
+        const auto& tev_stage = tev_stages[tev_stage_index];
+
+        const auto get_source = [&](Source source) -> Common::Vec4<u8> {
+            switch (source) {
+            case Source::PrimaryColor:
+                return in.primary_color;
+            case Source::PrimaryFragmentColor:
+                return in.primary_fragment_color;
+            case Source::SecondaryFragmentColor:
+                return in.secondary_fragment_color;
+            case Source::Texture0:
+                return in.texture_color[0];
+            case Source::Texture1:
+                return in.texture_color[1];
+            case Source::Texture2:
+                return in.texture_color[2];
+            case Source::Texture3:
+                return in.texture_color[3];
+            case Source::PreviousBuffer:
+                return combiner_buffer;
+            case Source::Constant:
+                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                    .Cast<u8>();
+            case Source::Previous:
+            default:
+                return combiner_output;
+            }
+        };
+
+        auto color_source1 = tev_stage.color_source1.Value();
+        auto color_source2 = tev_stage.color_source2.Value();
+        if (tev_stage_index == 0) {
+            if (color_source1 == Source::Previous) {
+                color_source1 = tev_stage.color_source3;
+            }
+            if (color_source2 == Source::Previous) {
+                color_source2 = tev_stage.color_source3;
+            }
+        }
+
+        const std::array<Common::Vec3<u8>, 3> color_result = {
+            GetColorModifier(tev_stage.color_modifier1, get_source(color_source1)),
+            GetColorModifier(tev_stage.color_modifier2, get_source(color_source2)),
+            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
+        };
+        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
+
+        u8 alpha_output;
+        if (tev_stage.color_op == Operation::Dot3_RGBA) {
+            alpha_output = color_output.x;
+        } else {
+            const std::array<u8, 3> alpha_result = {{
+                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
+                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
+                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
+            }};
+            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
+        }
+
+        combiner_output[0] = std::min(255U, color_output.x * tev_stage.GetColorMultiplier());
+        combiner_output[1] = std::min(255U, color_output.y * tev_stage.GetColorMultiplier());
+        combiner_output[2] = std::min(255U, color_output.z * tev_stage.GetColorMultiplier());
+        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
+
+        combiner_buffer = next_combiner_buffer;
+
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(tev_stage_index)) {
+            next_combiner_buffer.x = combiner_output.x;
+            next_combiner_buffer.y = combiner_output.y;
+            next_combiner_buffer.z = combiner_output.z;
+        }
+        if (regs.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(tev_stage_index)) {
+            next_combiner_buffer.w = combiner_output.w;
+        }
+    }
+
+    return combiner_output;
+}
+
+TevStageConfig& Stage(TexturingRegs& regs, u32 index) {
+    switch (index) {
+    case 0:
+        return regs.tev_stage0;
+    case 1:
+        return regs.tev_stage1;
+    case 2:
+        return regs.tev_stage2;
+    case 3:
+        return regs.tev_stage3;
+    case 4:
+        return regs.tev_stage4;
+    default:
+        return regs.tev_stage5;
+    }
+}
+
+/// Configures a stage to forward the previous combiner output, as games leave unused stages.
+void SetPassthrough(TevStageConfig& stage) {
+    stage.sources_raw = 0;
+    stage.color_source1.Assign(Source::Previous);
+    stage.alpha_source1.Assign(Source::Previous);
+    stage.modifiers_raw = 0;
+    stage.ops_raw = 0;
+    stage.scales_raw = 0;
+}
+
+TexturingRegs PassthroughRegs() {
+    TexturingRegs regs{};
+    for (u32 i = 0; i < 6; ++i) {
+        SetPassthrough(Stage(regs, i));
+    }
+    return regs;
+}
+
+void SetStage(TevStageConfig& stage, Source color, Source alpha, Operation op,
+              Source color2 = Source::PrimaryColor, Source alpha2 = Source::PrimaryColor) {
+    stage.sources_raw = 0;
+    stage.color_source1.Assign(color);
+    stage.color_source2.Assign(color2);
+    stage.color_source3.Assign(Source::Texture1);
+    stage.alpha_source1.Assign(alpha);
+    stage.alpha_source2.Assign(alpha2);
+    stage.alpha_source3.Assign(Source::Texture1);
+    stage.modifiers_raw = 0;
+    stage.ops_raw = 0;
+    stage.color_op.Assign(op);
+    stage.alpha_op.Assign(op == Operation::Dot3_RGBA ? Operation::Modulate : op);
+    stage.scales_raw = 0;
+}
+
+Inputs RandomInputs(std::mt19937& rng) {
+    const auto color = [&] {
+        return Common::MakeVec(rng(), rng(), rng(), rng()).Cast<u8>();
+    };
+    return Inputs{
+        .texture_color = {color(), color(), color(), color()},
+        .primary_color = color(),
+        .primary_fragment_color = color(),
+        .secondary_fragment_color = color(),
+    };
+}
+
+void CheckProgram(const TexturingRegs& regs, std::mt19937& rng) {
+    const TevProgram program{regs};
+    for (int i = 0; i < 64; ++i) {
+        const Inputs in = RandomInputs(rng);
+        REQUIRE(program.Run(in.texture_color, in.primary_color, in.primary_fragment_color,
+                            in.secondary_fragment_color) == ReferenceCombine(regs, in));
+    }
+}
+
+template <typename T, std::size_t N>
+T Pick(const std::array<T, N>& values, std::mt19937& rng) {
+    return values[rng() % N];
+}
+
+constexpr std::array SOURCES = {
+    Source::PrimaryColor, Source::PrimaryFragmentColor, Source::SecondaryFragmentColor,
+    Source::Texture0,     Source::Texture1,             Source::Texture2,
+    Source::Texture3,     Source::PreviousBuffer,       Source::Constant,
+    Source::Previous,
+};
+
+constexpr std::array COLOR_MODIFIERS = {
+    ColorModifier::SourceColor, ColorModifier::OneMinusSourceColor,
+    ColorModifier::SourceAlpha, ColorModifier::OneMinusSourceAlpha,
+    ColorModifier::SourceRed,   ColorModifier::OneMinusSourceRed,
+    ColorModifier::SourceGreen, ColorModifier::OneMinusSourceGreen,
+    ColorModifier::SourceBlue,  ColorModifier::OneMinusSourceBlue,
+};
+
+constexpr std::array OPERATIONS = {
+    Operation::Replace,         Operation::Modulate, Operation::Add,      Operation::AddSigned,
+    Operation::Lerp,            Operation::Subtract, Operation::Dot3_RGB, Operation::Dot3_RGBA,
+    Operation::MultiplyThenAdd, Operation::AddThenMultiply,
+};
+
+void RandomizeStage(TevStageConfig& stage, std::mt19937& rng) {
+    stage.color_source1.Assign(Pick(SOURCES, rng));
+    stage.color_source2.Assign(Pick(SOURCES, rng));
+    stage.color_source3.Assign(Pick(SOURCES, rng));
+    stage.alpha_source1.Assign(Pick(SOURCES, rng));
+    stage.alpha_source2.Assign(Pick(SOURCES, rng));
+    stage.alpha_source3.Assign(Pick(SOURCES, rng));
+    stage.color_modifier1.Assign(Pick(COLOR_MODIFIERS, rng));
+    stage.color_modifier2.Assign(Pick(COLOR_MODIFIERS, rng));
+    stage.color_modifier3.Assign(Pick(COLOR_MODIFIERS, rng));
+    stage.alpha_modifier1.Assign(static_cast<AlphaModifier>(rng() % 8));
+    stage.alpha_modifier2.Assign(static_cast<AlphaModifier>(rng() % 8));
+    stage.alpha_modifier3.Assign(static_cast<AlphaModifier>(rng() % 8));
+    stage.color_op.Assign(Pick(OPERATIONS, rng));
+    // Dot3 is only valid as a color operation
+    Operation alpha_op;
+    do {
+        alpha_op = Pick(OPERATIONS, rng);
+    } while (alpha_op == Operation::Dot3_RGB || alpha_op == Operation::Dot3_RGBA);
+    stage.alpha_op.Assign(alpha_op);
+    stage.const_color = rng();
+    stage.color_scale.Assign(rng() % 4);
+    stage.alpha_scale.Assign(rng() % 4);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TevProgram forwards the first stage through skipped stages",
+          "[video_core][renderer_software]") {
+    std::mt19937 rng{1};
+    TexturingRegs regs = PassthroughRegs();
+    SetStage(regs.tev_stage0, Source::Texture0, Source::PrimaryColor, Operation::Modulate);
+    CheckProgram(regs, rng);
+
+    // Stages on both sides of a run of skipped ones, with scaled output
+    SetStage(regs.tev_stage4, Source::Previous, Source::Previous, Operation::Add,
+             Source::Texture2, Source::SecondaryFragmentColor);
+    regs.tev_stage4.color_scale.Assign(1);
+    regs.tev_stage4.alpha_scale.Assign(2);
+    CheckProgram(regs, rng);
+
+    // An all pass-through program outputs the first stage substituting its color sources
+    CheckProgram(PassthroughRegs(), rng);
+}
+
+TEST_CASE("TevProgram reads the combiner buffer across skipped stages",
+          "[video_core][renderer_software]") {
+    std::mt19937 rng{2};
+    TexturingRegs regs = PassthroughRegs();
+    regs.tev_combiner_buffer_color.raw = 0x80402010;
+
+    // The buffer is written by stages 0 and 1 and read after skipped stages 2 and 3, which still
+    // advance it.
+    SetStage(regs.tev_stage0, Source::Texture0, Source::Texture0, Operation::Replace);
+    SetStage(regs.tev_stage1, Source::PreviousBuffer, Source::PrimaryColor, Operation::Add,
+             Source::Texture3, Source::PreviousBuffer);
+    SetStage(regs.tev_stage4, Source::PreviousBuffer, Source::PreviousBuffer,
+             Operation::Subtract, Source::Previous, Source::Previous);
+    regs.tev_combiner_buffer_input.update_mask_rgb.Assign(0b0011);
+    regs.tev_combiner_buffer_input.update_mask_a.Assign(0b0001);
+    CheckProgram(regs, rng);
+
+    // Skipped stages that update the buffer are kept
+    regs.tev_combiner_buffer_input.update_mask_rgb.Assign(0b0101);
+    regs.tev_combiner_buffer_input.update_mask_a.Assign(0b1000);
+    CheckProgram(regs, rng);
+
+    // The first stage reads the zero buffer, the second one the initial buffer color
+    regs = PassthroughRegs();
+    regs.tev_combiner_buffer_color.raw = 0xFFC08040;
+    SetStage(regs.tev_stage0, Source::PreviousBuffer, Source::PreviousBuffer, Operation::Add,
+             Source::Texture0, Source::Texture0);
+    SetStage(regs.tev_stage5, Source::PreviousBuffer, Source::PreviousBuffer, Operation::Add,
+             Source::Previous, Source::Previous);
+    CheckProgram(regs, rng);
+}
+
+TEST_CASE("TevProgram uses the constant color of each stage", "[video_core][renderer_software]") {
+    std::mt19937 rng{3};
+    TexturingRegs regs = PassthroughRegs();
+    for (u32 i = 0; i < 6; ++i) {
+        auto& stage = Stage(regs, i);
+        SetStage(stage, Source::Constant, Source::Constant,
+                 i % 2 ? Operation::Lerp : Operation::Dot3_RGBA, Source::Previous,
+                 Source::Previous);
+        stage.color_source3.Assign(Source::Constant);
+        stage.color_modifier3.Assign(ColorModifier::SourceAlpha);
+        stage.const_color = 0x01020304 * (i + 1) + 0x10305070;
+    }
+    CheckProgram(regs, rng);
+
+    // Constant only used for alpha, and color for alpha through a modifier
+    SetStage(regs.tev_stage2, Source::Texture1, Source::Constant, Operation::MultiplyThenAdd);
+    regs.tev_stage2.alpha_modifier1.Assign(AlphaModifier::OneMinusSourceGreen);
+    CheckProgram(regs, rng);
+}
+
+TEST_CASE("TevProgram matches the per-fragment combiner for random programs",
+          "[video_core][renderer_software]") {
+    std::mt19937 rng{4};
+    for (int i = 0; i < 500; ++i) {
+        TexturingRegs regs = PassthroughRegs();
+        for (u32 stage = 0; stage < 6; ++stage) {
+            // Leave some stages as pass-through so they get skipped
+            if (rng() % 3 != 0) {
+                RandomizeStage(Stage(regs, stage), rng);
+            }
+        }
+        regs.tev_combiner_buffer_input.update_mask_rgb.Assign(rng() % 16);
+        regs.tev_combiner_buffer_input.update_mask_a.Assign(rng() % 16);
+        regs.tev_combiner_buffer_color.raw = rng();
+        CheckProgram(regs, rng);
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/rasterizer_cache/texture_codec.h"
+
+using VideoCore::PixelFormat;
+
+namespace {
+
+constexpr u32 WIDTH = 64;
+constexpr u32 HEIGHT = 32;
+
+std::vector<u8> RandomData(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+/// Swizzles random data with the row kernels and the scalar path and compares the results.
+template <PixelFormat format, bool converted>
+void CheckFormat() {
+    constexpr u32 tiled_size = WIDTH * HEIGHT * VideoCore::GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel =
+        converted ? 4 : VideoCore::GetFormatBytesPerPixel(format);
+    const auto tiled = RandomData(tiled_size, 1);
+    auto linear = RandomData(WIDTH * HEIGHT * linear_bytes_per_pixel, 2);
+    if constexpr (format == PixelFormat::D24 && converted) {
+        // Encoding depth is only defined for values between zero and one.
+        std::mt19937 rng{3};
+        for (u32 i = 0; i < WIDTH * HEIGHT; i++) {
+            const float depth = static_cast<float>(rng() % 100001) / 100000.f;
+            std::memcpy(linear.data() + i * sizeof(float), &depth, sizeof(float));
+        }
+    }
+
+    auto decoded = linear;
+    auto expected_decoded = linear;
+    auto tiled_copy = tiled;
+    VideoCore::MortonCopy<true, format, converted>(WIDTH, HEIGHT, 0, tiled_size, decoded,
+                                                   tiled_copy);
+    VideoCore::MortonCopy<true, format, converted, true>(WIDTH, HEIGHT, 0, tiled_size,
+                                                         expected_decoded, tiled_copy);
+    REQUIRE(decoded == expected_decoded);
+
+    if constexpr (format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4) {
+        return;
+    } else {
+        // Downloads don't need to start or end on a tile boundary.
+        constexpr u32 start = 37;
+        constexpr u32 end = tiled_size - 51;
+        auto encoded = tiled;
+        auto expected_encoded = tiled;
+        VideoCore::MortonCopy<false, format, converted>(
+            WIDTH, HEIGHT, start, end, linear, std::span{encoded}.first(end - start));
+        VideoCore::MortonCopy<false, format, converted, true>(
+            WIDTH, HEIGHT, start, end, linear, std::span{expected_encoded}.first(end - start));
+        REQUIRE(encoded == expected_encoded);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MortonCopy row kernels match the scalar path", "[video_core][texture_codec]") {
+    SECTION("unconverted") {
+        CheckFormat<PixelFormat::RGBA8, false>();
+        CheckFormat<PixelFormat::RGB8, false>();
+        CheckFormat<PixelFormat::RGB5A1, false>();
+        CheckFormat<PixelFormat::RGB565, false>();
+        CheckFormat<PixelFormat::RGBA4, false>();
+        CheckFormat<PixelFormat::IA8, false>();
+        CheckFormat<PixelFormat::RG8, false>();
+        CheckFormat<PixelFormat::I8, false>();
+        CheckFormat<PixelFormat::A8, false>();
+        CheckFormat<PixelFormat::IA4, false>();
+        CheckFormat<PixelFormat::I4, false>();
+        CheckFormat<PixelFormat::A4, false>();
+        CheckFormat<PixelFormat::ETC1, false>();
+        CheckFormat<PixelFormat::ETC1A4, false>();
+        CheckFormat<PixelFormat::D16, false>();
+        CheckFormat<PixelFormat::D24, false>();
+        CheckFormat<PixelFormat::D24S8, false>();
+    }
+
+    SECTION("converted") {
+        CheckFormat<PixelFormat::RGBA8, true>();
+        CheckFormat<PixelFormat::RGB8, true>();
+        CheckFormat<PixelFormat::RGB5A1, true>();
+        CheckFormat<PixelFormat::RGB565, true>();
+        CheckFormat<PixelFormat::RGBA4, true>();
+        CheckFormat<PixelFormat::D16, true>();
+        CheckFormat<PixelFormat::D24, true>();
+    }
+}
+
+TEST_CASE("MortonCopy benchmark", "[.][video_core][texture_codec][benchmark]") {
+    constexpr u32 width = 512;
+    constexpr u32 height = 512;
+    constexpr u32 tiled_size = width * height * 4;
+    auto tiled = RandomData(tiled_size, 4);
+    std::vector<u8> linear(width * height * 4);
+
+    BENCHMARK("Decode RGBA8 scalar") {
+        VideoCore::MortonCopy<true, PixelFormat::RGBA8, true, true>(width, height, 0, tiled_size,
+                                                                    linear, tiled);
+        return linear[0];
+    };
+    BENCHMARK("Decode RGBA8") {
+        VideoCore::MortonCopy<true, PixelFormat::RGBA8, true>(width, height, 0, tiled_size,
+                                                              linear, tiled);
+        return linear[0];
+    };
+    BENCHMARK("Decode RGB565 scalar") {
+        VideoCore::MortonCopy<true, PixelFormat::RGB565, true, true>(width, height, 0,
+                                                                     tiled_size / 2, linear, tiled);
+        return linear[0];
+    };
+    BENCHMARK("Decode RGB565") {
+        VideoCore::MortonCopy<true, PixelFormat::RGB565, true>(width, height, 0, tiled_size / 2,
+                                                               linear, tiled);
+        return linear[0];
+    };
+    BENCHMARK("Encode RGBA8 scalar") {
+        VideoCore::MortonCopy<false, PixelFormat::RGBA8, true, true>(width, height, 0, tiled_size,
+                                                                     linear, tiled);
+        return tiled[0];
+    };
+    BENCHMARK("Encode RGBA8") {
+        VideoCore::MortonCopy<false, PixelFormat::RGBA8, true>(width, height, 0, tiled_size,
+                                                               linear, tiled);
+        return tiled[0];
+    };
+}
@@ -0,0 +1,236 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_batch.h"
+#include "video_core/shader/shader_interpreter.h"
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+using Type = nihstro::InlineAsm::Type;
+
+namespace {
+
+constexpr u32 NUM_UNIQUE_VERTICES = 512;
+constexpr u32 NUM_INDICES = 6000;
+
+/// Builds a vertex shader with two inputs and two outputs that loops over some arithmetic.
+std::unique_ptr<Pica::ShaderSetup> CompileVertexShader() {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output1 = DestRegister::MakeOutput(0);
+    const auto sh_output2 = DestRegister::MakeOutput(1);
+
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        // clang-format off
+        {OpCode::Id::MOV, sh_temp, sh_input1},
+        {OpCode::Id::LOOP, 0},
+            {OpCode::Id::MUL, sh_temp, sh_temp, sh_input2},
+            {OpCode::Id::ADD, sh_temp, sh_temp, sh_input1},
+        {Type::EndLoop},
+        {OpCode::Id::DP4, sh_output1, sh_temp, sh_input2},
+        {OpCode::Id::MAX, sh_output2, sh_temp, sh_input1},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    auto shader = std::make_unique<Pica::ShaderSetup>();
+    std::transform(shbin.program.begin(), shbin.program.end(), shader->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   shader->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    shader->uniforms.i[0] = {15, 0, 1, 0};
+    return shader;
+}
+
+/// Builds a vertex shader that adds its input to a temporary it never initializes.
+std::unique_ptr<Pica::ShaderSetup> CompileAccumulatingShader() {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output1 = DestRegister::MakeOutput(0);
+    const auto sh_output2 = DestRegister::MakeOutput(1);
+
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        // clang-format off
+        {OpCode::Id::ADD, sh_temp, sh_temp, sh_input1},
+        {OpCode::Id::MOV, sh_output1, sh_temp},
+        {OpCode::Id::MOV, sh_output2, sh_input2},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    auto shader = std::make_unique<Pica::ShaderSetup>();
+    std::transform(shbin.program.begin(), shbin.program.end(), shader->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   shader->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    return shader;
+}
+
+/// Draw state shared by the serial and batched paths.
+struct VertexDraw {
+    explicit VertexDraw(std::unique_ptr<Pica::ShaderSetup> setup_ = CompileVertexShader())
+        : setup{std::move(setup_)} {
+        config.max_input_attribute_index.Assign(1);
+        config.input_attribute_to_register_map_low = 0x10;
+        config.input_attribute_to_register_map_high = 0;
+        config.output_mask.Assign(0b11);
+        engine.SetupBatch(*setup, 0);
+
+        std::mt19937 rng{1234};
+        std::uniform_int_distribution<u32> dist{0, NUM_UNIQUE_VERTICES - 1};
+        vertices.resize(NUM_INDICES);
+        std::generate(vertices.begin(), vertices.end(), [&] { return dist(rng); });
+    }
+
+    static void LoadVertex(u32 vertex, Pica::AttributeBuffer& input) {
+        const float base = static_cast<float>(vertex) / NUM_UNIQUE_VERTICES;
+        input[0] = Common::MakeVec(Pica::f24::FromFloat32(base), Pica::f24::FromFloat32(-base),
+                                   Pica::f24::FromFloat32(base * 2.0f), Pica::f24::One());
+        input[1] = Common::MakeVec(Pica::f24::FromFloat32(0.5f), Pica::f24::FromFloat32(base),
+                                   Pica::f24::FromFloat32(1.0f - base), Pica::f24::One());
+    }
+
+    /// Shades every index through a single ShaderUnit with the 64-entry FIFO vertex cache.
+    std::vector<Pica::AttributeBuffer> RunSerial() const {
+        constexpr std::size_t VERTEX_CACHE_SIZE = 64;
+        std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
+        std::array<u32, VERTEX_CACHE_SIZE> vertex_cache_ids;
+        std::array<Pica::AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
+        u32 vertex_cache_pos = 0;
+
+        std::vector<Pica::AttributeBuffer> outputs;
+        outputs.reserve(vertices.size());
+        Pica::ShaderUnit shader_unit;
+        for (u32 index = 0; index < vertices.size(); ++index) {
+            const u32 vertex = vertices[index];
+            bool vertex_cache_hit = false;
+            for (std::size_t i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
+                    outputs.push_back(vertex_cache[i]);
+                    vertex_cache_hit = true;
+                    break;
+                }
+            }
+            if (vertex_cache_hit) {
+                continue;
+            }
+
+            Pica::AttributeBuffer input{};
+            Pica::AttributeBuffer output{};
+            LoadVertex(vertex, input);
+            shader_unit.LoadInput(config, input);
+            engine.Run(*setup, shader_unit);
+            shader_unit.WriteOutput(config, output);
+
+            vertex_cache[vertex_cache_pos] = output;
+            vertex_cache_valid[vertex_cache_pos] = true;
+            vertex_cache_ids[vertex_cache_pos] = vertex;
+            vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+            outputs.push_back(output);
+        }
+        return outputs;
+    }
+
+    /// Shades every index with a new ShaderUnit.
+    std::vector<Pica::AttributeBuffer> RunIsolated() const {
+        std::vector<Pica::AttributeBuffer> outputs(vertices.size());
+        for (std::size_t index = 0; index < vertices.size(); ++index) {
+            Pica::AttributeBuffer input{};
+            LoadVertex(vertices[index], input);
+            Pica::ShaderUnit shader_unit;
+            shader_unit.LoadInput(config, input);
+            engine.Run(*setup, shader_unit);
+            shader_unit.WriteOutput(config, outputs[index]);
+        }
+        return outputs;
+    }
+
+    std::vector<Pica::AttributeBuffer> RunBatched(Pica::VertexBatch& batch,
+                                                  bool deduplicate) const {
+        std::vector<Pica::AttributeBuffer> outputs;
+        outputs.reserve(vertices.size());
+        const auto load_vertices = [](std::span<const u32> batch_vertices,
+                                      std::span<Pica::AttributeBuffer> inputs) {
+            for (std::size_t i = 0; i < batch_vertices.size(); ++i) {
+                LoadVertex(batch_vertices[i], inputs[i]);
+            }
+        };
+        batch.Process(engine, *setup, config, vertices, deduplicate, load_vertices,
+                      [&](const Pica::AttributeBuffer& output) { outputs.push_back(output); });
+        return outputs;
+    }
+
+    std::unique_ptr<Pica::ShaderSetup> setup;
+    Pica::ShaderRegs config{};
+    Pica::Shader::InterpreterEngine engine;
+    std::vector<u32> vertices;
+};
+
+bool OutputsEqual(const std::vector<Pica::AttributeBuffer>& a,
+                  const std::vector<Pica::AttributeBuffer>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        // Only the two written outputs are compared, the rest of the buffer is unspecified.
+        if (std::memcmp(a[i].data(), b[i].data(), 2 * sizeof(a[i][0])) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VertexBatch matches serial shading", "[video_core][vertex_batch]") {
+    const VertexDraw draw;
+    const auto expected = draw.RunSerial();
+
+    const std::size_t num_workers = GENERATE(0, 1, 3);
+    Pica::VertexBatch batch{num_workers};
+    REQUIRE(OutputsEqual(draw.RunBatched(batch, true), expected));
+    REQUIRE(OutputsEqual(draw.RunBatched(batch, false), expected));
+}
+
+TEST_CASE("VertexBatch doesn't carry registers between vertices", "[video_core][vertex_batch]") {
+    const VertexDraw draw{CompileAccumulatingShader()};
+    const auto expected = draw.RunIsolated();
+
+    const std::size_t num_workers = GENERATE(0, 1, 3);
+    Pica::VertexBatch batch{num_workers};
+    for (int run = 0; run < 2; ++run) {
+        REQUIRE(OutputsEqual(draw.RunBatched(batch, true), expected));
+        REQUIRE(OutputsEqual(draw.RunBatched(batch, false), expected));
+    }
+}
+
+TEST_CASE("VertexBatch benchmark", "[.][video_core][vertex_batch][benchmark]") {
+    const VertexDraw draw;
+    Pica::VertexBatch batch{3};
+
+    BENCHMARK("Serial") {
+        return draw.RunSerial();
+    };
+    BENCHMARK("Batched") {
+        return draw.RunBatched(batch, true);
+    };
+}
@@ -0,0 +1,110 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/pica/vertex_loader.h"
+
+using Format = Pica::PipelineRegs::VertexAttributeFormat;
+
+namespace {
+
+constexpr u32 DATA_OFFSET = 0x100;
+constexpr u32 VERTEX_SIZE = 32;
+constexpr u32 NUM_VERTICES = 256;
+
+/// Returns the bits of a component as it would be loaded by the scalar conversion.
+u32 Expected(float value) {
+    return std::bit_cast<u32>(Pica::f24::FromFloat32(value).ToFloat32());
+}
+
+u32 Loaded(const Pica::AttributeBuffer& buffer, u32 attrib, u32 comp) {
+    return std::bit_cast<u32>(buffer[attrib][comp].ToFloat32());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VertexLoader decodes every format", "[video_core][vertex_loader]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+
+    // float3 at 0, byte4 at 12, ubyte2 at 16, short3 at 18, padded to 32 bytes per vertex.
+    Pica::PipelineRegs regs{};
+    auto& attributes = regs.vertex_attributes;
+    attributes.base_address.Assign(Memory::FCRAM_PADDR / 16);
+    attributes.max_attribute_index.Assign(4);
+    attributes.format0.Assign(Format::FLOAT);
+    attributes.size0.Assign(2);
+    attributes.format1.Assign(Format::BYTE);
+    attributes.size1.Assign(3);
+    attributes.format2.Assign(Format::UBYTE);
+    attributes.size2.Assign(1);
+    attributes.format3.Assign(Format::SHORT);
+    attributes.size3.Assign(2);
+    attributes.attribute_mask.Assign(1 << 4);
+
+    auto& loader_config = attributes.attribute_loaders[0];
+    loader_config.data_offset.Assign(DATA_OFFSET);
+    loader_config.comp0.Assign(0);
+    loader_config.comp1.Assign(1);
+    loader_config.comp2.Assign(2);
+    loader_config.comp3.Assign(3);
+    loader_config.byte_count.Assign(VERTEX_SIZE);
+    loader_config.component_count.Assign(4);
+
+    // Fill the vertex array with random data and some floats that need flushing or truncation.
+    u8* data = memory.GetFCRAMPointer(DATA_OFFSET);
+    std::mt19937 rng{5678};
+    for (u32 i = 0; i < NUM_VERTICES * VERTEX_SIZE; ++i) {
+        data[i] = static_cast<u8>(rng());
+    }
+    constexpr std::array<float, 6> special_floats = {1e-20f, -1e-30f, 1e20f, 1.0f / 3.0f, -0.0f,
+                                                     INFINITY};
+    for (u32 i = 0; i < special_floats.size(); ++i) {
+        std::memcpy(data + i * VERTEX_SIZE, &special_floats[i], sizeof(float));
+    }
+
+    std::vector<u32> vertices(NUM_VERTICES);
+    for (u32& vertex : vertices) {
+        vertex = rng() % NUM_VERTICES;
+    }
+    std::vector<Pica::AttributeBuffer> inputs(vertices.size());
+    Pica::AttributeBuffer default_attributes{};
+    default_attributes[4] = Common::MakeVec(Pica::f24::One(), Pica::f24::Zero(),
+                                            Pica::f24::One(), Pica::f24::Zero());
+
+    const Pica::VertexLoader loader{memory, regs};
+    loader.LoadVertices(attributes.GetPhysicalBaseAddress(), vertices, inputs, default_attributes);
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const u8* vertex = data + vertices[i] * VERTEX_SIZE;
+        const auto& input = inputs[i];
+        for (u32 comp = 0; comp < 3; ++comp) {
+            float value;
+            std::memcpy(&value, vertex + comp * sizeof(float), sizeof(float));
+            REQUIRE(Loaded(input, 0, comp) == Expected(value));
+        }
+        REQUIRE(Loaded(input, 0, 3) == Expected(1.0f));
+        for (u32 comp = 0; comp < 4; ++comp) {
+            REQUIRE(Loaded(input, 1, comp) == Expected(static_cast<s8>(vertex[12 + comp])));
+        }
+        REQUIRE(Loaded(input, 2, 0) == Expected(vertex[16]));
+        REQUIRE(Loaded(input, 2, 1) == Expected(vertex[17]));
+        REQUIRE(Loaded(input, 2, 2) == Expected(0.0f));
+        REQUIRE(Loaded(input, 2, 3) == Expected(1.0f));
+        for (u32 comp = 0; comp < 3; ++comp) {
+            s16 value;
+            std::memcpy(&value, vertex + 18 + comp * sizeof(s16), sizeof(s16));
+            REQUIRE(Loaded(input, 3, comp) == Expected(value));
+        }
+        REQUIRE(Loaded(input, 3, 3) == Expected(1.0f));
+        REQUIRE(input[4] == default_attributes[4]);
+    }
+}
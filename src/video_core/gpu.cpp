@@ -92,6 +92,10 @@ void GPU::InvalidateRegion(PAddr addr, u32 size) {
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
+void GPU::FlushAll() {
+    impl->rasterizer->FlushAll();
+}
+
 void GPU::ClearAll(bool flush) {
     impl->rasterizer->ClearAll(flush);
 }
@@ -58,6 +58,9 @@ public:
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(PAddr addr, u32 size);
 
+    /// Flushes all memory in the rasterizer cache, keeping the cached surfaces.
+    void FlushAll();
+
     /// Flushes and invalidates all memory in the rasterizer cache and removes any leftover state.
     void ClearAll(bool flush);
 
@@ -3,6 +3,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/profiling.h"
@@ -12,6 +14,7 @@
 #include "core/memory.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/pica/pica_core.h"
+#include "video_core/pica/vertex_batch.h"
 #include "video_core/pica/vertex_loader.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/shader/shader.h"
@@ -32,7 +35,9 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext> debug_context_)
     : memory{memory_}, debug_context{std::move(debug_context_)},
       geometry_pipeline{regs.internal, gs_unit, gs_setup},
-      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
+      shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())},
+      vertex_batch{std::make_unique<VertexBatch>(
+          std::max(std::thread::hardware_concurrency(), 2U) >> 1)} {
     InitializeRegs();
 
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
@@ -565,6 +570,34 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
+    // Shade the draw in parallel batches unless the debugger has a breakpoint on every invocation
+    // or the geometry shader consumes the raw indices. The frontends always create a debug context,
+    // so only the breakpoint itself forces the serial path.
+    const bool observe_invocations =
+        debug_context &&
+        debug_context->breakpoints[static_cast<int>(DebugContext::Event::VertexShaderInvocation)]
+            .enabled;
+    if (!observe_invocations && !geometry_pipeline.NeedIndexInput()) {
+        batch_vertices.resize(pipeline.num_vertices);
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            // Indexed rendering doesn't use the start offset
+            batch_vertices[index] =
+                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                           : (index + pipeline.vertex_offset);
+        }
+
+        const auto load_vertices = [&](std::span<const u32> vertices,
+                                       std::span<AttributeBuffer> inputs) {
+            loader.LoadVertices(base_address, vertices, inputs, input_default_attributes);
+        };
+        const auto submit_vertex = [this](const AttributeBuffer& output) {
+            geometry_pipeline.SubmitVertex(output);
+        };
+        vertex_batch->Process(*shader_engine, vs_setup, regs.internal.vs, batch_vertices,
+                              is_indexed, load_vertices, submit_vertex);
+        return;
+    }
+
     for (u32 index = 0; index < pipeline.num_vertices; ++index) {
         // Indexed rendering doesn't use the start offset
         const u32 vertex = is_indexed
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <vector>
 #include "common/common_types.h"
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/geometry_pipeline.h"
@@ -28,6 +29,7 @@ namespace Pica {
 
 class DebugContext;
 class ShaderEngine;
+class VertexBatch;
 
 class PicaCore {
 public:
@@ -292,6 +294,8 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    std::unique_ptr<VertexBatch> vertex_batch;
+    std::vector<u32> batch_vertices;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
@@ -0,0 +1,93 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/alignment.h"
+#include "common/profiling.h"
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/vertex_batch.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica {
+
+VertexBatch::VertexBatch(std::size_t num_workers)
+    : workers{num_workers, "VertexBatch", [](std::size_t) { return ShaderUnit{}; }} {
+    vertex_slots.reserve(BATCH_SIZE);
+    index_slots.resize(BATCH_SIZE);
+    unique_vertices.resize(BATCH_SIZE);
+    inputs.resize(BATCH_SIZE);
+    outputs.resize(BATCH_SIZE);
+}
+
+VertexBatch::~VertexBatch() = default;
+
+void VertexBatch::Process(const ShaderEngine& engine, const ShaderSetup& setup,
+                          const ShaderRegs& config, std::span<const u32> vertices,
+                          bool deduplicate, const VertexLoadHandler& load_vertices,
+                          const VertexHandler& submit_vertex) {
+    BORKED3DS_PROFILE("PicaCore", "Vertex Batch");
+
+    for (std::size_t first = 0; first < vertices.size(); first += BATCH_SIZE) {
+        const std::size_t count = std::min(BATCH_SIZE, vertices.size() - first);
+
+        // Gather every vertex id that is not already part of this batch and load them together.
+        u32 num_unique = 0;
+        vertex_slots.clear();
+        for (std::size_t i = 0; i < count; ++i) {
+            const u32 vertex = vertices[first + i];
+            if (deduplicate) {
+                const auto [it, is_new] = vertex_slots.try_emplace(vertex, num_unique);
+                index_slots[i] = it->second;
+                if (!is_new) {
+                    continue;
+                }
+            } else {
+                index_slots[i] = num_unique;
+            }
+            unique_vertices[num_unique++] = vertex;
+        }
+        load_vertices(std::span{unique_vertices}.first(num_unique),
+                      std::span{inputs}.first(num_unique));
+
+        Shade(engine, setup, config, num_unique);
+
+        // Send to geometry pipeline in the original order.
+        for (std::size_t i = 0; i < count; ++i) {
+            submit_vertex(outputs[index_slots[i]]);
+        }
+    }
+}
+
+void VertexBatch::Shade(const ShaderEngine& engine, const ShaderSetup& setup,
+                        const ShaderRegs& config, std::size_t num_unique) {
+    const auto shade_range = [&](ShaderUnit& unit, std::size_t begin, std::size_t end) {
+        // Every vertex starts from a cleared unit. Registers a shader reads before writing them
+        // would otherwise hold whatever the thread shaded last, which depends on scheduling.
+        unit = ShaderUnit{};
+        engine.RunBatch(setup, config, unit, std::span{inputs}.subspan(begin, end - begin),
+                        std::span{outputs}.subspan(begin, end - begin));
+    };
+
+    // The calling thread shades the first range itself, so small batches never leave it.
+    const std::size_t max_tasks = workers.NumWorkers() + 1;
+    const std::size_t num_tasks =
+        std::clamp<std::size_t>(num_unique / MIN_VERTICES_PER_TASK, 1, max_tasks);
+    // Ranges are kept a multiple of four so engines shading several vertices at once stay full.
+    const std::size_t task_size = Common::AlignUp((num_unique + num_tasks - 1) / num_tasks, 4);
+
+    for (std::size_t begin = task_size; begin < num_unique; begin += task_size) {
+        const std::size_t end = std::min(begin + task_size, num_unique);
+        workers.QueueWork(
+            [&shade_range, begin, end](ShaderUnit* unit) { shade_range(*unit, begin, end); });
+    }
+
+    shade_range(shader_unit, 0, std::min(task_size, num_unique));
+
+    if (num_tasks > 1) {
+        workers.WaitForRequests();
+    }
+}
+
+} // namespace Pica
@@ -0,0 +1,69 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "common/thread_worker.h"
+#include "video_core/pica/shader_unit.h"
+
+namespace Pica {
+
+class ShaderEngine;
+struct ShaderRegs;
+struct ShaderSetup;
+
+/**
+ * Runs the vertex shader over the vertices of a draw in batches. Each batch deduplicates its
+ * vertex ids with a hashed cache, shades the unique vertices on several threads with one
+ * ShaderUnit each and then submits the outputs in the original index order.
+ */
+class VertexBatch {
+public:
+    /// Number of indices loaded and shaded together.
+    static constexpr std::size_t BATCH_SIZE = 1024;
+
+    /// Minimum number of unique vertices worth handing to another thread.
+    static constexpr std::size_t MIN_VERTICES_PER_TASK = 32;
+
+    /// Handler type for loading the input attributes of several vertices from their vertex ids
+    using VertexLoadHandler =
+        std::function<void(std::span<const u32> vertices, std::span<AttributeBuffer> inputs)>;
+
+    explicit VertexBatch(std::size_t num_workers);
+    ~VertexBatch();
+
+    /**
+     * Shades the vertices of a draw and submits their outputs in draw order.
+     * @param engine Shader engine, must be setup with SetupBatch for the provided shader.
+     * @param setup Vertex shader state.
+     * @param config Vertex shader configuration.
+     * @param vertices Vertex id of every index of the draw.
+     * @param deduplicate Whether indices referring to the same vertex id share an invocation.
+     * @param load_vertices Handler that loads the input attributes of the unique vertices.
+     * @param submit_vertex Handler that receives the shaded vertices in draw order.
+     */
+    void Process(const ShaderEngine& engine, const ShaderSetup& setup, const ShaderRegs& config,
+                 std::span<const u32> vertices, bool deduplicate,
+                 const VertexLoadHandler& load_vertices, const VertexHandler& submit_vertex);
+
+private:
+    /// Shades the loaded unique vertices of the current batch.
+    void Shade(const ShaderEngine& engine, const ShaderSetup& setup, const ShaderRegs& config,
+               std::size_t num_unique);
+
+    Common::StatefulThreadWorker<ShaderUnit> workers;
+    ShaderUnit shader_unit;
+    std::unordered_map<u32, u32> vertex_slots;
+    std::vector<u32> index_slots;
+    std::vector<u32> unique_vertices;
+    std::vector<AttributeBuffer> inputs;
+    std::vector<AttributeBuffer> outputs;
+};
+
+} // namespace Pica
@@ -3,23 +3,174 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/alignment.h"
 #include "common/logging/log.h"
+#include "common/vector_math.h"
 #include "video_core/pica/vertex_loader.h"
 
 namespace Pica {
 
+namespace {
+
+static_assert(sizeof(f24) == sizeof(float) && sizeof(Common::Vec4<f24>) == 4 * sizeof(float),
+              "Attributes are stored as four packed floats");
+
+#if defined(HAVE_SSE2)
+using Components = __m128;
+
+/// Same as f24::FromFloat32 for every component: flushes denormals, saturates to infinity and
+/// truncates the mantissa to 16 bits.
+Components TruncF24(Components value) {
+    const __m128i bits = _mm_castps_si128(value);
+    const __m128i abs = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+    const __m128i sign = _mm_xor_si128(bits, abs);
+    const __m128i is_small = _mm_cmplt_epi32(abs, _mm_set1_epi32(0x20800000)); // 2^-62
+    const __m128i is_big = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x5F800000));   // 2^64
+    const __m128i is_nan = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7F800000));
+    const __m128i inf = _mm_or_si128(sign, _mm_set1_epi32(0x7F800000));
+
+    __m128i result = _mm_and_si128(bits, _mm_set1_epi32(0xFFFFFF80));
+    result = _mm_or_si128(_mm_and_si128(is_big, inf), _mm_andnot_si128(is_big, result));
+    result = _mm_or_si128(_mm_and_si128(is_nan, bits), _mm_andnot_si128(is_nan, result));
+    result = _mm_andnot_si128(is_small, result);
+    return _mm_castsi128_ps(result);
+}
+
+template <typename T>
+Components ToComponents(const T* raw) {
+    if constexpr (std::is_same_v<T, f32>) {
+        return TruncF24(_mm_loadu_ps(raw));
+    } else if constexpr (std::is_same_v<T, s16>) {
+        // Integers of up to 16 bits are exact in f24, so no truncation is needed.
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(raw));
+        return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+    } else {
+        s32 packed;
+        std::memcpy(&packed, raw, sizeof(packed));
+        const __m128i v = _mm_cvtsi32_si128(packed);
+        if constexpr (std::is_same_v<T, s8>) {
+            const __m128i v16 = _mm_unpacklo_epi8(v, v);
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v16, v16), 24));
+        } else {
+            const __m128i zero = _mm_setzero_si128();
+            return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(v, zero), zero));
+        }
+    }
+}
+
+void StoreComponents(Components value, bool set_w, Common::Vec4<f24>& out) {
+    if (set_w) {
+        value = _mm_or_ps(value, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+    _mm_storeu_ps(reinterpret_cast<float*>(out.AsArray()), value);
+}
+#elif defined(HAVE_NEON)
+using Components = float32x4_t;
+
+/// Same as f24::FromFloat32 for every component: flushes denormals, saturates to infinity and
+/// truncates the mantissa to 16 bits.
+Components TruncF24(Components value) {
+    const uint32x4_t bits = vreinterpretq_u32_f32(value);
+    const uint32x4_t abs = vandq_u32(bits, vdupq_n_u32(0x7FFFFFFF));
+    const uint32x4_t sign = veorq_u32(bits, abs);
+    const uint32x4_t is_small = vcltq_u32(abs, vdupq_n_u32(0x20800000)); // 2^-62
+    const uint32x4_t is_big = vcgtq_u32(abs, vdupq_n_u32(0x5F800000));   // 2^64
+    const uint32x4_t is_nan = vcgtq_u32(abs, vdupq_n_u32(0x7F800000));
+    const uint32x4_t inf = vorrq_u32(sign, vdupq_n_u32(0x7F800000));
+
+    uint32x4_t result = vandq_u32(bits, vdupq_n_u32(0xFFFFFF80));
+    result = vbslq_u32(is_big, inf, result);
+    result = vbslq_u32(is_nan, bits, result);
+    result = vbicq_u32(result, is_small);
+    return vreinterpretq_f32_u32(result);
+}
+
+template <typename T>
+Components ToComponents(const T* raw) {
+    if constexpr (std::is_same_v<T, f32>) {
+        return TruncF24(vld1q_f32(raw));
+    } else if constexpr (std::is_same_v<T, s16>) {
+        // Integers of up to 16 bits are exact in f24, so no truncation is needed.
+        return vcvtq_f32_s32(vmovl_s16(vld1_s16(raw)));
+    } else if constexpr (std::is_same_v<T, s8>) {
+        const int16x8_t v16 = vmovl_s8(vld1_s8(raw));
+        return vcvtq_f32_s32(vmovl_s16(vget_low_s16(v16)));
+    } else {
+        const uint16x8_t v16 = vmovl_u8(vld1_u8(raw));
+        return vcvtq_f32_u32(vmovl_u16(vget_low_u16(v16)));
+    }
+}
+
+void StoreComponents(Components value, bool set_w, Common::Vec4<f24>& out) {
+    if (set_w) {
+        value = vsetq_lane_f32(1.0f, value, 3);
+    }
+    vst1q_f32(reinterpret_cast<float*>(out.AsArray()), value);
+}
+#else
+using Components = std::array<f24, 4>;
+
+template <typename T>
+Components ToComponents(const T* raw) {
+    Components components;
+    for (std::size_t comp = 0; comp < 4; ++comp) {
+        components[comp] = f24::FromFloat32(static_cast<float>(raw[comp]));
+    }
+    return components;
+}
+
+void StoreComponents(const Components& value, bool set_w, Common::Vec4<f24>& out) {
+    out = Common::MakeVec(value[0], value[1], value[2], set_w ? f24::One() : value[3]);
+}
+#endif
+
+/**
+ * Decodes an attribute with N elements of type T. Missing elements are zero, except for w which is
+ * one. This is *not* carried over from the default attribute settings even if they're enabled for
+ * this attribute.
+ */
+template <typename T, u32 N>
+void DecodeAttribute(const u8* data, u32 stride, u32 first_vertex, std::span<const u32> vertices,
+                     u32 attrib, std::span<AttributeBuffer> out) {
+    // Padded to a full vector so the loads never read past it, elements after N stay zero.
+    std::array<T, 16 / sizeof(T)> raw{};
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        std::memcpy(raw.data(), data + stride * (vertices[i] - first_vertex), N * sizeof(T));
+        StoreComponents(ToComponents(raw.data()), N < 4, out[i][attrib]);
+    }
+}
+
+template <typename T>
+constexpr std::array<VertexLoader::AttributeDecoder, 4> DECODERS_FOR_TYPE = {
+    &DecodeAttribute<T, 1>,
+    &DecodeAttribute<T, 2>,
+    &DecodeAttribute<T, 3>,
+    &DecodeAttribute<T, 4>,
+};
+
+/// Decoders by vertex attribute format and number of elements
+constexpr std::array<std::array<VertexLoader::AttributeDecoder, 4>, 4> DECODERS = {
+    DECODERS_FOR_TYPE<s8>,
+    DECODERS_FOR_TYPE<u8>,
+    DECODERS_FOR_TYPE<s16>,
+    DECODERS_FOR_TYPE<f32>,
+};
+
+} // Anonymous namespace
+
 VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs)
     : memory{memory_} {
     const auto& attribute_config = regs.vertex_attributes;
     num_total_attributes = attribute_config.GetNumTotalAttributes();
 
+    std::array<u32, 16> vertex_attribute_sources;
+    std::array<u32, 16> vertex_attribute_strides{};
+    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
+    std::array<u32, 16> vertex_attribute_elements{};
     vertex_attribute_sources.fill(0xdeadbeef);
 
-    for (u32 i = 0; i < 16; i++) {
-        vertex_attribute_is_default[i] = attribute_config.IsDefaultAttribute(i);
-    }
-
     // Setup attribute data from loaders
     for (u32 loader = 0; loader < 12; ++loader) {
         const auto& loader_config = attribute_config.attribute_loaders[loader];
@@ -58,51 +209,80 @@ VertexLoader::VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& re
             }
         }
     }
-}
 
-VertexLoader::~VertexLoader() = default;
-
-void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
-                              AttributeBuffer& input_default_attributes) const {
+    // Build the decode plan of the draw, so loading a vertex no longer switches on the layout.
     for (s32 i = 0; i < num_total_attributes; ++i) {
         // Load the default attribute if we're configured to do so
-        if (vertex_attribute_is_default[i]) {
-            input[i] = input_default_attributes[i];
+        if (attribute_config.IsDefaultAttribute(i)) {
+            default_attributes[num_default_attributes++] = i;
             continue;
         }
 
         // TODO(yuriks): In this case, no data gets loaded and the vertex
         // remains with the last value it had. This isn't currently maintained
         // as global state, however, and so won't work in Borked3DS yet.
-        if (vertex_attribute_elements[i] == 0) {
-            LOG_ERROR(HW_GPU, "Vertex retension unimplemented");
+        const u32 elements = vertex_attribute_elements[i];
+        if (elements == 0) {
+            has_retained_attributes = true;
             continue;
         }
 
-        // Load per-vertex data from the loader arrays
-        const PAddr source_addr =
-            base_address + vertex_attribute_sources[i] + vertex_attribute_strides[i] * vertex;
-
-        switch (vertex_attribute_formats[i]) {
-        case PipelineRegs::VertexAttributeFormat::BYTE:
-            LoadAttribute<s8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::UBYTE:
-            LoadAttribute<u8>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::SHORT:
-            LoadAttribute<s16>(source_addr, i, input);
-            break;
-        case PipelineRegs::VertexAttributeFormat::FLOAT:
-            LoadAttribute<f32>(source_addr, i, input);
-            break;
+        const auto format = vertex_attribute_formats[i];
+        attribute_plans[num_attribute_plans++] = {
+            .attrib = static_cast<u32>(i),
+            .source = vertex_attribute_sources[i],
+            .stride = vertex_attribute_strides[i],
+            .size = elements * PipelineRegs::GetFormatBytes(format),
+            .decode = DECODERS[static_cast<u32>(format)][elements - 1],
+        };
+    }
+}
+
+VertexLoader::~VertexLoader() = default;
+
+void VertexLoader::LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
+                              AttributeBuffer& input_default_attributes) const {
+    LoadVertices(base_address, {&vertex, 1}, {&input, 1}, input_default_attributes);
+}
+
+void VertexLoader::LoadVertices(PAddr base_address, std::span<const u32> vertices,
+                                std::span<AttributeBuffer> inputs,
+                                const AttributeBuffer& input_default_attributes) const {
+    if (vertices.empty()) {
+        return;
+    }
+
+    if (has_retained_attributes) {
+        LOG_ERROR(HW_GPU, "Vertex retension unimplemented");
+    }
+
+    for (std::size_t i = 0; i < num_default_attributes; ++i) {
+        const u32 attrib = default_attributes[i];
+        for (AttributeBuffer& input : inputs) {
+            input[attrib] = input_default_attributes[attrib];
+        }
+    }
+
+    const auto [min_vertex, max_vertex] = std::minmax_element(vertices.begin(), vertices.end());
+    for (std::size_t i = 0; i < num_attribute_plans; ++i) {
+        const AttributePlan& plan = attribute_plans[i];
+
+        // Decode every vertex straight from the host pointer when the whole range of the array
+        // that is accessed lies within the same memory region.
+        const PAddr first_addr = base_address + plan.source + plan.stride * *min_vertex;
+        const PAddr last_addr = base_address + plan.source + plan.stride * *max_vertex + plan.size;
+        const u8* first_ptr = memory.GetPhysicalPointer(first_addr);
+        const u8* last_ptr = memory.GetPhysicalPointer(last_addr);
+        if (first_ptr && last_ptr &&
+            last_ptr - first_ptr == static_cast<std::ptrdiff_t>(last_addr - first_addr)) {
+            plan.decode(first_ptr, plan.stride, *min_vertex, vertices, plan.attrib, inputs);
+            continue;
         }
 
-        // Default attribute values set if array elements have < 4 components. This
-        // is *not* carried over from the default attribute settings even if they're
-        // enabled for this attribute.
-        for (u32 comp = vertex_attribute_elements[i]; comp < 4; comp++) {
-            input[i][comp] = comp == 3 ? f24::One() : f24::Zero();
+        for (std::size_t j = 0; j < vertices.size(); ++j) {
+            const PAddr source_addr = base_address + plan.source + plan.stride * vertices[j];
+            plan.decode(memory.GetPhysicalPointer(source_addr), plan.stride, vertices[j],
+                        vertices.subspan(j, 1), plan.attrib, inputs.subspan(j, 1));
         }
     }
 }
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <span>
 #include "core/memory.h"
 #include "video_core/pica/output_vertex.h"
 #include "video_core/pica/regs_pipeline.h"
@@ -17,31 +18,52 @@ namespace Pica {
 
 class VertexLoader {
 public:
+    /**
+     * Decodes attribute `attrib` of a run of vertices into `out`. The data of vertex `vertices[i]`
+     * starts at `data + stride * (vertices[i] - first_vertex)`.
+     */
+    using AttributeDecoder = void (*)(const u8* data, u32 stride, u32 first_vertex,
+                                      std::span<const u32> vertices, u32 attrib,
+                                      std::span<AttributeBuffer> out);
+
     explicit VertexLoader(Memory::MemorySystem& memory_, const PipelineRegs& regs);
     ~VertexLoader();
 
     void LoadVertex(PAddr base_address, u32 index, u32 vertex, AttributeBuffer& input,
                     AttributeBuffer& input_default_attributes) const;
 
-    template <typename T>
-    void LoadAttribute(PAddr source_addr, u32 attrib, AttributeBuffer& out) const {
-        const T* data = reinterpret_cast<const T*>(memory.GetPhysicalPointer(source_addr));
-        for (u32 comp = 0; comp < vertex_attribute_elements[attrib]; ++comp) {
-            out[attrib][comp] = f24::FromFloat32(data[comp]);
-        }
-    }
+    /**
+     * Loads the input attributes of several vertices. Each attribute is decoded for all the
+     * vertices at once with the decoder selected for its format when the loader was created.
+     * @param base_address Base address of the vertex arrays.
+     * @param vertices Vertex id of each vertex to load.
+     * @param inputs Receives the input attributes of each vertex.
+     * @param input_default_attributes Values of the attributes configured as default.
+     */
+    void LoadVertices(PAddr base_address, std::span<const u32> vertices,
+                      std::span<AttributeBuffer> inputs,
+                      const AttributeBuffer& input_default_attributes) const;
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
     }
 
 private:
+    /// Decode plan of an attribute loaded from the vertex arrays
+    struct AttributePlan {
+        u32 attrib;
+        u32 source;
+        u32 stride;
+        u32 size;
+        AttributeDecoder decode;
+    };
+
     Memory::MemorySystem& memory;
-    std::array<u32, 16> vertex_attribute_sources;
-    std::array<u32, 16> vertex_attribute_strides{};
-    std::array<PipelineRegs::VertexAttributeFormat, 16> vertex_attribute_formats;
-    std::array<u32, 16> vertex_attribute_elements{};
-    std::array<bool, 16> vertex_attribute_is_default;
+    std::array<AttributePlan, 16> attribute_plans{};
+    std::size_t num_attribute_plans = 0;
+    std::array<u32, 16> default_attributes{};
+    std::size_t num_default_attributes = 0;
+    bool has_retained_attributes = false;
     int num_total_attributes = 0;
 };
 
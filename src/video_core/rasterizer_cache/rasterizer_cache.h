@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <thread>
 #include <type_traits>
 #include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
 #include "common/alignment.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/profiling.h"
 #include "common/scope_exit.h"
@@ -37,7 +40,8 @@ RasterizerCache<T>::RasterizerCache(Memory::MemorySystem& memory_,
       renderer{renderer_}, resolution_scale_factor{renderer.GetResolutionScaleFactor()},
       filter{Settings::values.texture_filter.GetValue()},
       dump_textures{Settings::values.dump_textures.GetValue()},
-      use_custom_textures{Settings::values.custom_textures.GetValue()} {
+      use_custom_textures{Settings::values.custom_textures.GetValue()},
+      decode_workers{std::max(std::thread::hardware_concurrency(), 2U) >> 1, "TextureDecode"} {
 
     program_id = OpenGL::ShaderDiskCache::GetInstance().GetProgramID(); //gvx64 store game at object construction for game-specific hacks in methods AccelerateTextureCopy() and AccelerateDisplayTransfer()
 
@@ -89,6 +93,11 @@ void RasterizerCache<T>::TickFrame() {
     custom_tex_manager.TickFrame();
     RunGarbageCollector();
 
+    BORKED3DS_PLOT("Texture Bytes Decoded", decoded_bytes);
+    BORKED3DS_PLOT("Texture Bytes Decoded In Parallel", parallel_decoded_bytes);
+    decoded_bytes = 0;
+    parallel_decoded_bytes = 0;
+
     const auto new_filter = Settings::values.texture_filter.GetValue();
     if (filter != new_filter) [[unlikely]] {
         filter = new_filter;
@@ -1028,7 +1037,7 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 
         FlushRegion(params.addr, params.size);
         if (!use_custom_textures || !UploadCustomSurface(surface_id, interval)) {
-            UploadSurface(surface, interval);
+            UploadSurface(surface_id, interval);
         }
         notify_validated(params.GetInterval());
     }
@@ -1041,22 +1050,30 @@ void RasterizerCache<T>::ValidateSurface(SurfaceId surface_id, PAddr addr, u32 s
 }
 
 template <class T>
-void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interval) {
+void RasterizerCache<T>::UploadSurface(SurfaceId surface_id, SurfaceInterval interval) {
     BORKED3DS_PROFILE("RasterizerCache", "Upload Surface");
 
+    Surface& surface = slot_surfaces[surface_id];
     const SurfaceParams load_info = surface.FromInterval(interval);
     ASSERT(load_info.addr >= surface.addr && load_info.end <= surface.end);
 
-    const auto staging = runtime.FindStaging(
-        load_info.width * load_info.height * surface.GetInternalBytesPerPixel(), true);
-
     MemoryRef source_ptr = memory.GetPhysicalRef(load_info.addr);
     if (!source_ptr) [[unlikely]] {
         return;
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
+    const HashedUploadId upload_id = GetHashedUpload(load_info, upload_data);
+    const u64 content_hash = slot_hashed_uploads[upload_id].content_hash;
+    if (!dump_textures &&
+        CopyIdenticalUpload(surface_id, load_info, upload_data, content_hash)) {
+        slot_hashed_uploads[upload_id].surface_id = surface_id;
+        return;
+    }
+
+    const auto staging = runtime.FindStaging(
+        load_info.width * load_info.height * surface.GetInternalBytesPerPixel(), true);
+    DecodeSurface(load_info, upload_data, staging.mapped,
                   runtime.NeedsConversion(surface.pixel_format));
 
     const bool should_dump = False(surface.flags & SurfaceFlagBits::Custom) &&
@@ -1074,20 +1091,205 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
         .texture_level = surface.LevelOf(load_info.addr),
     };
     surface.Upload(upload, staging);
+
+    slot_hashed_uploads[upload_id].surface_id = surface_id;
+    uploads_by_content[content_hash] = upload_id;
+}
+
+template <class T>
+void RasterizerCache<T>::DecodeSurface(const SurfaceParams& load_info, std::span<u8> source,
+                                       std::span<u8> dest, bool convert) {
+    const u32 dest_bytes_per_pixel = convert ? 4 : GetFormatBytesPerPixel(load_info.pixel_format);
+    const u32 decoded_size = load_info.width * load_info.height * dest_bytes_per_pixel;
+    const u32 num_tile_rows = load_info.height / 8;
+    decoded_bytes += decoded_size;
+
+    // Uploads narrower than a row of tiles and linear textures are always decoded inline.
+    if (!load_info.is_tiled || load_info.stride != load_info.width || num_tile_rows < 2 ||
+        decoded_size < PARALLEL_DECODE_THRESHOLD || decode_workers.NumWorkers() == 0) {
+        DecodeTexture(load_info, load_info.addr, load_info.end, source, dest, convert);
+        return;
+    }
+
+    BORKED3DS_PROFILE("RasterizerCache", "Parallel Decode");
+    parallel_decoded_bytes += decoded_size;
+
+    const u32 source_row_size = load_info.BytesInPixels(load_info.width * 8);
+    const u32 dest_row_size = load_info.width * 8 * dest_bytes_per_pixel;
+    const u32 rows_per_task = std::max(PARALLEL_DECODE_TASK_SIZE / dest_row_size, 1U);
+
+    // The linear data is stored bottom up, so the first rows of tiles go to the end of dest.
+    const auto decode_rows = [&](u32 first_row, u32 num_rows) {
+        SurfaceParams rows_info = load_info;
+        rows_info.addr = load_info.addr + first_row * source_row_size;
+        rows_info.height = num_rows * 8;
+        rows_info.UpdateParams();
+        const u32 dest_row = num_tile_rows - first_row - num_rows;
+        DecodeTexture(rows_info, rows_info.addr, rows_info.end,
+                      source.subspan(first_row * source_row_size, num_rows * source_row_size),
+                      dest.subspan(dest_row * dest_row_size, num_rows * dest_row_size), convert);
+    };
+
+    for (u32 row = rows_per_task; row < num_tile_rows; row += rows_per_task) {
+        const u32 num_rows = std::min(rows_per_task, num_tile_rows - row);
+        decode_workers.QueueWork([&decode_rows, row, num_rows] { decode_rows(row, num_rows); });
+    }
+    decode_rows(0, std::min(rows_per_task, num_tile_rows));
+    decode_workers.WaitForRequests();
 }
 
 template <class T>
 u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data) {
+    HashedUpload& hashed_upload = slot_hashed_uploads[GetHashedUpload(load_info, upload_data)];
+    if (hashed_upload.hash) {
+        return *hashed_upload.hash;
+    }
+
     if (!custom_tex_manager.UseNewHash()) {
         const u32 width = load_info.width;
         const u32 height = load_info.height;
         const u32 bpp = GetFormatBytesPerPixel(load_info.pixel_format);
         auto decoded = std::vector<u8>(width * height * bpp);
         DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, decoded, false);
-        return Common::ComputeHash64(decoded.data(), decoded.size());
+        hashed_upload.hash = Common::ComputeHash64(decoded.data(), decoded.size());
     } else {
-        return Common::ComputeHash64(upload_data.data(), upload_data.size());
+        hashed_upload.hash = Common::ComputeHash64(upload_data.data(), upload_data.size());
+    }
+    return *hashed_upload.hash;
+}
+
+template <class T>
+HashedUploadId RasterizerCache<T>::GetHashedUpload(const SurfaceParams& load_info,
+                                                   std::span<u8> upload_data) {
+    // Hashed uploads are dropped when their guest data changes, so a match is still current.
+    const auto page_it = upload_pages.find(load_info.addr >> BORKED3DS_PAGEBITS);
+    if (page_it != upload_pages.end()) {
+        for (const HashedUploadId upload_id : page_it->second) {
+            const SurfaceParams& params = slot_hashed_uploads[upload_id].params;
+            if (params.addr == load_info.addr && params.end == load_info.end &&
+                params.width == load_info.width && params.height == load_info.height &&
+                params.stride == load_info.stride && params.is_tiled == load_info.is_tiled &&
+                params.pixel_format == load_info.pixel_format) {
+                return upload_id;
+            }
+        }
+    }
+
+    if (slot_hashed_uploads.size() >= MAX_HASHED_UPLOADS) {
+        UnregisterAllHashedUploads();
+    }
+
+    const u64 content_hash =
+        Common::ComputeHash64(upload_data.data(), upload_data.size(), Common::HashAlgorithm::Fast);
+    const HashedUploadId upload_id =
+        slot_hashed_uploads.insert(load_info, content_hash, std::nullopt, SurfaceId{});
+
+    // Keep the pages cached so writes from the CPU are seen even after the surfaces are gone.
+    UpdatePagesCachedCount(load_info.addr, load_info.size, 1);
+    ForEachPage(load_info.addr, load_info.size,
+                [this, upload_id](u64 page) { upload_pages[page].push_back(upload_id); });
+    return upload_id;
+}
+
+template <class T>
+void RasterizerCache<T>::UnregisterHashedUpload(HashedUploadId upload_id) {
+    const HashedUpload& hashed_upload = slot_hashed_uploads[upload_id];
+    const SurfaceParams& params = hashed_upload.params;
+
+    UpdatePagesCachedCount(params.addr, params.size, -1);
+    ForEachPage(params.addr, params.size, [this, upload_id](u64 page) {
+        std::vector<HashedUploadId>& uploads = upload_pages[page];
+        std::erase(uploads, upload_id);
+    });
+
+    const auto content_it = uploads_by_content.find(hashed_upload.content_hash);
+    if (content_it != uploads_by_content.end() && content_it->second == upload_id) {
+        uploads_by_content.erase(content_it);
     }
+    slot_hashed_uploads.erase(upload_id);
+}
+
+template <class T>
+void RasterizerCache<T>::UnregisterHashedUploads(PAddr addr, u32 size) {
+    boost::container::small_vector<HashedUploadId, 16> remove_uploads;
+    ForEachPage(addr, size, [&](u64 page) {
+        const auto page_it = upload_pages.find(page);
+        if (page_it == upload_pages.end()) {
+            return;
+        }
+        for (const HashedUploadId upload_id : page_it->second) {
+            const SurfaceParams& params = slot_hashed_uploads[upload_id].params;
+            const bool overlaps = params.addr < addr + size && params.end > addr;
+            if (overlaps && std::find(remove_uploads.begin(), remove_uploads.end(), upload_id) ==
+                                remove_uploads.end()) {
+                remove_uploads.push_back(upload_id);
+            }
+        }
+    });
+
+    for (const HashedUploadId upload_id : remove_uploads) {
+        UnregisterHashedUpload(upload_id);
+    }
+}
+
+template <class T>
+void RasterizerCache<T>::UnregisterAllHashedUploads() {
+    slot_hashed_uploads.ForEach([this](HashedUploadId, const HashedUpload& hashed_upload) {
+        UpdatePagesCachedCount(hashed_upload.params.addr, hashed_upload.params.size, -1);
+    });
+    slot_hashed_uploads.clear();
+    upload_pages.clear();
+    uploads_by_content.clear();
+}
+
+template <class T>
+bool RasterizerCache<T>::CopyIdenticalUpload(SurfaceId surface_id, const SurfaceParams& load_info,
+                                             std::span<u8> upload_data, u64 content_hash) {
+    const auto content_it = uploads_by_content.find(content_hash);
+    if (content_it == uploads_by_content.end()) {
+        return false;
+    }
+
+    const HashedUpload& source = slot_hashed_uploads[content_it->second];
+    const SurfaceParams& source_info = source.params;
+    if (!source.surface_id || source.surface_id == surface_id ||
+        source_info.width != load_info.width || source_info.height != load_info.height ||
+        source_info.stride != load_info.stride || source_info.is_tiled != load_info.is_tiled ||
+        source_info.pixel_format != load_info.pixel_format) {
+        return false;
+    }
+
+    // The source surface may have been unregistered or had its slot reused since the upload, it
+    // is only usable if it still holds the decoded data at the same address.
+    Surface& source_surface = slot_surfaces[source.surface_id];
+    Surface& surface = slot_surfaces[surface_id];
+    if (False(source_surface.flags & SurfaceFlagBits::Registered) || source_surface.IsCustom() ||
+        source_surface.type == SurfaceType::Fill ||
+        source_surface.pixel_format != surface.pixel_format ||
+        source_surface.res_scale != surface.res_scale || source_info.addr < source_surface.addr ||
+        source_info.end > source_surface.end ||
+        !source_surface.IsRegionValid(source_info.GetInterval())) {
+        return false;
+    }
+
+    // The hash only finds a candidate, the guest data has to match exactly.
+    MemoryRef source_ptr = memory.GetPhysicalRef(source_info.addr);
+    if (!source_ptr || !std::ranges::equal(source_ptr.GetWriteBytes(upload_data.size()),
+                                           upload_data)) {
+        return false;
+    }
+
+    BORKED3DS_PROFILE("RasterizerCache", "Copy Identical Upload");
+    const auto src_rect = source_surface.GetScaledSubRect(source_info);
+    const auto dst_rect = surface.GetScaledSubRect(load_info);
+    const TextureCopy copy = {
+        .src_level = source_surface.LevelOf(source_info.addr),
+        .dst_level = surface.LevelOf(load_info.addr),
+        .src_offset = {src_rect.left, src_rect.bottom},
+        .dst_offset = {dst_rect.left, dst_rect.bottom},
+        .extent = {src_rect.GetWidth(), src_rect.GetHeight()},
+    };
+    return runtime.CopyTextures(source_surface, surface, copy);
 }
 
 template <class T>
@@ -1249,6 +1451,7 @@ void RasterizerCache<T>::ClearAll(bool flush) {
     if (flush) {
         FlushRegion(0x0, 0xFFFFFFFF);
     }
+    UnregisterAllHashedUploads();
     // Unmark all of the marked pages
     for (auto& pair : RangeFromInterval(cached_pages, flush_interval)) {
         const auto interval = pair.first & flush_interval;
@@ -1327,6 +1530,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     }
 
     const SurfaceInterval invalid_interval(addr, addr + size);
+    UnregisterHashedUploads(addr, size);
 
     if (region_owner_id) {
         Surface& region_owner = slot_surfaces[region_owner_id];
@@ -1441,6 +1645,7 @@ void RasterizerCache<T>::UnregisterSurface(SurfaceId surface_id) {
 template <class T>
 void RasterizerCache<T>::UnregisterAll() {
     FlushAll();
+    UnregisterAllHashedUploads();
     for (auto& [page, surfaces] : page_table) {
         while (!surfaces.empty()) {
             UnregisterSurface(surfaces.back());
@@ -14,6 +14,7 @@
 #include <boost/icl/interval_map.hpp>
 #include <tsl/robin_map.h>
 
+#include "common/thread_worker.h"
 #include "video_core/rasterizer_cache/framebuffer_base.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
 #include "video_core/rasterizer_cache/surface_params.h"
@@ -63,6 +64,15 @@ class RasterizerCache {
     /// Address shift for caching surfaces into a hash table
     static constexpr u64 BORKED3DS_PAGEBITS = 18;
 
+    /// Minimum decoded size of a tiled upload that is split across the decode workers
+    static constexpr u32 PARALLEL_DECODE_THRESHOLD = 256 * 1024;
+
+    /// Approximate decoded size of each range of tile rows handed to a decode worker
+    static constexpr u32 PARALLEL_DECODE_TASK_SIZE = 64 * 1024;
+
+    /// Number of hashed uploads after which all of them are forgotten
+    static constexpr std::size_t MAX_HASHED_UPLOADS = 4096;
+
     using Runtime = typename T::Runtime;
     using Sampler = typename T::Sampler;
     using Surface = typename T::Surface;
@@ -76,6 +86,14 @@ class RasterizerCache {
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
     using PageMap = boost::icl::interval_map<u32, int>;
 
+    /// Hashes of guest texture data, kept until the data is written to
+    struct HashedUpload {
+        SurfaceParams params;    ///< Layout of the guest data
+        u64 content_hash;        ///< Fast hash of the guest data, used to find identical uploads
+        std::optional<u64> hash; ///< Custom texture hash of the guest data, computed on demand
+        SurfaceId surface_id;    ///< Surface that the data was last decoded to, if any
+    };
+
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
                              Runtime& runtime, Pica::RegsInternal& regs, RendererBase& renderer);
@@ -175,11 +193,31 @@ private:
     /// Computes the hash of the provided texture data.
     u64 ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data);
 
+    /// Returns the hashed upload of the provided texture data, hashing it if needed.
+    HashedUploadId GetHashedUpload(const SurfaceParams& load_info, std::span<u8> upload_data);
+
+    /// Removes a hashed upload and stops tracking its pages.
+    void UnregisterHashedUpload(HashedUploadId upload_id);
+
+    /// Removes every hashed upload overlapping the region.
+    void UnregisterHashedUploads(PAddr addr, u32 size);
+
+    /// Removes all hashed uploads.
+    void UnregisterAllHashedUploads();
+
+    /// Copies identical texture data from another surface, avoiding a decode and upload.
+    bool CopyIdenticalUpload(SurfaceId surface_id, const SurfaceParams& load_info,
+                             std::span<u8> upload_data, u64 content_hash);
+
     /// Update surface's texture for given region when necessary
     void ValidateSurface(SurfaceId surface, PAddr addr, u32 size);
 
     /// Copies pixel data in interval from the guest VRAM to the host GPU surface
-    void UploadSurface(Surface& surface, SurfaceInterval interval);
+    void UploadSurface(SurfaceId surface_id, SurfaceInterval interval);
+
+    /// Decodes guest texture data, splitting large tiled uploads by rows of tiles across workers
+    void DecodeSurface(const SurfaceParams& load_info, std::span<u8> source, std::span<u8> dest,
+                       bool convert);
 
     /// Uploads a custom texture identified with hash to the target surface
     bool UploadCustomSurface(SurfaceId surface_id, SurfaceInterval interval);
@@ -223,6 +261,9 @@ private:
     Common::SlotVector<Surface> slot_surfaces;
     Common::SlotVector<Sampler> slot_samplers;
     Common::SlotVector<Framebuffer> slot_framebuffers;
+    Common::SlotVector<HashedUpload> slot_hashed_uploads;
+    tsl::robin_pg_map<u64, std::vector<HashedUploadId>, Common::IdentityHash<u64>> upload_pages;
+    std::unordered_map<u64, HashedUploadId> uploads_by_content;
     SurfaceMap dirty_regions;
     PageMap cached_pages;
     u32 resolution_scale_factor;
@@ -231,6 +272,9 @@ private:
     Settings::TextureFilter filter;
     bool dump_textures;
     bool use_custom_textures;
+    Common::ThreadWorker decode_workers;
+    u64 decoded_bytes{};
+    u64 parallel_decoded_bytes{};
     u64 program_id = 0; //gvx64
     int forceFallBackToSW = 0;     /// gvx64 - Track instances of bad surfaces to force fall-back to software renderer
 };
@@ -7,9 +7,11 @@
 
 #include <algorithm>
 #include <bit>
+#include <cstring>
 #include <span>
 #include "common/alignment.h"
 #include "common/color.h"
+#include "common/vector_math.h"
 #include "video_core/rasterizer_cache/pixel_format.h"
 #include "video_core/texture/etc1.h"
 #include "video_core/utils.h"
@@ -197,13 +199,535 @@ constexpr void EncodePixel4(u32 x, u32 y, const u8* source_pixel, u8* dest_tile_
     }
 }
 
+/// Returns true if pixels of the format are copied as is between the tiled and linear layouts.
+template <PixelFormat format, bool converted>
+constexpr bool IsPlainCopy() {
+    constexpr bool is_converted_color =
+        format == PixelFormat::RGBA8 || format == PixelFormat::RGB8 ||
+        format == PixelFormat::RGB565 || format == PixelFormat::RGB5A1 ||
+        format == PixelFormat::RGBA4 || format == PixelFormat::D24;
+    constexpr bool is_always_converted =
+        format == PixelFormat::IA8 || format == PixelFormat::RG8 || format == PixelFormat::I8 ||
+        format == PixelFormat::A8 || format == PixelFormat::IA4 || format == PixelFormat::D24S8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+    return !(converted && is_converted_color) && !is_always_converted &&
+           linear_bytes_per_pixel == GetFormatBpp(format) / 8;
+}
+
+// Vector helpers for the row kernels below. SSE4.1 builds can rely on SSSE3 byte shuffles, NEON
+// table lookups return zero for out of range indices just like pshufb does for 0x80.
+#if defined(HAVE_SSE4_1)
+using RowVec = __m128i;
+
+inline RowVec RowLoad(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+inline void RowStore(u8* dest, RowVec v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), v);
+}
+
+inline void RowStore64(u8* dest, RowVec v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), v);
+}
+
+inline RowVec RowShuffle(RowVec v, const std::array<u8, 16>& indices) {
+    return _mm_shuffle_epi8(v, RowLoad(indices.data()));
+}
+
+inline RowVec RowSplat32(u32 value) {
+    return _mm_set1_epi32(static_cast<s32>(value));
+}
+
+inline RowVec RowOr(RowVec a, RowVec b) {
+    return _mm_or_si128(a, b);
+}
+
+inline RowVec RowAnd(RowVec a, RowVec b) {
+    return _mm_and_si128(a, b);
+}
+
+template <int shift>
+inline RowVec RowShl32(RowVec v) {
+    return _mm_slli_epi32(v, shift);
+}
+
+template <int shift>
+inline RowVec RowShr32(RowVec v) {
+    return _mm_srli_epi32(v, shift);
+}
+
+template <int shift>
+inline RowVec RowSar32(RowVec v) {
+    return _mm_srai_epi32(v, shift);
+}
+
+template <int shift>
+inline RowVec RowShl16(RowVec v) {
+    return _mm_slli_epi16(v, shift);
+}
+
+template <int shift>
+inline RowVec RowShr16(RowVec v) {
+    return _mm_srli_epi16(v, shift);
+}
+
+inline RowVec RowZipLow8(RowVec a, RowVec b) {
+    return _mm_unpacklo_epi8(a, b);
+}
+
+inline RowVec RowCombineLow64(RowVec a, RowVec b) {
+    return _mm_unpacklo_epi64(a, b);
+}
+
+inline RowVec RowD24ToFloat(RowVec v) {
+    return _mm_castps_si128(_mm_div_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(16777215.f)));
+}
+
+inline RowVec RowFloatToD24(RowVec v) {
+    return _mm_cvttps_epi32(_mm_mul_ps(_mm_castsi128_ps(v), _mm_set1_ps(16777215.f)));
+}
+#elif defined(HAVE_NEON)
+using RowVec = uint8x16_t;
+
+inline RowVec RowLoad(const u8* src) {
+    return vld1q_u8(src);
+}
+
+inline void RowStore(u8* dest, RowVec v) {
+    vst1q_u8(dest, v);
+}
+
+inline void RowStore64(u8* dest, RowVec v) {
+    vst1_u8(dest, vget_low_u8(v));
+}
+
+inline RowVec RowShuffle(RowVec v, const std::array<u8, 16>& indices) {
+    return vqtbl1q_u8(v, vld1q_u8(indices.data()));
+}
+
+inline RowVec RowSplat32(u32 value) {
+    return vreinterpretq_u8_u32(vdupq_n_u32(value));
+}
+
+inline RowVec RowOr(RowVec a, RowVec b) {
+    return vorrq_u8(a, b);
+}
+
+inline RowVec RowAnd(RowVec a, RowVec b) {
+    return vandq_u8(a, b);
+}
+
+template <int shift>
+inline RowVec RowShl32(RowVec v) {
+    return vreinterpretq_u8_u32(vshlq_n_u32(vreinterpretq_u32_u8(v), shift));
+}
+
+template <int shift>
+inline RowVec RowShr32(RowVec v) {
+    return vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(v), shift));
+}
+
+template <int shift>
+inline RowVec RowSar32(RowVec v) {
+    return vreinterpretq_u8_s32(vshrq_n_s32(vreinterpretq_s32_u8(v), shift));
+}
+
+template <int shift>
+inline RowVec RowShl16(RowVec v) {
+    return vreinterpretq_u8_u16(vshlq_n_u16(vreinterpretq_u16_u8(v), shift));
+}
+
+template <int shift>
+inline RowVec RowShr16(RowVec v) {
+    return vreinterpretq_u8_u16(vshrq_n_u16(vreinterpretq_u16_u8(v), shift));
+}
+
+inline RowVec RowZipLow8(RowVec a, RowVec b) {
+    return vzip1q_u8(a, b);
+}
+
+inline RowVec RowCombineLow64(RowVec a, RowVec b) {
+    return vcombine_u8(vget_low_u8(a), vget_low_u8(b));
+}
+
+inline RowVec RowD24ToFloat(RowVec v) {
+    return vreinterpretq_u8_f32(
+        vdivq_f32(vcvtq_f32_u32(vreinterpretq_u32_u8(v)), vdupq_n_f32(16777215.f)));
+}
+
+inline RowVec RowFloatToD24(RowVec v) {
+    return vreinterpretq_u8_u32(
+        vcvtq_u32_f32(vmulq_f32(vreinterpretq_f32_u8(v), vdupq_n_f32(16777215.f))));
+}
+#endif
+
+#if defined(HAVE_SSE4_1) || defined(HAVE_NEON)
+#define HAVE_MORTON_ROW_SIMD
+
+/// Builds shuffle indices that produce four 32-bit pixels from the given source byte pattern,
+/// offset by four source pixels of size step for each output pixel. 0x80 selects zero.
+constexpr std::array<u8, 16> MakeRowShuffle(std::array<u8, 4> pattern, u8 step, u8 first = 0) {
+    std::array<u8, 16> indices{};
+    for (u8 pixel = 0; pixel < 4; pixel++) {
+        for (u8 byte = 0; byte < 4; byte++) {
+            const u8 index = pattern[byte];
+            indices[pixel * 4 + byte] =
+                index == 0x80 ? 0x80 : static_cast<u8>(index + (first + pixel) * step);
+        }
+    }
+    return indices;
+}
+
+/// Builds shuffle indices that pack the given bytes of four 32-bit pixels together.
+template <std::size_t N>
+constexpr std::array<u8, 16> MakePackShuffle(std::array<u8, N> bytes, u8 first_dest = 0) {
+    std::array<u8, 16> indices{};
+    indices.fill(0x80);
+    for (u8 pixel = 0; pixel < 4; pixel++) {
+        for (u8 byte = 0; byte < N; byte++) {
+            indices[first_dest + pixel * N + byte] = static_cast<u8>(pixel * 4 + bytes[byte]);
+        }
+    }
+    return indices;
+}
+
+/// Expands four 4-bit values in each byte pair lane to 8 bits, like Convert4To8.
+inline RowVec RowExpand4To8(RowVec v) {
+    return RowOr(v, RowShl16<4>(v));
+}
+
+/// Expands the 16-bit pixels at the given half of the row to 32-bit lanes.
+inline RowVec RowWiden16(RowVec v, u32 half) {
+    static constexpr std::array<u8, 16> low = MakeRowShuffle({0, 1, 0x80, 0x80}, 2);
+    static constexpr std::array<u8, 16> high = MakeRowShuffle({0, 1, 0x80, 0x80}, 2, 4);
+    return RowShuffle(v, half ? high : low);
+}
+
+/// Packs the low 16 bits of the 32-bit lanes of two vectors into one vector.
+inline RowVec RowNarrow32(RowVec low, RowVec high) {
+    static constexpr std::array<u8, 16> pack = MakePackShuffle<2>({0, 1});
+    return RowCombineLow64(RowShuffle(low, pack), RowShuffle(high, pack));
+}
+#endif
+
+/**
+ * Converts a row of 8 pixels from the tiled format to the linear format. The source is read in
+ * 16 byte blocks and may be over-read by up to 16 bytes.
+ */
+template <PixelFormat format, bool converted>
+inline void DecodeRow(const u8* source, u8* dest) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+
+#ifdef HAVE_MORTON_ROW_SIMD
+    if constexpr (format == PixelFormat::RGBA8 && converted) {
+        static constexpr auto swap = MakeRowShuffle({3, 2, 1, 0}, 4);
+        RowStore(dest, RowShuffle(RowLoad(source), swap));
+        RowStore(dest + 16, RowShuffle(RowLoad(source + 16), swap));
+        return;
+    } else if constexpr (format == PixelFormat::RGB8 && converted) {
+        static constexpr auto expand = MakeRowShuffle({2, 1, 0, 0x80}, 3);
+        const RowVec alpha = RowSplat32(0xFF000000);
+        RowStore(dest, RowOr(RowShuffle(RowLoad(source), expand), alpha));
+        RowStore(dest + 16, RowOr(RowShuffle(RowLoad(source + 12), expand), alpha));
+        return;
+    } else if constexpr ((format == PixelFormat::RGB565 || format == PixelFormat::RGB5A1 ||
+                          format == PixelFormat::RGBA4) &&
+                         converted) {
+        const RowVec pixels = RowLoad(source);
+        const RowVec mask4 = RowSplat32(0xF);
+        const RowVec mask5 = RowSplat32(0x1F);
+        const RowVec mask6 = RowSplat32(0x3F);
+        for (u32 half = 0; half < 2; half++) {
+            const RowVec p = RowWiden16(pixels, half);
+            RowVec r, g, b, a;
+            if constexpr (format == PixelFormat::RGB565) {
+                r = RowAnd(RowShr32<11>(p), mask5);
+                g = RowAnd(RowShr32<5>(p), mask6);
+                b = RowAnd(p, mask5);
+                r = RowOr(RowShl32<3>(r), RowShr32<2>(r));
+                g = RowOr(RowShl32<2>(g), RowShr32<4>(g));
+                b = RowOr(RowShl32<3>(b), RowShr32<2>(b));
+                a = RowSplat32(0xFF000000);
+            } else if constexpr (format == PixelFormat::RGB5A1) {
+                r = RowAnd(RowShr32<11>(p), mask5);
+                g = RowAnd(RowShr32<6>(p), mask5);
+                b = RowAnd(RowShr32<1>(p), mask5);
+                r = RowOr(RowShl32<3>(r), RowShr32<2>(r));
+                g = RowOr(RowShl32<3>(g), RowShr32<2>(g));
+                b = RowOr(RowShl32<3>(b), RowShr32<2>(b));
+                a = RowSar32<7>(RowShl32<31>(p));
+            } else {
+                r = RowAnd(RowShr32<12>(p), mask4);
+                g = RowAnd(RowShr32<8>(p), mask4);
+                b = RowAnd(RowShr32<4>(p), mask4);
+                a = RowAnd(p, mask4);
+                r = RowOr(RowShl32<4>(r), r);
+                g = RowOr(RowShl32<4>(g), g);
+                b = RowOr(RowShl32<4>(b), b);
+                a = RowShl32<24>(RowOr(RowShl32<4>(a), a));
+            }
+            const RowVec rgba = RowOr(RowOr(r, RowShl32<8>(g)), RowOr(RowShl32<16>(b), a));
+            RowStore(dest + half * 16, rgba);
+        }
+        return;
+    } else if constexpr (format == PixelFormat::IA8) {
+        static constexpr auto low = MakeRowShuffle({1, 1, 1, 0}, 2);
+        static constexpr auto high = MakeRowShuffle({1, 1, 1, 0}, 2, 4);
+        const RowVec pixels = RowLoad(source);
+        RowStore(dest, RowShuffle(pixels, low));
+        RowStore(dest + 16, RowShuffle(pixels, high));
+        return;
+    } else if constexpr (format == PixelFormat::RG8) {
+        static constexpr auto low = MakeRowShuffle({1, 0, 0x80, 0x80}, 2);
+        static constexpr auto high = MakeRowShuffle({1, 0, 0x80, 0x80}, 2, 4);
+        const RowVec alpha = RowSplat32(0xFF000000);
+        const RowVec pixels = RowLoad(source);
+        RowStore(dest, RowOr(RowShuffle(pixels, low), alpha));
+        RowStore(dest + 16, RowOr(RowShuffle(pixels, high), alpha));
+        return;
+    } else if constexpr (format == PixelFormat::I8) {
+        static constexpr auto low = MakeRowShuffle({0, 0, 0, 0x80}, 1);
+        static constexpr auto high = MakeRowShuffle({0, 0, 0, 0x80}, 1, 4);
+        const RowVec alpha = RowSplat32(0xFF000000);
+        const RowVec pixels = RowLoad(source);
+        RowStore(dest, RowOr(RowShuffle(pixels, low), alpha));
+        RowStore(dest + 16, RowOr(RowShuffle(pixels, high), alpha));
+        return;
+    } else if constexpr (format == PixelFormat::A8) {
+        static constexpr auto low = MakeRowShuffle({0x80, 0x80, 0x80, 0}, 1);
+        static constexpr auto high = MakeRowShuffle({0x80, 0x80, 0x80, 0}, 1, 4);
+        const RowVec pixels = RowLoad(source);
+        RowStore(dest, RowShuffle(pixels, low));
+        RowStore(dest + 16, RowShuffle(pixels, high));
+        return;
+    } else if constexpr (format == PixelFormat::IA4) {
+        static constexpr auto low = MakeRowShuffle({0, 0, 0, 1}, 2);
+        static constexpr auto high = MakeRowShuffle({0, 0, 0, 1}, 2, 4);
+        const RowVec mask = RowSplat32(0x0F0F0F0F);
+        const RowVec pixels = RowLoad(source);
+        const RowVec intensity = RowExpand4To8(RowAnd(RowShr16<4>(pixels), mask));
+        const RowVec alpha4 = RowExpand4To8(RowAnd(pixels, mask));
+        const RowVec pairs = RowZipLow8(intensity, alpha4);
+        RowStore(dest, RowShuffle(pairs, low));
+        RowStore(dest + 16, RowShuffle(pairs, high));
+        return;
+    } else if constexpr (format == PixelFormat::D24 && converted) {
+        static constexpr auto expand = MakeRowShuffle({0, 1, 2, 0x80}, 3);
+        RowStore(dest, RowD24ToFloat(RowShuffle(RowLoad(source), expand)));
+        RowStore(dest + 16, RowD24ToFloat(RowShuffle(RowLoad(source + 12), expand)));
+        return;
+    } else if constexpr (format == PixelFormat::D24S8) {
+        for (u32 half = 0; half < 2; half++) {
+            const RowVec p = RowLoad(source + half * 16);
+            RowStore(dest + half * 16, RowOr(RowShl32<8>(p), RowShr32<24>(p)));
+        }
+        return;
+    }
+#endif
+
+    for (u32 x = 0; x < 8; x++) {
+        DecodePixel<format, converted>(source + x * bytes_per_pixel,
+                                       dest + x * linear_bytes_per_pixel);
+    }
+}
+
+/**
+ * Converts a row of 8 pixels from the linear format to the tiled format. The destination is
+ * written in 16 byte blocks and may be over-written by up to 16 bytes.
+ */
+template <PixelFormat format, bool converted>
+inline void EncodeRow(const u8* source, u8* dest) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+
+#ifdef HAVE_MORTON_ROW_SIMD
+    if constexpr (format == PixelFormat::RGBA8 && converted) {
+        static constexpr auto swap = MakeRowShuffle({3, 2, 1, 0}, 4);
+        RowStore(dest, RowShuffle(RowLoad(source), swap));
+        RowStore(dest + 16, RowShuffle(RowLoad(source + 16), swap));
+        return;
+    } else if constexpr (format == PixelFormat::RGB8 && converted) {
+        static constexpr auto pack = MakePackShuffle<3>({2, 1, 0});
+        RowStore(dest, RowShuffle(RowLoad(source), pack));
+        RowStore(dest + 12, RowShuffle(RowLoad(source + 16), pack));
+        return;
+    } else if constexpr ((format == PixelFormat::RGB565 || format == PixelFormat::RGB5A1 ||
+                          format == PixelFormat::RGBA4) &&
+                         converted) {
+        const auto encode = [](const u8* pixels) {
+            const RowVec p = RowLoad(pixels);
+            if constexpr (format == PixelFormat::RGB565) {
+                return RowOr(RowOr(RowShl32<8>(RowAnd(p, RowSplat32(0xF8))),
+                                   RowAnd(RowShr32<5>(p), RowSplat32(0x7E0))),
+                             RowAnd(RowShr32<19>(p), RowSplat32(0x1F)));
+            } else if constexpr (format == PixelFormat::RGB5A1) {
+                return RowOr(RowOr(RowShl32<8>(RowAnd(p, RowSplat32(0xF8))),
+                                   RowAnd(RowShr32<5>(p), RowSplat32(0x7C0))),
+                             RowOr(RowAnd(RowShr32<18>(p), RowSplat32(0x3E)), RowShr32<31>(p)));
+            } else {
+                return RowOr(RowOr(RowShl32<8>(RowAnd(p, RowSplat32(0xF0))),
+                                   RowAnd(RowShr32<4>(p), RowSplat32(0xF00))),
+                             RowOr(RowAnd(RowShr32<16>(p), RowSplat32(0xF0)), RowShr32<28>(p)));
+            }
+        };
+        RowStore(dest, RowNarrow32(encode(source), encode(source + 16)));
+        return;
+    } else if constexpr (format == PixelFormat::A8) {
+        static constexpr auto low = MakePackShuffle<1>({3});
+        static constexpr auto high = MakePackShuffle<1>({3}, 4);
+        RowStore64(dest, RowOr(RowShuffle(RowLoad(source), low),
+                               RowShuffle(RowLoad(source + 16), high)));
+        return;
+    } else if constexpr (format == PixelFormat::D24 && converted) {
+        static constexpr auto pack = MakePackShuffle<3>({0, 1, 2});
+        RowStore(dest, RowShuffle(RowFloatToD24(RowLoad(source)), pack));
+        RowStore(dest + 12, RowShuffle(RowFloatToD24(RowLoad(source + 16)), pack));
+        return;
+    } else if constexpr (format == PixelFormat::D24S8) {
+        for (u32 half = 0; half < 2; half++) {
+            const RowVec p = RowLoad(source + half * 16);
+            RowStore(dest + half * 16, RowOr(RowShr32<8>(p), RowShl32<24>(p)));
+        }
+        return;
+    }
+#endif
+
+    for (u32 x = 0; x < 8; x++) {
+        EncodePixel<format, converted>(source + x * linear_bytes_per_pixel,
+                                       dest + x * bytes_per_pixel);
+    }
+}
+
+/// Converts a row of 8 4-bit pixels, packed two per byte low nibble first, to RGBA8.
+template <PixelFormat format>
+inline void DecodeRow4(const u8* source, u8* dest) {
+#ifdef HAVE_MORTON_ROW_SIMD
+    constexpr std::array<u8, 4> pattern =
+        format == PixelFormat::I4 ? std::array<u8, 4>{0, 0, 0, 0x80}
+                                  : std::array<u8, 4>{0x80, 0x80, 0x80, 0};
+    static constexpr auto low = MakeRowShuffle(pattern, 1);
+    static constexpr auto high = MakeRowShuffle(pattern, 1, 4);
+    const RowVec alpha = RowSplat32(format == PixelFormat::I4 ? 0xFF000000 : 0);
+    const RowVec mask = RowSplat32(0x0F0F0F0F);
+    const RowVec packed = RowLoad(source);
+    const RowVec pixels = RowExpand4To8(
+        RowZipLow8(RowAnd(packed, mask), RowAnd(RowShr16<4>(packed), mask)));
+    RowStore(dest, RowOr(RowShuffle(pixels, low), alpha));
+    RowStore(dest + 16, RowOr(RowShuffle(pixels, high), alpha));
+#else
+    for (u32 x = 0; x < 8; x++) {
+        const u8 value = source[x / 2];
+        const u8 pixel = Common::Color::Convert4To8((x % 2) ? (value >> 4) : (value & 0xF));
+        u8* dest_pixel = dest + x * 4;
+        if constexpr (format == PixelFormat::I4) {
+            std::memset(dest_pixel, pixel, 3);
+            dest_pixel[3] = 255;
+        } else {
+            std::memset(dest_pixel, 0, 3);
+            dest_pixel[3] = pixel;
+        }
+    }
+#endif
+}
+
+/// Converts a row of 8 RGBA8 pixels to 4-bit pixels, packed two per byte low nibble first.
+template <PixelFormat format>
+inline void EncodeRow4(const u8* source, u8* dest) {
+    for (u32 x = 0; x < 8; x += 2) {
+        std::array<u8, 2> values;
+        for (u32 i = 0; i < 2; i++) {
+            Common::Vec4<u8> rgba;
+            std::memcpy(rgba.AsArray(), source + (x + i) * 4, 4);
+            const u8 pixel =
+                format == PixelFormat::I4 ? Common::Color::AverageRgbComponents(rgba) : rgba.a();
+            values[i] = Common::Color::Convert8To4(pixel);
+        }
+        dest[x / 2] = (values[1] << 4) | values[0];
+    }
+}
+
+/**
+ * Swizzles a tile a row at a time. In morton order the pixels of a tile row are stored as four
+ * pairs of horizontally adjacent pixels, so each row is gathered with four copies and converted
+ * with the row kernels above.
+ */
 template <bool morton_to_linear, PixelFormat format, bool converted>
+constexpr void MortonCopyTileRows(u32 stride, std::span<u8> tile_buffer,
+                                  std::span<u8> linear_buffer) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+    constexpr bool is_4bit = format == PixelFormat::I4 || format == PixelFormat::A4;
+
+    for (u32 y = 0; y < 8; y++) {
+        u8* const linear_row = linear_buffer.data() + (7 - y) * stride * linear_bytes_per_pixel;
+        if constexpr (is_4bit) {
+            std::array<u8, 4 + 16> row;
+            if constexpr (!morton_to_linear) {
+                EncodeRow4<format>(linear_row, row.data());
+            }
+            for (u32 x = 0; x < 8; x += 2) {
+                u8& pair = tile_buffer[VideoCore::MortonInterleave(x, y) >> 1];
+                if constexpr (morton_to_linear) {
+                    row[x / 2] = pair;
+                } else {
+                    pair = row[x / 2];
+                }
+            }
+            if constexpr (morton_to_linear) {
+                DecodeRow4<format>(row.data(), linear_row);
+            }
+        } else if constexpr (IsPlainCopy<format, converted>()) {
+            for (u32 x = 0; x < 8; x += 2) {
+                u8* const tiled_pair =
+                    tile_buffer.data() + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+                if constexpr (morton_to_linear) {
+                    std::memcpy(linear_row + x * bytes_per_pixel, tiled_pair, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(tiled_pair, linear_row + x * bytes_per_pixel, 2 * bytes_per_pixel);
+                }
+            }
+        } else {
+            std::array<u8, 8 * bytes_per_pixel + 16> row;
+            if constexpr (!morton_to_linear) {
+                EncodeRow<format, converted>(linear_row, row.data());
+            }
+            for (u32 x = 0; x < 8; x += 2) {
+                u8* const tiled_pair =
+                    tile_buffer.data() + VideoCore::MortonInterleave(x, y) * bytes_per_pixel;
+                if constexpr (morton_to_linear) {
+                    std::memcpy(row.data() + x * bytes_per_pixel, tiled_pair, 2 * bytes_per_pixel);
+                } else {
+                    std::memcpy(tiled_pair, row.data() + x * bytes_per_pixel, 2 * bytes_per_pixel);
+                }
+            }
+            if constexpr (morton_to_linear) {
+                DecodeRow<format, converted>(row.data(), linear_row);
+            }
+        }
+    }
+}
+
+/**
+ * Swizzles a tile between the morton and linear layouts. ETC1 tiles are always decoded a pixel at
+ * a time, other formats go through the row kernels unless scalar is set.
+ * @param scalar If true converts one pixel at a time, this is the reference the row kernels are
+ * tested against.
+ */
+template <bool morton_to_linear, PixelFormat format, bool converted, bool scalar = false>
 constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u8> linear_buffer) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
     constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
     constexpr bool is_compressed = format == PixelFormat::ETC1 || format == PixelFormat::ETC1A4;
     constexpr bool is_4bit = format == PixelFormat::I4 || format == PixelFormat::A4;
 
+    if constexpr (!scalar && !is_compressed) {
+        MortonCopyTileRows<morton_to_linear, format, converted>(stride, tile_buffer,
+                                                                linear_buffer);
+        return;
+    }
+
     for (u32 y = 0; y < 8; y++) {
         for (u32 x = 0; x < 8; x++) {
             const auto tiled_pixel = tile_buffer.subspan(
@@ -232,6 +756,7 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
 /**
  * @brief Performs morton to/from linear convertions on the provided pixel data
  * @param converted If true performs RGBA8 to/from convertion to all color formats
+ * @param scalar If true converts one pixel at a time instead of using the row kernels
  * @param width, height The dimentions of the rectangular region of pixels in linear_buffer
  * @param start_offset The number of bytes from the start of the first tile to the start of
  * tiled_buffer
@@ -254,7 +779,7 @@ constexpr void MortonCopyTile(u32 stride, std::span<u8> tile_buffer, std::span<u
  * start_offset/end_offset are useful here as they tell us exactly where the data should be placed
  * in the linear_buffer.
  */
-template <bool morton_to_linear, PixelFormat format, bool converted = false>
+template <bool morton_to_linear, PixelFormat format, bool converted = false, bool scalar = false>
 static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 end_offset,
                                  std::span<u8> linear_buffer, std::span<u8> tiled_buffer) {
     constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
@@ -297,7 +822,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (start_offset < aligned_start_offset && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        MortonCopyTile<morton_to_linear, format, converted, scalar>(width, tmp_buf, linear_data);
 
         std::memcpy(tiled_buffer.data(), tmp_buf.data() + start_offset - aligned_down_start_offset,
                     std::min(aligned_start_offset, end_offset) - start_offset);
@@ -314,7 +839,8 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
         while (tiled_offset < buffer_end) {
             auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
             auto tiled_data = tiled_buffer.subspan(tiled_offset, tile_size);
-            MortonCopyTile<morton_to_linear, format, converted>(width, tiled_data, linear_data);
+            MortonCopyTile<morton_to_linear, format, converted, scalar>(width, tiled_data,
+                                                                        linear_data);
             tiled_offset += tile_size;
             linear_next_tile();
         }
@@ -325,7 +851,7 @@ static constexpr void MortonCopy(u32 width, u32 height, u32 start_offset, u32 en
     if (end_offset > std::max(aligned_start_offset, aligned_end_offset) && !morton_to_linear) {
         std::array<u8, tile_size> tmp_buf;
         auto linear_data = linear_buffer.subspan(linear_offset, linear_tile_stride);
-        MortonCopyTile<morton_to_linear, format, converted>(width, tmp_buf, linear_data);
+        MortonCopyTile<morton_to_linear, format, converted, scalar>(width, tmp_buf, linear_data);
         std::memcpy(tiled_buffer.data() + tiled_offset, tmp_buf.data(),
                     end_offset - aligned_end_offset);
     }
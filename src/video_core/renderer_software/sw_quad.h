@@ -0,0 +1,235 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica_types.h"
+
+namespace SwRenderer {
+
+using Pica::f24;
+
+/**
+ * Four f24 values processed in lockstep, one per fragment of a 2x2 pixel quad. Lanes are ordered
+ * top-left, top-right, bottom-left, bottom-right. Every operation reproduces the truncation,
+ * flushing and NaN rules of the scalar f24 operators lane by lane, so the results are identical
+ * to evaluating each fragment on its own.
+ */
+class QuadF24 {
+public:
+    QuadF24() = default;
+
+    /// Broadcasts the provided value to all lanes.
+    [[nodiscard]] static QuadF24 Splat(f24 value) {
+        QuadF24 ret;
+#if defined(HAVE_SSE2)
+        ret.value = _mm_set1_ps(value.ToFloat32());
+#elif defined(HAVE_NEON)
+        ret.value = vdupq_n_f32(value.ToFloat32());
+#else
+        ret.value.fill(value);
+#endif
+        return ret;
+    }
+
+    /// Converts four integers, equivalent to f24::FromFloat32(static_cast<f32>(value)).
+    [[nodiscard]] static QuadF24 FromInts(const std::array<s32, 4>& values) {
+        QuadF24 ret;
+#if defined(HAVE_SSE2)
+        ret.value = Trunc(
+            _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values.data()))));
+#elif defined(HAVE_NEON)
+        ret.value = Trunc(vcvtq_f32_s32(vld1q_s32(values.data())));
+#else
+        for (std::size_t i = 0; i < 4; i++) {
+            ret.value[i] = f24::FromFloat32(static_cast<f32>(values[i]));
+        }
+#endif
+        return ret;
+    }
+
+    /// Returns the values of all lanes.
+    [[nodiscard]] std::array<f24, 4> Lanes() const {
+        std::array<f24, 4> ret;
+#if defined(HAVE_SSE2)
+        alignas(16) std::array<f32, 4> lanes;
+        _mm_store_ps(lanes.data(), value);
+        for (std::size_t i = 0; i < 4; i++) {
+            ret[i] = f24::FromFloat32(lanes[i]);
+        }
+#elif defined(HAVE_NEON)
+        std::array<f32, 4> lanes;
+        vst1q_f32(lanes.data(), value);
+        for (std::size_t i = 0; i < 4; i++) {
+            ret[i] = f24::FromFloat32(lanes[i]);
+        }
+#else
+        ret = value;
+#endif
+        return ret;
+    }
+
+    [[nodiscard]] QuadF24 operator+(const QuadF24& other) const {
+        QuadF24 ret;
+#if defined(HAVE_SSE2)
+        ret.value = Trunc(_mm_add_ps(value, other.value));
+#elif defined(HAVE_NEON)
+        ret.value = Trunc(vaddq_f32(value, other.value));
+#else
+        for (std::size_t i = 0; i < 4; i++) {
+            ret.value[i] = value[i] + other.value[i];
+        }
+#endif
+        return ret;
+    }
+
+    [[nodiscard]] QuadF24 operator*(const QuadF24& other) const {
+        QuadF24 ret;
+#if defined(HAVE_SSE2)
+        // PICA gives 0 instead of NaN when multiplying by inf
+        const __m128 result = _mm_mul_ps(value, other.value);
+        const __m128 result_nan = _mm_cmpunord_ps(result, result);
+        const __m128 input_nan = _mm_cmpunord_ps(value, other.value);
+        ret.value = Trunc(_mm_andnot_ps(_mm_andnot_ps(input_nan, result_nan), result));
+#elif defined(HAVE_NEON)
+        // PICA gives 0 instead of NaN when multiplying by inf
+        const float32x4_t result = vmulq_f32(value, other.value);
+        const uint32x4_t result_ok = vceqq_f32(result, result);
+        const uint32x4_t input_ok =
+            vandq_u32(vceqq_f32(value, value), vceqq_f32(other.value, other.value));
+        const uint32x4_t keep = vornq_u32(result_ok, input_ok);
+        ret.value = Trunc(vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(result), keep)));
+#else
+        for (std::size_t i = 0; i < 4; i++) {
+            ret.value[i] = value[i] * other.value[i];
+        }
+#endif
+        return ret;
+    }
+
+    [[nodiscard]] QuadF24 operator/(const QuadF24& other) const {
+        QuadF24 ret;
+#if defined(HAVE_SSE2)
+        ret.value = Trunc(_mm_div_ps(value, other.value));
+#elif defined(HAVE_NEON)
+        ret.value = Trunc(vdivq_f32(value, other.value));
+#else
+        for (std::size_t i = 0; i < 4; i++) {
+            ret.value[i] = value[i] / other.value[i];
+        }
+#endif
+        return ret;
+    }
+
+private:
+    /// Low float mantissa bits that are discarded by f24.
+    static constexpr u32 DISCARDED_MANTISSA_MASK = (1U << (23 - 16)) - 1;
+
+#if defined(HAVE_SSE2)
+    /// Vectorized f24::Trunc
+    [[nodiscard]] static __m128 Trunc(__m128 val) {
+        const __m128 sign_mask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+        const __m128 min_normal = _mm_set1_ps(f24::MinNormal().ToFloat32());
+        const __m128 max = _mm_set1_ps(f24::Max().ToFloat32());
+        const __m128 magnitude = _mm_andnot_ps(sign_mask, val);
+
+        // NaN lanes fail every ordered comparison and pass through untouched.
+        const __m128 flush = _mm_cmplt_ps(magnitude, min_normal);
+        const __m128 overflow = _mm_cmpgt_ps(magnitude, max);
+        const __m128 normal =
+            _mm_and_ps(_mm_cmpge_ps(magnitude, min_normal), _mm_cmple_ps(magnitude, max));
+
+        const __m128 truncated =
+            _mm_and_ps(val, _mm_castsi128_ps(_mm_set1_epi32(~DISCARDED_MANTISSA_MASK)));
+        const __m128 inf = _mm_or_ps(_mm_and_ps(val, sign_mask),
+                                     _mm_castsi128_ps(_mm_set1_epi32(0x7F800000)));
+
+        __m128 ret = _mm_or_ps(_mm_and_ps(normal, truncated), _mm_andnot_ps(normal, val));
+        ret = _mm_or_ps(_mm_and_ps(overflow, inf), _mm_andnot_ps(overflow, ret));
+        return _mm_andnot_ps(flush, ret);
+    }
+
+    __m128 value;
+#elif defined(HAVE_NEON)
+    /// Vectorized f24::Trunc
+    [[nodiscard]] static float32x4_t Trunc(float32x4_t val) {
+        const float32x4_t min_normal = vdupq_n_f32(f24::MinNormal().ToFloat32());
+        const float32x4_t max = vdupq_n_f32(f24::Max().ToFloat32());
+        const float32x4_t magnitude = vabsq_f32(val);
+
+        // NaN lanes fail every ordered comparison and pass through untouched.
+        const uint32x4_t flush = vcltq_f32(magnitude, min_normal);
+        const uint32x4_t overflow = vcgtq_f32(magnitude, max);
+        const uint32x4_t normal =
+            vandq_u32(vcgeq_f32(magnitude, min_normal), vcleq_f32(magnitude, max));
+
+        const uint32x4_t bits = vreinterpretq_u32_f32(val);
+        const uint32x4_t truncated = vandq_u32(bits, vdupq_n_u32(~DISCARDED_MANTISSA_MASK));
+        const uint32x4_t inf =
+            vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x80000000)), vdupq_n_u32(0x7F800000));
+
+        uint32x4_t ret = vbslq_u32(normal, truncated, bits);
+        ret = vbslq_u32(overflow, inf, ret);
+        return vreinterpretq_f32_u32(vbicq_u32(ret, flush));
+    }
+
+    float32x4_t value;
+#else
+    std::array<f24, 4> value;
+#endif
+};
+
+/**
+ * Evaluates an edge function at the four pixels of a quad from its value at the top-left pixel
+ * and its increments for one pixel step along x and y.
+ */
+[[nodiscard]] inline std::array<s32, 4> QuadEdge(s32 origin, s32 step_x, s32 step_y) {
+    // Wrap around like the scalar edge function does instead of invoking signed overflow.
+    const u32 base = static_cast<u32>(origin);
+    return {
+        static_cast<s32>(base),
+        static_cast<s32>(base + static_cast<u32>(step_x)),
+        static_cast<s32>(base + static_cast<u32>(step_y)),
+        static_cast<s32>(base + static_cast<u32>(step_x) + static_cast<u32>(step_y)),
+    };
+}
+
+/**
+ * Returns a mask with bit i set when lane i of every edge function reaches the bias of that edge,
+ * meaning the fragment is covered by the triangle.
+ */
+[[nodiscard]] inline u32 QuadCoverage(const std::array<s32, 4>& w0, const std::array<s32, 4>& w1,
+                                      const std::array<s32, 4>& w2, int bias0, int bias1,
+                                      int bias2) {
+#if defined(HAVE_SSE2)
+    const auto load = [](const std::array<s32, 4>& w) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(w.data()));
+    };
+    const __m128i covered =
+        _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi32(load(w0), _mm_set1_epi32(bias0 - 1)),
+                                    _mm_cmpgt_epi32(load(w1), _mm_set1_epi32(bias1 - 1))),
+                      _mm_cmpgt_epi32(load(w2), _mm_set1_epi32(bias2 - 1)));
+    return static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(covered)));
+#elif defined(HAVE_NEON)
+    const uint32x4_t covered =
+        vandq_u32(vandq_u32(vcgeq_s32(vld1q_s32(w0.data()), vdupq_n_s32(bias0)),
+                            vcgeq_s32(vld1q_s32(w1.data()), vdupq_n_s32(bias1))),
+                  vcgeq_s32(vld1q_s32(w2.data()), vdupq_n_s32(bias2)));
+    static constexpr std::array<u32, 4> lane_bits = {1, 2, 4, 8};
+    return vaddvq_u32(vandq_u32(covered, vld1q_u32(lane_bits.data())));
+#else
+    u32 mask = 0;
+    for (std::size_t i = 0; i < 4; i++) {
+        if (w0[i] >= bias0 && w1[i] >= bias1 && w2[i] >= bias2) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+} // namespace SwRenderer
@@ -11,9 +11,11 @@
 #include "core/memory.h"
 #include "video_core/pica/output_vertex.h"
 #include "video_core/pica/pica_core.h"
+#include "video_core/pica/regs_internal.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
 #include "video_core/renderer_software/sw_lighting.h"
 #include "video_core/renderer_software/sw_proctex.h"
+#include "video_core/renderer_software/sw_quad.h"
 #include "video_core/renderer_software/sw_rasterizer.h"
 #include "video_core/renderer_software/sw_texturing.h"
 #include "video_core/texture/texture_decode.h"
@@ -84,6 +86,41 @@ struct Vertex : Pica::OutputVertex {
     }
 };
 
+/// Triangle that survived culling, wound counter-clockwise, waiting in the tile bins.
+struct BinnedTriangle {
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<int, 3> bias;
+    /// Pixel aligned bounding box in 12.4 fixed point, clipped to the scissor box.
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
+/// Perspective corrected attributes of the four fragments of a quad.
+struct QuadAttributes {
+    enum : std::size_t {
+        Color = 0,
+        Tc0 = 4,
+        Tc1 = 6,
+        Tc2 = 8,
+        Tc0W = 10,
+        NumUnlitAttributes = 11,
+        Quat = 11,
+        View = 15,
+        NumAttributes = 18,
+    };
+
+    std::array<f24, 4> w_inverse;
+    std::array<std::array<f24, 4>, NumAttributes> values;
+};
+
+/// Width and height of a screen tile in pixels. Each tile is rasterized by a single worker.
+constexpr u32 TILE_SIZE = 32;
+
 namespace {
 
 struct ClippingEdge {
@@ -124,6 +161,12 @@ RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::Pica
       num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
       sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
 
+RasterizerSoftware::~RasterizerSoftware() = default;
+
+void RasterizerSoftware::NotifyPicaRegisterChanged(u32 id) {
+    FlushTriangles();
+}
+
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
     /**
@@ -220,7 +263,7 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
             vtx1.screenpos.y.ToFloat32(), vtx1.screenpos.z.ToFloat32(),
             vtx2.screenpos.x.ToFloat32(), vtx2.screenpos.y.ToFloat32(),
             vtx2.screenpos.z.ToFloat32());
-        ProcessTriangle(vtx0, vtx1, vtx2);
+        BinTriangle(vtx0, vtx1, vtx2);
     }
 }
 
@@ -267,10 +310,8 @@ void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
     vtx.screenpos[2] = pos.z;
 }
 
-void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                                         bool reversed) {
-    BORKED3DS_PROFILE("Software", "Rasterization");
-
+void RasterizerSoftware::BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
+                                     bool reversed) {
     // Vertex positions in rasterizer coordinates
     static auto screen_to_rasterizer_coords = [](const Common::Vec3<f24>& vec) {
         return Common::Vec3{Fix12P4::FromFloat24(vec.x), Fix12P4::FromFloat24(vec.y),
@@ -286,13 +327,13 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     if (regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepAll) {
         // Make sure we always end up with a triangle wound counter-clockwise
         if (!reversed && SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) <= 0) {
-            ProcessTriangle(v0, v2, v1, true);
+            BinTriangle(v0, v2, v1, true);
             return;
         }
     } else {
         if (!reversed && regs.rasterizer.cull_mode == RasterizerRegs::CullMode::KeepClockWise) {
             // Reverse vertex order and use the CCW code path.
-            ProcessTriangle(v0, v2, v1, true);
+            BinTriangle(v0, v2, v1, true);
             return;
         }
         // Cull away triangles which are wound clockwise.
@@ -306,19 +347,11 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
 
-    // Convert the scissor box coordinates to 12.4 fixed point
-    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
-    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
-    // x2,y2 have +1 added to cover the entire sub-pixel area
-    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
-    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
-
     if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
-        // Calculate the new bounds
-        min_x = std::max(min_x, scissor_x1);
-        min_y = std::max(min_y, scissor_y1);
-        max_x = std::min(max_x, scissor_x2);
-        max_y = std::min(max_y, scissor_y2);
+        min_x = std::max(min_x, static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4));
+        min_y = std::max(min_y, static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4));
+        max_x = std::min(max_x, static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4));
+        max_y = std::min(max_y, static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4));
     }
 
     min_x &= Fix12P4::IntMask();
@@ -326,6 +359,26 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
 
+    // Skip triangles that do not cover any pixel center.
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    // Size the tile grid from the bound framebuffer when starting a new batch. Pixels outside
+    // of the framebuffer are assigned to the last row/column so that every pixel keeps exactly
+    // one owning tile.
+    if (triangles.empty()) {
+        const auto& framebuffer = regs.framebuffer.framebuffer;
+        num_tiles_x = std::max((framebuffer.GetWidth() + TILE_SIZE - 1) / TILE_SIZE, 1U);
+        num_tiles_y = std::max((framebuffer.GetHeight() + TILE_SIZE - 1) / TILE_SIZE, 1U);
+        tile_bins.resize(num_tiles_x * num_tiles_y);
+    }
+
+    const u32 tile_x0 = std::min<u32>((min_x >> 4) / TILE_SIZE, num_tiles_x - 1);
+    const u32 tile_y0 = std::min<u32>((min_y >> 4) / TILE_SIZE, num_tiles_y - 1);
+    const u32 tile_x1 = std::min<u32>(((max_x >> 4) - 1) / TILE_SIZE, num_tiles_x - 1);
+    const u32 tile_y1 = std::min<u32>(((max_y >> 4) - 1) / TILE_SIZE, num_tiles_y - 1);
+
     const int bias0 =
         IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? 1 : 0;
     const int bias1 =
@@ -333,206 +386,348 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     const int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? 1 : 0;
 
-    const auto w_inverse = Common::MakeVec(v0.pos().w, v1.pos().w, v2.pos().w);
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    triangles.push_back(BinnedTriangle{
+        .v0 = v0,
+        .v1 = v1,
+        .v2 = v2,
+        .vtxpos = vtxpos,
+        .bias = {bias0, bias1, bias2},
+        .min_x = min_x,
+        .min_y = min_y,
+        .max_x = max_x,
+        .max_y = max_y,
+    });
+
+    for (u32 tile_y = tile_y0; tile_y <= tile_y1; tile_y++) {
+        for (u32 tile_x = tile_x0; tile_x <= tile_x1; tile_x++) {
+            tile_bins[tile_y * num_tiles_x + tile_x].push_back(triangle_index);
+        }
+    }
+}
 
-    const auto textures = regs.texturing.GetTextures();
-    const auto tev_stages = regs.texturing.GetTevStages();
+void RasterizerSoftware::FlushTriangles() {
+    if (triangles.empty()) {
+        return;
+    }
+
+    BORKED3DS_PROFILE("Software", "Rasterization");
 
     fb.Bind();
 
-    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
-    // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
-                // Do not process the pixel if it's inside the scissor box and the scissor mode is
-                // set to Exclude.
-                if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                    if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
-                        continue;
-                    }
-                }
+    UpdateTevProgram();
 
-                // Calculate the barycentric coordinates w0, w1 and w2
-                const s32 w0 = SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-                const s32 w1 = SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-                const s32 w2 = SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-                const s32 wsum = w0 + w1 + w2;
+    // Every tile owns a disjoint region of the framebuffer and processes its triangles in
+    // submission order, so the result matches rasterizing the batch serially.
+    std::size_t num_busy_tiles = 0;
+    std::size_t last_busy_tile = 0;
+    for (std::size_t tile = 0; tile < tile_bins.size(); tile++) {
+        if (!tile_bins[tile].empty()) {
+            num_busy_tiles++;
+            last_busy_tile = tile;
+        }
+    }
 
-                // If current pixel is not covered by the current primitive
-                if (w0 < bias0 || w1 < bias1 || w2 < bias2) {
-                    continue;
-                }
+    if (num_busy_tiles == 1) {
+        ProcessTile(last_busy_tile);
+    } else {
+        for (std::size_t tile = 0; tile < tile_bins.size(); tile++) {
+            if (!tile_bins[tile].empty()) {
+                sw_workers.QueueWork([this, tile] { ProcessTile(tile); });
+            }
+        }
+        sw_workers.WaitForRequests();
+    }
 
-                const auto baricentric_coordinates = Common::MakeVec(
-                    f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
-                    f24::FromFloat32(static_cast<f32>(w2)));
-                const f24 interpolated_w_inverse =
-                    f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
-
-                // interpolated_z = z / w
-                const float interpolated_z_over_w =
-                    (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                     v2.screenpos[2].ToFloat32() * w2) /
-                    wsum;
-
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-                float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-                // Potentially switch to W-Buffer
-                if (regs.rasterizer.depthmap_enable ==
-                    Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                    // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                    depth = depth * interpolated_w_inverse.ToFloat32() * wsum;
-                }
+    for (auto& bin : tile_bins) {
+        bin.clear();
+    }
+    triangles.clear();
+}
 
-                // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
-
-                /**
-                 * Perspective correct attribute interpolation:
-                 * Attribute values cannot be calculated by simple linear interpolation since
-                 * they are not linear in screen space. For example, when interpolating a
-                 * texture coordinate across two vertices, something simple like
-                 *     u = (u0*w0 + u1*w1)/(w0+w1)
-                 * will not work. However, the attribute value divided by the
-                 * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-                 * in screenspace. Hence, we can linearly interpolate these two independently and
-                 * calculate the interpolated attribute by dividing the results.
-                 * I.e.
-                 *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-                 *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-                 *     u = u_over_w / one_over_w
-                 *
-                 * The generalization to three vertices is straightforward in baricentric
-                 *coordinates.
-                 **/
-
-                auto get_interpolated_attribute = [&](const f24& v0_attr, const f24& v1_attr,
-                                                      const f24& v2_attr) {
-                    auto attr_over_w = Common::MakeVec(v0_attr, v1_attr, v2_attr);
-                    f24 interpolated_attr_over_w =
-                        Common::Dot(attr_over_w, baricentric_coordinates);
-                    return interpolated_attr_over_w * interpolated_w_inverse;
-                };
-
-                // Color interpolation
-                const auto v0_color = v0.color();
-                const auto v1_color = v1.color();
-                const auto v2_color = v2.color();
-
-                const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(round(
-                        get_interpolated_attribute(v0_color.x, v1_color.x, v2_color.x).ToFloat32() *
-                        255)),
-                    static_cast<u8>(round(
-                        get_interpolated_attribute(v0_color.y, v1_color.y, v2_color.y).ToFloat32() *
-                        255)),
-                    static_cast<u8>(round(
-                        get_interpolated_attribute(v0_color.z, v1_color.z, v2_color.z).ToFloat32() *
-                        255)),
-                    static_cast<u8>(round(
-                        get_interpolated_attribute(v0_color.w, v1_color.w, v2_color.w).ToFloat32() *
-                        255)),
-                };
-
-                // Texture coordinate interpolation
-                auto tc0_v0 = v0.tc0();
-                auto tc0_v1 = v1.tc0();
-                auto tc0_v2 = v2.tc0();
-                auto tc1_v0 = v0.tc1();
-                auto tc1_v1 = v1.tc1();
-                auto tc1_v2 = v2.tc1();
-                auto tc2_v0 = v0.tc2();
-                auto tc2_v1 = v1.tc2();
-                auto tc2_v2 = v2.tc2();
-
-                std::array<Common::Vec2<f24>, 3> uv;
-                // TC0 coordinates
-                uv[0].x = get_interpolated_attribute(tc0_v0.x, tc0_v1.x, tc0_v2.x);
-                uv[0].y = get_interpolated_attribute(tc0_v0.y, tc0_v1.y, tc0_v2.y);
-                // TC1 coordinates
-                uv[1].x = get_interpolated_attribute(tc1_v0.x, tc1_v1.x, tc1_v2.x);
-                uv[1].y = get_interpolated_attribute(tc1_v0.y, tc1_v1.y, tc1_v2.y);
-                // TC2 coordinates
-                uv[2].x = get_interpolated_attribute(tc2_v0.x, tc2_v1.x, tc2_v2.x);
-                uv[2].y = get_interpolated_attribute(tc2_v0.y, tc2_v1.y, tc2_v2.y);
-
-                // Sample bound texture units.
-                const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-
-                const auto texture_color = TextureColor(uv, textures, tc0_w);
-
-                Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-                Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
-
-                if (!regs.lighting.disable) {
-                    const auto normquat =
-                        Common::Quaternion<f32>{
-                            {get_interpolated_attribute(v0.quat().x, v1.quat().x, v2.quat().x)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat().y, v1.quat().y, v2.quat().y)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat().z, v1.quat().z, v2.quat().z)
-                                 .ToFloat32()},
-                            get_interpolated_attribute(v0.quat().w, v1.quat().w, v2.quat().w)
-                                .ToFloat32(),
-                        }
-                            .Normalized();
-
-                    auto view0 = v0.view();
-                    auto view1 = v1.view();
-                    auto view2 = v2.view();
-
-                    const Common::Vec3f view{
-                        get_interpolated_attribute(view0.x, view1.x, view2.x).ToFloat32(),
-                        get_interpolated_attribute(view0.y, view1.y, view2.y).ToFloat32(),
-                        get_interpolated_attribute(view0.z, view1.z, view2.z).ToFloat32(),
-                    };
-
-                    std::tie(primary_fragment_color, secondary_fragment_color) =
-                        ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
-                                               texture_color);
-                }
+void RasterizerSoftware::UpdateTevProgram() {
+    // Programs are small, but keep the cache bounded for titles that stream TEV constants.
+    static constexpr std::size_t MAX_TEV_PROGRAMS = 1024;
 
-                // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
-
-                const auto& output_merger = regs.framebuffer.output_merger;
-                if (output_merger.fragment_operation_mode ==
-                    FramebufferRegs::FragmentOperationMode::Shadow) {
-                    const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                    // Use green color as the shadow intensity
-                    const u8 stencil = combiner_output.y;
-                    fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                    // Skip the normal output merger pipeline if it is in shadow mode
-                    continue;
-                }
+    // The registers are hashed for every batch rather than tracking register writes, as they also
+    // change without writes when a savestate is loaded.
+    const u64 hash = TevProgram::Hash(regs.texturing);
+    if (tev_program && hash == tev_program_hash) {
+        return;
+    }
+    auto it = tev_programs.find(hash);
+    if (it == tev_programs.end()) {
+        if (tev_programs.size() >= MAX_TEV_PROGRAMS) {
+            tev_programs.clear();
+        }
+        it = tev_programs.emplace(hash, TevProgram{regs.texturing}).first;
+    }
+    tev_program = &it->second;
+    tev_program_hash = hash;
+}
+
+void RasterizerSoftware::ProcessTile(std::size_t tile_index) {
+    const u32 tile_x = static_cast<u32>(tile_index % num_tiles_x);
+    const u32 tile_y = static_cast<u32>(tile_index / num_tiles_x);
+
+    // Tile bounds in 12.4 fixed point. The last row and column extend to the end of the
+    // rasterizer coordinate space.
+    const u32 tile_min_x = (tile_x * TILE_SIZE) << 4;
+    const u32 tile_min_y = (tile_y * TILE_SIZE) << 4;
+    const u32 tile_max_x = tile_x == num_tiles_x - 1 ? 0x10000 : ((tile_x + 1) * TILE_SIZE) << 4;
+    const u32 tile_max_y = tile_y == num_tiles_y - 1 ? 0x10000 : ((tile_y + 1) * TILE_SIZE) << 4;
+
+    for (const u32 triangle_index : tile_bins[tile_index]) {
+        const BinnedTriangle& triangle = triangles[triangle_index];
+        ProcessTriangle(triangle, static_cast<u16>(std::max<u32>(triangle.min_x, tile_min_x)),
+                        static_cast<u16>(std::max<u32>(triangle.min_y, tile_min_y)),
+                        static_cast<u16>(std::min<u32>(triangle.max_x, tile_max_x)),
+                        static_cast<u16>(std::min<u32>(triangle.max_y, tile_max_y)));
+    }
+}
+
+void RasterizerSoftware::ProcessTriangle(const BinnedTriangle& triangle, u16 min_x, u16 min_y,
+                                         u16 max_x, u16 max_y) {
+    const Vertex& v0 = triangle.v0;
+    const Vertex& v1 = triangle.v1;
+    const Vertex& v2 = triangle.v2;
+    const auto& vtxpos = triangle.vtxpos;
+
+    // Convert the scissor box coordinates to 12.4 fixed point
+    const u32 scissor_x1 = regs.rasterizer.scissor_test.x1 << 4;
+    const u32 scissor_y1 = regs.rasterizer.scissor_test.y1 << 4;
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    const u32 scissor_x2 = (regs.rasterizer.scissor_test.x2 + 1) << 4;
+    const u32 scissor_y2 = (regs.rasterizer.scissor_test.y2 + 1) << 4;
+    const bool scissor_exclude =
+        regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude;
+
+    const int bias0 = triangle.bias[0];
+    const int bias1 = triangle.bias[1];
+    const int bias2 = triangle.bias[2];
+
+    // Edge function increments for a one pixel step along x and y.
+    const s32 w0_step_x = -0x10 * (vtxpos[2].y - vtxpos[1].y);
+    const s32 w0_step_y = 0x10 * (vtxpos[2].x - vtxpos[1].x);
+    const s32 w1_step_x = -0x10 * (vtxpos[0].y - vtxpos[2].y);
+    const s32 w1_step_y = 0x10 * (vtxpos[0].x - vtxpos[2].x);
+    const s32 w2_step_x = -0x10 * (vtxpos[1].y - vtxpos[0].y);
+    const s32 w2_step_y = 0x10 * (vtxpos[1].x - vtxpos[0].x);
+
+    // Broadcast the per-vertex attributes once so every quad only has to do the interpolation.
+    const auto splat = [](f24 attr0, f24 attr1, f24 attr2) {
+        return std::array{QuadF24::Splat(attr0), QuadF24::Splat(attr1), QuadF24::Splat(attr2)};
+    };
+    const bool lighting_enable = !regs.lighting.disable;
+    const std::size_t num_attributes =
+        lighting_enable ? QuadAttributes::NumAttributes : QuadAttributes::NumUnlitAttributes;
+    std::array<std::array<QuadF24, 3>, QuadAttributes::NumAttributes> vertex_attributes;
+    for (u32 i = 0; i < 4; i++) {
+        vertex_attributes[QuadAttributes::Color + i] =
+            splat(v0.color()[i], v1.color()[i], v2.color()[i]);
+    }
+    for (u32 i = 0; i < 2; i++) {
+        vertex_attributes[QuadAttributes::Tc0 + i] = splat(v0.tc0()[i], v1.tc0()[i], v2.tc0()[i]);
+        vertex_attributes[QuadAttributes::Tc1 + i] = splat(v0.tc1()[i], v1.tc1()[i], v2.tc1()[i]);
+        vertex_attributes[QuadAttributes::Tc2 + i] = splat(v0.tc2()[i], v1.tc2()[i], v2.tc2()[i]);
+    }
+    vertex_attributes[QuadAttributes::Tc0W] = splat(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+    if (lighting_enable) {
+        for (u32 i = 0; i < 4; i++) {
+            vertex_attributes[QuadAttributes::Quat + i] =
+                splat(v0.quat()[i], v1.quat()[i], v2.quat()[i]);
+        }
+        for (u32 i = 0; i < 3; i++) {
+            vertex_attributes[QuadAttributes::View + i] =
+                splat(v0.view()[i], v1.view()[i], v2.view()[i]);
+        }
+    }
+    const auto w_inverse = splat(v0.pos().w, v1.pos().w, v2.pos().w);
+    const QuadF24 one = QuadF24::Splat(f24::One());
+
+    const auto textures = regs.texturing.GetTextures();
 
-                // Does alpha testing happen before or after stencil?
-                if (!DoAlphaTest(combiner_output.w)) { // Changed from a()
-                    continue;
+    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
+    // Pixels are processed in 2x2 quads so that coverage and attribute interpolation can be
+    // evaluated for four fragments at once.
+    for (u32 y = min_y + 8; y < max_y; y += 0x20) {
+        for (u32 x = min_x + 8; x < max_x; x += 0x20) {
+            const std::array<u32, 4> quad_x = {x, x + 0x10, x, x + 0x10};
+            const std::array<u32, 4> quad_y = {y, y, y + 0x10, y + 0x10};
+
+            // Calculate the barycentric coordinates w0, w1 and w2
+            const Common::Vec2<Fix12P4> origin{static_cast<u16>(x), static_cast<u16>(y)};
+            const auto w0 = QuadEdge(SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), origin),
+                                     w0_step_x, w0_step_y);
+            const auto w1 = QuadEdge(SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), origin),
+                                     w1_step_x, w1_step_y);
+            const auto w2 = QuadEdge(SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), origin),
+                                     w2_step_x, w2_step_y);
+
+            // Discard lanes past the bounding box and lanes not covered by the primitive.
+            u32 mask = QuadCoverage(w0, w1, w2, bias0, bias1, bias2);
+            for (u32 lane = 0; lane < 4; lane++) {
+                if (quad_x[lane] >= max_x || quad_y[lane] >= max_y) {
+                    mask &= ~(1U << lane);
                 }
-                WriteFog(depth, combiner_output);
-                if (!DoDepthStencilTest(x, y, depth)) {
-                    continue;
+                // Do not process the pixel if it's inside the scissor box and the scissor mode
+                // is set to Exclude.
+                if (scissor_exclude && quad_x[lane] >= scissor_x1 && quad_x[lane] < scissor_x2 &&
+                    quad_y[lane] >= scissor_y1 && quad_y[lane] < scissor_y2) {
+                    mask &= ~(1U << lane);
                 }
-                const auto result = PixelColor(x, y, combiner_output);
-                if (regs.framebuffer.framebuffer.allow_color_write != 0) {
-                    fb.DrawPixel(x >> 4, y >> 4, result);
+            }
+            if (mask == 0) {
+                continue;
+            }
+
+            const QuadF24 bary0 = QuadF24::FromInts(w0);
+            const QuadF24 bary1 = QuadF24::FromInts(w1);
+            const QuadF24 bary2 = QuadF24::FromInts(w2);
+            const QuadF24 interpolated_w_inverse =
+                one / (w_inverse[0] * bary0 + w_inverse[1] * bary1 + w_inverse[2] * bary2);
+
+            /**
+             * Perspective correct attribute interpolation:
+             * Attribute values cannot be calculated by simple linear interpolation since
+             * they are not linear in screen space. For example, when interpolating a
+             * texture coordinate across two vertices, something simple like
+             *     u = (u0*w0 + u1*w1)/(w0+w1)
+             * will not work. However, the attribute value divided by the
+             * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+             * in screenspace. Hence, we can linearly interpolate these two independently and
+             * calculate the interpolated attribute by dividing the results.
+             * I.e.
+             *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+             *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+             *     u = u_over_w / one_over_w
+             *
+             * The generalization to three vertices is straightforward in baricentric
+             *coordinates.
+             **/
+            QuadAttributes attributes;
+            attributes.w_inverse = interpolated_w_inverse.Lanes();
+            for (std::size_t i = 0; i < num_attributes; i++) {
+                const auto& attr = vertex_attributes[i];
+                attributes.values[i] =
+                    ((attr[0] * bary0 + attr[1] * bary1 + attr[2] * bary2) * interpolated_w_inverse)
+                        .Lanes();
+            }
+
+            for (u32 lane = 0; lane < 4; lane++) {
+                if (mask & (1U << lane)) {
+                    ProcessFragment(triangle, static_cast<u16>(quad_x[lane]),
+                                    static_cast<u16>(quad_y[lane]), w0[lane], w1[lane], w2[lane],
+                                    attributes, lane, textures);
                 }
             }
+        }
+    }
+}
+
+void RasterizerSoftware::ProcessFragment(
+    const BinnedTriangle& triangle, u16 x, u16 y, s32 w0, s32 w1, s32 w2,
+    const QuadAttributes& attributes, u32 lane,
+    std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures) {
+    const auto attribute = [&](std::size_t index) { return attributes.values[index][lane]; };
+    const f24 interpolated_w_inverse = attributes.w_inverse[lane];
+    const s32 wsum = w0 + w1 + w2;
+
+    // interpolated_z = z / w
+    const float interpolated_z_over_w = (triangle.v0.screenpos[2].ToFloat32() * w0 +
+                                         triangle.v1.screenpos[2].ToFloat32() * w1 +
+                                         triangle.v2.screenpos[2].ToFloat32() * w2) /
+                                        wsum;
+
+    // Not fully accurate. About 3 bits in precision are missing.
+    // Z-Buffer (z / w * scale + offset)
+    const float depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    const float depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+    float depth = interpolated_z_over_w * depth_scale + depth_offset;
+
+    // Potentially switch to W-Buffer
+    if (regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+        // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+        depth = depth * interpolated_w_inverse.ToFloat32() * wsum;
+    }
+
+    // Clamp the result
+    depth = std::clamp(depth, 0.0f, 1.0f);
+
+    // Color interpolation
+    const Common::Vec4<u8> primary_color{
+        static_cast<u8>(round(attribute(QuadAttributes::Color + 0).ToFloat32() * 255)),
+        static_cast<u8>(round(attribute(QuadAttributes::Color + 1).ToFloat32() * 255)),
+        static_cast<u8>(round(attribute(QuadAttributes::Color + 2).ToFloat32() * 255)),
+        static_cast<u8>(round(attribute(QuadAttributes::Color + 3).ToFloat32() * 255)),
+    };
+
+    // Texture coordinate interpolation
+    std::array<Common::Vec2<f24>, 3> uv;
+    // TC0 coordinates
+    uv[0].x = attribute(QuadAttributes::Tc0 + 0);
+    uv[0].y = attribute(QuadAttributes::Tc0 + 1);
+    // TC1 coordinates
+    uv[1].x = attribute(QuadAttributes::Tc1 + 0);
+    uv[1].y = attribute(QuadAttributes::Tc1 + 1);
+    // TC2 coordinates
+    uv[2].x = attribute(QuadAttributes::Tc2 + 0);
+    uv[2].y = attribute(QuadAttributes::Tc2 + 1);
+
+    // Sample bound texture units.
+    const f24 tc0_w = attribute(QuadAttributes::Tc0W);
+
+    const auto texture_color = TextureColor(uv, textures, tc0_w);
+
+    Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+    Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+
+    if (!regs.lighting.disable) {
+        const auto normquat =
+            Common::Quaternion<f32>{
+                {attribute(QuadAttributes::Quat + 0).ToFloat32(),
+                 attribute(QuadAttributes::Quat + 1).ToFloat32(),
+                 attribute(QuadAttributes::Quat + 2).ToFloat32()},
+                attribute(QuadAttributes::Quat + 3).ToFloat32(),
+            }
+                .Normalized();
+
+        const Common::Vec3f view{
+            attribute(QuadAttributes::View + 0).ToFloat32(),
+            attribute(QuadAttributes::View + 1).ToFloat32(),
+            attribute(QuadAttributes::View + 2).ToFloat32(),
         };
-        sw_workers.QueueWork(std::move(process_scanline));
+
+        std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
+            regs.lighting, pica.lighting, normquat, view, texture_color);
+    }
+
+    // Run the TEV stages.
+    auto combiner_output = tev_program->Run(texture_color, primary_color, primary_fragment_color,
+                                            secondary_fragment_color);
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    if (output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Shadow) {
+        const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+        // Use green color as the shadow intensity
+        const u8 stencil = combiner_output.y;
+        fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
+        // Skip the normal output merger pipeline if it is in shadow mode
+        return;
+    }
+
+    // Does alpha testing happen before or after stencil?
+    if (!DoAlphaTest(combiner_output.w)) { // Changed from a()
+        return;
+    }
+    WriteFog(depth, combiner_output);
+    if (!DoDepthStencilTest(x, y, depth)) {
+        return;
+    }
+    const auto result = PixelColor(x, y, combiner_output);
+    if (regs.framebuffer.framebuffer.allow_color_write != 0) {
+        fb.DrawPixel(x >> 4, y >> 4, result);
     }
-    sw_workers.WaitForRequests();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -735,123 +930,6 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
     return result;
 }
 
-Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
-    std::span<const Common::Vec4<u8>, 4> texture_color,
-    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-    Common::Vec4<u8> secondary_fragment_color) {
-    /**
-     * Texture environment - consists of 6 stages of color and alpha combining.
-     * Color combiners take three input color values from some source (e.g. interpolated
-     * vertex color, texture color, previous stage, etc), perform some very simple
-     * operations on each of them (e.g. inversion) and then calculate the output color
-     * with some basic arithmetic. Alpha combiners can be configured separately but work
-     * analogously.
-     **/
-    Common::Vec4<u8> combiner_output = {0, 0, 0, 0};
-    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-    Common::Vec4<u8> next_combiner_buffer =
-        Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                        regs.texturing.tev_combiner_buffer_color.g.Value(),
-                        regs.texturing.tev_combiner_buffer_color.b.Value(),
-                        regs.texturing.tev_combiner_buffer_color.a.Value())
-            .Cast<u8>();
-
-    for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
-        const auto& tev_stage = tev_stages[tev_stage_index];
-        using Source = TexturingRegs::TevStageConfig::Source;
-
-        auto get_source = [&](Source source) -> Common::Vec4<u8> {
-            switch (source) {
-            case Source::PrimaryColor:
-                return primary_color;
-            case Source::PrimaryFragmentColor:
-                return primary_fragment_color;
-            case Source::SecondaryFragmentColor:
-                return secondary_fragment_color;
-            case Source::Texture0:
-                return texture_color[0];
-            case Source::Texture1:
-                return texture_color[1];
-            case Source::Texture2:
-                return texture_color[2];
-            case Source::Texture3:
-                return texture_color[3];
-            case Source::PreviousBuffer:
-                return combiner_buffer;
-            case Source::Constant:
-                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                    .Cast<u8>();
-            case Source::Previous:
-                return combiner_output;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                UNIMPLEMENTED();
-                return {0, 0, 0, 0};
-            }
-        };
-
-        /**
-         * Color combiner
-         * NOTE: Not sure if the alpha combiner might use the color output of the previous
-         *       stage as input. Hence, we currently don't directly write the result to
-         *       combiner_output.rgb(), but instead store it in a temporary variable until
-         *       alpha combining has been done.
-         **/
-        const auto source1 = tev_stage_index == 0 && tev_stage.color_source1 == Source::Previous
-                                 ? tev_stage.color_source3.Value()
-                                 : tev_stage.color_source1.Value();
-        const auto source2 = tev_stage_index == 0 && tev_stage.color_source2 == Source::Previous
-                                 ? tev_stage.color_source3.Value()
-                                 : tev_stage.color_source2.Value();
-        const std::array<Common::Vec3<u8>, 3> color_result = {
-            GetColorModifier(tev_stage.color_modifier1, get_source(source1)),
-            GetColorModifier(tev_stage.color_modifier2, get_source(source2)),
-            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
-        };
-        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
-
-        u8 alpha_output;
-        if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-            // result of Dot3_RGBA operation is also placed to the alpha component
-            alpha_output = color_output.x;
-        } else {
-            // alpha combiner
-            const std::array<u8, 3> alpha_result = {{
-                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
-                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
-                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
-            }};
-            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-        }
-
-        combiner_output[0] =
-            std::min(255U, color_output.x * tev_stage.GetColorMultiplier()); // Changed from r()
-        combiner_output[1] =
-            std::min(255U, color_output.y * tev_stage.GetColorMultiplier()); // Changed from g()
-        combiner_output[2] =
-            std::min(255U, color_output.z * tev_stage.GetColorMultiplier()); // Changed from b()
-        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
-
-        combiner_buffer = next_combiner_buffer;
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                tev_stage_index)) {
-            next_combiner_buffer.x = combiner_output.x; // Changed from r()
-            next_combiner_buffer.y = combiner_output.y; // Changed from g()
-            next_combiner_buffer.z = combiner_output.z; // Changed from b()
-        }
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                tev_stage_index)) {
-            next_combiner_buffer.w = combiner_output.w; // Changed from a()
-        }
-    } // End of for loop
-
-    return combiner_output;
-}
-
 void RasterizerSoftware::WriteFog(float depth, Common::Vec4<u8>& combiner_output) const {
     if (regs.texturing.fog_mode == TexturingRegs::FogMode::Fog) {
         const Common::Vec3<u8> fog_color =
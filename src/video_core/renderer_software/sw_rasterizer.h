@@ -6,11 +6,14 @@
 #pragma once
 
 #include <span>
+#include <unordered_map>
+#include <vector>
 #include "common/thread_worker.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_texturing.h"
 
 namespace Pica {
 struct RegsInternal;
@@ -20,28 +23,61 @@ class PicaCore;
 namespace SwRenderer {
 
 struct Vertex;
+struct BinnedTriangle;
+struct QuadAttributes;
 
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
-    void ClearAll(bool flush) override {}
+    void DrawTriangles() override {
+        FlushTriangles();
+    }
+    void NotifyPicaRegisterChanged(u32 id) override;
+    void FlushAll() override {
+        FlushTriangles();
+    }
+    void FlushRegion(PAddr addr, u32 size) override {
+        FlushTriangles();
+    }
+    void InvalidateRegion(PAddr addr, u32 size) override {
+        FlushTriangles();
+    }
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {
+        FlushTriangles();
+    }
+    void ClearAll(bool flush) override {
+        FlushTriangles();
+    }
 
 private:
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
-    /// Processes the triangle defined by the provided vertices.
-    void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
-                         bool reversed = false);
+    /// Culls the triangle defined by the provided vertices and sorts it into the screen tiles
+    /// its bounding box overlaps.
+    void BinTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2, bool reversed = false);
+
+    /// Rasterizes all binned triangles, one worker per screen tile, and clears the bins.
+    void FlushTriangles();
+
+    /// Looks up or compiles the TEV program for the current texturing registers.
+    void UpdateTevProgram();
+
+    /// Rasterizes the triangles binned to the provided tile in submission order.
+    void ProcessTile(std::size_t tile_index);
+
+    /// Processes the part of the triangle that lies inside the provided 12.4 fixed point bounds.
+    void ProcessTriangle(const BinnedTriangle& triangle, u16 min_x, u16 min_y, u16 max_x,
+                         u16 max_y);
+
+    /// Shades and writes the fragment stored in the provided lane of an interpolated quad.
+    void ProcessFragment(const BinnedTriangle& triangle, u16 x, u16 y, s32 w0, s32 w1, s32 w2,
+                         const QuadAttributes& attributes, u32 lane,
+                         std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures);
 
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
@@ -51,13 +87,6 @@ private:
     /// Returns the final pixel color with blending or logic ops applied.
     Common::Vec4<u8> PixelColor(u16 x, u16 y, Common::Vec4<u8> combiner_output) const;
 
-    /// Emulates the TEV configuration and returns the combiner output.
-    Common::Vec4<u8> WriteTevConfig(
-        std::span<const Common::Vec4<u8>, 4> texture_color,
-        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-        Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-        Common::Vec4<u8> secondary_fragment_color);
-
     /// Blends fog to the combiner output if enabled.
     void WriteFog(float depth, Common::Vec4<u8>& combiner_output) const;
 
@@ -74,6 +103,13 @@ private:
     std::size_t num_sw_threads;
     Common::ThreadWorker sw_workers;
     Framebuffer fb;
+    std::vector<BinnedTriangle> triangles;
+    std::vector<std::vector<u32>> tile_bins;
+    u32 num_tiles_x{};
+    u32 num_tiles_y{};
+    std::unordered_map<u64, TevProgram> tev_programs;
+    const TevProgram* tev_program{};
+    u64 tev_program_hash{};
 };
 
 } // namespace SwRenderer
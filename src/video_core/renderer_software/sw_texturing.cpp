@@ -4,8 +4,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <utility>
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/vector_math.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/renderer_software/sw_texturing.h"
@@ -205,4 +207,234 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+namespace {
+
+template <std::size_t modifier>
+Common::Vec3<u8> ColorModifierImpl(const Common::Vec4<u8>& values) {
+    return GetColorModifier(static_cast<TevStageConfig::ColorModifier>(modifier), values);
+}
+
+template <std::size_t modifier>
+u8 AlphaModifierImpl(const Common::Vec4<u8>& values) {
+    return GetAlphaModifier(static_cast<TevStageConfig::AlphaModifier>(modifier), values);
+}
+
+template <std::size_t op>
+Common::Vec3<u8> ColorCombineImpl(std::span<const Common::Vec3<u8>, 3> input) {
+    return ColorCombine(static_cast<TevStageConfig::Operation>(op), input);
+}
+
+template <std::size_t op>
+u8 AlphaCombineImpl(const std::array<u8, 3>& input) {
+    return AlphaCombine(static_cast<TevStageConfig::Operation>(op), input);
+}
+
+/// Tables of specializations indexed by the raw register value of the respective field.
+template <std::size_t... values>
+constexpr auto MakeColorModifierTable(std::index_sequence<values...>) {
+    return std::array{&ColorModifierImpl<values>...};
+}
+
+template <std::size_t... values>
+constexpr auto MakeAlphaModifierTable(std::index_sequence<values...>) {
+    return std::array{&AlphaModifierImpl<values>...};
+}
+
+template <std::size_t... values>
+constexpr auto MakeColorCombineTable(std::index_sequence<values...>) {
+    return std::array{&ColorCombineImpl<values>...};
+}
+
+template <std::size_t... values>
+constexpr auto MakeAlphaCombineTable(std::index_sequence<values...>) {
+    return std::array{&AlphaCombineImpl<values>...};
+}
+
+constexpr auto color_modifier_table = MakeColorModifierTable(std::make_index_sequence<16>{});
+constexpr auto alpha_modifier_table = MakeAlphaModifierTable(std::make_index_sequence<8>{});
+constexpr auto color_combine_table = MakeColorCombineTable(std::make_index_sequence<16>{});
+constexpr auto alpha_combine_table = MakeAlphaCombineTable(std::make_index_sequence<16>{});
+
+/// Returns true if the stage forwards the previous combiner output unchanged.
+bool IsPassthroughStage(const TevStageConfig& stage) {
+    using Source = TevStageConfig::Source;
+    using Operation = TevStageConfig::Operation;
+    return stage.color_source1 == Source::Previous && stage.alpha_source1 == Source::Previous &&
+           stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+           stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+           stage.color_op == Operation::Replace && stage.alpha_op == Operation::Replace &&
+           stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1;
+}
+
+} // Anonymous namespace
+
+TevProgram::TevProgram(const Pica::TexturingRegs& regs) {
+    using Source = TevStageConfig::Source;
+
+    const auto tev_stages = regs.GetTevStages();
+    const auto& buffer_input = regs.tev_combiner_buffer_input;
+
+    const auto get_slot = [&](Source source, u32 stage_index) -> Slot {
+        switch (source) {
+        case Source::PrimaryColor:
+            return PrimaryColor;
+        case Source::PrimaryFragmentColor:
+            return PrimaryFragmentColor;
+        case Source::SecondaryFragmentColor:
+            return SecondaryFragmentColor;
+        case Source::Texture0:
+        case Source::Texture1:
+        case Source::Texture2:
+        case Source::Texture3:
+            return static_cast<Slot>(Texture0 + static_cast<u32>(source) -
+                                     static_cast<u32>(Source::Texture0));
+        case Source::PreviousBuffer:
+            return PreviousBuffer;
+        case Source::Constant:
+            return static_cast<Slot>(Constant0 + stage_index);
+        case Source::Previous:
+            return Previous;
+        default:
+            LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
+            UNIMPLEMENTED();
+            return Zero;
+        }
+    };
+
+    bool skipped_stage = false;
+    for (u32 stage_index = 0; stage_index < tev_stages.size(); ++stage_index) {
+        const auto& tev_stage = tev_stages[stage_index];
+        const bool update_buffer_color =
+            buffer_input.TevStageUpdatesCombinerBufferColor(stage_index);
+        const bool update_buffer_alpha =
+            buffer_input.TevStageUpdatesCombinerBufferAlpha(stage_index);
+
+        // Stages that only forward the previous output are dropped. They still advance the
+        // combiner buffer, which the next kept stage catches up on. The first stage is always
+        // kept since it substitutes Previous color sources.
+        if (stage_index != 0 && !update_buffer_color && !update_buffer_alpha &&
+            IsPassthroughStage(tev_stage)) {
+            skipped_stage = true;
+            continue;
+        }
+
+        const auto source1 = stage_index == 0 && tev_stage.color_source1 == Source::Previous
+                                 ? tev_stage.color_source3.Value()
+                                 : tev_stage.color_source1.Value();
+        const auto source2 = stage_index == 0 && tev_stage.color_source2 == Source::Previous
+                                 ? tev_stage.color_source3.Value()
+                                 : tev_stage.color_source2.Value();
+        const bool dot3_rgba = tev_stage.color_op == TevStageConfig::Operation::Dot3_RGBA;
+
+        stages[num_stages++] = Stage{
+            .color_sources = {get_slot(source1, stage_index), get_slot(source2, stage_index),
+                              get_slot(tev_stage.color_source3, stage_index)},
+            .alpha_sources = {get_slot(tev_stage.alpha_source1, stage_index),
+                              get_slot(tev_stage.alpha_source2, stage_index),
+                              get_slot(tev_stage.alpha_source3, stage_index)},
+            .color_modifiers = {color_modifier_table[tev_stage.modifiers_raw & 0xF],
+                                color_modifier_table[(tev_stage.modifiers_raw >> 4) & 0xF],
+                                color_modifier_table[(tev_stage.modifiers_raw >> 8) & 0xF]},
+            .alpha_modifiers = {alpha_modifier_table[(tev_stage.modifiers_raw >> 12) & 0x7],
+                                alpha_modifier_table[(tev_stage.modifiers_raw >> 16) & 0x7],
+                                alpha_modifier_table[(tev_stage.modifiers_raw >> 20) & 0x7]},
+            .color_combine = color_combine_table[tev_stage.ops_raw & 0xF],
+            .alpha_combine =
+                dot3_rgba ? nullptr : alpha_combine_table[(tev_stage.ops_raw >> 16) & 0xF],
+            .color_multiplier = tev_stage.GetColorMultiplier(),
+            .alpha_multiplier = tev_stage.GetAlphaMultiplier(),
+            .update_buffer_color = update_buffer_color,
+            .update_buffer_alpha = update_buffer_alpha,
+            .advance_buffer = std::exchange(skipped_stage, false),
+        };
+
+        initial_inputs[Constant0 + stage_index] =
+            Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                            tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                .Cast<u8>();
+    }
+
+    initial_buffer = Common::MakeVec(regs.tev_combiner_buffer_color.r.Value(),
+                                     regs.tev_combiner_buffer_color.g.Value(),
+                                     regs.tev_combiner_buffer_color.b.Value(),
+                                     regs.tev_combiner_buffer_color.a.Value())
+                         .Cast<u8>();
+}
+
+u64 TevProgram::Hash(const Pica::TexturingRegs& regs) {
+    std::array<u32, 6 * 5 + 2> state{};
+    std::size_t i = 0;
+    for (const auto& tev_stage : regs.GetTevStages()) {
+        state[i++] = tev_stage.sources_raw;
+        state[i++] = tev_stage.modifiers_raw;
+        state[i++] = tev_stage.ops_raw;
+        state[i++] = tev_stage.const_color;
+        state[i++] = tev_stage.scales_raw;
+    }
+    state[i++] = regs.tev_combiner_buffer_input.update_mask_rgb |
+                 (regs.tev_combiner_buffer_input.update_mask_a << 4);
+    state[i++] = regs.tev_combiner_buffer_color.raw;
+    return Common::ComputeStructHash64(state);
+}
+
+Common::Vec4<u8> TevProgram::Run(std::span<const Common::Vec4<u8>, 4> texture_color,
+                                 Common::Vec4<u8> primary_color,
+                                 Common::Vec4<u8> primary_fragment_color,
+                                 Common::Vec4<u8> secondary_fragment_color) const {
+    std::array<Common::Vec4<u8>, NumSlots> inputs = initial_inputs;
+    inputs[PrimaryColor] = primary_color;
+    inputs[PrimaryFragmentColor] = primary_fragment_color;
+    inputs[SecondaryFragmentColor] = secondary_fragment_color;
+    std::copy(texture_color.begin(), texture_color.end(), inputs.begin() + Texture0);
+
+    // The first stage reads a zero buffer, later ones the buffer as left by the previous stage.
+    Common::Vec4<u8> next_combiner_buffer = initial_buffer;
+    Common::Vec4<u8>& combiner_output = inputs[Previous];
+
+    for (std::size_t i = 0; i < num_stages; ++i) {
+        const Stage& stage = stages[i];
+        if (stage.advance_buffer) {
+            inputs[PreviousBuffer] = next_combiner_buffer;
+        }
+
+        const std::array<Common::Vec3<u8>, 3> color_result = {
+            stage.color_modifiers[0](inputs[stage.color_sources[0]]),
+            stage.color_modifiers[1](inputs[stage.color_sources[1]]),
+            stage.color_modifiers[2](inputs[stage.color_sources[2]]),
+        };
+        const Common::Vec3<u8> color_output = stage.color_combine(color_result);
+
+        u8 alpha_output;
+        if (!stage.alpha_combine) {
+            // result of Dot3_RGBA operation is also placed to the alpha component
+            alpha_output = color_output.x;
+        } else {
+            const std::array<u8, 3> alpha_result = {{
+                stage.alpha_modifiers[0](inputs[stage.alpha_sources[0]]),
+                stage.alpha_modifiers[1](inputs[stage.alpha_sources[1]]),
+                stage.alpha_modifiers[2](inputs[stage.alpha_sources[2]]),
+            }};
+            alpha_output = stage.alpha_combine(alpha_result);
+        }
+
+        combiner_output[0] = std::min(255U, color_output.x * stage.color_multiplier);
+        combiner_output[1] = std::min(255U, color_output.y * stage.color_multiplier);
+        combiner_output[2] = std::min(255U, color_output.z * stage.color_multiplier);
+        combiner_output[3] = std::min(255U, alpha_output * stage.alpha_multiplier);
+
+        inputs[PreviousBuffer] = next_combiner_buffer;
+
+        if (stage.update_buffer_color) {
+            next_combiner_buffer.x = combiner_output.x;
+            next_combiner_buffer.y = combiner_output.y;
+            next_combiner_buffer.z = combiner_output.z;
+        }
+        if (stage.update_buffer_alpha) {
+            next_combiner_buffer.w = combiner_output.w;
+        }
+    }
+
+    return combiner_output;
+}
+
 } // namespace SwRenderer
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <array>
 #include <span>
 
 #include "common/common_types.h"
@@ -26,4 +27,60 @@ Common::Vec3<u8> ColorCombine(Pica::TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(Pica::TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+/**
+ * Texture environment configuration decoded once from the PICA registers. Combiner sources are
+ * resolved to input slots and every modifier and combiner operation is bound to a function
+ * specialized for it, so running the program does not re-decode any register per fragment.
+ */
+class TevProgram {
+public:
+    explicit TevProgram(const Pica::TexturingRegs& regs);
+
+    /// Returns a hash of the registers that make up the TEV program.
+    [[nodiscard]] static u64 Hash(const Pica::TexturingRegs& regs);
+
+    /// Runs the combiner stages and returns the combiner output.
+    [[nodiscard]] Common::Vec4<u8> Run(std::span<const Common::Vec4<u8>, 4> texture_color,
+                                       Common::Vec4<u8> primary_color,
+                                       Common::Vec4<u8> primary_fragment_color,
+                                       Common::Vec4<u8> secondary_fragment_color) const;
+
+private:
+    enum Slot : u8 {
+        PrimaryColor,
+        PrimaryFragmentColor,
+        SecondaryFragmentColor,
+        Texture0,
+        PreviousBuffer = Texture0 + 4,
+        Previous,
+        Zero,
+        Constant0,
+        NumSlots = Constant0 + 6,
+    };
+
+    using ColorModifierFunc = Common::Vec3<u8> (*)(const Common::Vec4<u8>&);
+    using AlphaModifierFunc = u8 (*)(const Common::Vec4<u8>&);
+    using ColorCombineFunc = Common::Vec3<u8> (*)(std::span<const Common::Vec3<u8>, 3>);
+    using AlphaCombineFunc = u8 (*)(const std::array<u8, 3>&);
+
+    struct Stage {
+        std::array<Slot, 3> color_sources;
+        std::array<Slot, 3> alpha_sources;
+        std::array<ColorModifierFunc, 3> color_modifiers;
+        std::array<AlphaModifierFunc, 3> alpha_modifiers;
+        ColorCombineFunc color_combine;
+        AlphaCombineFunc alpha_combine; ///< Null when the stage uses Dot3_RGBA
+        u32 color_multiplier;
+        u32 alpha_multiplier;
+        bool update_buffer_color;
+        bool update_buffer_alpha;
+        bool advance_buffer; ///< Set when pass-through stages before this one were dropped
+    };
+
+    std::array<Stage, 6> stages;
+    std::size_t num_stages = 0;
+    std::array<Common::Vec4<u8>, NumSlots> initial_inputs{};
+    Common::Vec4<u8> initial_buffer;
+};
+
 } // namespace SwRenderer
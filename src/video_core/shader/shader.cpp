@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include "common/arch.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader_interpreter.h"
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 #include "video_core/shader/shader_jit.h"
@@ -12,6 +13,20 @@
 
 namespace Pica {
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                            std::span<const AttributeBuffer> inputs,
+                            std::span<AttributeBuffer> outputs) const {
+    const ShaderUnit initial_state = state;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (i != 0) {
+            state = initial_state;
+        }
+        state.LoadInput(config, inputs[i]);
+        Run(setup, state);
+        state.WriteOutput(config, outputs[i]);
+    }
+}
+
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit) {
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
     if (use_jit) {
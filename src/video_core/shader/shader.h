@@ -6,10 +6,13 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
 
 namespace Pica {
 
+struct ShaderRegs;
 struct ShaderSetup;
 struct ShaderUnit;
 
@@ -30,6 +33,21 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for several vertices. Engines that can shade multiple
+     * vertices per invocation override this, the default runs them one by one through `state`.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param config Shader configuration used to map the input and output attributes.
+     * @param state Shader unit state every vertex starts from, so the outputs don't depend on
+     *              how the vertices are split into batches. Left as it is after the last vertex.
+     * @param inputs Input attributes of each vertex.
+     * @param outputs Receives the output attributes of each vertex.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                          std::span<const AttributeBuffer> inputs,
+                          std::span<AttributeBuffer> outputs) const;
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
@@ -6,9 +6,14 @@
 #include "common/arch.h"
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/profiling.h"
+#include "common/settings.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
 #if BORKED3DS_ARCH(arm64)
@@ -16,13 +21,62 @@
 #endif
 #if BORKED3DS_ARCH(x86_64)
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/shader/shader_jit_x64_simd_compiler.h"
 #endif
 
 namespace Pica::Shader {
 
-JitEngine::JitEngine() = default;
+namespace {
+
+/// Shaders compiled from the disk cache are kept until the guest uses them, this bounds the memory
+/// held by the ones it never does. Shaders above it are compiled when they are first used.
+constexpr std::size_t MAX_PRECOMPILED_SHADERS = 128;
+
+} // Anonymous namespace
+
+JitEngine::JitEngine() : precompile_worker{1, "ShaderJitCache"} {
+    if (Settings::values.use_disk_shader_cache.GetValue()) {
+        Precompile(disk_cache.Load());
+    }
+}
+
 JitEngine::~JitEngine() = default;
 
+void JitEngine::Precompile(std::vector<JitDiskCacheEntry> entries) {
+    {
+        std::scoped_lock lock{precompiled_mutex};
+        for (const JitDiskCacheEntry& entry : entries) {
+            pending_precompile.insert(entry.unique_identifier);
+        }
+    }
+
+    auto shared_entries = std::make_shared<std::vector<JitDiskCacheEntry>>(std::move(entries));
+    for (std::size_t i = 0; i < shared_entries->size(); ++i) {
+        precompile_worker.QueueWork([this, shared_entries, i] {
+            const JitDiskCacheEntry& entry = (*shared_entries)[i];
+            {
+                std::scoped_lock lock{precompiled_mutex};
+                if (!pending_precompile.contains(entry.unique_identifier)) {
+                    return;
+                }
+                if (precompiled.size() >= MAX_PRECOMPILED_SHADERS) {
+                    pending_precompile.erase(entry.unique_identifier);
+                    return;
+                }
+            }
+
+            auto shader = std::make_unique<JitShader>();
+            shader->Compile(&entry.program_code, &entry.swizzle_data);
+
+            // The guest may have compiled the shader itself in the meantime.
+            std::scoped_lock lock{precompiled_mutex};
+            if (pending_precompile.erase(entry.unique_identifier) != 0) {
+                precompiled.emplace(entry.unique_identifier, std::move(shader));
+            }
+        });
+    }
+}
+
 void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.entry_point = entry_point;
@@ -35,11 +89,41 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     if (iter != cache.end()) {
         setup.cached_shader = iter->second.get();
     } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
+        std::unique_ptr<JitShader> shader;
+        {
+            std::scoped_lock lock{precompiled_mutex};
+            if (auto node = precompiled.extract(cache_key)) {
+                shader = std::move(node.mapped());
+            } else {
+                // Compiled below, a copy precompiled later would never be used.
+                pending_precompile.erase(cache_key);
+            }
+        }
+        if (!shader) {
+            shader = std::make_unique<JitShader>();
+            shader->Compile(&setup.program_code, &setup.swizzle_data);
+            disk_cache.Save(cache_key, setup.program_code, setup.swizzle_data);
+        }
         setup.cached_shader = shader.get();
         cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+
+    setup.cached_simd_shader = nullptr;
+#if BORKED3DS_ARCH(x86_64)
+    if (Settings::values.use_shader_jit_simd.GetValue()) {
+        auto simd_iter = simd_cache.find(cache_key);
+        if (simd_iter == simd_cache.end()) {
+            auto shader = std::make_unique<JitShaderSimd>();
+            shader->Compile(&setup.program_code, &setup.swizzle_data);
+            simd_iter = simd_cache.emplace(cache_key, std::move(shader)).first;
+        }
+
+        // Entry points with divergent control flow keep using the scalar shader.
+        if (simd_iter->second->IsRunnable(setup.program_code, entry_point)) {
+            setup.cached_simd_shader = simd_iter->second.get();
+        }
+    }
+#endif
 }
 
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
@@ -51,6 +135,33 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                         std::span<const AttributeBuffer> inputs,
+                         std::span<AttributeBuffer> outputs) const {
+#if BORKED3DS_ARCH(x86_64)
+    if (setup.cached_simd_shader && !inputs.empty()) {
+        BORKED3DS_PROFILE("Shader", "Shader JIT SIMD");
+
+        const JitShaderSimd* shader = static_cast<const JitShaderSimd*>(setup.cached_simd_shader);
+        ShaderUnitSimd simd_state;
+
+        std::size_t count = 0;
+        for (std::size_t first = 0; first < inputs.size(); first += count) {
+            count = std::min(SIMD_LANES, inputs.size() - first);
+            simd_state.LoadState(state);
+            simd_state.LoadInput(config, inputs.subspan(first, count));
+            shader->Run(setup, simd_state, setup.entry_point);
+            simd_state.WriteOutput(config, outputs.subspan(first, count));
+        }
+
+        simd_state.StoreState(state, count - 1);
+        return;
+    }
+#endif
+
+    ShaderEngine::RunBatch(setup, config, state, inputs, outputs);
+}
+
 } // namespace Pica::Shader
 
 #endif // BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
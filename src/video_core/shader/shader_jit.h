@@ -9,13 +9,18 @@
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 
 namespace Pica::Shader {
 
 class JitShader;
+class JitShaderSimd;
 
 class JitEngine final : public ShaderEngine {
 public:
@@ -24,9 +29,24 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                  std::span<const AttributeBuffer> inputs,
+                  std::span<AttributeBuffer> outputs) const override;
 
 private:
+    /// Compiles the shaders recorded in the disk cache on the worker thread.
+    void Precompile(std::vector<JitDiskCacheEntry> entries);
+
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    std::unordered_map<u64, std::unique_ptr<JitShaderSimd>> simd_cache;
+
+    JitDiskCache disk_cache;
+    /// Shaders compiled from the disk cache that have not been used yet
+    std::unordered_map<u64, std::unique_ptr<JitShader>> precompiled;
+    /// Shaders from the disk cache that are still to be precompiled
+    std::unordered_set<u64> pending_precompile;
+    std::mutex precompiled_mutex;
+    Common::ThreadWorker precompile_worker;
 };
 
 } // namespace Pica::Shader
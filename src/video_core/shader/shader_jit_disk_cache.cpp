@@ -0,0 +1,239 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+enum class JitEntryKind : u32 {
+    Raw,
+};
+
+constexpr u32 NativeVersion = 1;
+
+namespace {
+
+/// Writes the words of an array up to the last non-zero one, the rest is known to be zero.
+template <std::size_t N>
+bool SaveTrimmed(FileUtil::IOFile& file, const std::array<u32, N>& data) {
+    const auto last = std::find_if(data.rbegin(), data.rend(), [](u32 word) { return word != 0; });
+    const auto length = static_cast<u32>(std::distance(last, data.rend()));
+    return file.WriteObject(length) == 1 && file.WriteArray(data.data(), length) == length;
+}
+
+template <std::size_t N>
+bool LoadTrimmed(FileUtil::IOFile& file, std::array<u32, N>& data) {
+    u32 length{};
+    if (file.ReadBytes(&length, sizeof(u32)) != sizeof(u32) || length > N) {
+        return false;
+    }
+    data.fill(0);
+    return file.ReadArray(data.data(), length) == length;
+}
+
+} // Anonymous namespace
+
+bool JitDiskCacheEntry::Load(FileUtil::IOFile& file) {
+    if (file.ReadBytes(&unique_identifier, sizeof(u64)) != sizeof(u64) ||
+        !LoadTrimmed(file, program_code) || !LoadTrimmed(file, swizzle_data)) {
+        return false;
+    }
+
+    // Must match the cache key of JitEngine::SetupBatch, a mismatch means the entry is corrupt.
+    const u64 code_hash = Common::ComputeHash64(&program_code, sizeof(program_code));
+    const u64 swizzle_hash = Common::ComputeHash64(&swizzle_data, sizeof(swizzle_data));
+    return unique_identifier == Common::HashCombine(code_hash, swizzle_hash);
+}
+
+bool JitDiskCacheEntry::Save(FileUtil::IOFile& file) const {
+    return file.WriteObject(unique_identifier) == 1 && SaveTrimmed(file, program_code) &&
+           SaveTrimmed(file, swizzle_data);
+}
+
+JitDiskCache::JitDiskCache() = default;
+
+JitDiskCache::JitDiskCache(u64 program_id_) : program_id{program_id_} {}
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::vector<JitDiskCacheEntry> JitDiskCache::Load() {
+    const bool has_title_id = GetProgramID() != 0;
+    if (!Settings::values.use_disk_shader_cache || !has_title_id) {
+        return {};
+    }
+    tried_to_load = true;
+
+    // The file is only created once the cache is going to be used.
+    const bool existed = FileUtil::Exists(GetCachePath());
+    cache_file = AppendCacheFile();
+    if (!cache_file.IsOpen()) {
+        tried_to_load = false;
+        return {};
+    }
+    if (!existed) {
+        LOG_INFO(HW_GPU, "No shader JIT cache found for game with title id={}", GetTitleID());
+        return {};
+    }
+
+    u32 version{};
+    cache_file.Seek(0, SEEK_SET);
+    if (cache_file.ReadBytes(&version, sizeof(version)) != sizeof(version)) {
+        LOG_ERROR(HW_GPU, "Failed to get shader JIT cache version for title id={} - removing",
+                  GetTitleID());
+        InvalidateAll();
+        return {};
+    }
+
+    if (version < NativeVersion) {
+        LOG_INFO(HW_GPU, "Shader JIT cache is old - removing");
+        InvalidateAll();
+        return {};
+    }
+    if (version > NativeVersion) {
+        LOG_WARNING(HW_GPU, "Shader JIT cache was generated with a newer version of the emulator "
+                            "- skipping");
+        tried_to_load = false;
+        cache_file.Close();
+        return {};
+    }
+
+    std::vector<JitDiskCacheEntry> entries;
+    while (cache_file.Tell() < cache_file.GetSize()) {
+        JitEntryKind kind{};
+        if (cache_file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
+            LOG_ERROR(HW_GPU, "Failed to read shader JIT cache - removing");
+            InvalidateAll();
+            return {};
+        }
+
+        switch (kind) {
+        case JitEntryKind::Raw: {
+            JitDiskCacheEntry entry;
+            if (!entry.Load(cache_file)) {
+                LOG_ERROR(HW_GPU, "Failed to load shader JIT cache entry - removing");
+                InvalidateAll();
+                return {};
+            }
+            stored.insert(entry.unique_identifier);
+            entries.push_back(std::move(entry));
+            break;
+        }
+        default:
+            LOG_ERROR(HW_GPU, "Unknown shader JIT cache entry kind={} - removing", kind);
+            InvalidateAll();
+            return {};
+        }
+    }
+
+    // New entries are appended after the loaded ones.
+    cache_file.Seek(0, SEEK_END);
+
+    LOG_INFO(HW_GPU, "Found a shader JIT cache with {} entries", entries.size());
+    return entries;
+}
+
+void JitDiskCache::Save(u64 unique_identifier, const ProgramCode& program_code,
+                        const SwizzleData& swizzle_data) {
+    if (!IsUsable() || stored.contains(unique_identifier)) {
+        return;
+    }
+
+    if (cache_file.WriteObject(static_cast<u32>(JitEntryKind::Raw)) != 1 ||
+        cache_file.WriteObject(unique_identifier) != 1 || !SaveTrimmed(cache_file, program_code) ||
+        !SaveTrimmed(cache_file, swizzle_data)) {
+        LOG_ERROR(HW_GPU, "Failed to save shader JIT cache entry - removing");
+        InvalidateAll();
+        return;
+    }
+    stored.insert(unique_identifier);
+    cache_file.Flush();
+}
+
+void JitDiskCache::InvalidateAll() {
+    stored.clear();
+
+    cache_file.Close();
+    if (!FileUtil::Delete(GetCachePath())) {
+        LOG_ERROR(HW_GPU, "Failed to invalidate shader JIT cache file={}", GetCachePath());
+    }
+    cache_file = AppendCacheFile();
+}
+
+bool JitDiskCache::IsUsable() const {
+    return tried_to_load && Settings::values.use_disk_shader_cache;
+}
+
+FileUtil::IOFile JitDiskCache::AppendCacheFile() {
+    if (!EnsureDirectories())
+        return {};
+
+    const auto cache_path{GetCachePath()};
+    const bool existed = FileUtil::Exists(cache_path);
+
+    FileUtil::IOFile file(cache_path, "ab+");
+    if (!file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open shader JIT cache in path={}", cache_path);
+        return {};
+    }
+    if (!existed || file.GetSize() == 0) {
+        // If the file didn't exist, write its version
+        if (file.WriteObject(NativeVersion) != 1) {
+            LOG_ERROR(HW_GPU, "Failed to write shader JIT cache version in path={}", cache_path);
+            return {};
+        }
+    }
+    return file;
+}
+
+bool JitDiskCache::EnsureDirectories() const {
+    const auto CreateDir = [](const std::string& dir) {
+        if (!FileUtil::CreateDir(dir)) {
+            LOG_ERROR(HW_GPU, "Failed to create directory={}", dir);
+            return false;
+        }
+        return true;
+    };
+
+    return CreateDir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
+           CreateDir(GetBaseDir());
+}
+
+std::string JitDiskCache::GetCachePath() {
+    return FileUtil::SanitizePath(GetBaseDir() + DIR_SEP_CHR + GetTitleID() + ".bin");
+}
+
+std::string JitDiskCache::GetBaseDir() const {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "jit";
+}
+
+u64 JitDiskCache::GetProgramID() {
+    // Skip games without title id
+    if (program_id != 0) {
+        return program_id;
+    }
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+        Loader::ResultStatus::Success) {
+        return 0;
+    }
+    return program_id;
+}
+
+std::string JitDiskCache::GetTitleID() {
+    if (!title_id.empty()) {
+        return title_id;
+    }
+    title_id = fmt::format("{:016X}", GetProgramID());
+    return title_id;
+}
+
+} // namespace Pica::Shader
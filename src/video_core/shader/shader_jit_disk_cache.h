@@ -0,0 +1,84 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/pica/shader_setup.h"
+
+namespace Pica::Shader {
+
+/// Program and swizzle data of a shader compiled by the JIT
+struct JitDiskCacheEntry {
+    u64 unique_identifier{};
+    ProgramCode program_code{};
+    SwizzleData swizzle_data{};
+
+    bool Load(FileUtil::IOFile& file);
+
+    bool Save(FileUtil::IOFile& file) const;
+};
+
+/**
+ * Per-title record of the shader programs compiled by the JIT. Machine code is not stored, the
+ * recorded programs are recompiled at boot before the guest uses them.
+ */
+class JitDiskCache {
+public:
+    JitDiskCache();
+    /// Uses the cache of the given title instead of the one of the running application.
+    explicit JitDiskCache(u64 program_id);
+    ~JitDiskCache();
+
+    /// Loads the cache of the current title, creating its file if the cache is enabled. If file
+    /// has a old version or on failure, it deletes the file.
+    std::vector<JitDiskCacheEntry> Load();
+
+    /// Appends a program to the cache file unless it was already recorded.
+    void Save(u64 unique_identifier, const ProgramCode& program_code,
+              const SwizzleData& swizzle_data);
+
+    /// Removes the cache file of the current title.
+    void InvalidateAll();
+
+private:
+    /// Returns if the cache can be used
+    [[nodiscard]] bool IsUsable() const;
+
+    /// Opens current game's cache file and write it's header if it doesn't exist.
+    FileUtil::IOFile AppendCacheFile();
+
+    /// Create shader disk cache directories. Returns true on success.
+    [[nodiscard]] bool EnsureDirectories() const;
+
+    /// Gets current game's cache file path
+    std::string GetCachePath();
+
+    /// Get user's JIT shader directory path
+    [[nodiscard]] std::string GetBaseDir() const;
+
+    /// Get current game's title id as u64
+    u64 GetProgramID();
+
+    /// Get current game's title id
+    std::string GetTitleID();
+
+    // Identifiers of the programs stored in the cache file
+    std::unordered_set<u64> stored;
+
+    // The cache has been loaded at boot
+    bool tried_to_load{};
+
+    u64 program_id{};
+    std::string title_id;
+
+    FileUtil::IOFile cache_file;
+};
+
+} // namespace Pica::Shader
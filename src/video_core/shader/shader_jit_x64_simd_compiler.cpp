@@ -0,0 +1,1010 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if BORKED3DS_ARCH(x86_64)
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include <xbyak/xbyak_util.h>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/pica_types.h"
+#include "video_core/shader/shader_jit_x64_simd_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+using nihstro::DestRegister;
+using nihstro::RegisterType;
+
+static const Xbyak::util::Cpu host_caps;
+
+namespace Pica::Shader {
+
+void ShaderUnitSimd::LoadState(const ShaderUnit& unit) {
+    for (std::size_t reg = 0; reg < temporary.size(); ++reg) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            temporary[reg][comp].fill(unit.temporary[reg][comp]);
+            output[reg][comp].fill(unit.output[reg][comp]);
+        }
+    }
+    address_registers[0].fill(unit.address_registers[0]);
+    address_registers[1].fill(unit.address_registers[1]);
+    loop_register = unit.address_registers[2];
+    conditional_code[0].fill(unit.conditional_code[0] ? ~0U : 0U);
+    conditional_code[1].fill(unit.conditional_code[1] ? ~0U : 0U);
+}
+
+void ShaderUnitSimd::StoreState(ShaderUnit& unit, std::size_t lane) const {
+    for (std::size_t reg = 0; reg < temporary.size(); ++reg) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            unit.temporary[reg][comp] = temporary[reg][comp][lane];
+            unit.output[reg][comp] = output[reg][comp][lane];
+        }
+    }
+    unit.address_registers[0] = address_registers[0][lane];
+    unit.address_registers[1] = address_registers[1][lane];
+    unit.address_registers[2] = loop_register;
+    unit.conditional_code[0] = conditional_code[0][lane] != 0;
+    unit.conditional_code[1] = conditional_code[1][lane] != 0;
+}
+
+void ShaderUnitSimd::LoadInput(const ShaderRegs& config,
+                               std::span<const AttributeBuffer> inputs) {
+    const u32 max_attribute = config.max_input_attribute_index;
+    for (u32 attr = 0; attr <= max_attribute; ++attr) {
+        Register& reg = input[config.GetRegisterForAttribute(attr)];
+        for (std::size_t lane = 0; lane < SIMD_LANES; ++lane) {
+            const auto& buffer = inputs[std::min(lane, inputs.size() - 1)];
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                reg[comp][lane] = buffer[attr][comp];
+            }
+        }
+    }
+}
+
+void ShaderUnitSimd::WriteOutput(const ShaderRegs& config,
+                                 std::span<AttributeBuffer> outputs) const {
+    u32 output_index{};
+    for (u32 reg : Common::BitSet<u32>(config.output_mask)) {
+        for (std::size_t lane = 0; lane < outputs.size(); ++lane) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                outputs[lane][output_index][comp] = output[reg][comp][lane];
+            }
+        }
+        ++output_index;
+    }
+}
+
+typedef void (JitShaderSimd::*JitFunction)(Instruction instr);
+
+// Instructions left out have no SIMD implementation; IsRunnable rejects entry points reaching them.
+const JitFunction simd_instr_table[64] = {
+    &JitShaderSimd::Compile_ADD,   // add
+    &JitShaderSimd::Compile_DP3,   // dp3
+    &JitShaderSimd::Compile_DP4,   // dp4
+    &JitShaderSimd::Compile_DPH,   // dph
+    nullptr,                       // unknown
+    nullptr,                       // ex2
+    nullptr,                       // lg2
+    nullptr,                       // unknown
+    &JitShaderSimd::Compile_MUL,   // mul
+    &JitShaderSimd::Compile_SGE,   // sge
+    &JitShaderSimd::Compile_SLT,   // slt
+    &JitShaderSimd::Compile_FLR,   // flr
+    &JitShaderSimd::Compile_MAX,   // max
+    &JitShaderSimd::Compile_MIN,   // min
+    &JitShaderSimd::Compile_RCP,   // rcp
+    &JitShaderSimd::Compile_RSQ,   // rsq
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    &JitShaderSimd::Compile_MOVA,  // mova
+    &JitShaderSimd::Compile_MOV,   // mov
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    &JitShaderSimd::Compile_DPH,   // dphi
+    nullptr,                       // unknown
+    &JitShaderSimd::Compile_SGE,   // sgei
+    &JitShaderSimd::Compile_SLT,   // slti
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    nullptr,                       // unknown
+    &JitShaderSimd::Compile_NOP,   // nop
+    &JitShaderSimd::Compile_END,   // end
+    nullptr,                       // breakc
+    &JitShaderSimd::Compile_CALL,  // call
+    nullptr,                       // callc
+    &JitShaderSimd::Compile_CALLU, // callu
+    &JitShaderSimd::Compile_IF,    // ifu
+    nullptr,                       // ifc
+    &JitShaderSimd::Compile_LOOP,  // loop
+    nullptr,                       // emit
+    nullptr,                       // sete
+    nullptr,                       // jmpc
+    &JitShaderSimd::Compile_JMP,   // jmpu
+    &JitShaderSimd::Compile_CMP,   // cmp
+    &JitShaderSimd::Compile_CMP,   // cmp
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // madi
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+    &JitShaderSimd::Compile_MAD,   // mad
+};
+
+// The register assignment follows JitShader where possible. Address registers and conditional
+// codes differ per lane, so they live in the ShaderUnitSimd instead of general purpose registers.
+// RAX-RDX and the SCRATCH registers can be used freely within a compiler function.
+
+/// Pointer to the uniform memory
+constexpr Reg64 UNIFORMS = r9;
+/// VS loop count register, identical for all lanes
+constexpr Reg32 LOOPCOUNT_REG = r12d;
+/// Current VS loop iteration number
+constexpr Reg32 LOOPCOUNT = esi;
+/// Number to increment LOOPCOUNT_REG by on each loop iteration
+constexpr Reg32 LOOPINC = edi;
+/// Pointer to the ShaderUnitSimd instance
+constexpr Reg64 STATE = r15;
+/// Loaded with the components of the first swizzled source register
+constexpr std::array<Xmm, 4> SRC1 = {xmm0, xmm1, xmm2, xmm3};
+/// Loaded with the components of the second swizzled source register
+constexpr std::array<Xmm, 4> SRC2 = {xmm4, xmm5, xmm6, xmm7};
+/// Loaded with the components of the third swizzled source register
+constexpr std::array<Xmm, 4> SRC3 = {xmm8, xmm9, xmm10, xmm11};
+/// SIMD scratch registers
+constexpr Xmm SCRATCH = xmm12;
+constexpr Xmm SCRATCH2 = xmm13;
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+constexpr Xmm ONE = xmm14;
+/// Constant vector of [-0.f, -0.f, -0.f, -0.f], used to efficiently negate a vector with XOR
+constexpr Xmm NEGBIT = xmm15;
+
+/// Mask of the X component, used for instructions that only read the first component
+constexpr u32 MASK_X = 0b0001;
+/// Mask of the X and Y components
+constexpr u32 MASK_XY = 0b0011;
+/// Mask of the X, Y and Z components
+constexpr u32 MASK_XYZ = 0b0111;
+/// Mask of all components
+constexpr u32 MASK_XYZW = 0b1111;
+
+static std::size_t AddressRegisterOffset(u32 index) {
+    return offsetof(ShaderUnitSimd, address_registers) +
+           index * sizeof(ShaderUnitSimd::address_registers[0]);
+}
+
+static std::size_t ConditionalCodeOffset(u32 index) {
+    return offsetof(ShaderUnitSimd, conditional_code) +
+           index * sizeof(ShaderUnitSimd::conditional_code[0]);
+}
+
+/**
+ * Loads and swizzles the selected components of a source register into the specified XMM
+ * registers. Component i of the swizzled register is loaded into dest[i] for all lanes.
+ */
+void JitShaderSimd::Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                                       const ComponentRegs& dest, u32 mask) {
+    u32 operand_desc_id;
+
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    u32 address_register_index;
+    u32 offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    SwizzlePattern swiz((*swizzle_data)[operand_desc_id]);
+    const u8 sel = swiz.GetRawSelector(src_num);
+    const auto selected = [sel](u32 i) -> u32 { return (sel >> (6 - 2 * i)) & 3; };
+
+    std::size_t src_offset;
+    switch (src_reg.GetRegisterType()) {
+    case RegisterType::FloatUniform:
+        if (src_num == offset_src && address_register_index == 3) {
+            // The loop register is identical for all lanes, so only one uniform is loaded.
+            Compile_UniformIndex(LOOPCOUNT_REG.cvt64(), src_reg.GetIndex());
+            Compile_LoadUniform(SCRATCH);
+            for (u32 i = 0; i < 4; ++i) {
+                if (mask & (1 << i)) {
+                    movaps(dest[i], SCRATCH);
+                    shufps(dest[i], dest[i], static_cast<u8>(selected(i) * 0x55));
+                }
+            }
+            src_offset = 0;
+            break;
+        }
+
+        if (src_num == offset_src && address_register_index != 0) {
+            // Each lane may address a different uniform: gather the uniform of every lane into
+            // the staging register, which is then swizzled like any other register.
+            for (u32 lane = 0; lane < SIMD_LANES; ++lane) {
+                const std::size_t offset =
+                    AddressRegisterOffset(address_register_index - 1) + lane * sizeof(s32);
+                movsxd(rcx, dword[STATE + offset]);
+                Compile_UniformIndex(rcx, src_reg.GetIndex());
+                Compile_LoadUniform(dest[lane]);
+            }
+            Compile_Transpose(dest);
+            for (u32 comp = 0; comp < 4; ++comp) {
+                movaps(xword[STATE + offsetof(ShaderUnitSimd, gathered) +
+                             ShaderUnitSimd::ComponentOffset(comp)],
+                       dest[comp]);
+            }
+            for (u32 i = 0; i < 4; ++i) {
+                if (mask & (1 << i)) {
+                    movaps(dest[i], xword[STATE + offsetof(ShaderUnitSimd, gathered) +
+                                          ShaderUnitSimd::ComponentOffset(selected(i))]);
+                }
+            }
+            src_offset = 0;
+            break;
+        }
+
+        for (u32 i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) {
+                const std::size_t offset =
+                    Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) + selected(i) * sizeof(f24);
+                movss(dest[i], dword[UNIFORMS + offset]);
+                shufps(dest[i], dest[i], _MM_SHUFFLE(0, 0, 0, 0));
+            }
+        }
+        src_offset = 0;
+        break;
+    case RegisterType::Input:
+        src_offset = ShaderUnitSimd::InputOffset(src_reg.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        src_offset = ShaderUnitSimd::TemporaryOffset(src_reg.GetIndex());
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown source register type: {}", src_reg.GetRegisterType());
+        break;
+    }
+
+    if (src_reg.GetRegisterType() != RegisterType::FloatUniform) {
+        // Swizzling only selects which component is loaded into each register
+        for (u32 i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) {
+                movaps(dest[i],
+                       xword[STATE + src_offset + ShaderUnitSimd::ComponentOffset(selected(i))]);
+            }
+        }
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        for (u32 i = 0; i < 4; ++i) {
+            if (mask & (1 << i)) {
+                xorps(dest[i], NEGBIT);
+            }
+        }
+    }
+}
+
+u32 JitShaderSimd::DestMask(Instruction instr) const {
+    u32 operand_desc_id;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        operand_desc_id = instr.mad.operand_desc_id;
+    } else {
+        operand_desc_id = instr.common.operand_desc_id;
+    }
+
+    SwizzlePattern swiz = {(*swizzle_data)[operand_desc_id]};
+    u32 mask = 0;
+    for (u32 i = 0; i < 4; ++i) {
+        if (swiz.DestComponentEnabled(i)) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+void JitShaderSimd::Compile_DestEnable(Instruction instr, const ComponentRegs& src) {
+    DestRegister dest;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        dest = instr.mad.dest.Value();
+    } else {
+        dest = instr.common.dest.Value();
+    }
+
+    std::size_t dest_offset_disp;
+    switch (dest.GetRegisterType()) {
+    case RegisterType::Output:
+        dest_offset_disp = ShaderUnitSimd::OutputOffset(dest.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        dest_offset_disp = ShaderUnitSimd::TemporaryOffset(dest.GetIndex());
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown destination register type: {}",
+                        dest.GetRegisterType());
+        break;
+    }
+
+    // Components are stored separately, so disabled components are simply not written
+    const u32 mask = DestMask(instr);
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            movaps(xword[STATE + dest_offset_disp + ShaderUnitSimd::ComponentOffset(i)], src[i]);
+        }
+    }
+}
+
+void JitShaderSimd::Compile_UniformIndex(Reg64 address_reg, u32 index) {
+    // s32 offset = address_reg >= -128 && address_reg <= 127 ? address_reg : 0;
+    // u32 index = (src_reg.GetIndex() + offset) & 0x7f;
+    lea(eax, ptr[address_reg + 128]);
+    mov(ebx, index);
+    mov(ecx, address_reg.cvt32());
+    add(ecx, ebx);
+    cmp(eax, 256);
+    cmovb(ebx, ecx);
+    and_(ebx, 0x7f);
+}
+
+void JitShaderSimd::Compile_LoadUniform(Xmm dest) {
+    static_assert(offsetof(Uniforms, f) == 0, "Float uniforms must start the uniform memory");
+
+    // index > 95 ? vec4(1.0) : uniforms.f[index];
+    movaps(dest, ONE);
+    cmp(ebx, 95);
+    Label load_end;
+    jg(load_end);
+    shl(rbx, 4);
+    movaps(dest, xword[UNIFORMS + rbx]);
+    L(load_end);
+}
+
+void JitShaderSimd::Compile_Transpose(const ComponentRegs& regs) {
+    // regs[lane] = [x, y, z, w] -> regs[comp] = [lane0, lane1, lane2, lane3]
+    movaps(SCRATCH, regs[0]);
+    unpcklps(SCRATCH, regs[1]); // x0 x1 y0 y1
+    unpckhps(regs[0], regs[1]); // z0 z1 w0 w1
+    movaps(SCRATCH2, regs[2]);
+    unpcklps(SCRATCH2, regs[3]); // x2 x3 y2 y3
+    unpckhps(regs[2], regs[3]);  // z2 z3 w2 w3
+
+    movaps(regs[1], SCRATCH2);
+    movhlps(regs[1], SCRATCH); // y0 y1 y2 y3
+    movlhps(SCRATCH, SCRATCH2); // x0 x1 x2 x3
+    movaps(regs[3], regs[2]);
+    movhlps(regs[3], regs[0]); // w0 w1 w2 w3
+    movlhps(regs[0], regs[2]); // z0 z1 z2 z3
+
+    movaps(regs[2], regs[0]);
+    movaps(regs[0], SCRATCH);
+}
+
+void JitShaderSimd::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN. This can be implemented by
+    // checking for NaNs before and after the multiplication.  If the multiplication result is NaN
+    // where neither source was, this NaN was generated by a 0 * inf multiplication, and so the
+    // result should be transformed to 0 to match PICA fp rules.
+
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL | Cpu::tAVX512DQ)) {
+        vmulps(scratch, src1, src2);
+
+        // Mask of any NaN values found in the result
+        const Xbyak::Opmask zero_mask = k1;
+        vcmpunordps(zero_mask, scratch, scratch);
+
+        // Mask of any non-NaN inputs producing NaN results
+        vcmpordps(zero_mask | zero_mask, src1, src2);
+
+        knotb(zero_mask, zero_mask);
+        vmovaps(src1 | zero_mask | T_z, scratch);
+
+        return;
+    }
+
+    // Set scratch to mask of (src1 != NaN and src2 != NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpordps(scratch, src1, src2);
+    } else {
+        movaps(scratch, src1);
+        cmpordps(scratch, src2);
+    }
+
+    mulps(src1, src2);
+
+    // Set src2 to mask of (result == NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpunordps(src2, src2, src1);
+    } else {
+        movaps(src2, src1);
+        cmpunordps(src2, src2);
+    }
+
+    // Clear components where scratch != src2 (i.e. if result is NaN where neither source was NaN)
+    xorps(scratch, src2);
+    andps(src1, scratch);
+}
+
+void JitShaderSimd::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+void JitShaderSimd::Compile_ADD(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            addps(SRC1[i], SRC2[i]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_DP3(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, MASK_XYZ);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, MASK_XYZ);
+
+    for (u32 i = 0; i < 3; ++i) {
+        Compile_SanitizedMul(SRC1[i], SRC2[i], SCRATCH);
+    }
+
+    // Same summation order as JitShader: (x + y) + z
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitShaderSimd::Compile_DP4(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+
+    for (u32 i = 0; i < 4; ++i) {
+        Compile_SanitizedMul(SRC1[i], SRC2[i], SCRATCH);
+    }
+
+    // Same summation order as the two HADDPS of JitShader: (x + y) + (z + w)
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[2], SRC1[3]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitShaderSimd::Compile_DPH(Instruction instr) {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, MASK_XYZ);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, MASK_XYZ);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2);
+    }
+
+    // Set 4th component to 1.0
+    movaps(SRC1[3], ONE);
+
+    for (u32 i = 0; i < 4; ++i) {
+        Compile_SanitizedMul(SRC1[i], SRC2[i], SCRATCH);
+    }
+
+    addps(SRC1[0], SRC1[1]);
+    addps(SRC1[2], SRC1[3]);
+    addps(SRC1[0], SRC1[2]);
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitShaderSimd::Compile_MUL(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            Compile_SanitizedMul(SRC1[i], SRC2[i], SCRATCH);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_SGE(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, mask);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, mask);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    }
+
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            cmpleps(SRC2[i], SRC1[i]);
+            andps(SRC2[i], ONE);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC2);
+}
+
+void JitShaderSimd::Compile_SLT(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1i, SRC1, mask);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2i, SRC2, mask);
+    } else {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    }
+
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            cmpltps(SRC1[i], SRC2[i]);
+            andps(SRC1[i], ONE);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_FLR(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+
+    for (u32 i = 0; i < 4; ++i) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        if (host_caps.has(Cpu::tSSE41)) {
+            roundps(SRC1[i], SRC1[i], _MM_FROUND_FLOOR);
+        } else {
+            cvttps2dq(SRC1[i], SRC1[i]);
+            cvtdq2ps(SRC1[i], SRC1[i]);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_MAX(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            maxps(SRC1[i], SRC2[i]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_MIN(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, mask);
+    // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            minps(SRC1[i], SRC2[i]);
+        }
+    }
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_MOVA(Instruction instr) {
+    const u32 mask = DestMask(instr) & MASK_XY;
+    if (mask == 0) {
+        return; // NoOp
+    }
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+
+    // Convert floats to integers using truncation, one address register per component
+    for (u32 i = 0; i < 2; ++i) {
+        if (mask & (1 << i)) {
+            cvttps2dq(SRC1[i], SRC1[i]);
+            movaps(xword[STATE + AddressRegisterOffset(i)], SRC1[i]);
+        }
+    }
+}
+
+void JitShaderSimd::Compile_MOV(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, mask);
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, MASK_X);
+
+    // The packed forms use the same approximation as the scalar ones of JitShader
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrcp14ps(SRC1[0], SRC1[0]);
+    } else {
+        rcpps(SRC1[0], SRC1[0]);
+    }
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitShaderSimd::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, MASK_X);
+
+    // The packed forms use the same approximation as the scalar ones of JitShader
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrsqrt14ps(SRC1[0], SRC1[0]);
+    } else {
+        rsqrtps(SRC1[0], SRC1[0]);
+    }
+
+    Compile_DestEnable(instr, {SRC1[0], SRC1[0], SRC1[0], SRC1[0]});
+}
+
+void JitShaderSimd::Compile_NOP(Instruction instr) {}
+
+void JitShaderSimd::Compile_END(Instruction instr) {
+    // Address registers and conditional codes are already in memory, only the loop register is not
+    mov(dword[STATE + offsetof(ShaderUnitSimd, loop_register)], LOOPCOUNT_REG);
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+}
+
+void JitShaderSimd::Compile_CALL(Instruction instr) {
+    // Push offset of the return
+    push(qword, (instr.flow_control.dest_offset + instr.flow_control.num_instructions));
+
+    // Call the subroutine
+    call(instruction_labels[instr.flow_control.dest_offset]);
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitShaderSimd::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitShaderSimd::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    Op op_x = instr.common.compare_op.x;
+    Op op_y = instr.common.compare_op.y;
+
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, SRC1, MASK_XY);
+    Compile_SwizzleSrc(instr, 2, instr.common.src2, SRC2, MASK_XY);
+
+    // SSE doesn't have greater-than (GT) or greater-equal (GE) comparison operators. You need to
+    // emulate them by swapping the lhs and rhs and using LT and LE. NLT and NLE can't be used here
+    // because they don't match when used with NaNs.
+    static const u8 cmp[] = {CMP_EQ, CMP_NEQ, CMP_LT, CMP_LE, CMP_LT, CMP_LE};
+
+    const Op ops[] = {op_x, op_y};
+    for (u32 i = 0; i < 2; ++i) {
+        const bool invert_op = (ops[i] == Op::GreaterThan || ops[i] == Op::GreaterEqual);
+        const Xmm lhs = invert_op ? SRC2[i] : SRC1[i];
+        const Xmm rhs = invert_op ? SRC1[i] : SRC2[i];
+
+        cmpps(lhs, rhs, cmp[ops[i]]);
+        movaps(xword[STATE + ConditionalCodeOffset(i)], lhs);
+    }
+}
+
+void JitShaderSimd::Compile_MAD(Instruction instr) {
+    const u32 mask = DestMask(instr);
+    Compile_SwizzleSrc(instr, 1, instr.mad.src1, SRC1, mask);
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2i, SRC2, mask);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3i, SRC3, mask);
+    } else {
+        Compile_SwizzleSrc(instr, 2, instr.mad.src2, SRC2, mask);
+        Compile_SwizzleSrc(instr, 3, instr.mad.src3, SRC3, mask);
+    }
+
+    for (u32 i = 0; i < 4; ++i) {
+        if (mask & (1 << i)) {
+            Compile_SanitizedMul(SRC1[i], SRC2[i], SCRATCH);
+            addps(SRC1[i], SRC3[i]);
+        }
+    }
+
+    Compile_DestEnable(instr, SRC1);
+}
+
+void JitShaderSimd::Compile_IF(Instruction instr) {
+    // Only IFU is supported, so the condition is the same for all lanes
+    Label l_else, l_endif;
+
+    Compile_UniformCondition(instr);
+    jz(l_else, T_NEAR);
+
+    // Compile the code that corresponds to the condition evaluating as true
+    Compile_Block(instr.flow_control.dest_offset);
+
+    // If there isn't an "ELSE" condition, we are done here
+    if (instr.flow_control.num_instructions == 0) {
+        L(l_else);
+        return;
+    }
+
+    jmp(l_endif, T_NEAR);
+
+    L(l_else);
+    // This code corresponds to the "ELSE" condition
+    // Comple the code that corresponds to the condition evaluating as false
+    Compile_Block(instr.flow_control.dest_offset + instr.flow_control.num_instructions);
+
+    L(l_endif);
+}
+
+void JitShaderSimd::Compile_LOOP(Instruction instr) {
+    if (loop_depth++) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PushRegistersAndAdjustStack(*this, loop_save_regs, 0);
+    }
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id.
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(LOOPCOUNT_REG, LOOPCOUNT);
+    shr(LOOPCOUNT_REG, 8);
+    and_(LOOPCOUNT_REG, 0xFF); // Y-component is the start
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 16);
+    and_(LOOPINC, 0xFF);                // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    Label l_loop_start;
+    L(l_loop_start);
+
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    add(LOOPCOUNT_REG, LOOPINC); // Increment LOOPCOUNT_REG by Z-component
+    sub(LOOPCOUNT, 1);           // Increment loop count by 1
+    jnz(l_loop_start);           // Loop if not equal
+
+    if (--loop_depth) {
+        const auto loop_save_regs = BuildRegSet({LOOPCOUNT_REG, LOOPINC, LOOPCOUNT});
+        ABI_PopRegistersAndAdjustStack(*this, loop_save_regs, 0);
+    }
+}
+
+void JitShaderSimd::Compile_JMP(Instruction instr) {
+    // Only JMPU is supported, so the condition is the same for all lanes
+    Compile_UniformCondition(instr);
+
+    bool inverted_condition = (instr.flow_control.num_instructions & 1);
+
+    Label& b = instruction_labels[instr.flow_control.dest_offset];
+    if (inverted_condition) {
+        jz(b, T_NEAR);
+    } else {
+        jnz(b, T_NEAR);
+    }
+}
+
+void JitShaderSimd::Compile_Block(u32 end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitShaderSimd::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitShaderSimd::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+
+    Instruction instr = ((*program_code)[program_counter++]);
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = simd_instr_table[static_cast<u32>(opcode)];
+
+    // Instructions without a SIMD implementation are never reached, see IsRunnable
+    if (instr_func) {
+        ((*this).*instr_func)(instr);
+    }
+}
+
+void JitShaderSimd::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = 0; offset < program_code->size(); ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+bool JitShaderSimd::IsRunnable(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& code,
+                               u32 entry_point) {
+    if (const auto it = runnable_entry_points.find(entry_point);
+        it != runnable_entry_points.end()) {
+        return it->second;
+    }
+
+    // Walk every instruction that can be reached from the entry point. Both sides of each branch
+    // are followed, which may visit more code than can actually execute but never less.
+    // Subroutines are only followed up to their return offset.
+    const bool runnable = [&] {
+        std::set<std::pair<u32, u32>> queued{{entry_point, MAX_PROGRAM_CODE_LENGTH}};
+        std::vector<std::pair<u32, u32>> pending{{entry_point, MAX_PROGRAM_CODE_LENGTH}};
+        const auto queue = [&](u32 begin, u32 end) {
+            if (queued.emplace(begin, end).second) {
+                pending.emplace_back(begin, end);
+            }
+        };
+
+        while (!pending.empty()) {
+            const auto [begin, end] = pending.back();
+            pending.pop_back();
+
+            for (u32 offset = begin; offset < std::min<u32>(end, MAX_PROGRAM_CODE_LENGTH);
+                 ++offset) {
+                const Instruction instr = {code[offset]};
+                const OpCode::Id opcode = instr.opcode.Value();
+                if (!simd_instr_table[static_cast<u32>(opcode)]) {
+                    return false;
+                }
+
+                if (opcode == OpCode::Id::END) {
+                    break;
+                }
+
+                const u32 dest_offset = instr.flow_control.dest_offset;
+                switch (opcode) {
+                case OpCode::Id::CALL:
+                case OpCode::Id::CALLU:
+                    queue(dest_offset, dest_offset + instr.flow_control.num_instructions);
+                    break;
+                case OpCode::Id::JMPU:
+                    queue(dest_offset, MAX_PROGRAM_CODE_LENGTH);
+                    break;
+                case OpCode::Id::IFU:
+                case OpCode::Id::LOOP:
+                    // JitShader only asserts on backwards blocks, leave those to it
+                    if (dest_offset < offset) {
+                        return false;
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        return true;
+    }();
+
+    runnable_entry_points.emplace(entry_point, runnable);
+    return runnable;
+}
+
+void JitShaderSimd::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                            const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+
+    // Reset flow control state
+    program = (CompiledShader*)getCurr();
+    program_counter = 0;
+    loop_depth = 0;
+    instruction_labels.fill(Xbyak::Label());
+
+    // Find all `CALL` instructions and identify return locations
+    FindReturnOffsets();
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+
+    // Load loop register
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(ShaderUnitSimd, loop_register)]);
+
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<std::size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<std::size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+
+    // Jump to start of the shader program
+    jmp(ABI_PARAM3);
+
+    // Compile entire program
+    Compile_Block(static_cast<u32>(program_code->size()));
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_SIMD_SHADER_SIZE,
+               "Compiled a shader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled SIMD shader size={}", getSize());
+}
+
+JitShaderSimd::JitShaderSimd() : Xbyak::CodeGenerator(MAX_SIMD_SHADER_SIZE) {}
+
+} // namespace Pica::Shader
+
+#endif // BORKED3DS_ARCH(x86_64)
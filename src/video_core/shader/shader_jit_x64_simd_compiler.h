@@ -0,0 +1,191 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+#if BORKED3DS_ARCH(x86_64)
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak/xbyak.h>
+#include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
+#include "video_core/pica/shader_setup.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+
+namespace Pica {
+struct ShaderRegs;
+struct ShaderUnit;
+} // namespace Pica
+
+namespace Pica::Shader {
+
+/// Number of vertices shaded by a single invocation of a JitShaderSimd program
+constexpr std::size_t SIMD_LANES = 4;
+
+/// Memory allocated for each compiled SIMD shader
+constexpr std::size_t MAX_SIMD_SHADER_SIZE = MAX_PROGRAM_CODE_LENGTH * 256;
+
+/**
+ * State of SIMD_LANES shader units laid out structure-of-arrays: every component of every register
+ * holds the value of that component for each lane, so one SSE register covers all the lanes.
+ */
+struct ShaderUnitSimd {
+    using Component = std::array<f24, SIMD_LANES>;
+    using Register = std::array<Component, 4>;
+
+    /// Copies the temporaries, outputs, address registers and conditional codes of a unit to
+    /// every lane.
+    void LoadState(const ShaderUnit& unit);
+
+    /// Copies the temporaries, outputs, address registers and conditional codes of a lane into a
+    /// unit.
+    void StoreState(ShaderUnit& unit, std::size_t lane) const;
+
+    /// Loads the inputs of up to SIMD_LANES vertices, missing lanes repeat the last vertex.
+    void LoadInput(const ShaderRegs& config, std::span<const AttributeBuffer> inputs);
+
+    /// Writes the outputs of the first outputs.size() lanes.
+    void WriteOutput(const ShaderRegs& config, std::span<AttributeBuffer> outputs) const;
+
+    static constexpr std::size_t InputOffset(s32 register_index) {
+        return offsetof(ShaderUnitSimd, input) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t OutputOffset(s32 register_index) {
+        return offsetof(ShaderUnitSimd, output) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t TemporaryOffset(s32 register_index) {
+        return offsetof(ShaderUnitSimd, temporary) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t ComponentOffset(u32 component) {
+        return component * sizeof(Component);
+    }
+
+    alignas(16) std::array<Register, 16> input{};
+    alignas(16) std::array<Register, 16> temporary{};
+    alignas(16) std::array<Register, 16> output{};
+    /// Staging register for float uniforms gathered with per-lane relative addressing
+    alignas(16) Register gathered{};
+    alignas(16) std::array<std::array<s32, SIMD_LANES>, 2> address_registers{};
+    /// Per-lane masks with all bits set when the condition is true
+    alignas(16) std::array<std::array<u32, SIMD_LANES>, 2> conditional_code{};
+    s32 loop_register{};
+};
+
+/**
+ * This class implements the structure-of-arrays variant of the x86_64 shader JIT. It recompiles a
+ * Pica shader program into code that runs SIMD_LANES vertices per invocation, with one SSE
+ * register per vector component. Results are bit-identical to JitShader.
+ *
+ * Control flow is only supported when it is uniform across lanes, divergent control flow and
+ * instructions without a SIMD implementation make IsRunnable reject the entry point, in which case
+ * the scalar JitShader has to be used instead.
+ */
+class JitShaderSimd : public Xbyak::CodeGenerator {
+public:
+    JitShaderSimd();
+
+    void Run(const ShaderSetup& setup, ShaderUnitSimd& state, u32 offset) const {
+        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+    }
+
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
+
+    /// Returns true when every instruction reachable from the entry point can run on all lanes.
+    bool IsRunnable(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>& program_code, u32 entry_point);
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOVA(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_CMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+
+private:
+    /// One SSE register per vector component, each holding that component for every lane
+    using ComponentRegs = std::array<Xbyak::Xmm, 4>;
+
+    void Compile_Block(u32 end);
+    void Compile_NextInstr();
+
+    /**
+     * Loads and swizzles the components of a source register selected by `mask` into `dest`.
+     * Components that are not selected are left undefined.
+     */
+    void Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                            const ComponentRegs& dest, u32 mask = 0xF);
+    void Compile_DestEnable(Instruction instr, const ComponentRegs& src);
+
+    /// Returns the mask of the destination components written by the instruction.
+    u32 DestMask(Instruction instr) const;
+
+    /// Computes the index of a relatively addressed float uniform into EBX.
+    void Compile_UniformIndex(Xbyak::Reg64 address_reg, u32 index);
+
+    /// Loads the float uniform at the index in EBX into `dest`, or vec4(1.0) when out of range.
+    void Compile_LoadUniform(Xbyak::Xmm dest);
+
+    /// Transposes four per-lane vectors into per-component vectors. Clobbers the scratch registers.
+    void Compile_Transpose(const ComponentRegs& regs);
+
+    /// Same as JitShader::Compile_SanitizedMul, so both produce identical results.
+    void Compile_SanitizedMul(Xbyak::Xmm src1, Xbyak::Xmm src2, Xbyak::Xmm scratch);
+
+    void Compile_UniformCondition(Instruction instr);
+    void Compile_Return();
+
+    void FindReturnOffsets();
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<u32> return_offsets;
+
+    /// Cached results of IsRunnable, by entry point
+    std::unordered_map<u32, bool> runnable_entry_points;
+
+    u32 program_counter = 0; ///< Offset of the next instruction to decode
+    u8 loop_depth = 0;       ///< Depth of the (nested) loops currently compiled
+
+    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    CompiledShader* program = nullptr;
+};
+
+} // namespace Pica::Shader
+
+#endif